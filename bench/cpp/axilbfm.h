@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	axilbfm.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A small AXI4-lite bus functional model, to act as the bus master
+//		for cores having an AXI-lite slave port.  Reads and writes are
+//	queued, and then issued back to back.  Several AR (or AW/W) requests
+//	may therefore be outstanding at once, just as a pipelined AXI master
+//	would issue them.  RREADY and BREADY are held high.
+//
+//	To use, call before_tick() immediately before the clock edge (once all
+//	other inputs have been set), and after_tick() immediately after.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	AXILBFM_H
+#define	AXILBFM_H
+
+#include <stdint.h>
+#include <assert.h>
+#include <deque>
+
+template <class VA>	class AXILBFM {
+	typedef	struct	{ unsigned addr; uint32_t data; } WRITEREQ;
+
+	VA			*m_core;
+	std::deque<unsigned>	m_arq;	// Reads waiting on AR
+	std::deque<WRITEREQ>	m_awq,	// Writes waiting on AW
+				m_wq;	// Writes waiting on W
+	std::deque<uint32_t>	m_rq;	// Read data, waiting to be claimed
+	unsigned		m_rd_outstanding, m_wr_outstanding;
+	bool			m_ar, m_aw, m_w, m_r, m_b;
+	uint32_t		m_rdata;
+public:
+	// Statistics
+	uint64_t		m_reads, m_writes, m_ar_stalls;
+
+	AXILBFM(VA *core) : m_core(core) {
+		clear();
+		m_reads = m_writes = m_ar_stalls = 0;
+	}
+
+	// clear
+	// {{{
+	// Abandon anything outstanding, as we would on a bus reset
+	void	clear(void) {
+		m_arq.clear();
+		m_awq.clear();
+		m_wq.clear();
+		m_rq.clear();
+		m_rd_outstanding = m_wr_outstanding = 0;
+		m_ar = m_aw = m_w = m_r = m_b = false;
+		m_rdata = 0;
+	}
+	// }}}
+
+	// read, write
+	// {{{
+	// Queue a request.  The address is a byte address.
+	void	read(unsigned addr) {
+		m_arq.push_back(addr);
+		m_rd_outstanding++;
+	}
+
+	void	write(unsigned addr, uint32_t data) {
+		WRITEREQ	req;
+
+		req.addr = addr;
+		req.data = data;
+		m_awq.push_back(req);
+		m_wq.push_back(req);
+		m_wr_outstanding++;
+	}
+	// }}}
+
+	// cancel_reads
+	// {{{
+	// Drop any reads that haven't yet been issued.  Those already issued
+	// will still return, and are left counted as outstanding.
+	void	cancel_reads(void) {
+		m_rd_outstanding -= m_arq.size();
+		m_arq.clear();
+	}
+	// }}}
+
+	// Return the next read result, if one is available
+	bool	rdata(uint32_t &v) {
+		if (m_rq.empty())
+			return false;
+		v = m_rq.front();
+		m_rq.pop_front();
+		return true;
+	}
+
+	unsigned reads_outstanding(void) const { return m_rd_outstanding; }
+	unsigned writes_outstanding(void) const { return m_wr_outstanding; }
+	bool	idle(void) const {
+		return m_rd_outstanding == 0 && m_wr_outstanding == 0; }
+
+	// before_tick
+	// {{{
+	// Drive the bus, and then note which handshakes will take place on
+	// the coming clock edge
+	void	before_tick(void) {
+		m_core->S_AXI_ARVALID = !m_arq.empty();
+		m_core->S_AXI_ARADDR  = (m_arq.empty()) ? 0 : m_arq.front();
+		m_core->S_AXI_ARPROT  = 0;
+
+		m_core->S_AXI_AWVALID = !m_awq.empty();
+		m_core->S_AXI_AWADDR  = (m_awq.empty()) ? 0 : m_awq.front().addr;
+		m_core->S_AXI_AWPROT  = 0;
+
+		m_core->S_AXI_WVALID  = !m_wq.empty();
+		m_core->S_AXI_WDATA   = (m_wq.empty()) ? 0 : m_wq.front().data;
+		m_core->S_AXI_WSTRB   = 0x0f;
+
+		m_core->S_AXI_RREADY  = 1;
+		m_core->S_AXI_BREADY  = 1;
+
+		m_core->eval();
+
+		m_ar = m_core->S_AXI_ARVALID && m_core->S_AXI_ARREADY;
+		m_aw = m_core->S_AXI_AWVALID && m_core->S_AXI_AWREADY;
+		m_w  = m_core->S_AXI_WVALID  && m_core->S_AXI_WREADY;
+		m_r  = m_core->S_AXI_RVALID;
+		m_b  = m_core->S_AXI_BVALID;
+		m_rdata = m_core->S_AXI_RDATA;
+
+		if (m_r)
+			assert(m_core->S_AXI_RRESP == 0);
+		if (m_b)
+			assert(m_core->S_AXI_BRESP == 0);
+		if (m_core->S_AXI_ARVALID && !m_core->S_AXI_ARREADY)
+			m_ar_stalls++;
+	}
+	// }}}
+
+	// after_tick
+	// {{{
+	void	after_tick(void) {
+		if (m_ar)
+			m_arq.pop_front();
+		if (m_aw)
+			m_awq.pop_front();
+		if (m_w)
+			m_wq.pop_front();
+		if (m_r) {
+			// A slave may not respond to a request that hasn't
+			// yet been made
+			assert(m_rd_outstanding > m_arq.size());
+			m_rq.push_back(m_rdata);
+			m_rd_outstanding--;
+			m_reads++;
+		}
+
+		if (m_b) {
+			assert(m_wr_outstanding > m_awq.size());
+			assert(m_wr_outstanding > m_wq.size());
+			m_wr_outstanding--;
+			m_writes++;
+		}
+
+		m_ar = m_aw = m_w = m_r = m_b = false;
+	}
+	// }}}
+};
+
+#endif
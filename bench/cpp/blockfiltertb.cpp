@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	blockfiltertb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	The full rate tests of BLOCKFILTERTB, which feed a block
+//		filter one NLANES wide vector of samples per clock.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdlib.h>
+#include "blockfiltertb.h"
+
+// applyblocks
+// {{{
+template<class VA> void	BLOCKFILTERTB<VA>::applyblocks(int nlen,
+		int64_t *data) {
+	BLOCKCORE<VA>	*core = TESTB<BLOCKCORE<VA> >::m_core;
+	const int	nl = NLANES(), iw = FILTERTB<BLOCKCORE<VA> >::IW();
+	const int	nblocks = (nlen + nl - 1) / nl;
+
+	core->wide(true);
+	core->i_reset  = 0;
+	core->i_tap_wr = 0;
+
+	// One more block than we have data for, so as to flush the last
+	// block's results out of the filter
+	for(int b=0; b<=nblocks; b++) {
+		uint64_t	v = 0;
+
+		// Every now and then, idle for a clock
+		core->i_ce = 0;
+		while((rand() & 7) == 0)
+			FILTERTB<BLOCKCORE<VA> >::tick();
+
+		for(int k=0; k<nl; k++) {
+			int	n = b*nl + k;
+
+			if (b < nblocks && n < nlen)
+				v |= (ubits(data[n], iw) << (k*iw));
+		}
+
+		core->i_ce = 1;
+		core->i_vector = v;
+		FILTERTB<BLOCKCORE<VA> >::tick();
+
+		// Each clock returns the results of the block before
+		for(int k=0; b > 0 && k<nl; k++) {
+			int	n = (b-1)*nl + k;
+
+			if (n < nlen)
+				data[n] = core->lane(k);
+		}
+	}
+
+	core->i_ce = 0;
+	core->wide(false);
+}
+// }}}
+
+// testblocks
+// {{{
+template<class VA> void	BLOCKFILTERTB<VA>::testblocks(int nlen,
+		int64_t *data) {
+	FILTERTB<BLOCKCORE<VA> >::reset();
+	applyblocks(nlen, data);
+}
+// }}}
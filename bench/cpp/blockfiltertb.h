@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	blockfiltertb.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	Test a filter accepting NLANES samples per clock, such as
+//		blockfir.v, using the same FILTERTB tests as any other filter.
+//
+//	BLOCKCORE wraps the block filter so that it looks like a one sample
+//	per clock filter: samples are gathered NLANES at a time, and handed
+//	to the core as one block.  Outputs are then returned one at a time
+//	from the block before.  As a result, the filter appears to have a
+//	delay of 2*NLANES samples.
+//
+//	BLOCKFILTERTB adds testblocks(), which instead feeds the core a new
+//	block on (nearly) every clock, as it would be used in practice.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	BLOCKFILTERTB_H
+#define	BLOCKFILTERTB_H
+
+#include <stdint.h>
+#include <assert.h>
+#include "filtertb.h"
+
+// blockbits
+// {{{
+// Extract w bits, starting at lsb, from the wide output of a core.  Verilator
+// uses an integer for up to 64 bits, and an array of 32-bit words beyond.
+static inline uint64_t	blockbits(uint32_t v, int lsb, int w) {
+	return (v >> lsb) & ((w >= 64) ? ~0ul : ((1ul << w)-1));
+}
+
+static inline uint64_t	blockbits(uint64_t v, int lsb, int w) {
+	return (v >> lsb) & ((w >= 64) ? ~0ul : ((1ul << w)-1));
+}
+
+template <class W> static inline uint64_t	blockbits(const W &v, int lsb, int w) {
+	uint64_t	r = 0;
+
+	for(int b=0; b<w; b++) {
+		int	k = lsb + b;
+		if ((v[k/32] >> (k&31)) & 1)
+			r |= (1ul << b);
+	}
+
+	return r;
+}
+// }}}
+
+template <class VA> class BLOCKCORE {
+	VA	*m_block;
+	int	m_nlanes, m_iw, m_ow, m_lane;
+	bool	m_wide, m_last_clk;
+	uint64_t	m_in;	// Samples received so far this block
+	int64_t		*m_out;	// Outputs from the last block
+public:
+	// The ports of a one sample per clock filter
+	uint8_t		i_clk, i_reset, i_ce, i_tap_wr;
+	uint64_t	i_tap, i_sample, o_result;
+	// The block presented to the core on i_ce, when wide()
+	uint64_t	i_vector;
+
+	BLOCKCORE(void) {
+		m_block = new VA;
+		m_block->eval();
+		m_nlanes = m_block->o_NLANES;
+		m_iw     = m_block->o_IW;
+		m_ow     = m_block->o_OW;
+		// i_sample must fit in a single verilator word
+		assert(m_nlanes * m_iw <= 64);
+
+		m_out = new int64_t[m_nlanes];
+		m_wide = false;
+		m_last_clk = false;
+		i_clk = i_reset = i_ce = i_tap_wr = 0;
+		i_tap = i_sample = o_result = i_vector = 0;
+		clear();
+	}
+
+	~BLOCKCORE(void) {
+		delete[] m_out;
+		delete	m_block;
+	}
+
+	VA	*core(void) { return m_block; }
+	int	nlanes(void) const { return m_nlanes; }
+
+	// When wide, i_ce and i_vector go straight to the core, and outputs
+	// must be read with lane()
+	void	wide(bool w) { m_wide = w; }
+
+	// The sign extended output of lane k of the core
+	int64_t	lane(int k) {
+		uint64_t	v = blockbits(m_block->o_result, k*m_ow, m_ow);
+
+		return ((int64_t)(v << (64-m_ow))) >> (64-m_ow);
+	}
+
+	void	clear(void) {
+		m_lane = 0;
+		m_in   = 0;
+		for(int k=0; k<m_nlanes; k++)
+			m_out[k] = 0;
+		o_result = 0;
+	}
+
+	void	eval(void) {
+		bool		posedge = (i_clk && !m_last_clk);
+		uint64_t	s = i_sample & ((1ul << m_iw)-1);
+
+		m_last_clk = i_clk;
+
+		m_block->i_clk    = i_clk;
+		m_block->i_reset  = i_reset;
+		m_block->i_tap_wr = i_tap_wr;
+		m_block->i_tap    = i_tap;
+		if (m_wide) {
+			m_block->i_ce     = i_ce;
+			m_block->i_sample = i_vector;
+		} else {
+			m_block->i_ce     = (i_ce && m_lane == m_nlanes-1);
+			m_block->i_sample = m_in | (s << (m_lane * m_iw));
+		}
+		m_block->eval();
+
+		if (!posedge)
+			return;
+
+		if (i_reset)
+			clear();
+		else if (i_ce && !m_wide) {
+			o_result = m_out[m_lane] & ((1ul << m_ow)-1);
+			m_in |= (s << (m_lane * m_iw));
+
+			if (m_lane == m_nlanes-1) {
+				// The core has just accepted this block, and
+				// now returns the results of the last one
+				for(int k=0; k<m_nlanes; k++)
+					m_out[k] = lane(k);
+				m_in   = 0;
+				m_lane = 0;
+			} else
+				m_lane++;
+		}
+	}
+
+	void	trace(VerilatedVcdC *tfp, int levels) {
+		m_block->trace(tfp, levels);
+	}
+};
+
+template <class VA> class BLOCKFILTERTB : public FILTERTB<BLOCKCORE<VA> > {
+public:
+	BLOCKFILTERTB(void) {
+		FILTERTB<BLOCKCORE<VA> >::DELAY(2*NLANES());
+	}
+
+	int	NLANES(void) const {
+		return TESTB<BLOCKCORE<VA> >::m_core->nlanes();
+	}
+
+	// Apply nlen samples to the filter, NLANES at a time, on all but a
+	// few random clocks.  Unlike apply(), the results are aligned with
+	// the data, so data[k] is replaced by the filter's k'th output.
+	void	applyblocks(int nlen, int64_t *data);
+
+	// Reset the filter, and then applyblocks()
+	void	testblocks(int nlen, int64_t *data);
+};
+
+#endif
@@ -0,0 +1,257 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename:	blockfir_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test blockfir, the NLANES samples per clock FIR filter.
+//		Through BLOCKFILTERTB, each configuration is first put through
+//	the same impulse, overflow, and frequency response tests as fastfir.
+//	Then, fed one block per clock, its outputs are checked bit for bit
+//	against fastfir given the same random taps and samples.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <signal.h>
+#include <time.h>
+#include <ctype.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vblockfir.h"
+#include "Vblockfir_k2.h"
+#include "Vblockfir_k3.h"
+#include "Vfastfir.h"
+#include "testb.h"
+#include "filtertb.h"
+#include "filtertb.cpp"
+#include "blockfiltertb.h"
+#include "blockfiltertb.cpp"
+#include "twelvebfltr.h"
+
+const	unsigned	NTAPS = 128;
+const	unsigned	IW   = 12; // bits
+const	unsigned	TW   = 12; // bits
+const	unsigned	OW   = IW+TW+7; // bits
+
+template <class VA> class	BLOCKFIR_TB : public BLOCKFILTERTB<VA> {
+public:
+
+	// BLOCKFIR_TB
+	// {{{
+	BLOCKFIR_TB(void) {
+		FILTERTB<BLOCKCORE<VA> >::TW(::TW);
+		FILTERTB<BLOCKCORE<VA> >::IW(::IW);
+		FILTERTB<BLOCKCORE<VA> >::OW(::OW);
+		FILTERTB<BLOCKCORE<VA> >::NTAPS(::NTAPS);
+	}
+	// }}}
+
+	// trace
+	// {{{
+	void	trace(const char *vcd_trace_file_name) {
+		fprintf(stderr, "Opening TRACE(%s)\n", vcd_trace_file_name);
+		TESTB<BLOCKCORE<VA> >::opentrace(vcd_trace_file_name);
+	}
+	// }}}
+};
+
+// The single lane reference, fastfir
+class	FASTFIR_TB : public FILTERTB<Vfastfir> {
+public:
+	FASTFIR_TB(void) {
+		TW(::TW);
+		IW(::IW);
+		OW(::OW);
+		NTAPS(::NTAPS);
+		DELAY(1);
+	}
+};
+
+// runtests
+// {{{
+// The standard set of tests, as applied to fastfir
+template <class VA> void	runtests(BLOCKFIR_TB<VA> *tb) {
+	const int	TAPVALUE = -(1<<(TW-1));
+	const int64_t	IMPULSE  =  (1<<(IW-1))-1;
+
+	int64_t	tapvec[NTAPS];
+	int64_t	ivec[2*NTAPS];
+
+	tb->reset();
+
+	// Impulse + overflow checks
+	// {{{
+	for(unsigned k=0; k<NTAPS; k++) {
+		for(unsigned i=0; i<NTAPS; i++)
+			tapvec[i] = 0;
+		tapvec[k] = TAPVALUE;
+
+		tb->testload(NTAPS, tapvec);
+		tb->test_overflow();
+	}
+	// }}}
+
+	// Block filter, impulse input
+	// {{{
+	for(unsigned i=0; i<NTAPS; i++)
+		tapvec[i] = TAPVALUE;
+
+	tb->testload(NTAPS, tapvec);
+
+	for(unsigned i=0; i<2*NTAPS; i++)
+		ivec[i] = 0;
+	ivec[0] = IMPULSE;
+
+	tb->test(2*NTAPS, ivec);
+
+	for(unsigned i=0; i<NTAPS; i++)
+		assert(ivec[i] == IMPULSE * TAPVALUE);
+	// }}}
+
+	// Block filter, block input
+	// {{{
+	for(unsigned i=0; i<2*NTAPS; i++)
+		ivec[i] = IMPULSE;
+
+	tb->test(2*NTAPS, ivec);
+
+	for(unsigned i=0; i<NTAPS; i++)
+		assert(ivec[i] == (i+1)*IMPULSE*TAPVALUE);
+
+	assert(tb->test_overflow());
+	// }}}
+
+	// Frequency response
+	// {{{
+	assert(NCOEFFS < NTAPS);
+	for(int i=0; i<NCOEFFS; i++)
+		tapvec[i] = icoeffs[i];
+	for(int i=NCOEFFS; i<(int)NTAPS; i++)
+		tapvec[i] = 0;
+
+	tb->testload(NTAPS, tapvec);
+
+	{
+		double fp,      // Passband frequency cutoff
+			fs,     // Stopband frequency cutoff,
+			depth,  // Depth of the stopband
+			ripple; // Maximum deviation within the passband
+
+		tb->measure_lowpass(fp, fs, depth, ripple);
+		printf("FP     = %f\n", fp);
+		printf("FS     = %f\n", fs);
+		printf("DEPTH  = %6.2f dB\n", depth);
+		printf("RIPPLE = %.2g\n", ripple);
+
+		// The same filter as fastfir, with the same stopband depth
+		assert(depth < -54);
+		assert(depth > -55);
+	}
+	// }}}
+}
+// }}}
+
+// fullrate
+// {{{
+// Load random taps into both filters, and feed them the same random samples:
+// fastfir one per clock, the block filter NLANES per clock.  The two must
+// agree, sample for sample.
+template <class VA> void	fullrate(BLOCKFIR_TB<VA> *tb, FASTFIR_TB *ref,
+		unsigned seed) {
+	// A multiple of every NLANES we test
+	const int	NLEN = 48*NTAPS;
+	int64_t		tapvec[NTAPS];
+	int64_t		*expected = new int64_t[NLEN],
+			*actual   = new int64_t[NLEN];
+
+	srand(seed);
+	for(unsigned i=0; i<NTAPS; i++)
+		tapvec[i] = (rand() & ((1<<TW)-1)) - (1<<(TW-1));
+	for(int i=0; i<NLEN; i++)
+		expected[i] = actual[i] = (rand() & ((1<<IW)-1)) - (1<<(IW-1));
+
+	ref->load(NTAPS, tapvec);
+	ref->test(NLEN, expected);
+
+	tb->load(NTAPS, tapvec);
+	tb->testblocks(NLEN, actual);
+
+	for(int i=0; i<NLEN; i++) {
+		if (actual[i] != expected[i]) {
+			printf("MISMATCH: NLANES = %d, seed %d, sample %d: "
+				"%ld (blockfir) != %ld (fastfir)\n",
+				tb->NLANES(), seed, i,
+				(long)actual[i], (long)expected[i]);
+			assert(0);
+		}
+	}
+
+	printf("NLANES = %d, seed %d: %d samples match fastfir\n",
+		tb->NLANES(), seed, NLEN);
+
+	delete[] expected;
+	delete[] actual;
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	BLOCKFIR_TB<Vblockfir>		*tb  = new BLOCKFIR_TB<Vblockfir>();
+	BLOCKFIR_TB<Vblockfir_k2>	*tb2 = new BLOCKFIR_TB<Vblockfir_k2>();
+	BLOCKFIR_TB<Vblockfir_k3>	*tb3 = new BLOCKFIR_TB<Vblockfir_k3>();
+	FASTFIR_TB			*ref = new FASTFIR_TB();
+
+	if ((argc > 1)&&(strcmp(argv[1], "-d")==0))
+		tb->trace("trace.vcd");
+
+	runtests(tb);
+	runtests(tb2);
+	runtests(tb3);
+
+	for(unsigned seed=1; seed<=4; seed++) {
+		fullrate(tb,  ref, seed);
+		fullrate(tb2, ref, seed);
+		fullrate(tb3, ref, seed);
+	}
+
+	delete tb;
+	delete tb2;
+	delete tb3;
+	delete ref;
+	printf("SUCCESS\n");
+
+	exit(0);
+}
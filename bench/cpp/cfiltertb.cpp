@@ -0,0 +1,327 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cfiltertb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	The complex filter testbench class, CFILTERTB.  See
+//		cfiltertb.h for a description.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "cfiltertb.h"
+
+// reset
+// {{{
+template<class VFLTR> void	CFILTERTB<VFLTR>::reset(void) {
+	TESTB<VFLTR>::m_core->i_tap   = 0;
+	TESTB<VFLTR>::m_core->i_sample= 0;
+	TESTB<VFLTR>::m_core->i_ce    = 0;
+	TESTB<VFLTR>::m_core->i_tap_wr= 0;
+
+	TESTB<VFLTR>::reset();
+
+	TESTB<VFLTR>::m_core->i_reset = 0;
+}
+// }}}
+
+// load
+// {{{
+template<class VFLTR> void	CFILTERTB<VFLTR>::load(int ntaps,
+		const int64_t *re, const int64_t *im) {
+	assert(ntaps <= NTAPS());
+
+	TESTB<VFLTR>::m_core->i_reset = 0;
+	TESTB<VFLTR>::m_core->i_ce    = 0;
+	TESTB<VFLTR>::m_core->i_tap_wr= 1;
+	for(int i=0; i<ntaps; i++) {
+		m_tre[i] = sbits(re[i], TW());
+		m_tim[i] = (CTAPS()) ? sbits(im[i], TW()) : 0;
+
+		if (CTAPS())
+			TESTB<VFLTR>::m_core->i_tap = (ubits(re[i], TW())<<TW())
+					| ubits(im[i], TW());
+		else
+			TESTB<VFLTR>::m_core->i_tap = ubits(re[i], TW());
+
+		TESTB<VFLTR>::tick();
+	}
+	TESTB<VFLTR>::m_core->i_tap_wr= 0;
+
+	for(int i=ntaps; i<NTAPS(); i++)
+		m_tre[i] = m_tim[i] = 0;
+}
+// }}}
+
+// apply
+// {{{
+template<class VFLTR> void	CFILTERTB<VFLTR>::apply(int nlen,
+		int64_t *re, int64_t *im) {
+	// Both halves of the result must fit in one Verilator word
+	assert(2*OW() <= 64);
+
+	TESTB<VFLTR>::m_core->i_reset  = 0;
+	TESTB<VFLTR>::m_core->i_tap_wr = 0;
+	TESTB<VFLTR>::m_core->i_ce     = 0;
+	TESTB<VFLTR>::tick();
+	for(int i=0; i<nlen; i++) {
+		uint64_t	r;
+
+		TESTB<VFLTR>::m_core->i_ce     = 1;
+		TESTB<VFLTR>::m_core->i_sample = pack_sample(re[i], im[i]);
+		TESTB<VFLTR>::tick();
+
+		r = TESTB<VFLTR>::m_core->o_result;
+		re[i] = sbits(r >> OW(), OW());
+		im[i] = sbits(r, OW());
+
+		TESTB<VFLTR>::m_core->i_ce     = 0;
+		for(int k=1; k<m_nclks; k++)
+			TESTB<VFLTR>::tick();
+	}
+	TESTB<VFLTR>::m_core->i_ce     = 0;
+}
+// }}}
+
+// test
+// {{{
+template<class VFLTR> void	CFILTERTB<VFLTR>::test(int nlen,
+		int64_t *re, int64_t *im) {
+	int	tstcounts = nlen+DELAY();
+	int64_t	*xre = new int64_t[tstcounts],
+		*xim = new int64_t[tstcounts];
+
+	assert(nlen > 0);
+
+	for(int i=0; i<tstcounts; i++) {
+		xre[i] = (i < nlen) ? re[i] : 0;
+		xim[i] = (i < nlen) ? im[i] : 0;
+	}
+
+	reset();
+	apply(tstcounts, xre, xim);
+
+	for(int i=0; i<nlen; i++) {
+		re[i] = xre[i+DELAY()];
+		im[i] = xim[i+DELAY()];
+	}
+
+	delete[] xre;
+	delete[] xim;
+}
+// }}}
+
+// testload
+// {{{
+template<class VFLTR> void	CFILTERTB<VFLTR>::testload(int ntaps,
+		const int64_t *re, const int64_t *im) {
+	const int64_t	IMPULSE = -(1l<<(IW()-1));
+	int	nlen = 2*NTAPS();
+	int64_t	*yre = new int64_t[nlen], *yim = new int64_t[nlen];
+	bool	mismatch = false;
+
+	load(ntaps, re, im);
+
+	// A real impulse, IMPULSE * h[k], followed by an imaginary one,
+	// j * IMPULSE * h[k]
+	for(int pass=0; pass<2; pass++) {
+		for(int k=0; k<nlen; k++)
+			yre[k] = yim[k] = 0;
+		if (pass == 0)
+			yre[0] = IMPULSE;
+		else
+			yim[0] = IMPULSE;
+
+		test(nlen, yre, yim);
+
+		for(int k=0; k<nlen; k++) {
+			int64_t	hre, him;
+
+			if (pass == 0) {
+				hre =  yre[k] / IMPULSE;
+				him =  yim[k] / IMPULSE;
+			} else {
+				hre =  yim[k] / IMPULSE;
+				him = -yre[k] / IMPULSE;
+			}
+
+			if (hre != ((k < NTAPS()) ? m_tre[k] : 0)
+				|| him != ((k < NTAPS()) ? m_tim[k] : 0)) {
+				printf("Err: %s impulse, h[%3d] = %ld%+ldj, "
+					"expected %ld%+ldj\n",
+					(pass) ? "Imaginary" : "Real", k,
+					(long)hre, (long)him,
+					(long)((k<NTAPS()) ? m_tre[k] : 0),
+					(long)((k<NTAPS()) ? m_tim[k] : 0));
+				mismatch = true;
+			}
+		}
+	}
+
+	delete[] yre;
+	delete[] yim;
+
+	if (mismatch) {
+		fflush(stdout);
+		assert(!mismatch);
+	}
+}
+// }}}
+
+// check
+// {{{
+template<class VFLTR> bool	CFILTERTB<VFLTR>::check(int nlen,
+		const int64_t *re, const int64_t *im) {
+	int64_t	*yre = new int64_t[nlen], *yim = new int64_t[nlen];
+	bool	pass = true;
+
+	for(int n=0; n<nlen; n++) {
+		yre[n] = re[n];
+		yim[n] = im[n];
+	}
+
+	test(nlen, yre, yim);
+
+	for(int n=0; n<nlen && pass; n++) {
+		int64_t	ere = 0, eim = 0;
+
+		for(int k=0; k<NTAPS() && k<=n; k++) {
+			int64_t	xre = sbits(re[n-k], IW()),
+				xim = sbits(im[n-k], IW());
+
+			ere += m_tre[k] * xre - m_tim[k] * xim;
+			eim += m_tre[k] * xim + m_tim[k] * xre;
+		}
+
+		ere = sbits(ere, OW());
+		eim = sbits(eim, OW());
+
+		if (yre[n] != ere || yim[n] != eim) {
+			printf("MISMATCH: Output[%d] = %ld%+ldj, "
+				"expected %ld%+ldj\n", n,
+				(long)yre[n], (long)yim[n],
+				(long)ere, (long)eim);
+			pass = false;
+		}
+	}
+
+	delete[] yre;
+	delete[] yim;
+	return pass;
+}
+// }}}
+
+// test_overflow
+// {{{
+template<class VFLTR> bool	CFILTERTB<VFLTR>::test_overflow(void) {
+	int	nlen = 2*NTAPS();
+	int64_t	*xre = new int64_t[nlen], *xim = new int64_t[nlen];
+	int64_t	maxv = (1l<<(IW()-1))-1, minv = -maxv-1,
+		maxre = 0, maxim = 0;
+	bool	pass;
+
+	// Align every input with its tap, so as to maximize first the real,
+	// and then the imaginary part of the output
+	for(int n=0; n<nlen; n++)
+		xre[n] = xim[n] = 0;
+	for(int k=0; k<NTAPS(); k++) {
+		int	n = NTAPS()-1-k;
+
+		xre[n] = (m_tre[k] < 0) ? minv : maxv;
+		xim[n] = (m_tim[k] < 0) ? maxv : minv;
+
+		n += NTAPS();
+		xre[n] = (m_tim[k] < 0) ? minv : maxv;
+		xim[n] = (m_tre[k] < 0) ? minv : maxv;
+
+		maxre += llabs(m_tre[k] * xre[NTAPS()-1-k])
+			+ llabs(m_tim[k] * xim[NTAPS()-1-k]);
+		maxim += llabs(m_tre[k] * xim[n]) + llabs(m_tim[k] * xre[n]);
+	}
+
+	// Neither extreme may exceed the output width
+	pass = (maxre < (1l<<(OW()-1))) && (maxim < (1l<<(OW()-1)));
+	if (!pass)
+		printf("OVERFLOW: %ld, %ld require more than %d bits\n",
+			(long)maxre, (long)maxim, OW());
+
+	pass = pass && check(nlen, xre, xim);
+
+	delete[] xre;
+	delete[] xim;
+	return pass;
+}
+// }}}
+
+// response
+// {{{
+template<class VFLTR> void	CFILTERTB<VFLTR>::response(int nfreq,
+		COMPLEX *rvec, double mag, const char *fname) {
+	int	nlen = NTAPS();
+	int64_t	*xre = new int64_t[nlen], *xim = new int64_t[nlen];
+
+	mag = mag * ((1<<(IW()-1))-1);
+
+	for(int i=0; i<nfreq; i++) {
+		// Frequency, in radians per sample, from -pi to pi
+		double	dtheta = 2.0 * M_PI * (i - nfreq/2) / (double)nfreq,
+			theta;
+
+		// A complex exponential, ending with a phase of zero at the
+		// last sample, where the filter is full.  The last output is
+		// then mag * H(dtheta)
+		theta = -(nlen-1) * dtheta;
+		for(int j=0; j<nlen; j++) {
+			xre[j] = (int64_t)round(mag * cos(theta));
+			xim[j] = (int64_t)round(mag * sin(theta));
+			theta += dtheta;
+		}
+
+		test(nlen, xre, xim);
+		rvec[i] = COMPLEX(xre[nlen-1] / mag, xim[nlen-1] / mag);
+	}
+
+	delete[] xre;
+	delete[] xim;
+
+	if (fname) {
+		FILE* fp;
+		fp = fopen(fname,"w");
+		fwrite(rvec, sizeof(COMPLEX), nfreq, fp);
+		fclose(fp);
+	}
+}
+// }}}
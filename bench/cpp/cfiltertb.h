@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cfiltertb.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A testbench class for complex filters, such as cfastfir.v and
+//		cslowfil.v, whose samples are complex and packed into a single
+//	word as { real, imaginary }.  Taps may be either real or, with
+//	CTAPS(true), complex--packed the same way.
+//
+//	This is FILTERTB, only with every sample (and possibly every tap)
+//	replaced by a pair of vectors: one real, one imaginary.  Results are
+//	checked against a (bit exact) complex convolution of the last taps
+//	loaded, and the frequency response is measured from -1/2 to 1/2
+//	cycles per sample, since positive and negative frequencies are no
+//	longer mirror images of each other.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	CFILTERTB_H
+#define	CFILTERTB_H
+
+#include <stdint.h>
+
+#ifndef	COMPLEX_H
+#include <complex>
+#define	COMPLEX_H
+typedef	std::complex<double>	COMPLEX;
+#endif
+
+template <class VFLTR> class CFILTERTB : public TESTB<VFLTR> {
+protected:
+	// The last taps loaded, as used by the model
+	int64_t	*m_tre, *m_tim;
+	int	m_delay, m_iw, m_ow, m_tw, m_ntaps, m_nclks;
+	bool	m_ctaps;
+
+	static	int64_t	sbits(uint64_t val, int b) {
+		int64_t	s = (int64_t)(val << (64-b));
+		return	s >> (64-b);
+	}
+
+	static	uint64_t ubits(int64_t val, int b) {
+		return	((uint64_t)val) & ((1ul << b)-1);
+	}
+
+	uint64_t	pack_sample(int64_t re, int64_t im) const {
+		return (ubits(re, IW()) << IW()) | ubits(im, IW());
+	}
+public:
+	CFILTERTB(void) {
+		m_delay = 2;
+		m_iw    = 12;
+		m_ow    = 32;
+		m_tw    = 12;
+		m_ntaps = 128;
+		m_nclks = 1;
+		m_ctaps = true;
+		m_tre = new int64_t[m_ntaps];
+		m_tim = new int64_t[m_ntaps];
+		for(int k=0; k<m_ntaps; k++)
+			m_tre[k] = m_tim[k] = 0;
+	}
+
+	~CFILTERTB(void) {
+		delete[] m_tre;
+		delete[] m_tim;
+	}
+
+	// The bits in each half of the input sample, IW
+	int	IW(int k)    { m_iw = k;    return m_iw; }
+	int	IW(void) const    { return m_iw; }
+
+	// The bits in each half of the output sample, OW
+	int	OW(void) const    { return m_ow; }
+	int	OW(int k)    { m_ow = k;    return m_ow; }
+
+	// The bits in each tap--or each half of each tap, if complex
+	int	TW(void) const    { return m_tw; }
+	int	TW(int k)    { m_tw = k;    return m_tw; }
+
+	// True if the filter has complex taps, false if real
+	bool	CTAPS(void) const { return m_ctaps; }
+	bool	CTAPS(bool c) { m_ctaps = c; return m_ctaps; }
+
+	// The number of samples from an input to its first output
+	int	DELAY(void) const { return m_delay; }
+	int	DELAY(int k) { m_delay = k; return m_delay; }
+
+	// The number of clocks per sample
+	int	CKPCE(void) const { return m_nclks; }
+	int	CKPCE(int k) {
+		m_nclks = (k <= 1) ? 1 : k;
+		return m_nclks;
+	}
+
+	int	NTAPS(void) const { return m_ntaps; }
+	int	NTAPS(int k) {
+		delete[] m_tre;
+		delete[] m_tim;
+		m_ntaps = k;
+		m_tre = new int64_t[m_ntaps];
+		m_tim = new int64_t[m_ntaps];
+		for(int i=0; i<m_ntaps; i++)
+			m_tre[i] = m_tim[i] = 0;
+		return m_ntaps;
+	}
+
+	virtual	void	reset(void);
+
+	// Load ntaps taps into the filter.  im is ignored, and may be NULL,
+	// if the taps are real.
+	virtual	void	load(int ntaps, const int64_t *re, const int64_t *im);
+
+	// Apply a given test vector to the filter (no reset applied).  The
+	// results replace the inputs.
+	virtual	void	apply(int nlen, int64_t *re, int64_t *im);
+
+	// Reset the filter, and apply a test vector to it.  The results,
+	// adjusted for DELAY(), replace the inputs.
+	virtual	void	test(int nlen, int64_t *re, int64_t *im);
+
+	// Load the taps, and then check them against the responses to both
+	// a real and an imaginary impulse
+	virtual	void	testload(int ntaps, const int64_t *re,
+				const int64_t *im);
+
+	// Filter the given vector, and compare the result against the
+	// complex convolution of the vector with the last taps loaded
+	bool	check(int nlen, const int64_t *re, const int64_t *im);
+
+	// Check the result of the worst case input for the taps loaded, and
+	// that this result doesn't overflow OW bits
+	bool	test_overflow(void);
+
+	// Measure the filter's frequency response at nfreq frequencies,
+	// from -1/2 up to (but not including) 1/2 cycles per sample
+	virtual	void	response(int nfreq, COMPLEX *rvec, double mag = 1.0,
+				const char *fname = NULL);
+};
+
+#endif
@@ -0,0 +1,410 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cicdecim_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test the CIC decimator, cicdecim.v, both with and without
+//		Hogenauer's register pruning and its slowfil compensation
+//	filter.  Every output is checked, bit for bit, against cicmodel.cpp,
+//	across rates from the slowest to the fastest each configuration
+//	supports.  The pruned and unpruned decimators are then compared
+//	against each other, to show that pruning adds less than an LSB of
+//	noise, and the compensation filter is checked for a flat passband.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <verilatedos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "cicmodel.h"
+#include "Vcicdecim.h"
+#include "Vcicdecim_pruned.h"
+#include "Vcicdecim_m2.h"
+#include "Vcicdecim_fir.h"
+
+// Outputs the model has produced, which the core hasn't yet
+const	int	NPENDING = 16;
+
+template <class VA> class CICDECIM_TB : public TESTB<VA> {
+	int		m_iw, m_ow, m_nstages, m_lgmaxrate, m_delay,
+			m_ntaps, m_ctw, *m_prune;
+	CICMODEL	*m_model;
+	int64_t		m_pending[NPENDING];
+	unsigned	m_head, m_tail;
+public:
+	bool		m_failed;
+
+	CICDECIM_TB(void) {
+		VA	*core = TESTB<VA>::m_core;
+
+		// Get the parameters of the core we are testing
+		core->i_stage = 0;
+		core->eval();
+		m_iw        = core->o_IW;
+		m_ow        = core->o_OW;
+		m_nstages   = core->o_NSTAGES;
+		m_lgmaxrate = core->o_LGMAXRATE;
+		m_delay     = core->o_DIFFDELAY;
+		m_ntaps     = core->o_NCTAPS;
+		m_ctw       = core->o_CTW;
+
+		m_prune = new int[2*m_nstages];
+		for(int s=0; s<2*m_nstages; s++) {
+			core->i_stage = s;
+			core->eval();
+			m_prune[s] = core->o_prune;
+		}
+
+		m_model = new CICMODEL(false, m_nstages, m_lgmaxrate, m_delay,
+				m_iw, m_ow, m_prune);
+		m_head = m_tail = 0;
+		m_failed = false;
+
+		core->i_ce     = 0;
+		core->i_tap_wr = 0;
+	}
+
+	~CICDECIM_TB(void) {
+		delete[] m_prune;
+		delete m_model;
+	}
+
+	int	NSTAGES(void) const { return m_nstages; }
+	int	MAXRATE(void) const { return 1<<m_lgmaxrate; }
+	int	DELAY(void) const { return m_delay; }
+	int	NCTAPS(void) const { return m_ntaps; }
+	int	IW(void) const { return m_iw; }
+	int	OW(void) const { return m_ow; }
+	int	prune(int s) const { return m_prune[s]; }
+	int	normshift(int r) const { return m_model->normshift(r); }
+
+	// setup
+	// {{{
+	// Set the rate and shift during a reset, and load any compensation
+	// filter
+	void	setup(int rate, int shift, const int64_t *taps = NULL) {
+		VA	*core = TESTB<VA>::m_core;
+
+		core->i_rate  = rate-1;
+		core->i_shift = shift;
+		TESTB<VA>::reset();
+
+		if (m_ntaps > 0) {
+			for(int k=0; k<m_ntaps; k++) {
+				core->i_tap_wr = 1;
+				core->i_tap = (int)taps[k] & ((1<<m_ctw)-1);
+				TESTB<VA>::tick();
+			}
+			core->i_tap_wr = 0;
+			m_model->compfir(m_ntaps, m_ctw, taps);
+		}
+
+		m_model->reset(rate, shift);
+		m_head = m_tail = 0;
+	}
+	// }}}
+
+	// tick
+	// {{{
+	// Step the core, checking any output against the model
+	void	tick(void) {
+		VA	*core = TESTB<VA>::m_core;
+		int64_t	out;
+
+		if (core->i_ce && m_model->decimate(core->i_sample, &out)) {
+			m_pending[m_head] = out;
+			m_head = (m_head + 1) % NPENDING;
+			assert(m_head != m_tail);
+		}
+
+		TESTB<VA>::tick();
+
+		if (core->o_ce) {
+			int64_t	v = core->o_result;
+
+			v <<= (64-m_ow);
+			v >>= (64-m_ow);
+			if (m_head == m_tail) {
+				if (!m_failed)
+					printf("Unexpected output, %ld\n", v);
+				m_failed = true;
+			} else {
+				if (v != m_pending[m_tail] && !m_failed) {
+					printf("Output = %ld, when it should "
+						"be %ld\n", v,
+						m_pending[m_tail]);
+					m_failed = true;
+				}
+				m_tail = (m_tail + 1) % NPENDING;
+			}
+		}
+	}
+	// }}}
+
+	// apply
+	// {{{
+	// Apply nin samples, one every clock, or with probability pvalid (in
+	// percent), and collect the outputs into out[].  Returns the number
+	// of outputs.
+	int	apply(int nin, const int64_t *in, int64_t *out, int pvalid) {
+		VA	*core = TESTB<VA>::m_core;
+		int	nout = 0;
+		int	mask = (1<<m_iw)-1;
+
+		for(int k=0; k<nin; ) {
+			core->i_ce = ((rand() % 100) < pvalid);
+			core->i_sample = (int)in[k] & mask;
+			if (core->i_ce)
+				k++;
+			tick();
+			if (core->o_ce)
+				out[nout++] = core->o_result;
+		}
+
+		// Flush the pipeline
+		core->i_ce = 0;
+		for(int k=0; k<2*m_nstages + m_ntaps + 16; k++) {
+			tick();
+			if (core->o_ce)
+				out[nout++] = core->o_result;
+		}
+
+		if (m_head != m_tail) {
+			if (!m_failed)
+				printf("Missing outputs\n");
+			m_failed = true;
+		}
+
+		for(int k=0; k<nout; k++) {
+			out[k] <<= (64-m_ow);
+			out[k] >>= (64-m_ow);
+		}
+		return nout;
+	}
+	// }}}
+};
+
+// testrates
+// {{{
+// Check a configuration bit for bit at its slowest, a middle, and its
+// fastest rate, and then again with two extra bits of gain to force it to
+// saturate
+template <class VA> bool testrates(const char *name, int minrate,
+		const int64_t *taps = NULL) {
+	const	int	NOUT = 200;
+	bool	pass = true;
+	int	rates[3];
+
+	{
+		CICDECIM_TB<VA>	tb;
+		int		lgm = (tb.DELAY() > 1) ? 1 : 0;
+		int		expected[32];
+
+		// Is the pruning what Hogenauer's rules say it should be?
+		if (minrate > 0)
+			CICMODEL::hogenauer(tb.NSTAGES(), tb.DELAY(),
+				tb.IW(), tb.OW(), minrate, expected);
+		else
+			for(int s=0; s<2*tb.NSTAGES(); s++)
+				expected[s] = 0;
+
+		printf("%-12s Bits dropped:", name);
+		for(int s=0; s<2*tb.NSTAGES(); s++) {
+			printf(" %d", tb.prune(s));
+			if (tb.prune(s) != expected[s]) {
+				printf(" (should be %d)", expected[s]);
+				pass = false;
+			}
+		}
+		printf(" from %d\n", tb.IW() + tb.NSTAGES()
+				* ((int)log2(tb.MAXRATE()) + lgm));
+
+		rates[0] = (minrate > 0) ? minrate : 2;
+		rates[1] = (rates[0] + tb.MAXRATE()) / 3;
+		rates[2] = tb.MAXRATE();
+	}
+
+	for(int r=0; r<3; r++) {
+	for(int boost=0; boost<=2; boost+=2) {
+		int	rate = rates[r], nin = NOUT * rate, nout;
+		int64_t	*in = new int64_t[nin], *out = new int64_t[NOUT+8];
+		CICDECIM_TB<VA>	tb;
+
+		tb.setup(rate, tb.normshift(rate) + boost, taps);
+		CICMODEL::randomdata(nin, tb.IW(), in);
+		// With a compensation filter, there must be at least NCTAPS
+		// clocks between CIC outputs
+		nout = tb.apply(nin, in, out,
+				(rate <= tb.NCTAPS()) ? 50 : 100);
+
+		printf("%-12s R = %5d, shift = %2d: %4d outputs%s\n",
+			name, rate, tb.normshift(rate) + boost, nout,
+			(tb.m_failed || nout != NOUT)
+				? "  -- FAILED" : "");
+		if (tb.m_failed || nout != NOUT)
+			pass = false;
+
+		delete[] in;
+		delete[] out;
+	}}
+
+	return pass;
+}
+// }}}
+
+// testpruning
+// {{{
+// Run the same data through the pruned and unpruned decimators.  Pruning
+// truncates, so the difference between the two has a DC offset to it.
+// Hogenauer's design bounds only the variance of this difference, so it is
+// the noise about that offset that should be well within an LSB.
+bool	testpruning(int rate) {
+	const	int	NOUT = 400;
+	int		nin = NOUT * rate, n0, n1;
+	int64_t		*in = new int64_t[nin], *full = new int64_t[NOUT+8],
+			*pruned = new int64_t[NOUT+8];
+	double		err = 0, bias = 0;
+	bool		pass;
+
+	{
+		CICDECIM_TB<Vcicdecim>	tb;
+
+		tb.setup(rate, tb.normshift(rate));
+		CICMODEL::randomdata(nin, tb.IW(), in);
+		n0 = tb.apply(nin, in, full, 100);
+		pass = !tb.m_failed;
+	}
+
+	{
+		CICDECIM_TB<Vcicdecim_pruned>	tb;
+
+		tb.setup(rate, tb.normshift(rate));
+		n1 = tb.apply(nin, in, pruned, 100);
+		pass = pass && !tb.m_failed;
+	}
+
+	pass = pass && (n0 == NOUT) && (n1 == NOUT);
+	for(int k=0; k<NOUT; k++)
+		bias += (double)(pruned[k] - full[k]);
+	bias /= NOUT;
+	for(int k=0; k<NOUT; k++) {
+		double	d = (double)(pruned[k] - full[k]) - bias;
+		err += d * d;
+	}
+	err = sqrt(err / NOUT);
+
+	printf("Pruning at R = %5d adds %.3f LSBs RMS, offset by %6.3f%s\n",
+		rate, err, bias, (pass && err < 1.0) ? "" : "  -- FAILED");
+
+	delete[] in;
+	delete[] full;
+	delete[] pruned;
+	return pass && err < 1.0;
+}
+// }}}
+
+// measure_gain
+// {{{
+// Measure the gain of a tone at frequency f (in cycles per output sample),
+// through the CIC and its compensation filter
+double	measure_gain(const int64_t *taps, int rate, double f) {
+	const	int	NOUT = 400, NSKIP = 100;
+	int		nin = NOUT * rate, nout;
+	int64_t		*in = new int64_t[nin], *out = new int64_t[NOUT+8];
+	double		amp, gain;
+	CICDECIM_TB<Vcicdecim_fir>	tb;
+
+	amp = 0.5 * (1<<(tb.IW()-1));
+	tb.setup(rate, tb.normshift(rate), taps);
+	for(int k=0; k<nin; k++)
+		in[k] = (int64_t)floor(amp * cos(2*M_PI*f*k/rate) + 0.5);
+	nout = tb.apply(nin, in, out, 100);
+	assert(nout == NOUT && !tb.m_failed);
+
+	// The gain is one at DC, so long as the rate is a power of two
+	gain = CICMODEL::toneamp(NOUT - NSKIP, &out[NSKIP], f) / amp
+			* (1<<(tb.IW() - tb.OW()));
+
+	delete[] in;
+	delete[] out;
+	return gain;
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	bool	pass = true;
+
+	// Start by checking our pruning calculation against the example in
+	// Hogenauer's paper: N = 4, R = 25, M = 1, and 16 bits in and out
+	{
+		const	int	HOGENAUER[] = { 1, 6, 9, 13, 14, 15, 16, 17 };
+		int		prune[8];
+
+		CICMODEL::hogenauer(4, 1, 16, 16, 25, prune);
+		for(int s=0; s<8; s++)
+			if (prune[s] != HOGENAUER[s]) {
+				printf("Stage %d prunes %d bits, not %d\n",
+					s+1, prune[s], HOGENAUER[s]);
+				pass = false;
+			}
+	}
+
+	pass = testrates<Vcicdecim>("Full", 0) && pass;
+	pass = testrates<Vcicdecim_pruned>("Pruned", 100) && pass;
+	pass = testrates<Vcicdecim_m2>("M=2", 4) && pass;
+
+	pass = testpruning(100) && pass;
+	pass = testpruning(10000) && pass;
+
+	{
+		int64_t	taps[32];
+
+		CICMODEL::compdesign(4, 32, 1, 31, 16, 0.2, taps);
+		pass = testrates<Vcicdecim_fir>("Compensated", 32, taps)
+			&& pass;
+		pass = CICMODEL::testdroop(4, 32, taps, measure_gain) && pass;
+	}
+
+	if (!pass)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
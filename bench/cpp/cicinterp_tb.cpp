@@ -0,0 +1,319 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cicinterp_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test the CIC interpolator, cicinterp.v, with and without
+//		its slowfil compensation filter.  Every output is checked,
+//	bit for bit, against cicmodel.cpp at rates from one to the largest
+//	each configuration supports, and the compensation filter is checked
+//	for a flat passband.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <verilatedos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "cicmodel.h"
+#include "Vcicinterp.h"
+#include "Vcicinterp_m2.h"
+#include "Vcicinterp_fir.h"
+
+// Outputs the model has produced, which the core hasn't yet
+const	int	NPENDING = 4096;
+
+template <class VA> class CICINTERP_TB : public TESTB<VA> {
+	int		m_iw, m_ow, m_nstages, m_lgmaxrate, m_delay,
+			m_ntaps, m_ctw, m_rate;
+	CICMODEL	*m_model;
+	int64_t		*m_pending, *m_out;
+	unsigned	m_head, m_tail;
+public:
+	bool		m_failed;
+
+	CICINTERP_TB(void) {
+		VA	*core = TESTB<VA>::m_core;
+
+		// Get the parameters of the core we are testing
+		core->eval();
+		m_iw        = core->o_IW;
+		m_ow        = core->o_OW;
+		m_nstages   = core->o_NSTAGES;
+		m_lgmaxrate = core->o_LGMAXRATE;
+		m_delay     = core->o_DIFFDELAY;
+		m_ntaps     = core->o_NCTAPS;
+		m_ctw       = core->o_CTW;
+
+		m_model = new CICMODEL(true, m_nstages, m_lgmaxrate, m_delay,
+				m_iw, m_ow, NULL);
+		m_pending = new int64_t[NPENDING];
+		m_out = new int64_t[1<<m_lgmaxrate];
+		m_head = m_tail = 0;
+		m_rate = 1;
+		m_failed = false;
+
+		core->i_ce     = 0;
+		core->i_tap_wr = 0;
+	}
+
+	~CICINTERP_TB(void) {
+		delete[] m_pending;
+		delete[] m_out;
+		delete m_model;
+	}
+
+	int	MAXRATE(void) const { return 1<<m_lgmaxrate; }
+	int	NCTAPS(void) const { return m_ntaps; }
+	int	IW(void) const { return m_iw; }
+	int	OW(void) const { return m_ow; }
+	int	BW(void) const { return m_model->BW(); }
+	int	normshift(int r) const { return m_model->normshift(r); }
+
+	// setup
+	// {{{
+	// Set the rate and shift during a reset, and load any compensation
+	// filter
+	void	setup(int rate, int shift, const int64_t *taps = NULL) {
+		VA	*core = TESTB<VA>::m_core;
+
+		core->i_rate  = rate-1;
+		core->i_shift = shift;
+		TESTB<VA>::reset();
+
+		if (m_ntaps > 0) {
+			for(int k=0; k<m_ntaps; k++) {
+				core->i_tap_wr = 1;
+				core->i_tap = (int)taps[k] & ((1<<m_ctw)-1);
+				TESTB<VA>::tick();
+			}
+			core->i_tap_wr = 0;
+			m_model->compfir(m_ntaps, m_ctw, taps);
+		}
+
+		m_model->reset(rate, shift);
+		m_rate = rate;
+		m_head = m_tail = 0;
+	}
+	// }}}
+
+	// tick
+	// {{{
+	// Step the core, checking any output against the model
+	void	tick(void) {
+		VA	*core = TESTB<VA>::m_core;
+
+		if (core->i_ce) {
+			m_model->interpolate(core->i_sample, m_out);
+			for(int k=0; k<m_rate; k++) {
+				m_pending[m_head] = m_out[k];
+				m_head = (m_head + 1) % NPENDING;
+				assert(m_head != m_tail);
+			}
+		}
+
+		TESTB<VA>::tick();
+
+		if (core->o_ce) {
+			int64_t	v = core->o_result;
+
+			v <<= (64-m_ow);
+			v >>= (64-m_ow);
+			if (m_head == m_tail) {
+				if (!m_failed)
+					printf("Unexpected output, %ld\n", v);
+				m_failed = true;
+			} else {
+				if (v != m_pending[m_tail] && !m_failed) {
+					printf("Output = %ld, when it should "
+						"be %ld\n", v,
+						m_pending[m_tail]);
+					m_failed = true;
+				}
+				m_tail = (m_tail + 1) % NPENDING;
+			}
+		}
+	}
+	// }}}
+
+	// apply
+	// {{{
+	// Apply nin samples, as close together as the core allows plus up to
+	// gap-1 extra clocks, and collect the outputs into out[].  Returns
+	// the number of outputs.
+	int	apply(int nin, const int64_t *in, int64_t *out, int gap) {
+		VA	*core = TESTB<VA>::m_core;
+		int	nout = 0, spacing;
+
+		spacing = m_rate;
+		if (m_ntaps > 0 && spacing < m_ntaps + 1)
+			spacing = m_ntaps + 1;
+
+		for(int k=0; k<nin; k++) {
+			int	nclocks = spacing + ((gap > 1) ? rand() % gap : 0);
+
+			core->i_sample = (int)in[k] & ((1<<m_iw)-1);
+			for(int c=0; c<nclocks; c++) {
+				core->i_ce = (c == 0);
+				tick();
+				if (core->o_ce)
+					out[nout++] = core->o_result;
+			}
+		}
+
+		// Flush the pipeline
+		core->i_ce = 0;
+		for(int k=0; k<2*m_nstages + m_ntaps + 16 + m_rate; k++) {
+			tick();
+			if (core->o_ce)
+				out[nout++] = core->o_result;
+		}
+
+		if (m_head != m_tail) {
+			if (!m_failed)
+				printf("Missing outputs\n");
+			m_failed = true;
+		}
+
+		for(int k=0; k<nout; k++) {
+			out[k] <<= (64-m_ow);
+			out[k] >>= (64-m_ow);
+		}
+		return nout;
+	}
+	// }}}
+};
+
+// testrates
+// {{{
+// Check a configuration bit for bit at several rates, from one to its
+// largest, and then again with two extra bits of gain to force it to
+// saturate
+template <class VA> bool testrates(const char *name,
+		const int64_t *taps = NULL) {
+	const	int	NIN = 200;
+	bool	pass = true;
+	int	rates[4];
+
+	{
+		CICINTERP_TB<VA>	tb;
+
+		rates[0] = 1;
+		rates[1] = 5;
+		rates[2] = tb.MAXRATE() / 3;
+		rates[3] = tb.MAXRATE();
+		printf("%-12s %d bits, at a rate of %d\n", name,
+			tb.BW(), tb.MAXRATE());
+	}
+
+	for(int r=0; r<4; r++) {
+	for(int boost=0; boost<=2; boost+=2) {
+		int	rate = rates[r], nout;
+		int64_t	*in = new int64_t[NIN],
+			*out = new int64_t[NIN * rate + 8];
+		CICINTERP_TB<VA>	tb;
+
+		tb.setup(rate, tb.normshift(rate) + boost, taps);
+		CICMODEL::randomdata(NIN, tb.IW(), in);
+		nout = tb.apply(NIN, in, out, 3);
+
+		printf("%-12s R = %4d, shift = %2d: %6d outputs%s\n",
+			name, rate, tb.normshift(rate) + boost, nout,
+			(tb.m_failed || nout != NIN * rate)
+				? "  -- FAILED" : "");
+		if (tb.m_failed || nout != NIN * rate)
+			pass = false;
+
+		delete[] in;
+		delete[] out;
+	}}
+
+	return pass;
+}
+// }}}
+
+// measure_gain
+// {{{
+// Measure the gain of a tone at frequency f (in cycles per input sample),
+// through the compensation filter and the CIC
+double	measure_gain(const int64_t *taps, int rate, double f) {
+	const	int	NIN = 400, NSKIP = 100;
+	int		nout;
+	int64_t		*in = new int64_t[NIN],
+			*out = new int64_t[NIN * rate + 8];
+	double		amp, gain;
+	CICINTERP_TB<Vcicinterp_fir>	tb;
+
+	amp = 0.5 * (1<<(tb.IW()-1));
+	tb.setup(rate, tb.normshift(rate), taps);
+	for(int k=0; k<NIN; k++)
+		in[k] = (int64_t)floor(amp * cos(2*M_PI*f*k) + 0.5);
+	nout = tb.apply(NIN, in, out, 1);
+	assert(nout == NIN * rate && !tb.m_failed);
+
+	// The gain is one at DC, so long as the rate is a power of two
+	gain = CICMODEL::toneamp((NIN - NSKIP) * rate, &out[NSKIP * rate],
+			f / rate) / amp * (1<<(tb.IW() - tb.OW()));
+
+	delete[] in;
+	delete[] out;
+	return gain;
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	bool	pass = true;
+
+	pass = testrates<Vcicinterp>("Default") && pass;
+	pass = testrates<Vcicinterp_m2>("M=2") && pass;
+
+	{
+		int64_t	taps[32];
+
+		CICMODEL::compdesign(4, 16, 1, 31, 16, 0.2, taps);
+		pass = testrates<Vcicinterp_fir>("Compensated", taps) && pass;
+		pass = CICMODEL::testdroop(4, 16, taps, measure_gain) && pass;
+	}
+
+	if (!pass)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
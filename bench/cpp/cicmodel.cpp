@@ -0,0 +1,429 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cicmodel.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A bit exact software model of the CIC decimator, cicdecim.v,
+//		and the CIC interpolator, cicinterp.v, together with their
+//	optional slowfil compensation filters.  The model tracks every
+//	integrator and comb register at the width the core uses for it, so
+//	that the effects of register pruning are reproduced exactly.
+//
+//	The model also includes Hogenauer's calculation of how many bits may
+//	be discarded from each stage of a decimator.  (E. B. Hogenauer, "An
+//	Economical Class of Digital Filters for Decimation and
+//	Interpolation," IEEE Trans. ASSP, April 1981.)
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <assert.h>
+#include "cicmodel.h"
+
+// sbits
+// {{{
+static cicint_t	sbits(cicint_t val, int b) {
+	val <<= (128-b);
+	val >>= (128-b);
+	return val;
+}
+// }}}
+
+// nlog2
+// {{{
+// The number of bits required to hold values up to v-1, as in $clog2(v)
+static int	nlog2(int v) {
+	int	r = 0;
+
+	while((1<<r) < v)
+		r++;
+	return r;
+}
+// }}}
+
+CICMODEL::CICMODEL(bool interp, int nstages, int lgmaxrate, int delay,
+		int iw, int ow, const int *prune)
+		: m_interp(interp), m_nstages(nstages), m_lgmaxrate(lgmaxrate),
+		m_delay(delay), m_iw(iw), m_ow(ow) {
+	int	growth = m_lgmaxrate + nlog2(m_delay);
+
+	m_prune = new int[2*m_nstages];
+	m_width = new int[2*m_nstages];
+	m_reg   = new cicint_t[2*m_nstages];
+	m_dly   = new cicint_t[m_nstages * m_delay];
+
+	if (m_interp) {
+		// The width of each stage is set by its maximum gain.  The
+		// combs come first, each growing by one bit.  The integrators
+		// follow, starting from a gain of 2^(N-1) * M.
+		m_bw = m_iw + m_nstages * growth - m_lgmaxrate;
+		for(int s=0; s<m_nstages; s++) {
+			m_prune[s] = m_prune[m_nstages+s] = 0;
+			m_width[s] = m_iw + s + 1;
+			m_width[m_nstages+s] = m_iw + (m_nstages-1-s)
+					+ (s+1) * growth - m_lgmaxrate;
+		}
+	} else {
+		m_bw = m_iw + m_nstages * growth;
+		for(int s=0; s<2*m_nstages; s++) {
+			m_prune[s] = (prune) ? prune[s] : 0;
+			m_width[s] = m_bw - m_prune[s];
+		}
+	}
+	assert(m_bw <= 120);
+
+	m_ntaps = 0;
+	m_taps = m_hist = NULL;
+
+	reset(1, 0);
+}
+
+CICMODEL::~CICMODEL(void) {
+	delete[] m_prune;
+	delete[] m_width;
+	delete[] m_reg;
+	delete[] m_dly;
+	if (m_taps) {
+		delete[] m_taps;
+		delete[] m_hist;
+	}
+}
+
+int	CICMODEL::normshift(int r) const {
+	double	lggain = m_nstages * log2((double)r * m_delay);
+
+	if (m_interp)
+		lggain -= log2((double)r);
+	return m_bw - m_iw - (int)ceil(lggain - 1e-9);
+}
+
+void	CICMODEL::hogenauer(int nstages, int delay,
+		int iw, int ow, int minrate, int *prune) {
+	int		rm = minrate * delay, len = nstages * rm + 1, bout;
+	int64_t		*h = new int64_t[len];
+	double		*lgf = new double[2*nstages];
+
+	// The number of bits the output drops at the slowest rate
+	bout = iw + (int)ceil(nstages * log2((double)rm) - 1e-9) - ow;
+
+	// The integrators: the noise from stage j (counting from one) passes
+	// through (1-z^{-RM})^N / (1-z^{-1})^{N-j+1}.  Start with the
+	// numerator, and accumulate it once for each integrator.
+	for(int k=0; k<len; k++)
+		h[k] = 0;
+	for(int l=0; l<=nstages; l++) {
+		int64_t	binom = 1;
+
+		for(int i=0; i<l; i++)
+			binom = binom * (nstages-i) / (i+1);
+		h[l*rm] = (l&1) ? -binom : binom;
+	}
+
+	for(int t=1; t<=nstages; t++) {
+		long double	f2 = 0;
+
+		for(int k=1; k<len; k++)
+			h[k] += h[k-1];
+		for(int k=0; k<len; k++)
+			f2 += (long double)h[k] * h[k];
+		lgf[nstages-t] = 0.5 * log2((double)f2);
+	}
+
+	// The combs: the noise from stage j passes through the last 2N+1-j
+	// combs alone, so F_j^2 is the binomial coefficient C(2(2N+1-j),2N+1-j)
+	for(int j=nstages+1; j<=2*nstages; j++) {
+		int	nc = 2*nstages+1-j;
+		double	binom = 1;
+
+		for(int i=0; i<nc; i++)
+			binom = binom * (2*nc-i) / (i+1);
+		lgf[j-1] = 0.5 * log2(binom);
+	}
+
+	for(int s=0; s<2*nstages; s++) {
+		int	b = (int)floor(bout - lgf[s] - 0.5 * log2(2.0*nstages));
+
+		prune[s] = (b > 0) ? b : 0;
+	}
+
+	delete[] h;
+	delete[] lgf;
+}
+
+double	CICMODEL::droop(int nstages, int r, int delay, double f) {
+	double	num, den;
+
+	if (f <= 0)
+		return 1.0;
+	num = sin(M_PI * delay * f);
+	den = r * sin(M_PI * delay * f / r);
+	return pow(fabs(num / den), nstages);
+}
+
+void	CICMODEL::randomdata(int n, int iw, int64_t *in) {
+	for(int k=0; k<n; k++) {
+		in[k] = rand() & ((1<<iw)-1);
+		in[k] <<= (64-iw);
+		in[k] >>= (64-iw);
+	}
+}
+
+double	CICMODEL::toneamp(int n, const int64_t *x, double f) {
+	double	re = 0, im = 0;
+
+	for(int k=0; k<n; k++) {
+		re += x[k] * cos(2*M_PI*f*k);
+		im += x[k] * sin(2*M_PI*f*k);
+	}
+
+	return 2 * sqrt(re*re + im*im) / n;
+}
+
+bool	CICMODEL::testdroop(int nstages, int r, const int64_t *taps,
+		double (*gain)(const int64_t *, int, double)) {
+	const	double	FREQS[] = { 0.05, 0.1, 0.15 };
+	bool	pass = true;
+
+	for(int k=0; k<3; k++) {
+		double	lgcomp = 20*log10(gain(taps, r, FREQS[k])),
+			lgcic = 20*log10(droop(nstages, r, 1, FREQS[k]));
+
+		printf("f = %.2f: CIC %6.3f dB, compensated %6.3f dB%s\n",
+			FREQS[k], lgcic, lgcomp,
+			(fabs(lgcomp) < 0.25) ? "" : "  -- FAILED");
+		if (fabs(lgcomp) >= 0.25)
+			pass = false;
+	}
+
+	return pass;
+}
+
+void	CICMODEL::compdesign(int nstages, int r, int delay,
+		int ntaps, int tw, double fpass, int64_t *taps) {
+	const	int	NGRID = 1024;
+	const	double	FTRANS = 0.1;
+	double		*h = new double[ntaps], sum = 0;
+
+	// Frequency sampling: the inverse of the CIC's response across the
+	// passband, with a raised cosine transition to zero beyond it
+	for(int k=0; k<ntaps; k++)
+		h[k] = 0;
+	for(int i=0; i<NGRID; i++) {
+		double	f = (i + 0.5) * 0.5 / NGRID, d;
+
+		if (f <= fpass)
+			d = 1.0 / droop(nstages, r, delay, f);
+		else if (f < fpass + FTRANS)
+			d = 0.5 * (1 + cos(M_PI * (f - fpass) / FTRANS))
+				/ droop(nstages, r, delay, fpass);
+		else
+			d = 0;
+
+		for(int k=0; k<ntaps; k++)
+			h[k] += d * cos(2 * M_PI * f * (k - (ntaps-1)/2.0));
+	}
+
+	// Hann window, then normalize to a DC gain of one
+	for(int k=0; k<ntaps; k++) {
+		h[k] *= 0.5 - 0.5 * cos(2 * M_PI * (k+1) / (ntaps+1));
+		sum += h[k];
+	}
+
+	for(int k=0; k<ntaps; k++)
+		taps[k] = (int64_t)floor(h[k] / sum * (1l << (tw-1)) + 0.5);
+
+	delete[] h;
+}
+
+void	CICMODEL::compfir(int ntaps, int tw, const int64_t *taps) {
+	if (m_taps) {
+		delete[] m_taps;
+		delete[] m_hist;
+	}
+
+	m_ntaps = ntaps;
+	m_tw    = tw;
+	m_taps  = new int64_t[m_ntaps];
+	m_hist  = new int64_t[m_ntaps];
+	for(int k=0; k<m_ntaps; k++) {
+		m_taps[k] = (int64_t)sbits(taps[k], m_tw);
+		m_hist[k] = 0;
+	}
+	m_hpos = 0;
+	m_firout = 0;
+}
+
+void	CICMODEL::reset(int rate, int shift) {
+	m_rate  = rate;
+	m_shift = shift;
+	m_count = 0;
+	for(int s=0; s<2*m_nstages; s++)
+		m_reg[s] = 0;
+	for(int k=0; k<m_nstages * m_delay; k++)
+		m_dly[k] = 0;
+	// Like slowfil, the compensation filter's history isn't reset
+}
+
+// round
+// {{{
+// Shift left by m_shift, then round (half up) and saturate to OW bits
+int64_t	CICMODEL::round(cicint_t v) {
+	int		drop = m_bw - m_ow;
+	cicint_t	lim = ((cicint_t)1) << (m_bw-1-m_shift),
+			maxv = (((cicint_t)1) << (m_ow-1)) - 1, r;
+
+	assert(m_shift < m_bw);
+	if (v >= lim)
+		return (int64_t)maxv;
+	else if (v < -lim)
+		return (int64_t)(-maxv-1);
+
+	r = ((v << m_shift) + (((cicint_t)1) << (drop-1))) >> drop;
+	if (r > maxv)
+		r = maxv;
+	return (int64_t)r;
+}
+// }}}
+
+// compensate
+// {{{
+// Apply one w-bit sample to the compensation filter.  As with slowfil, the
+// result returned is that of the sample before.  It is rounded by TW-1 bits,
+// so that a coefficient of 2^(TW-1) has a gain of one, and saturated back
+// to w bits.
+int64_t	CICMODEL::compensate(int64_t x, int w) {
+	int64_t	result = m_firout, acc = 0, maxv = (1l << (w-1)) - 1;
+
+	m_hist[m_hpos] = x;
+	for(int k=0; k<m_ntaps; k++)
+		acc += m_taps[k] * m_hist[(m_hpos + m_ntaps - k) % m_ntaps];
+	m_hpos = (m_hpos + 1) % m_ntaps;
+
+	acc = (acc + (1l << (m_tw-2))) >> (m_tw-1);
+	if (acc > maxv)
+		acc = maxv;
+	else if (acc < -maxv-1)
+		acc = -maxv-1;
+	m_firout = acc;
+
+	return result;
+}
+// }}}
+
+int	CICMODEL::decimate(int64_t x, int64_t *out) {
+	const int	N = m_nstages;
+	cicint_t	v;
+
+	assert(!m_interp);
+
+	// The integrators, each from the value its predecessor had before
+	// this sample
+	for(int s=N-1; s>=0; s--) {
+		cicint_t	in;
+
+		if (s == 0)
+			in = sbits(x, m_iw);
+		else
+			in = sbits(m_reg[s-1] << m_prune[s-1], m_bw);
+		in >>= m_prune[s];
+		m_reg[s] = sbits(m_reg[s] + in, m_width[s]);
+	}
+
+	if (m_count > 0) {
+		m_count--;
+		return 0;
+	}
+	m_count = m_rate-1;
+
+	// The combs
+	v = sbits(m_reg[N-1] << m_prune[N-1], m_bw);
+	for(int c=0; c<N; c++) {
+		int		s = N+c;
+		cicint_t	in = v >> m_prune[s], *dly = &m_dly[c*m_delay];
+
+		m_reg[s] = sbits(in - dly[m_delay-1], m_width[s]);
+		for(int k=m_delay-1; k>0; k--)
+			dly[k] = dly[k-1];
+		dly[0] = in;
+
+		v = sbits(m_reg[s] << m_prune[s], m_bw);
+	}
+
+	out[0] = round(v);
+	if (m_ntaps > 0)
+		out[0] = compensate(out[0], m_ow);
+	return 1;
+}
+
+void	CICMODEL::interpolate(int64_t x, int64_t *out) {
+	const int	N = m_nstages;
+	cicint_t	v;
+
+	assert(m_interp);
+
+	v = sbits(x, m_iw);
+	if (m_ntaps > 0)
+		v = compensate((int64_t)v, m_iw);
+
+	// The combs, at the input rate
+	for(int c=0; c<N; c++) {
+		cicint_t	in = sbits(v, m_width[c]), *dly = &m_dly[c*m_delay];
+
+		m_reg[c] = sbits(in - dly[m_delay-1], m_width[c]);
+		for(int k=m_delay-1; k>0; k--)
+			dly[k] = dly[k-1];
+		dly[0] = in;
+
+		v = m_reg[c];
+	}
+
+	// The integrators, at the output rate, with rate-1 zeros inserted
+	// after every comb output
+	for(int i=0; i<m_rate; i++) {
+		for(int s=2*N-1; s>=N; s--) {
+			cicint_t	in;
+
+			if (s == N)
+				in = (i == 0) ? v : 0;
+			else
+				in = m_reg[s-1];
+			m_reg[s] = sbits(m_reg[s] + sbits(in, m_width[s]),
+						m_width[s]);
+		}
+
+		out[i] = round(m_reg[2*N-1]);
+	}
+}
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cicmodel.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A bit exact software model of the CIC decimator, cicdecim.v,
+//		and the CIC interpolator, cicinterp.v, together with their
+//	optional slowfil compensation filters.  The model tracks every
+//	integrator and comb register at the width the core uses for it, so
+//	that the effects of register pruning are reproduced exactly.
+//
+//	The model also includes Hogenauer's calculation of how many bits may
+//	be discarded from each stage of a decimator.  (E. B. Hogenauer, "An
+//	Economical Class of Digital Filters for Decimation and
+//	Interpolation," IEEE Trans. ASSP, April 1981.)
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	CICMODEL_H
+#define	CICMODEL_H
+
+#include <stdint.h>
+
+// The first integrator of a CIC can be wider than 64 bits
+typedef	__int128	cicint_t;
+
+class	CICMODEL {
+	bool		m_interp;
+	int		m_nstages, m_lgmaxrate, m_delay, m_iw, m_ow, m_bw;
+	int		*m_prune, *m_width;
+	cicint_t	*m_reg, *m_dly;
+	int		m_rate, m_shift, m_count;
+
+	// The compensation filter, if any
+	int		m_ntaps, m_tw;
+	int64_t		*m_taps, *m_hist, m_firout;
+	unsigned	m_hpos;
+
+	int64_t	round(cicint_t v);
+	int64_t	compensate(int64_t x, int w);
+	cicint_t stage(int s, cicint_t in);
+public:
+	// For a decimator, prune[] gives the number of bits dropped at the
+	// input of each of the 2*nstages stages.  It may be NULL.
+	CICMODEL(bool interp, int nstages, int lgmaxrate, int delay,
+			int iw, int ow, const int *prune);
+	~CICMODEL(void);
+
+	int	BW(void) const { return m_bw; }
+	int	width(int s) const { return m_width[s]; }
+
+	// The shift, i_shift, which best normalizes the gain at rate r
+	int	normshift(int r) const;
+
+	// Hogenauer's register pruning for a decimator, chosen so that no
+	// stage adds more noise than the final truncation to ow bits would at
+	// the slowest rate, minrate.  Higher rates add less.
+	static	void	hogenauer(int nstages, int delay,
+			int iw, int ow, int minrate, int *prune);
+
+	// Design an ntaps long filter to compensate for the droop of a CIC
+	// at rate r, flat to fpass and cut off above fpass+0.1, where the
+	// frequencies are in cycles per sample at the CIC's slower rate.
+	// The coefficients are scaled so that 2^(tw-1) is unity.
+	static	void	compdesign(int nstages, int r, int delay,
+			int ntaps, int tw, double fpass, int64_t *taps);
+
+	// The CIC's own normalized magnitude response at frequency f
+	static	double	droop(int nstages, int r, int delay, double f);
+
+	// Test bench helpers, shared by the decimator and interpolator
+	// {{{
+	// Fill in[] with n random, sign extended, iw-bit samples
+	static	void	randomdata(int n, int iw, int64_t *in);
+
+	// The amplitude of a tone at f cycles per sample within x[0..n-1]
+	static	double	toneamp(int n, const int64_t *x, double f);
+
+	// Check that gain(taps, r, f), the measured gain of a CIC of nstages
+	// (with a delay of one) and its compensation filter, is within
+	// 0.25 dB of unity across the passband.  Returns true on success.
+	static	bool	testdroop(int nstages, int r, const int64_t *taps,
+			double (*gain)(const int64_t *, int, double));
+	// }}}
+
+	// Use a compensation filter of ntaps coefficients, each tw bits
+	void	compfir(int ntaps, int tw, const int64_t *taps);
+
+	// Equivalent to setting i_rate and i_shift during a reset
+	void	reset(int rate, int shift);
+
+	// Decimate: returns the number of outputs, zero or one
+	int	decimate(int64_t x, int64_t *out);
+
+	// Interpolate: produces rate outputs for every input
+	void	interpolate(int64_t x, int64_t *out);
+};
+
+#endif
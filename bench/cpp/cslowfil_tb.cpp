@@ -0,0 +1,250 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename:	cslowfil_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test cslowfil, the complex version of slowfil, in each of
+//		its three forms: complex taps, complex taps using three
+//	multiplies per tap, and real taps.  Each is checked against the
+//	impulse responses of its taps, against a bit exact model given random
+//	taps and data, against overflow, and finally for the frequency
+//	response of a complex (or, with real taps, the usual) lowpass filter.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <signal.h>
+#include <time.h>
+#include <ctype.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vcslowfil.h"
+#include "Vcslowfil_3m.h"
+#include "Vcslowfil_real.h"
+#include "testb.h"
+#include "cfiltertb.h"
+#include "cfiltertb.cpp"
+#include "twelvebfltr.h"
+
+const	unsigned	LGNTAPS = 7;
+const	unsigned	NTAPS = 110;
+const	unsigned	IW   = 12; // bits
+const	unsigned	TW   = 12; // bits
+const	unsigned	OW   = IW+TW+LGNTAPS+1; // bits
+const	unsigned	DELAY= 2;
+const	unsigned	CKPCE= NTAPS;
+const	unsigned	NFREQ= 512;
+
+static	int     nextlg(int vl) {
+	int     r;
+
+	for(r=1; r<vl; r<<=1)
+		;
+	return r;
+}
+
+template <class VA> class	CSLOWFIL_TB : public CFILTERTB<VA> {
+public:
+	// CSLOWFIL_TB
+	// {{{
+	CSLOWFIL_TB(bool ctaps) {
+		CFILTERTB<VA>::TW(::TW);
+		CFILTERTB<VA>::IW(::IW);
+		CFILTERTB<VA>::OW(::OW);
+		CFILTERTB<VA>::NTAPS(::NTAPS);
+		CFILTERTB<VA>::DELAY(::DELAY);
+		CFILTERTB<VA>::CKPCE(::CKPCE);
+		CFILTERTB<VA>::CTAPS(ctaps);
+	}
+	// }}}
+
+	void	test(int nlen, int64_t *re, int64_t *im) {
+		clear_filter();
+		CFILTERTB<VA>::test(nlen, re, im);
+	}
+
+	void	load(int ntaps, const int64_t *re, const int64_t *im) {
+		CFILTERTB<VA>::reset();
+		CFILTERTB<VA>::load(ntaps, re, im);
+	}
+
+	// clear_filter
+	// {{{
+	// As with slowfil, the reset doesn't clear the data memory.  Running
+	// NTAPS worth of zeros through the filter does.
+	void	clear_filter(void) {
+		VA	*core = TESTB<VA>::m_core;
+
+		core->i_tap_wr = 0;
+		core->i_ce     = 1;
+		core->i_sample = 0;
+		for(int k=0; k<nextlg(CFILTERTB<VA>::NTAPS()); k++)
+			TESTB<VA>::tick();
+
+		core->i_ce = 0;
+		for(int k=0; k<CFILTERTB<VA>::CKPCE(); k++)
+			TESTB<VA>::tick();
+	}
+	// }}}
+};
+
+// runtests
+// {{{
+template <class VA> void	runtests(CSLOWFIL_TB<VA> *tb, const char *name) {
+	const int	TAPVALUE = -(1<<(TW-1));
+	int64_t		tre[NTAPS], tim[NTAPS];
+
+	printf("%s: %s taps\n", name, (tb->CTAPS()) ? "Complex" : "Real");
+	tb->reset();
+
+	// Impulse + overflow checks
+	// {{{
+	for(unsigned k=0; k<NTAPS; k++) {
+		for(unsigned i=0; i<NTAPS; i++)
+			tre[i] = tim[i] = 0;
+		tre[k] = TAPVALUE;
+		tim[k] = (int)k - (int)NTAPS/2;
+
+		tb->testload(NTAPS, tre, tim);
+		assert(tb->test_overflow());
+	}
+	// }}}
+
+	// Full scale taps, the worst case for overflow
+	// {{{
+	for(unsigned i=0; i<NTAPS; i++)
+		tre[i] = tim[i] = TAPVALUE;
+	tb->testload(NTAPS, tre, tim);
+	assert(tb->test_overflow());
+	// }}}
+
+	// Random taps and data, compared against the model
+	// {{{
+	{
+		const int	NLEN = 16*NTAPS;
+		int64_t		*xre = new int64_t[NLEN],
+				*xim = new int64_t[NLEN];
+
+		for(unsigned i=0; i<NTAPS; i++) {
+			tre[i] = (rand() & ((1<<TW)-1)) - (1<<(TW-1));
+			tim[i] = (rand() & ((1<<TW)-1)) - (1<<(TW-1));
+		}
+		for(int i=0; i<NLEN; i++) {
+			xre[i] = (rand() & ((1<<IW)-1)) - (1<<(IW-1));
+			xim[i] = (rand() & ((1<<IW)-1)) - (1<<(IW-1));
+		}
+
+		tb->testload(NTAPS, tre, tim);
+		assert(tb->check(NLEN, xre, xim));
+		assert(tb->test_overflow());
+
+		delete[] xre;
+		delete[] xim;
+	}
+	// }}}
+
+	// Frequency response
+	// {{{
+	// With real taps, this is the usual lowpass filter.  With complex
+	// ones, it's shifted up by a quarter of the sample rate, passing
+	// positive frequencies and rejecting negative ones.
+	{
+		COMPLEX	*rvec = new COMPLEX[NFREQ];
+		double	center = (tb->CTAPS()) ? 0.25 : 0.0, pass, stop = 0,
+			depth;
+
+		assert(NCOEFFS < (int)NTAPS);
+		for(unsigned i=0; i<NTAPS; i++) {
+			int64_t	h = (i < (unsigned)NCOEFFS) ? icoeffs[i] : 0;
+
+			if (!tb->CTAPS()) {
+				tre[i] = h;
+				tim[i] = 0;
+			} else switch(i&3) {
+				// h[k] * j^k
+				case 0: tre[i] =  h; tim[i] =  0; break;
+				case 1: tre[i] =  0; tim[i] =  h; break;
+				case 2: tre[i] = -h; tim[i] =  0; break;
+				case 3: tre[i] =  0; tim[i] = -h; break;
+			}
+		}
+
+		tb->testload(NTAPS, tre, tim);
+		tb->response(NFREQ, rvec);
+
+		pass = abs(rvec[NFREQ/2 + (int)(center * NFREQ)]);
+		for(unsigned i=0; i<NFREQ; i++) {
+			double	f = (i - (int)NFREQ/2) / (double)NFREQ - center;
+
+			// Distance from the center of the passband
+			f = fabs(f - round(f));
+			if (f >= 0.27 && abs(rvec[i]) > stop)
+				stop = abs(rvec[i]);
+		}
+
+		depth = 20.0 * log(stop / pass) / log(10.0);
+		printf("DEPTH  = %6.2f dB\n", depth);
+
+		// The same stopband depth as slowfil achieves with these taps
+		assert(depth < -54);
+		assert(depth > -56);
+
+		delete[] rvec;
+	}
+	// }}}
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	CSLOWFIL_TB<Vcslowfil>		*tb  = new CSLOWFIL_TB<Vcslowfil>(true);
+	CSLOWFIL_TB<Vcslowfil_3m>	*tb3 = new CSLOWFIL_TB<Vcslowfil_3m>(true);
+	CSLOWFIL_TB<Vcslowfil_real>	*tbr = new CSLOWFIL_TB<Vcslowfil_real>(false);
+
+	if ((argc > 1)&&(strcmp(argv[1], "-d")==0))
+		tb->opentrace("trace.vcd");
+
+	runtests(tb,  "cslowfil");
+	runtests(tb3, "cslowfil, OPT_3MPY");
+	runtests(tbr, "cslowfil, real taps");
+
+	delete tb;
+	delete tb3;
+	delete tbr;
+	printf("SUCCESS\n");
+
+	exit(0);
+}
@@ -39,6 +39,8 @@
 // }}}
 #include <verilatedos.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
@@ -49,8 +51,34 @@
 #include "verilated_vcd_c.h"
 #include "testb.h"
 #include "Vdelayw.h"
+#include "Vdelayw_bram.h"
 
 const int	DW = 12, LGDLY=4, NTESTS=512;
+// The OPT_BRAM delay line is too long to sweep every delay.  Instead, its
+// delay is changed at random, for NBRAM samples.
+const int	LGBRAM = 16, NBRAM = (1<<19);
+
+//
+// pick_delay
+// {{{
+// Choose a delay for the OPT_BRAM delay line, favoring the special cases:
+// zero, one, and two (the shortest delay through memory), and the longest
+// delay.
+static unsigned	pick_delay(void) {
+	const unsigned	mask = (1<<LGBRAM)-1;
+
+	switch(rand() & 7) {
+	case 0: return 0;
+	case 1: return 1;
+	case 2: return 2;
+	case 3: return mask;
+	case 4: return rand() & 15;
+	case 5: return mask - (rand() & 15);
+	default:
+		return rand() & mask;
+	}
+}
+// }}}
 
 int	main(int argc, char **argv) {
 	Verilated::commandArgs(argc, argv);
@@ -123,6 +151,84 @@ int	main(int argc, char **argv) {
 			break;
 	}
 
+	//
+	// Random delay changes, on the long OPT_BRAM delay line
+	// {{{
+	// A delay given with one i_ce applies to the output produced by the
+	// third i_ce after it.  Every output must then come from exactly the
+	// delay in effect at that time.
+	if (!failed) {
+		TESTB<Vdelayw_bram>	btb;
+		unsigned	bmask = (1<<LGBRAM)-1, pending[3], nchanges = 0;
+		unsigned	*hist = new unsigned[(1<<LGBRAM)];
+		int		hold = 0;
+
+		btb.m_core->i_ce    = 0;
+		btb.m_core->i_delay = pick_delay();
+		btb.reset();
+		pending[0] = pending[1] = pending[2] = btb.m_core->i_delay;
+
+		for(int n=0; n<NBRAM; n++) {
+			unsigned	v = rand() & ((1<<DW)-1),
+					c = rand() & 0x3, dly;
+
+			if (hold-- <= 0) {
+				btb.m_core->i_delay = pick_delay();
+				hold = rand() & 0x3ff;
+				nchanges++;
+			}
+
+			hist[n & bmask] = v;
+			btb.m_core->i_ce = 1;
+			btb.m_core->i_word = v;
+			btb.tick();
+
+			dly = pending[0];
+			pending[0] = pending[1];
+			pending[1] = pending[2];
+			pending[2] = btb.m_core->i_delay;
+
+			if (btb.m_core->o_word != v) {
+				printf("BRAM: O_WORD[%d] = %03x != %03x\n",
+					n, btb.m_core->o_word, v);
+				failed = true;
+			}
+
+			if ((int)dly <= n && btb.m_core->o_delayed
+						!= hist[(n-dly) & bmask]) {
+				printf("BRAM: O_DELAYED[%d] = %03x != X[%d-%d] = %03x\n",
+					n, btb.m_core->o_delayed, n, dly,
+					hist[(n-dly) & bmask]);
+				failed = true;
+			}
+
+			if (failed)
+				break;
+
+			// Idle clocks between samples, during which the delay
+			// may also change
+			btb.m_core->i_ce = 0;
+			for(unsigned i=0; i<c; i++) {
+				unsigned	ow = btb.m_core->o_word,
+						od = btb.m_core->o_delayed;
+
+				btb.m_core->i_word = rand();
+				if ((rand() & 0x3ff) == 0)
+					btb.m_core->i_delay = pick_delay();
+				btb.tick();
+
+				assert(btb.m_core->o_word    == ow);
+				assert(btb.m_core->o_delayed == od);
+			}
+		}
+
+		if (!failed)
+			printf("BRAM: %d samples, %d delay changes\n",
+				NBRAM, nchanges);
+		delete[] hist;
+	}
+	// }}}
+
 	if (failed)
 		printf("TEST FAILURE!\n");
 	else {	
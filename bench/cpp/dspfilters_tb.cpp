@@ -0,0 +1,965 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename:	dspfilters_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	Compares each of the libdspfilters engines (../../sw) against
+//		the Verilated core it is named after.  Each core and its
+//	engine are given the same coefficients and the same data, and every
+//	output of the core must then match the engine's, bit for bit.
+//
+//	Where a core's output depends upon its clock timing, i.e. gaps between
+//	samples or back pressure, those gaps are chosen at random.  The
+//	engines are all latency free, so the comparisons are made after
+//	removing each core's latency.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <signal.h>
+#include <time.h>
+#include <ctype.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vfastfir.h"
+#include "Vslowsymf_i12.h"
+#include "Vshalfband_i12.h"
+#include "Vsubfildown.h"
+#include "Vratfil.h"
+#include "Vsubfildown_shadow.h"
+#include "Vratfil_shadow.h"
+#include "Vboxcar.h"
+#include "Viiravg.h"
+#include "Viiravg_a2.h"
+#include "Vcheapspectral.h"
+#include "testb.h"
+
+#include "filtertb.h"
+#include "filtertb.cpp"
+
+#include "dspfilters.h"
+#include "subfildown_simd.h"
+
+const	int	NTRIALS = 4;
+
+// nextlg
+// {{{
+static	int     nextlg(int vl) {
+	int     r;
+
+	for(r=1; r<vl; r<<=1)
+		;
+	return r;
+}
+// }}}
+
+// randbits
+// {{{
+// A random, signed, nbits value.  The first trial of each test uses the
+// most negative value instead, to check the extremes.
+static	int32_t	randbits(int nbits, bool extreme) {
+	if (extreme)
+		return -(1<<(nbits-1));
+	return (int32_t)sbits(rand(), nbits);
+}
+// }}}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Direct form filters: fastfir, slowsymf, and shalfband
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+
+template<class VFLTR> class DIFFTB : public FILTERTB<VFLTR> {
+	bool	m_clear;
+public:
+	DIFFTB(int ntaps, int iw, int tw, int ow, int delay, int ckpce,
+			bool clear) : m_clear(clear) {
+		this->IW(iw);
+		this->TW(tw);
+		this->OW(ow);
+		this->NTAPS(ntaps);
+		this->DELAY(delay);
+		this->CKPCE(ckpce);
+	}
+
+	void	test(int nlen, int64_t *data) {
+		if (m_clear)
+			clear_filter();
+		FILTERTB<VFLTR>::test(nlen, data);
+	}
+
+	void	load(int nlen, int64_t *data) {
+		this->reset();
+		FILTERTB<VFLTR>::load(nlen, data);
+	}
+
+	// The symmetric filters need NTAPS worth of zeros to clear them.
+	// Their reset isn't sufficient.
+	void	clear_filter(void) {
+		this->m_core->i_tap_wr = 0;
+
+		this->m_core->i_ce     = 1;
+		this->m_core->i_sample = 0;
+		for(int k=0; k<nextlg(this->NTAPS()); k++)
+			this->tick();
+
+		this->m_core->i_ce = 0;
+		for(int k=0; k<this->CKPCE(); k++)
+			this->tick();
+	}
+};
+
+// difffir
+// {{{
+template<class VFLTR, class ENGINE> bool difffir(const char *name,
+		DIFFTB<VFLTR> *tb, ENGINE &eng, int nload) {
+	const	int	NLEN = 4 * tb->NTAPS();
+	int64_t	*taps = new int64_t[nload], *data = new int64_t[NLEN];
+	int32_t	*etaps = new int32_t[nload],
+		*ein = new int32_t[NLEN], *eout = new int32_t[NLEN];
+	bool	pass = true;
+
+	printf("%s\n", name);
+	for(int trial=0; trial<NTRIALS && pass; trial++) {
+		for(int k=0; k<nload; k++)
+			taps[k] = etaps[k] = randbits(tb->TW(), trial == 0);
+		for(int k=0; k<NLEN; k++)
+			data[k] = ein[k] = randbits(tb->IW(), trial == 0);
+
+		tb->load(nload, taps);
+		tb->test(NLEN, data);
+
+		eng.load(span<const int32_t>(etaps, nload));
+		eng.reset();
+		eng.process(span<const int32_t>(ein, NLEN),
+				span<int32_t>(eout, NLEN));
+
+		for(int k=0; k<NLEN && pass; k++) {
+			if (data[k] != eout[k]) {
+				printf("%s, trial %d: OUT[%4d] = %12ld != %12d\n",
+					name, trial, k, data[k], eout[k]);
+				pass = false;
+			}
+		}
+	}
+
+	delete[] taps;
+	delete[] data;
+	delete[] etaps;
+	delete[] ein;
+	delete[] eout;
+
+	return pass;
+}
+// }}}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// diffsubfildown
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+bool	diffsubfildown(void) {
+	const	int	IW = 16, OW = 24, CW = 12, NDOWN = 5, NCOEFFS = 103,
+			SHIFT = 2,
+			// Clocks per sample.  The core needs NCOEFFS+5 clocks
+			// per output, spread over NDOWN samples.
+			CKPCE = 24,
+			NLEN = 256 * NDOWN;
+	int32_t	taps[NCOEFFS], ein[NLEN], eout[NLEN/NDOWN+1],
+		cout[NLEN/NDOWN+1];
+	bool	pass = true;
+
+	printf("Subfildown\n");
+	for(int trial=0; trial<NTRIALS && pass; trial++) {
+		// The core's block timing can't be reset, so each trial
+		// starts from a newly powered up core
+		TESTB<Vsubfildown>	*tb = new TESTB<Vsubfildown>;
+		SUBFILDOWN		eng(IW, OW, CW, NDOWN, NCOEFFS, SHIFT);
+		// Trial zero saturates, the smaller amplitudes of the later
+		// trials exercise the rounding
+		int	amp = (trial < 2) ? IW : IW-4-trial;
+		int	nc = 0, ne;
+
+		for(int k=0; k<NCOEFFS; k++)
+			taps[k] = randbits(CW, trial == 0);
+		for(int k=0; k<NLEN; k++)
+			ein[k] = randbits(amp, trial == 0);
+
+		tb->m_core->i_ce     = 0;
+		tb->m_core->i_sample = 0;
+		tb->m_core->i_tap_wr = 0;
+		tb->reset();
+
+		tb->m_core->i_tap_wr = 1;
+		for(int k=0; k<NCOEFFS; k++) {
+			tb->m_core->i_tap = ubits(taps[k], CW);
+			tb->tick();
+		}
+		tb->m_core->i_tap_wr = 0;
+
+		for(int k=0; k<NLEN; k++) {
+			tb->m_core->i_ce     = 1;
+			tb->m_core->i_sample = ubits(ein[k], IW);
+			for(int ck=0; ck<CKPCE; ck++) {
+				tb->tick();
+				tb->m_core->i_ce = 0;
+				if (tb->m_core->o_ce)
+					cout[nc++] = (int32_t)sbits(
+						tb->m_core->o_result, OW);
+			}
+		}
+
+		eng.load(span<const int32_t>(taps, NCOEFFS));
+		ne = eng.process(span<const int32_t>(ein, NLEN),
+				span<int32_t>(eout, NLEN/NDOWN+1));
+
+		// The vectorized engine must match as well
+		{
+			SUBFILDOWN_SIMD	veng(IW, OW, CW, NDOWN, NCOEFFS, SHIFT);
+			int32_t		vout[NLEN/NDOWN+1];
+
+			veng.load(span<const int32_t>(taps, NCOEFFS));
+			if (ne != veng.process(span<const int32_t>(ein, NLEN),
+					span<int32_t>(vout, NLEN/NDOWN+1))
+				|| memcmp(vout, eout, ne*sizeof(int32_t)) != 0) {
+				printf("Subfildown, trial %d: The %s engine doesn't match\n",
+					trial, dspisa_name(veng.isa()));
+				pass = false;
+			}
+		}
+
+		// The core's last output remains waiting on the next block
+		if (nc != ne-1) {
+			printf("Subfildown, trial %d: %d outputs, expected %d\n",
+				trial, nc, ne-1);
+			pass = false;
+		}
+
+		for(int k=0; k<nc && pass; k++) {
+			if (cout[k] != eout[k]) {
+				printf("Subfildown, trial %d: OUT[%3d] = %8d != %8d\n",
+					trial, k, cout[k], eout[k]);
+				pass = false;
+			}
+		}
+
+		delete tb;
+	}
+
+	return pass;
+}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// swapsubfildown
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+// Subfildown with OPT_SHADOW.  New coefficients are loaded at random while
+// the data streams through, and then committed at a random time.  The core
+// swaps them in starting with the first block to begin with or after the
+// commit, so the engine is given them at the sample given with the commit.
+// Random taps are written between each commit and that block, and the core
+// must ignore them.
+bool	swapsubfildown(void) {
+	const	int	IW = 16, OW = 24, CW = 12, NDOWN = 5, NCOEFFS = 103,
+			SHIFT = 2, CKPCE = 24, NSWAPS = 6,
+			// Samples from the start of one load to the next.  The
+			// load and commit take a dozen samples or so, and the
+			// swap then takes no more than NDOWN.
+			SPAN = 32 * NDOWN,
+			NLEN = (NSWAPS+1) * SPAN;
+	TESTB<Vsubfildown_shadow>	*tb = new TESTB<Vsubfildown_shadow>;
+	SUBFILDOWN	eng(IW, OW, CW, NDOWN, NCOEFFS, SHIFT);
+	int32_t	taps[2][NCOEFFS], ein[NLEN], eout[NLEN+1], cout[NLEN];
+	int	nin = 0, nc = 0, ne = 0, start = 0, ck = 0, swap_at = -1;
+	bool	pass = true;
+
+	printf("Subfildown, coefficient swaps\n");
+
+	for(int k=0; k<NLEN; k++)
+		ein[k] = randbits(IW, false);
+
+	// Load and commit the first set, before any data arrives
+	tb->m_core->i_ce         = 0;
+	tb->m_core->i_sample     = 0;
+	tb->m_core->i_tap_wr     = 0;
+	tb->m_core->i_tap_commit = 0;
+	tb->reset();
+
+	tb->m_core->i_tap_wr = 1;
+	for(int k=0; k<NCOEFFS; k++) {
+		taps[0][k] = randbits(CW, false);
+		tb->m_core->i_tap = ubits(taps[0][k], CW);
+		tb->tick();
+	}
+	tb->m_core->i_tap_wr = 0;
+	tb->m_core->i_tap_commit = 1;
+	tb->tick();
+	tb->m_core->i_tap_commit = 0;
+	eng.load(span<const int32_t>(taps[0], NCOEFFS));
+
+	for(int seg=0; seg<=NSWAPS; seg++) {
+		const int32_t	*next = taps[(seg+1)&1];
+		int		nwritten = 0, wait = rand() % 64;
+
+		for(int k=0; k<NCOEFFS; k++)
+			taps[(seg+1)&1][k] = randbits(CW, false);
+
+		for(; nin < (seg+1) * SPAN; ck++) {
+			bool	commit = false;
+
+			if (swap_at >= 0) {
+				// Between the commit and the block that takes
+				// it.  These writes must be ignored.
+				tb->m_core->i_tap_wr = 1;
+				tb->m_core->i_tap = ubits(randbits(CW, false), CW);
+			} else if (seg == NSWAPS)
+				; // No more swaps, just finish the data
+			else if (nin == 0)
+				; // The first set swaps in with the first sample
+			else if (nwritten < NCOEFFS) {
+				tb->m_core->i_tap_wr = rand() & 1;
+				tb->m_core->i_tap = ubits(next[nwritten], CW);
+				if (tb->m_core->i_tap_wr)
+					nwritten++;
+			} else if (wait > 0)
+				wait--;
+			else if (wait == 0 && ((seg & 1) == 0
+					|| ((ck % CKPCE) == 0
+						&& (nin % NDOWN) == 0))) {
+				// Every other commit lands on the first sample
+				// of a block
+				commit = true;
+				wait = -1;
+				swap_at = ((nin + NDOWN-1) / NDOWN) * NDOWN;
+			}
+			tb->m_core->i_tap_commit = commit;
+
+			if (commit) {
+				// Everything before this sample uses the old
+				// coefficients, everything after the new
+				ne += eng.process(span<const int32_t>(ein+start,
+						nin-start),
+					span<int32_t>(eout+ne, NLEN+1-ne));
+				eng.load(span<const int32_t>(next, NCOEFFS));
+				start = nin;
+			}
+
+			if ((ck % CKPCE) == 0) {
+				if (nin == swap_at) {
+					tb->m_core->i_tap_wr = 0;
+					swap_at = -1;
+				}
+				tb->m_core->i_ce     = 1;
+				tb->m_core->i_sample = ubits(ein[nin++], IW);
+			}
+
+			tb->tick();
+			if (tb->m_core->o_ce)
+				cout[nc++] = (int32_t)sbits(tb->m_core->o_result,
+								OW);
+
+			tb->m_core->i_ce         = 0;
+			tb->m_core->i_tap_wr     = 0;
+			tb->m_core->i_tap_commit = 0;
+		}
+		assert(seg == NSWAPS || wait < 0);
+	}
+
+	ne += eng.process(span<const int32_t>(ein+start, NLEN-start),
+			span<int32_t>(eout+ne, NLEN+1-ne));
+
+	// As before, the core's last output remains waiting on the next block
+	if (nc != ne-1) {
+		printf("Subfildown swaps: %d outputs, expected %d\n", nc, ne-1);
+		pass = false;
+	}
+
+	for(int k=0; k<nc && pass; k++) {
+		if (cout[k] != eout[k]) {
+			printf("Subfildown swaps: OUT[%3d] = %8d != %8d\n",
+				k, cout[k], eout[k]);
+			pass = false;
+		}
+	}
+
+	delete tb;
+
+	return pass;
+}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// diffratfil
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+bool	diffratfil(void) {
+	// The core doesn't report NS, so this must match its default
+	const	int	NS = 2, NIN = 200 * NS, NROUNDS = 3;
+	TESTB<Vratfil>	*tb = new TESTB<Vratfil>;
+	int	iw, tw, ow, nup, ndown, lggain, ncoeffs;
+	int32_t	*taps, ein[NIN], *eout, *cout;
+	bool	*clast, pass = true;
+
+	printf("Ratfil\n");
+
+	tb->m_core->i_tap_wr     = 0;
+	tb->m_core->S_AXI_TVALID = 0;
+	tb->m_core->M_AXI_TREADY = 1;
+	tb->reset();
+
+	iw      = tb->m_core->o_IW;
+	tw      = tb->m_core->o_TW;
+	ow      = tb->m_core->o_OW;
+	nup     = tb->m_core->o_NUP;
+	ndown   = tb->m_core->o_NDOWN;
+	lggain  = tb->m_core->o_LGGAIN;
+	ncoeffs = tb->m_core->o_NCOEFFS;
+
+	RATFIL	eng(iw, tw, ow, NS, nup, ndown, lggain, ncoeffs);
+
+	taps  = new int32_t[ncoeffs];
+	eout  = new int32_t[eng.maxout(NIN)];
+	cout  = new int32_t[NIN];
+	clast = new bool[NIN];
+
+	for(int k=0; k<ncoeffs; k++)
+		taps[k] = randbits(tw, false);
+
+	tb->m_core->i_tap_wr = 1;
+	for(int k=0; k<ncoeffs; k++) {
+		tb->m_core->i_tap = ubits(taps[k], tw);
+		tb->tick();
+	}
+	tb->m_core->i_tap_wr = 0;
+	eng.load(span<const int32_t>(taps, ncoeffs));
+
+	// Each round ends with a reset.  Since the data memory isn't cleared
+	// on reset, the next round then starts with the data of the last.
+	for(int round=0; round<NROUNDS && pass; round++) {
+		int	nin = 0, nc = 0, ne, idle = 0;
+
+		for(int k=0; k<NIN; k++)
+			ein[k] = randbits(iw, false);
+
+		while(idle < 64) {
+			bool	valid = (nin < NIN) && (rand() & 3) != 0;
+
+			tb->m_core->S_AXI_TVALID = valid;
+			tb->m_core->S_AXI_TDATA  = (valid)
+						? ubits(ein[nin], iw) : 0;
+			tb->m_core->S_AXI_TLAST  = (nin % NS) == NS-1;
+			tb->m_core->M_AXI_TREADY = (rand() & 3) != 0;
+			tb->eval();
+
+			if (tb->m_core->M_AXI_TVALID
+					&& tb->m_core->M_AXI_TREADY) {
+				assert(nc < NIN);
+				clast[nc] = tb->m_core->M_AXI_TLAST;
+				cout[nc++] = (int32_t)sbits(
+						tb->m_core->M_AXI_TDATA, iw);
+				idle = 0;
+			} else if (nin >= NIN)
+				idle++;
+
+			if (valid && tb->m_core->S_AXI_TREADY)
+				nin++;
+
+			tb->tick();
+		}
+
+		ne = eng.process(span<const int32_t>(ein, NIN),
+				span<int32_t>(eout, eng.maxout(NIN)));
+
+		if (nc != ne) {
+			printf("Ratfil, round %d: %d outputs, expected %d\n",
+				round, nc, ne);
+			pass = false;
+		}
+
+		for(int k=0; k<nc && pass; k++) {
+			if (cout[k] != eout[k]) {
+				printf("Ratfil, round %d: OUT[%3d] = %6d != %6d\n",
+					round, k, cout[k], eout[k]);
+				pass = false;
+			} else if (clast[k] != ((k % NS) == NS-1)) {
+				printf("Ratfil, round %d: OUT[%3d] has the wrong TLAST\n",
+					round, k);
+				pass = false;
+			}
+		}
+
+		tb->m_core->S_AXI_TVALID = 0;
+		tb->reset();
+		eng.reset();
+	}
+
+	delete[] taps;
+	delete[] eout;
+	delete[] cout;
+	delete[] clast;
+	delete tb;
+
+	return pass;
+}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// swapratfil
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+// Ratfil with OPT_SHADOW.  As with swapsubfildown, new coefficients are loaded
+// and committed at random times while the data streams through, now with
+// random gaps and back pressure as well.  The core swaps them in starting with
+// the first group of NS beats it filters that's accepted with or after the
+// commit.  Since the engine only filters whole groups, it can be given them
+// at the start of the first group accepted with or after the commit.  Every
+// other commit is followed by a few clocks without data, during which random
+// taps are written.  The swap can't have taken place yet, so the core must
+// ignore them.
+bool	swapratfil(void) {
+	const	int	NS = 2, NSWAPS = 6, SPAN = 64 * NS,
+			NIN = (NSWAPS+1) * SPAN;
+	TESTB<Vratfil_shadow>	*tb = new TESTB<Vratfil_shadow>;
+	int	iw, tw, ow, nup, ndown, lggain, ncoeffs;
+	int32_t	*taps[2], ein[NIN], eout[NIN+NS], cout[NIN];
+	int	nin = 0, nc = 0, ne = 0, start = 0, idle = 0, hold = 0;
+	bool	pass = true;
+
+	printf("Ratfil, coefficient swaps\n");
+
+	tb->m_core->i_tap_wr     = 0;
+	tb->m_core->i_tap_commit = 0;
+	tb->m_core->S_AXI_TVALID = 0;
+	tb->m_core->M_AXI_TREADY = 1;
+	tb->reset();
+
+	iw      = tb->m_core->o_IW;
+	tw      = tb->m_core->o_TW;
+	ow      = tb->m_core->o_OW;
+	nup     = tb->m_core->o_NUP;
+	ndown   = tb->m_core->o_NDOWN;
+	lggain  = tb->m_core->o_LGGAIN;
+	ncoeffs = tb->m_core->o_NCOEFFS;
+
+	RATFIL	eng(iw, tw, ow, NS, nup, ndown, lggain, ncoeffs);
+
+	taps[0] = new int32_t[ncoeffs];
+	taps[1] = new int32_t[ncoeffs];
+
+	for(int k=0; k<NIN; k++)
+		ein[k] = randbits(iw, false);
+
+	// Load and commit the first set, before any data arrives
+	tb->m_core->i_tap_wr = 1;
+	for(int k=0; k<ncoeffs; k++) {
+		taps[0][k] = randbits(tw, false);
+		tb->m_core->i_tap = ubits(taps[0][k], tw);
+		tb->tick();
+	}
+	tb->m_core->i_tap_wr = 0;
+	tb->m_core->i_tap_commit = 1;
+	tb->tick();
+	tb->m_core->i_tap_commit = 0;
+	eng.load(span<const int32_t>(taps[0], ncoeffs));
+
+	for(int seg=0; seg<=NSWAPS; seg++) {
+		int32_t	*next = taps[(seg+1)&1];
+		int	nwritten = 0, wait = rand() % 64;
+
+		for(int k=0; k<ncoeffs; k++)
+			next[k] = randbits(tw, false);
+
+		while((seg < NSWAPS) ? (nin < (seg+1) * SPAN) : (idle < 64)) {
+			bool	valid = (nin < NIN) && (rand() & 3) != 0,
+				commit = false;
+
+			if (hold > 0) {
+				// Hold off the data following a commit, so the
+				// swap can't take place yet, and write taps that
+				// must be ignored
+				tb->m_core->i_tap_wr = 1;
+				tb->m_core->i_tap = ubits(randbits(tw, false), tw);
+				valid = false;
+				hold--;
+			} else if (seg == NSWAPS)
+				; // No more swaps, just finish the data
+			else if (nin == 0)
+				; // The first set swaps in with the first beat
+			else if (nwritten < ncoeffs) {
+				tb->m_core->i_tap_wr = rand() & 1;
+				tb->m_core->i_tap = ubits(next[nwritten], tw);
+				if (tb->m_core->i_tap_wr)
+					nwritten++;
+			} else if (wait >= 0 && wait-- == 0) {
+				commit = true;
+				// Every other commit is followed by writes
+				// before the swap
+				if (seg & 1) {
+					hold  = 1 + (rand() % 8);
+					valid = false;
+				}
+			}
+			tb->m_core->i_tap_commit = commit;
+
+			if (commit) {
+				// The old coefficients remain in use through
+				// the end of the group in progress
+				int	end = ((nin + NS-1) / NS) * NS;
+
+				ne += eng.process(span<const int32_t>(ein+start,
+						end-start),
+					span<int32_t>(eout+ne, NIN+NS-ne));
+				eng.load(span<const int32_t>(next, ncoeffs));
+				start = end;
+			}
+
+			tb->m_core->S_AXI_TVALID = valid;
+			tb->m_core->S_AXI_TDATA  = (valid)
+						? ubits(ein[nin], iw) : 0;
+			tb->m_core->S_AXI_TLAST  = (nin % NS) == NS-1;
+			tb->m_core->M_AXI_TREADY = (rand() & 3) != 0;
+			tb->eval();
+
+			if (tb->m_core->M_AXI_TVALID
+					&& tb->m_core->M_AXI_TREADY) {
+				assert(nc < NIN);
+				cout[nc++] = (int32_t)sbits(
+						tb->m_core->M_AXI_TDATA, iw);
+				idle = 0;
+			} else if (nin >= NIN)
+				idle++;
+
+			if (valid && tb->m_core->S_AXI_TREADY)
+				nin++;
+
+			tb->tick();
+			tb->m_core->i_tap_wr     = 0;
+			tb->m_core->i_tap_commit = 0;
+		}
+		assert(seg == NSWAPS || wait < 0);
+	}
+
+	ne += eng.process(span<const int32_t>(ein+start, NIN-start),
+			span<int32_t>(eout+ne, NIN+NS-ne));
+
+	if (nc != ne) {
+		printf("Ratfil swaps: %d outputs, expected %d\n", nc, ne);
+		pass = false;
+	}
+
+	for(int k=0; k<nc && pass; k++) {
+		if (cout[k] != eout[k]) {
+			printf("Ratfil swaps: OUT[%3d] = %6d != %6d\n",
+				k, cout[k], eout[k]);
+			pass = false;
+		}
+	}
+
+	delete[] taps[0];
+	delete[] taps[1];
+	delete tb;
+
+	return pass;
+}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// diffboxcar
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+bool	diffboxcar(void) {
+	const	int	IW = 16, LGMEM = 6, OW = IW+LGMEM, NLEN = 512,
+			// The core's latency, in samples
+			DELAY = 3;
+	const	int	navgs[] = { 0, 1, 2, 17, 63 };
+	TESTB<Vboxcar>	*tb = new TESTB<Vboxcar>;
+	BOXCAR		eng(IW, LGMEM, OW, 0);
+	int32_t		ein[NLEN], eout[NLEN];
+	uint32_t	cout[NLEN];
+	bool		pass = true;
+
+	printf("Boxcar\n");
+
+	// Since the memory isn't reset, later runs (as with the engine)
+	// begin with the data from the runs before them
+	for(unsigned run=0; run<sizeof(navgs)/sizeof(navgs[0]) && pass; run++) {
+		tb->m_core->i_ce     = 0;
+		tb->m_core->i_sample = 0;
+		tb->m_core->i_navg   = navgs[run];
+		tb->reset();
+		eng.reset(navgs[run]);
+
+		for(int k=0; k<NLEN; k++) {
+			ein[k] = rand() & ((1<<IW)-1);
+
+			tb->m_core->i_ce     = 1;
+			tb->m_core->i_sample = ein[k];
+			tb->tick();
+			cout[k] = tb->m_core->o_result;
+
+			tb->m_core->i_ce = 0;
+			for(int gap = rand() & 3; gap > 0; gap--)
+				tb->tick();
+		}
+
+		eng.process(span<const int32_t>(ein, NLEN),
+				span<int32_t>(eout, NLEN));
+
+		for(int k=DELAY; k<NLEN && pass; k++) {
+			if (cout[k] != (uint32_t)eout[k-DELAY]) {
+				printf("Boxcar, NAVG=%2d: OUT[%3d] = %8u != %8u\n",
+					navgs[run], k-DELAY, cout[k],
+					(uint32_t)eout[k-DELAY]);
+				pass = false;
+			}
+		}
+	}
+
+	delete tb;
+
+	return pass;
+}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// diffiiravg
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+template<class VFLTR> bool diffiiravg(const char *name, int lgalpha,
+		uint64_t reset_value) {
+	const	int	IW = 15, OW = 16, NLEN = 4096;
+	TESTB<VFLTR>	*tb = new TESTB<VFLTR>;
+	IIRAVG		eng(IW, OW, lgalpha, reset_value);
+	bool		pass = true;
+
+	printf("%s\n", name);
+
+	tb->m_core->i_ce   = 0;
+	tb->m_core->i_data = 0;
+	tb->reset();
+	eng.reset();
+
+	for(int k=0; k<NLEN && pass; k++) {
+		int32_t	x = rand() & ((1<<IW)-1), y;
+
+		// An occasional reset, to check the reset value
+		if ((rand() & 0x1ff) == 0) {
+			tb->reset();
+			eng.reset();
+		}
+
+		tb->m_core->i_ce   = 1;
+		tb->m_core->i_data = x;
+		tb->tick();
+		eng.process(span<const int32_t>(&x, 1), span<int32_t>(&y, 1));
+
+		if (tb->m_core->o_data != (uint32_t)y) {
+			printf("%s: OUT[%4d] = %6d != %6d\n", name, k,
+				tb->m_core->o_data, y);
+			pass = false;
+		}
+
+		tb->m_core->i_ce = 0;
+		for(int gap = rand() & 3; gap > 0; gap--)
+			tb->tick();
+	}
+
+	delete tb;
+
+	return pass;
+}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// diffcheapspectral
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+// This follows the steps of cheapspectral_tb: clear the memory, request a
+// new estimate, feed it data, wait for the interrupt, and then read the
+// results.  Every clock given to the core is also given to the engine.
+//
+bool	diffcheapspectral(void) {
+	const	int	IW = 10, LGLAGS = 6, LGNAVG = 15,
+			LAGS = 1<<LGLAGS, NAVG = 1<<LGNAVG,
+			NLEN = (LAGS+1) * NAVG, NROUNDS = 2;
+	TESTB<Vcheapspectral>	*tb = new TESTB<Vcheapspectral>;
+	CHEAPSPECTRAL		eng(IW, LGLAGS, LGNAVG);
+	int32_t	*ein = new int32_t[NLEN], eout[LAGS];
+	bool	pass = true;
+
+	printf("Cheapspectral\n");
+
+	tb->m_core->i_data_ce = 0;
+	tb->m_core->i_data    = 0;
+	tb->m_core->i_wb_cyc  = 0;
+	tb->m_core->i_wb_stb  = 0;
+	tb->reset();
+	eng.reset();
+
+	// The second round checks that the core starts the same way again
+	for(int round=0; round<NROUNDS && pass; round++) {
+		// Clear the memory
+		tb->m_core->i_data_ce = 1;
+		tb->m_core->i_data    = 0;
+		for(int k=0; k<LAGS+1; k++) {
+			ein[k] = 0;
+			tb->tick();
+		}
+		tb->m_core->i_data_ce = 0;
+		eng.process(span<const int32_t>(ein, LAGS+1),
+				span<int32_t>(eout, LAGS));
+
+		// Request a new estimate
+		tb->m_core->i_wb_cyc  = 1;
+		tb->m_core->i_wb_stb  = 1;
+		tb->m_core->i_wb_we   = 1;
+		tb->m_core->i_wb_addr = 0;
+		tb->m_core->i_wb_data = 0;
+		tb->m_core->i_wb_sel  = 15;
+		tb->tick();
+		tb->m_core->i_wb_cyc  = 0;
+		tb->m_core->i_wb_stb  = 0;
+		eng.start();
+
+		// Random data
+		for(int k=0; k<NLEN; k++)
+			ein[k] = (int32_t)sbits(rand(), IW);
+
+		tb->m_core->i_data_ce = 1;
+		for(int k=0; k<NLEN; k++) {
+			tb->m_core->i_data = ubits(ein[k], IW);
+			tb->tick();
+		}
+		tb->m_core->i_data_ce = 0;
+		eng.process(span<const int32_t>(ein, NLEN),
+				span<int32_t>(eout, LAGS));
+
+		while(!tb->m_core->o_int) {
+			tb->tick();
+			eng.idle();
+		}
+
+		// Read the results back
+		for(int k=0; k<LAGS && pass; k++) {
+			int32_t	v;
+
+			tb->m_core->i_wb_cyc = 1;
+			tb->m_core->i_wb_stb = 1;
+			tb->m_core->i_wb_we  = 0;
+			tb->m_core->i_wb_addr= k;
+			tb->tick();
+			tb->m_core->i_wb_cyc = 0;
+			tb->m_core->i_wb_stb = 0;
+			v = tb->m_core->o_wb_data;
+			eng.idle();
+
+			if (v != eng.result(k)) {
+				printf("Cheapspectral, round %d: R[%2d] = %10d != %10d\n",
+					round, k, v, eng.result(k));
+				pass = false;
+			}
+		}
+	}
+
+	delete[] ein;
+	delete tb;
+
+	return pass;
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	bool	pass = true;
+
+	{
+		DIFFTB<Vfastfir>	*tb
+				= new DIFFTB<Vfastfir>(128, 12, 12, 31, 1, 1, false);
+		FASTFIR	eng(128, 12, 12, 31);
+
+		pass = pass && difffir("Fastfir", tb, eng, eng.NTAPS());
+		delete tb;
+	}
+
+	{
+		DIFFTB<Vslowsymf_i12>	*tb = new DIFFTB<Vslowsymf_i12>(
+					107, 12, 12, 31, 2, (107-1)/2+3, true);
+		SLOWSYMF	eng(107, 12, 12, 31);
+
+		pass = pass && difffir("Slowsymf", tb, eng, eng.nload());
+		delete tb;
+	}
+
+	{
+		DIFFTB<Vshalfband_i12>	*tb = new DIFFTB<Vshalfband_i12>(
+					107, 12, 12, 31, 2, (107-1)/2+3, true);
+		SHALFBAND	eng(107, 12, 12, 31);
+
+		pass = pass && difffir("Shalfband", tb, eng, eng.nload());
+		delete tb;
+	}
+
+	pass = pass && diffsubfildown();
+	pass = pass && diffratfil();
+	pass = pass && swapsubfildown();
+	pass = pass && swapratfil();
+	pass = pass && diffboxcar();
+	pass = pass && diffiiravg<Viiravg>("Iiravg", 4, 0);
+	pass = pass && diffiiravg<Viiravg_a2>("Iiravg, LGALPHA=2", 2, 49152);
+	pass = pass && diffcheapspectral();
+
+	if (pass)
+		printf("SUCCESS!!\n");
+	else
+		printf("TEST FAILURE!\n");
+
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -4,7 +4,13 @@
 // {{{
 // Project:	DSP Filtering Example Project
 //
-// Purpose:
+// Purpose:	To test fastfir, and its pipelined counterpart pipefir.  Both
+//		are put through the same impulse, overflow, and frequency
+//	response tests.  pipefir is then checked bit for bit against fastfir,
+//	given the same random taps and samples, after allowing for its extra
+//	latency.  The number of simulated clock cycles per second is reported
+//	for each, since a deeper pipeline means more state for Verilator to
+//	update every clock.
 //
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
@@ -47,6 +53,10 @@
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 #include "Vfastfir.h"
+#include "Vpipefir.h"
+#include "Vpipefir_f2.h"
+#include "Vfastfir_shadow.h"
+#include "Vpipefir_shadow.h"
 #include "testb.h"
 #include "filtertb.h"
 #include "filtertb.cpp"
@@ -58,17 +68,17 @@ const	unsigned	TW   = 12; // bits
 const	unsigned	OW   = IW+TW+7; // bits
 const	unsigned	DELAY= 1; // bits
 
-class	FASTFIR_TB : public FILTERTB<Vfastfir> {
+template <class VA> class	FASTFIR_TB : public FILTERTB<VA> {
 public:
 
 	// FASTFIR_TB
 	// {{{
 	FASTFIR_TB(void) {
-		TW(::TW);
-		IW(::IW);
-		OW(::OW);
-		NTAPS(::NTAPS);
-		DELAY(::DELAY);
+		FILTERTB<VA>::TW(::TW);
+		FILTERTB<VA>::IW(::IW);
+		FILTERTB<VA>::OW(::OW);
+		FILTERTB<VA>::NTAPS(::NTAPS);
+		FILTERTB<VA>::DELAY(::DELAY);
 	}
 	// }}}
 
@@ -76,41 +86,30 @@ public:
 	// {{{
 	void	trace(const char *vcd_trace_file_name) {
 		fprintf(stderr, "Opening TRACE(%s)\n", vcd_trace_file_name);
-		opentrace(vcd_trace_file_name);
+		TESTB<VA>::opentrace(vcd_trace_file_name);
 	}
 	// }}}
 };
 
-FASTFIR_TB	*tb;
+// pipefir is fastfir, delayed by however many samples it says it needs
+template <class VA> FASTFIR_TB<VA> *new_pipefir(void) {
+	FASTFIR_TB<VA>	*tb = new FASTFIR_TB<VA>();
 
-int	main(int argc, char **argv) {
-	Verilated::commandArgs(argc, argv);
-	tb = new FASTFIR_TB();
-	bool	create_trace = false;
-
-#ifdef	MCY
-	{
-		int	argn, mutation_index;
-		argn = 1;
-		if (argv[argn][0] == '-') {
-			create_trace = (argv[argn][1] == 'd');
-			argn++;
-		}
+	tb->m_core->eval();
+	tb->DELAY(DELAY + tb->m_core->o_latency);
+	return tb;
+}
 
-		if (isdigit(argv[argn][0])) {
-			mutation_index = atoi(argv[argn]);
-			tb->m_core->mutsel = mutation_index;
-		}
-	}
-#endif
+// runtests
+// {{{
+// The standard set of tests, applied to any of our filters
+template <class VA> void	runtests(FASTFIR_TB<VA> *tb) {
 	const int	TAPVALUE = -(1<<(TW-1));
 	const int64_t	IMPULSE  =  (1<<(IW-1))-1;
 
 	int64_t	tapvec[NTAPS];
 	int64_t	ivec[2*NTAPS];
 
-	if (create_trace)
-		tb->trace("trace.vcd");
 	tb->reset();
 
 	// Impulse + overflow checks
@@ -214,8 +213,142 @@ int	main(int argc, char **argv) {
 		assert(depth < -54);
 		assert(depth > -55);
 	}
+}
+// }}}
+
+// random_run
+// {{{
+// Load a set of random taps, and filter nlen random samples.  The result
+// replaces the samples, and the simulation rate (clocks/second) is returned.
+template <class VA> double	random_run(FASTFIR_TB<VA> *tb, unsigned seed,
+		int nlen, int64_t *data) {
+	int64_t		tapvec[NTAPS];
+	uint64_t	ticks;
+	clock_t		start;
+	double		secs;
+
+	srand(seed);
+	for(unsigned i=0; i<NTAPS; i++)
+		tapvec[i] = (rand() & ((1<<TW)-1)) - (1<<(TW-1));
+	for(int i=0; i<nlen; i++)
+		data[i] = (rand() & ((1<<IW)-1)) - (1<<(IW-1));
+
+	tb->load(NTAPS, tapvec);
+
+	ticks = tb->m_tickcount;
+	start = clock();
+	tb->test(nlen, data);
+	secs  = (clock() - start) / (double)CLOCKS_PER_SEC;
+	ticks = tb->m_tickcount - ticks;
+
+	return (secs > 0) ? ticks / secs : 0.0;
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	FASTFIR_TB<Vfastfir>	*tb = new FASTFIR_TB<Vfastfir>();
+	bool	create_trace = false;
+
+#ifdef	MCY
+	{
+		int	argn, mutation_index;
+		argn = 1;
+		if (argv[argn][0] == '-') {
+			create_trace = (argv[argn][1] == 'd');
+			argn++;
+		}
+
+		if (isdigit(argv[argn][0])) {
+			mutation_index = atoi(argv[argn]);
+			tb->m_core->mutsel = mutation_index;
+		}
+	}
+#endif
+
+	if (create_trace)
+		tb->trace("trace.vcd");
+
+	runtests(tb);
+#ifndef	MCY
+	FASTFIR_TB<Vpipefir>	*ptb = new_pipefir<Vpipefir>();
+	FASTFIR_TB<Vpipefir_f2>	*ftb = new_pipefir<Vpipefir_f2>();
+
+	runtests(ptb);
+	runtests(ftb);
+
+	// Bit exact comparison, and simulation rates
+	// {{{
+	{
+		const int	NLEN = 64*NTAPS;
+		int64_t		*ref = new int64_t[NLEN],
+				*pip = new int64_t[NLEN],
+				*fan = new int64_t[NLEN];
+		double		rref, rpip, rfan;
+
+		for(unsigned seed=1; seed<=4; seed++) {
+			rref = random_run(tb,  seed, NLEN, ref);
+			rpip = random_run(ptb, seed, NLEN, pip);
+			rfan = random_run(ftb, seed, NLEN, fan);
+
+			for(int i=0; i<NLEN; i++) {
+				if (pip[i] != ref[i] || fan[i] != ref[i]) {
+					printf("MISMATCH: Seed %d, sample %d: "
+						"%ld (fastfir) != %ld (pipefir)"
+						" or %ld (fanout 2)\n",
+						seed, i, (long)ref[i],
+						(long)pip[i], (long)fan[i]);
+					assert(0);
+				}
+			}
+		}
+
+		printf("fastfir:            latency %2d, %10.0f clocks/s\n",
+			tb->DELAY(), rref);
+		printf("pipefir:            latency %2d, %10.0f clocks/s\n",
+			ptb->DELAY(), rpip);
+		printf("pipefir, fanout 2:  latency %2d, %10.0f clocks/s\n",
+			ftb->DELAY(), rfan);
+
+		delete[] ref;
+		delete[] pip;
+		delete[] fan;
+	}
+	// }}}
+
+	// Coefficient hot swaps
+	// {{{
+	{
+		FASTFIR_TB<Vfastfir_shadow>	*stb
+					= new FASTFIR_TB<Vfastfir_shadow>();
+		FASTFIR_TB<Vpipefir_shadow>	*sptb
+					= new_pipefir<Vpipefir_shadow>();
+		int64_t	first[NTAPS], second[NTAPS];
+
+		for(unsigned i=0; i<NTAPS; i++) {
+			first[i]  = (int64_t)(rand() & ((1<<TW)-1)) - (1<<(TW-1));
+			second[i] = (int64_t)(rand() & ((1<<TW)-1)) - (1<<(TW-1));
+		}
+
+		// The commit reaches the last tap NTAPS samples later.
+		// pipefir's samples reach its taps LATENCY samples late, and
+		// so it finishes the swap that much sooner.
+		assert(stb->testswap(NTAPS, first, second, NTAPS));
+		assert(sptb->testswap(NTAPS, first, second,
+				NTAPS - sptb->m_core->o_latency));
+		printf("fastfir and pipefir: coefficient hot swaps pass\n");
+
+		delete stb;
+		delete sptb;
+	}
+	// }}}
+
+	delete ptb;
+	delete ftb;
+#endif
+
+	delete tb;
 	printf("SUCCESS\n");
 
 	exit(0);
 }
-
@@ -0,0 +1,314 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fastspectral_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test the full rate autocorrelation estimator, fastspectral,
+//		at several levels of parallelism.  Each configuration is
+//	checked bit for bit against a software autocorrelation of the samples
+//	it actually accepted, and the effective number of products per input
+//	sample is reported for each.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2020-2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <verilatedos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "Vfastspectral.h"
+#include "Vfastspectral_p1.h"
+#include "Vfastspectral_pall.h"
+#include "Vfastspectral_skip.h"
+
+template <class VA> class SPECTRAL_TB : public TESTB<VA> {
+	int	m_iw, m_lglags, m_lgnavg, m_lgpar, m_lags, m_navg, m_shift;
+	bool	m_tready;
+
+	// Our software model of the core
+	int64_t		*m_hist, *m_acc;
+	unsigned	m_hpos;
+	bool		m_collecting;
+	int		m_count;
+public:
+	// Statistics from the last run
+	uint64_t	m_clocks, m_recorded, m_processed;
+
+	SPECTRAL_TB(void) {
+		// Get the parameters of the core we are testing
+		TESTB<VA>::m_core->eval();
+		m_iw     = TESTB<VA>::m_core->o_width;
+		m_lglags = TESTB<VA>::m_core->o_lglags;
+		m_lgnavg = TESTB<VA>::m_core->o_lgnavg;
+		m_lgpar  = TESTB<VA>::m_core->o_lgpar;
+		m_tready = TESTB<VA>::m_core->o_tready;
+		m_lags   = (1<<m_lglags);
+		m_navg   = (1<<m_lgnavg);
+		m_shift  = 0;
+		if (2*m_iw + m_lgnavg > 32)
+			m_shift = 2*m_iw + m_lgnavg - 32;
+
+		m_hist = new int64_t[m_lags];
+		m_acc  = new int64_t[m_lags];
+		m_hpos = 0;
+		m_collecting = true;
+		m_count = 0;
+		for(int k=0; k<m_lags; k++)
+			m_hist[k] = m_acc[k] = 0;
+	}
+
+	~SPECTRAL_TB(void) {
+		delete[] m_hist;
+		delete[] m_acc;
+	}
+
+	int	lags(void) const { return m_lags; }
+	int	nlanes(void) const { return 1<<m_lgpar; }
+	int	nsteps(void) const { return m_lags >> m_lgpar; }
+	bool	tready(void) const { return m_tready; }
+
+	// tick
+	// {{{
+	// Step the core, and our model of it with it
+	void	tick(void) {
+		VA	*core = TESTB<VA>::m_core;
+		bool	ready = core->o_data_ready;
+		bool	record = core->i_data_ce && (!m_tready || ready);
+		bool	process= core->i_data_ce && ready && m_collecting;
+		int64_t	x;
+
+		x = core->i_data;
+		x <<= (64-m_iw);
+		x >>= (64-m_iw);
+
+		if (record) {
+			m_hist[m_hpos] = x;
+			m_recorded++;
+		}
+
+		if (process) {
+			for(int k=0; k<m_lags; k++)
+				m_acc[k] = ((m_count == 0) ? 0 : m_acc[k])
+					+ x * m_hist[(m_hpos - k) & (m_lags-1)];
+			m_processed++;
+			if (++m_count >= m_navg) {
+				m_count = 0;
+				m_collecting = false;
+			}
+		}
+
+		if (record)
+			m_hpos = (m_hpos + 1) & (m_lags-1);
+
+		m_clocks++;
+		TESTB<VA>::tick();
+	}
+	// }}}
+
+	// reset_core
+	// {{{
+	void	reset_core(void) {
+		TESTB<VA>::m_core->i_data_ce = 0;
+		TESTB<VA>::m_core->i_data    = 0;
+		TESTB<VA>::m_core->i_wb_cyc  = 0;
+		TESTB<VA>::m_core->i_wb_stb  = 0;
+		TESTB<VA>::reset();
+		m_collecting = true;
+		m_count = 0;
+	}
+	// }}}
+
+	// clear_mem
+	// {{{
+	// Fill the core's sample history with zeros
+	void	clear_mem(void) {
+		int	nz = 0;
+
+		TESTB<VA>::m_core->i_data_ce = 1;
+		TESTB<VA>::m_core->i_data    = 0;
+		while(nz <= m_lags) {
+			if (!m_tready || TESTB<VA>::m_core->o_data_ready)
+				nz++;
+			tick();
+		}
+		TESTB<VA>::m_core->i_data_ce = 0;
+	}
+	// }}}
+
+	// request_start
+	// {{{
+	void	request_start(void) {
+		TESTB<VA>::m_core->i_wb_cyc  = 1;
+		TESTB<VA>::m_core->i_wb_stb  = 1;
+		TESTB<VA>::m_core->i_wb_we   = 1;
+		TESTB<VA>::m_core->i_wb_addr = 0;
+		TESTB<VA>::m_core->i_wb_data = 0;
+		TESTB<VA>::m_core->i_wb_sel  = 15;
+		TESTB<VA>::m_core->i_data_ce = 0;
+		assert(!TESTB<VA>::m_core->o_wb_stall);
+		tick();
+		assert(TESTB<VA>::m_core->o_wb_ack);
+		TESTB<VA>::m_core->i_wb_cyc  = 0;
+		TESTB<VA>::m_core->i_wb_stb  = 0;
+		TESTB<VA>::m_core->i_wb_we   = 0;
+
+		m_collecting = true;
+		m_count = 0;
+	}
+	// }}}
+
+	// wb_read
+	// {{{
+	int	wb_read(unsigned addr) {
+		TESTB<VA>::m_core->i_wb_cyc = 1;
+		TESTB<VA>::m_core->i_wb_stb = 1;
+		TESTB<VA>::m_core->i_wb_we  = 0;
+		TESTB<VA>::m_core->i_wb_addr= addr;
+
+		assert(!TESTB<VA>::m_core->o_wb_stall);
+
+		tick();
+
+		assert(TESTB<VA>::m_core->o_wb_ack);
+
+		TESTB<VA>::m_core->i_wb_cyc = 0;
+		TESTB<VA>::m_core->i_wb_stb = 0;
+		return TESTB<VA>::m_core->o_wb_data;
+	}
+	// }}}
+
+	// run
+	// {{{
+	// Offer one random sample every "pace" clocks, until the core has
+	// correlated 2^LGNAVG of them.  Then read the result back, and
+	// compare it against our model.  Returns true on success.
+	bool	run(const char *name, int pace) {
+		int	dmask = (1<<m_iw)-1, phase = 0;
+		bool	failed = false;
+
+		reset_core();
+		clear_mem();
+		request_start();
+
+		m_clocks = m_recorded = m_processed = 0;
+		while(m_collecting) {
+			bool	handshake;
+
+			if (phase == 0 && !TESTB<VA>::m_core->i_data_ce) {
+				TESTB<VA>::m_core->i_data_ce = 1;
+				TESTB<VA>::m_core->i_data = rand() & dmask;
+			}
+
+			handshake = TESTB<VA>::m_core->i_data_ce
+				&& (!m_tready || TESTB<VA>::m_core->o_data_ready);
+			tick();
+			if (handshake)
+				TESTB<VA>::m_core->i_data_ce = 0;
+			if (++phase >= pace)
+				phase = 0;
+		}
+		TESTB<VA>::m_core->i_data_ce = 0;
+
+		// Statistics are only kept for the collection window
+		uint64_t	clocks = m_clocks,
+				recorded = m_recorded, processed = m_processed;
+
+		for(int k=0; !TESTB<VA>::m_core->o_int; k++) {
+			assert(k < 16 + 2*m_lags);
+			tick();
+		}
+
+		for(int k=0; k<m_lags; k++) {
+			int	mem = wb_read(k);
+			int	expected = (int)(m_acc[m_lags-1-k] >> m_shift);
+
+			if (mem != expected) {
+				if (!failed)
+					printf("%s: R[%d] = %d, when it should be %d\n",
+						name, m_lags-1-k, mem, expected);
+				failed = true;
+			}
+		}
+
+		printf("%-16s P = %2d, pace = %2d: %7.4f samples/clk, "
+			"%6.2f products/sample of %d lags%s\n",
+			name, nlanes(), pace,
+			recorded / (double)clocks,
+			m_lags * processed / (double)recorded, m_lags,
+			(failed) ? "  -- FAILED" : "");
+
+		return !failed;
+	}
+	// }}}
+};
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	bool	pass = true;
+
+	// Backpressure: every sample contributes to every lag, regardless of
+	// the rate it is offered at.  Only the throughput changes.
+	{
+		SPECTRAL_TB<Vfastspectral_p1>	tb;
+		pass = tb.run("P=1", 1) && pass;
+	}
+
+	{
+		SPECTRAL_TB<Vfastspectral>	tb;
+		pass = tb.run("Default", 1) && pass;
+		pass = tb.run("Default", 3) && pass;
+	}
+
+	{
+		SPECTRAL_TB<Vfastspectral_pall>	tb;
+		pass = tb.run("Full rate", 1) && pass;
+	}
+
+	// Without backpressure, samples arriving while the core is busy are
+	// recorded, but not correlated.  If the source is paced at one sample
+	// every NSTEPS clocks, nothing gets skipped.
+	{
+		SPECTRAL_TB<Vfastspectral_skip>	tb;
+		pass = tb.run("No TREADY", 1) && pass;
+		pass = tb.run("No TREADY", tb.nsteps()) && pass;
+	}
+
+	if (!pass)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
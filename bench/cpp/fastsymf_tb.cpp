@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fastsymf_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test the full rate symmetric filter, fastsymf.  Only the
+//		first (NTAPS+1)/2 coefficients are loaded into the filter.
+//	The rest are implied by symmetry, so every test here checks the full
+//	NTAPS long impulse response against both halves of what was loaded.
+//	Both an odd length filter, having a center tap, and an even length
+//	filter, having none, are tested.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <signal.h>
+#include <time.h>
+#include <ctype.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vfastsymf.h"
+#include "Vfastsymf_even.h"
+#include "testb.h"
+#include "filtertb.h"
+#include "filtertb.cpp"
+#include "twelvebfltr.h"
+
+const	unsigned	IW   = 16; // bits
+const	unsigned	TW   = 12; // bits
+const	unsigned	OW   = IW+TW+7; // bits
+const	unsigned	MAXTAPS = 107;
+
+template <class VA> class	FASTSYMF_TB : public FILTERTB<VA> {
+public:
+	// The number of coefficients actually loaded into the filter
+	const	int	m_nmpy;
+
+	// FASTSYMF_TB
+	// {{{
+	FASTSYMF_TB(int ntaps) : m_nmpy((ntaps+1)/2) {
+		FILTERTB<VA>::TW(::TW);
+		FILTERTB<VA>::IW(::IW);
+		FILTERTB<VA>::OW(::OW);
+		FILTERTB<VA>::NTAPS(ntaps);
+		// One clock for the pre-add, one for the multiply, and one
+		// per tap for the accumulator chain
+		FILTERTB<VA>::DELAY(m_nmpy+1);
+	}
+	// }}}
+
+	// testload
+	// {{{
+	// Load the first half of a symmetric filter, then verify the filter
+	// produces the entire impulse response--both halves
+	void	testload(int nlen, int64_t *data) {
+		const int	ntaps = FILTERTB<VA>::NTAPS();
+
+		assert(nlen == m_nmpy);
+		FILTERTB<VA>::load(nlen, data);
+		FILTERTB<VA>::reset();
+
+		for(int k=0; k<2*ntaps; k++) {
+			int64_t	expected = 0;
+			int	m = (*this)[k];
+
+			if (k < m_nmpy)
+				expected = data[k];
+			else if (k < ntaps)
+				expected = data[ntaps-1-k];
+
+			if (m != expected) {
+				printf("Err: H[%3d] = %8d != %8ld\n",
+					k, m, expected);
+				assert(m == expected);
+			}
+		}
+	}
+	// }}}
+};
+
+// runtests
+// {{{
+// The tests that apply to any length of symmetric filter
+template <class VA> void	runtests(FASTSYMF_TB<VA> *tb) {
+	const int	NTAPS = tb->NTAPS(), NMPY = tb->m_nmpy;
+	const int	TAPVALUE = -(1<<(TW-1));
+	const int64_t	IMPULSE  =  (1<<(IW-1))-1;
+
+	int64_t	tapvec[MAXTAPS];
+	int64_t	ivec[2*MAXTAPS];
+
+	assert(NTAPS <= (int)MAXTAPS);
+	tb->reset();
+
+	// Impulse + overflow checks
+	// {{{
+	printf("NTAPS = %3d: Impulse tests\n", NTAPS);
+	for(int k=0; k<NMPY; k++) {
+		//
+		// Create a new coefficient vector
+		//
+		// Initialize it with all zeros
+		for(int i=0; i<NMPY; i++)
+			tapvec[i] = 0;
+		// Then set one value to non-zero
+		tapvec[k] = TAPVALUE;
+
+		// Test whether or not this coefficient vector
+		// loads properly into the filter, and produces both its
+		// tap and its mirror image
+		tb->testload(NMPY, tapvec);
+
+		// Then test whether or not the filter overflows
+		assert(tb->test_overflow());
+	}
+	// }}}
+
+	//
+	// Block filter, impulse input
+	// {{{
+	printf("NTAPS = %3d: Block Fil, Impulse input\n", NTAPS);
+	for(int i=0; i<NMPY; i++)
+		tapvec[i] = TAPVALUE;
+
+	tb->testload(NMPY, tapvec);
+
+	for(int i=0; i<2*NTAPS; i++)
+		ivec[i] = 0;
+	ivec[0] = IMPULSE;
+
+	tb->test(2*NTAPS, ivec);
+
+	for(int i=0; i<NTAPS; i++)
+		assert(ivec[i] == IMPULSE * TAPVALUE);
+	for(int i=NTAPS; i<2*NTAPS; i++)
+		assert(0 == ivec[i]);
+	// }}}
+
+	//
+	// Block filter, block input
+	// {{{
+	printf("NTAPS = %3d: Block Fil, block input\n", NTAPS);
+	for(int i=0; i<2*NTAPS; i++)
+		ivec[i] = IMPULSE;
+
+	// Now apply this vector to the filter
+	tb->test(2*NTAPS, ivec);
+
+	// And check that it has the right response
+	for(int i=0; i<2*NTAPS; i++) {
+		int64_t	expected = ((i < NTAPS) ? i+1 : NTAPS)
+						* IMPULSE * TAPVALUE;
+		if (ivec[i] != expected) {
+			printf("OUT[%3d] = %12ld != %12ld\n",
+				i, ivec[i], expected);
+			assert(ivec[i] == expected);
+		}
+	}
+
+	assert(tb->test_overflow());
+	// }}}
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+
+	{
+		FASTSYMF_TB<Vfastsymf>	*tb
+			= new FASTSYMF_TB<Vfastsymf>(MAXTAPS);
+		int64_t	tapvec[MAXTAPS];
+
+		// tb->opentrace("trace.vcd");
+		runtests(tb);
+
+		//
+		// The same low-pass filter slowsymf uses, center tap and all
+		// {{{
+		assert(SYMCOEF+1 == tb->m_nmpy);
+		for(int i=0; i<SYMCOEF; i++)
+			tapvec[i] = symcoeffs[i];
+		tapvec[SYMCOEF] = (1<<(TW-1))-1;
+
+		printf("Low-pass filter test\n");
+		tb->testload(tb->m_nmpy, tapvec);
+
+		{
+			double fp,      // Passband frequency cutoff
+				fs,     // Stopband frequency cutoff,
+				depth,  // Depth of the stopband
+				ripple; // Maximum deviation within the passband
+
+			tb->measure_lowpass(fp, fs, depth, ripple);
+			printf("FP     = %f\n", fp);
+			printf("FS     = %f\n", fs);
+			printf("DEPTH  = %6.2f dB\n", depth);
+			printf("RIPPLE = %.2g\n", ripple);
+
+			// The depth of this stopband should be between -55
+			// and -54 dB
+			assert(depth < -54);
+			assert(depth > -55);
+		}
+		// }}}
+
+		delete tb;
+	}
+
+	{
+		FASTSYMF_TB<Vfastsymf_even>	*tb
+			= new FASTSYMF_TB<Vfastsymf_even>(MAXTAPS-1);
+
+		runtests(tb);
+		delete tb;
+	}
+
+	printf("SUCCESS!!\n");
+	exit(0);
+}
@@ -0,0 +1,427 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename:	filtchain_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	Exercises filtchain, a chain of filters any of which may be
+//		switched in or out of the signal path at run time.
+//
+//	Three tests are run:
+//	1. The latency through the chain is measured, both with every filter
+//	   bypassed and with every filter enabled, and the two are required
+//	   to match.
+//	2. With random taps, random inputs, and random switching, every output
+//	   is compared against a model of the chain.
+//	3. A slow sinewave is run through unity gain low-pass filters while
+//	   they are switched in and out.  The output must follow the delayed
+//	   sinewave throughout, whichever filters are selected.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "Vfiltchain.h"
+
+const	int	NSTAGES = 2, NTAPS = 31, IW = 12, TW = 12,
+		GRPDELAY = (NTAPS-1)/2,
+		// Latency through each stage, in samples
+		STAGE_DELAY = GRPDELAY+2;
+
+static	inline	int	sbits(int64_t val, int bits) {
+	int64_t	r;
+
+	r = val & ((1l<<bits)-1);
+	if (r & (1l << (bits-1)))
+		r |= (-1l << bits);
+	return (int)r;
+}
+
+class	FILTCHAIN_TB : public TESTB<Vfiltchain> {
+	int	m_taps[NSTAGES][NTAPS],
+		// Inputs to each stage, and the chain's output, by sample
+		*m_s[NSTAGES+1],
+		// The clock each sample entered the chain on
+		*m_tin,
+		// Which filters were selected, and what the chain produced,
+		// for each output sample
+		*m_sel, *m_out,
+		m_maxsamples, m_nin, m_nout;
+	// i_en, on every clock
+	unsigned	*m_enlog;
+	uint64_t	m_maxclocks, m_clk;
+public:
+	bool	m_failed;
+	// The clock the last sample left the chain on
+	uint64_t	m_tout;
+
+	FILTCHAIN_TB(int maxsamples, uint64_t maxclocks) {
+		m_maxsamples = maxsamples;
+		m_maxclocks  = maxclocks;
+		for(int k=0; k<=NSTAGES; k++) {
+			m_s[k] = new int[maxsamples];
+			memset(m_s[k], 0, sizeof(int)*maxsamples);
+		}
+		m_tin   = new int[maxsamples];
+		m_sel   = new int[maxsamples];
+		m_out   = new int[maxsamples];
+		m_enlog = new unsigned[maxclocks];
+		memset(m_taps, 0, sizeof(m_taps));
+		m_nin = m_nout = 0;
+		m_clk = 0;
+		m_tout = 0;
+		m_failed = false;
+
+		m_core->i_en     = 0;
+		m_core->i_tap_wr = 0;
+		m_core->i_ce     = 0;
+		reset();
+	}
+
+	~FILTCHAIN_TB(void) {
+		for(int k=0; k<=NSTAGES; k++)
+			delete[] m_s[k];
+		delete[] m_tin;
+		delete[] m_sel;
+		delete[] m_out;
+		delete[] m_enlog;
+	}
+
+	int	nout(void) const { return m_nout; }
+	int	result(int m) const { return m_out[m]; }
+	int	selected(int m) const { return m_sel[m]; }
+
+	// load
+	// {{{
+	// Load a set of taps into one stage.  This must be done before any
+	// data is given to the chain, lest the model be confused.
+	void	load(int stage, const int *taps) {
+		assert(m_nin == 0);
+		m_core->i_ce = 0;
+		m_core->i_tap_wr = (1<<stage);
+		for(int k=0; k<NTAPS; k++) {
+			m_core->i_tap = taps[k] & ((1<<TW)-1);
+			TESTB<Vfiltchain>::tick();
+			m_taps[stage][k] = taps[k];
+		}
+		m_core->i_tap_wr = 0;
+	}
+	// }}}
+
+	// model
+	// {{{
+	// Calculate what the chain should produce for sample m.  Stage k
+	// accepts sample m k clocks after the chain does, and it's i_en at
+	// that time that selects the filter or the bypass.
+	void	model(int m) {
+		m_sel[m] = 0;
+		for(int k=0; k<NSTAGES; k++) {
+			int64_t	acc = 0;
+			int	bypass = 0;
+			bool	en;
+
+			for(int j=0; j<NTAPS; j++) {
+				if (m-2-j >= 0)
+					acc += (int64_t)m_taps[k][j] * m_s[k][m-2-j];
+			}
+
+			if (m-2-GRPDELAY >= 0)
+				bypass = m_s[k][m-2-GRPDELAY];
+
+			en = (m_enlog[m_tin[m]+k] >> k)&1;
+			if (en)
+				m_sel[m] |= (1<<k);
+			m_s[k+1][m] = (en) ? sbits(acc >> (TW-1), IW) : bypass;
+		}
+	}
+	// }}}
+
+	// tick
+	// {{{
+	// Every output is checked against the model as it leaves the chain.
+	void	tick(void) {
+		assert(m_clk < m_maxclocks);
+		m_enlog[m_clk] = m_core->i_en;
+		if (m_core->i_ce) {
+			assert(m_nin < m_maxsamples);
+			m_tin[m_nin] = (int)m_clk;
+			m_s[0][m_nin] = sbits(m_core->i_sample, IW);
+			m_nin++;
+		}
+
+		TESTB<Vfiltchain>::tick();
+
+		if (m_core->o_ce) {
+			int	v = sbits(m_core->o_sample, IW);
+
+			assert(m_nout < m_nin);
+			model(m_nout);
+			m_out[m_nout] = v;
+			if (v != m_s[NSTAGES][m_nout] && !m_failed) {
+				// Only the first failure is reported
+				printf("O_SAMPLE[%d] = %d != %d (expected), SEL=%x\n",
+					m_nout, v, m_s[NSTAGES][m_nout],
+					m_sel[m_nout]);
+				m_failed = true;
+			}
+			m_nout++;
+			m_tout = m_clk;
+		}
+
+		m_clk++;
+	}
+	// }}}
+
+	// apply
+	// {{{
+	// Apply one sample, followed by nidle clocks without any.  i_en
+	// is held for the whole time.
+	void	apply(int sample, unsigned en, int nidle) {
+		m_core->i_en = en;
+		m_core->i_ce = 1;
+		m_core->i_sample = sample & ((1<<IW)-1);
+		tick();
+
+		m_core->i_ce = 0;
+		for(int k=0; k<nidle; k++)
+			tick();
+	}
+	// }}}
+
+	// flush
+	// {{{
+	// Run until every sample given to the chain has come back out
+	void	flush(void) {
+		m_core->i_ce = 0;
+		while(m_nout < m_nin)
+			tick();
+	}
+	// }}}
+
+	// latency
+	// {{{
+	// Measure the latency through the chain, in samples, by sending an
+	// impulse through it and finding the output sample with the largest
+	// magnitude.  The latency in clocks, from the i_ce of the impulse to
+	// the o_ce of that output, is returned in clocks.
+	int	latency(unsigned en, int amplitude, uint64_t &clocks) {
+		int	first = m_nin, peak = -1, mx = 0;
+		uint64_t	tpeak = 0;
+
+		apply(amplitude, en, 0);
+		for(int k=0; k<NSTAGES*(STAGE_DELAY+1); k++) {
+			apply(0, en, 0);
+			if (m_nout > first && abs(result(m_nout-1)) > mx) {
+				peak = m_nout-1;
+				mx = abs(result(peak));
+				tpeak = m_tout;
+			}
+		}
+
+		assert(peak >= 0);
+		clocks = tpeak - m_tin[first];
+		return peak - first;
+	}
+	// }}}
+};
+
+// lowpass
+// {{{
+// Build a windowed sinc low-pass filter, with a gain of one at DC
+void	lowpass(double cutoff, int *taps) {
+	double	h[NTAPS], sum = 0;
+
+	for(int k=0; k<NTAPS; k++) {
+		double	t = k - GRPDELAY, w;
+
+		w = 0.54 - 0.46 * cos(2.0 * M_PI * k / (NTAPS-1));
+		h[k] = (t == 0) ? 2*cutoff : sin(2.0*M_PI*cutoff*t)/(M_PI*t);
+		h[k] *= w;
+		sum += h[k];
+	}
+
+	for(int k=0; k<NTAPS; k++)
+		taps[k] = (int)round(h[k] / sum * (1<<(TW-1)));
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	FILTCHAIN_TB	*tb;
+	int	taps[NTAPS];
+	bool	failed = false;
+
+	//
+	// Latency
+	// {{{
+	{
+		const	int	AMPLITUDE = (1<<(IW-2));
+		int		byp, flt;
+		uint64_t	bclocks, fclocks;
+
+		tb = new FILTCHAIN_TB(4096, 65536);
+
+		// Every filter is a delay of its group delay, with (nearly)
+		// a gain of one
+		for(int k=0; k<NTAPS; k++)
+			taps[k] = 0;
+		taps[GRPDELAY] = (1<<(TW-1))-1;
+		for(int s=0; s<NSTAGES; s++)
+			tb->load(s, taps);
+
+		// Fill the chain with zeros first
+		for(int k=0; k<NSTAGES*STAGE_DELAY; k++)
+			tb->apply(0, 0, 0);
+
+		byp = tb->latency(0, AMPLITUDE, bclocks);
+		flt = tb->latency((1<<NSTAGES)-1, AMPLITUDE, fclocks);
+		tb->flush();
+
+		printf("Latency, bypassed: %d samples, %ld clocks\n",
+			byp, (unsigned long)bclocks);
+		printf("Latency, filtered: %d samples, %ld clocks\n",
+			flt, (unsigned long)fclocks);
+		// Beyond the filters' group delays
+		printf("Added latency:     %d samples (%d per stage)\n",
+			byp - NSTAGES*GRPDELAY, STAGE_DELAY - GRPDELAY);
+
+		assert(byp == flt);
+		assert(bclocks == fclocks);
+		assert(byp == NSTAGES*STAGE_DELAY);
+		failed = failed || tb->m_failed;
+		delete tb;
+	}
+	// }}}
+
+	//
+	// Random taps, data, and switching, compared against the model
+	// {{{
+	if (!failed) {
+		const	int	NSAMPLES = 20000;
+		unsigned	en = 0;
+
+		tb = new FILTCHAIN_TB(NSAMPLES, (uint64_t)NSAMPLES*8);
+		for(int s=0; s<NSTAGES; s++) {
+			for(int k=0; k<NTAPS; k++)
+				taps[k] = (rand() & ((1<<TW)-1)) - (1<<(TW-1));
+			tb->load(s, taps);
+		}
+
+		for(int k=0; k<NSAMPLES && !tb->m_failed; k++) {
+			if ((rand() & 0x0f) == 0)
+				en = rand() & ((1<<NSTAGES)-1);
+			// Some samples arrive on every clock, others not
+			tb->apply((rand() & ((1<<IW)-1)), en,
+				(rand() & 1) ? 0 : (rand() & 7));
+		}
+
+		tb->flush();
+		printf("Random:   %d samples checked\n", tb->nout());
+		failed = failed || tb->m_failed;
+		delete tb;
+	}
+	// }}}
+
+	//
+	// Continuity
+	// {{{
+	// Switch unity gain low-pass filters in and out of a slow sinewave.
+	// Whatever is selected, the output should follow the same sinewave,
+	// delayed by the latency of the chain.  Were the bypass not aligned
+	// with the filters, the output would jump forwards or backwards at
+	// every switch.
+	if (!failed) {
+		const	int	NSAMPLES = 20000,
+				LATENCY = NSTAGES*STAGE_DELAY;
+		const	double	AMPLITUDE = (1<<(IW-2)), PERIOD = 250.0;
+		const	int	MARGIN = 4;	// Filter error, in LSBs
+		int	maxerr = 0, maxswitch = 0, nswitch = 0;
+		unsigned	en = 0;
+
+		tb = new FILTCHAIN_TB(NSAMPLES, (uint64_t)NSAMPLES*8);
+		for(int s=0; s<NSTAGES; s++) {
+			lowpass(0.10+0.05*s, taps);
+			tb->load(s, taps);
+		}
+
+		for(int k=0; k<NSAMPLES; k++) {
+			int	v = (int)round(AMPLITUDE
+					* sin(2.0*M_PI*k/PERIOD));
+
+			// Don't switch until the filters are full
+			if (k > NSTAGES*(NTAPS+2) && (rand() % 40) == 0)
+				en ^= 1 << (rand() % NSTAGES);
+			tb->apply(v, en, rand() & 3);
+		}
+
+		tb->flush();
+
+		for(int m=NSTAGES*(STAGE_DELAY+NTAPS); m<tb->nout(); m++) {
+			int	expected, err;
+
+			expected = (int)round(AMPLITUDE
+					* sin(2.0*M_PI*(m-LATENCY)/PERIOD));
+			err = abs(tb->result(m) - expected);
+			if (err > maxerr)
+				maxerr = err;
+			if (tb->selected(m) != tb->selected(m-1)) {
+				nswitch++;
+				if (err > maxswitch)
+					maxswitch = err;
+			}
+		}
+
+		printf("Continuity: %d switches, max error %d, %d at a switch\n",
+			nswitch, maxerr, maxswitch);
+		assert(nswitch > 0);
+		if (maxerr > MARGIN) {
+			printf("Discontinuity!\n");
+			failed = true;
+		}
+		failed = failed || tb->m_failed;
+		delete tb;
+	}
+	// }}}
+
+	if (failed)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (failed) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -261,6 +261,170 @@ template<class VFLTR> void	FILTERTB<VFLTR>::testload(int nlen, int64_t *data) {
 }
 // }}}
 
+// impulse
+// {{{
+template<class VFLTR> void	FILTERTB<VFLTR>::impulse(int ntaps,
+			const int64_t *taps, int64_t *h) {
+	for(int k=0; k<NTAPS(); k++)
+		h[k] = (k < ntaps) ? sbits(taps[k], TW()) : 0;
+}
+// }}}
+
+// testswap
+// {{{
+// Stream random data through a filter with a shadow coefficient bank.  While
+// it runs, load the alternate set of taps into the shadow bank, one tap per
+// clock with random gaps, and commit them at a random time afterwards.  Every
+// output must match the filter's response using either the old or the new
+// taps, and the switch must take place on exactly the right sample.  That's
+// swapdelay samples after the first sample given with or following the
+// commit.  Filters that read their coefficients from memory, like slowfil,
+// switch immediately.  Transposed filters, like fastfir, switch NTAPS
+// samples later, once they've flushed the outputs already in progress.  Taps
+// aren't written again until NTAPS samples after each commit.  Each set holds
+// ntaps coefficients, and impulse() gives the response they should produce.
+// If pendwr is set, random taps are written on every clock between a commit
+// and the sample that takes it, and the filter must ignore them.
+template<class VFLTR> bool	FILTERTB<VFLTR>::testswap(int ntaps,
+			const int64_t *a, const int64_t *b, int swapdelay,
+			bool pendwr) {
+	const	int	NSWAPS = 4;
+	const	int	SPAN = 4*NTAPS() + DELAY() + 8;
+	const	int	NLEN = (NSWAPS+2) * SPAN;
+	VFLTR		*core = TESTB<VFLTR>::m_core;
+	int64_t		*x = new int64_t[NLEN], *y = new int64_t[NLEN],
+			*ya = new int64_t[NLEN], *yb = new int64_t[NLEN],
+			*ha = new int64_t[NTAPS()], *hb = new int64_t[NTAPS()];
+	int		commit_at[NSWAPS+1], ncommits = 0, nsamples = 0, cur;
+	bool		pass = true;
+
+	// Load the first set of taps, and swap them in
+	reset();
+	core->i_tap_wr = 1;
+	for(int k=0; k<ntaps; k++) {
+		core->i_tap = ubits(a[k], TW());
+		tick();
+	}
+	core->i_tap_wr = 0;
+	core->i_tap_commit = 1;
+	tick();
+	core->i_tap_commit = 0;
+	commit_at[ncommits++] = 0;
+	clear_cache();
+
+	for(int k=0; k<NLEN; k++)
+		x[k] = sbits(rand(), IW());
+
+	for(int seg=1; seg<=NSWAPS; seg++) {
+		const int64_t	*taps = (seg & 1) ? b : a;
+		int		nwritten = 0, wait = rand() % (ntaps/2 + 2);
+		// Every other commit is given alongside a sample.  The rest
+		// arrive at random.
+		bool		align = (seg & 1) == 0, pending = false;
+
+		while(nsamples < (seg+1) * SPAN) {
+			bool	sample = nsamples < NLEN
+				&& (TESTB<VFLTR>::m_tickcount % CKPCE()) == 0;
+
+			// Feed the tap loader, and then commit
+			if (pending && !sample) {
+				// Between the commit and the swap.  These
+				// writes must be ignored.
+				core->i_tap_wr = 1;
+				core->i_tap = ubits(rand(), TW());
+			} else if (nsamples < seg * SPAN)
+				; // Wait for the last swap to complete
+			else if (nwritten < ntaps) {
+				core->i_tap_wr = rand() & 1;
+				core->i_tap = ubits(taps[nwritten], TW());
+				if (core->i_tap_wr)
+					nwritten++;
+			} else if (wait > 0)
+				wait--;
+			else if (wait == 0 && (!align || sample)) {
+				core->i_tap_commit = 1;
+				commit_at[ncommits++] = nsamples;
+				wait = -1;
+				pending = pendwr && !sample;
+			}
+
+			// One new sample every CKPCE() clocks
+			if (sample) {
+				pending = false;
+				core->i_ce = 1;
+				core->i_sample = ubits(x[nsamples], IW());
+				tick();
+				y[nsamples++] = sbits(core->o_result, OW());
+			} else
+				tick();
+
+			core->i_ce = 0;
+			core->i_tap_wr = 0;
+			core->i_tap_commit = 0;
+		}
+		assert(nwritten == ntaps && wait < 0);
+	}
+
+	while(nsamples < NLEN) {
+		if ((TESTB<VFLTR>::m_tickcount % CKPCE()) == 0) {
+			core->i_ce = 1;
+			core->i_sample = ubits(x[nsamples], IW());
+			tick();
+			y[nsamples++] = sbits(core->o_result, OW());
+			core->i_ce = 0;
+		} else
+			tick();
+	}
+
+	// What the filter should produce, using either set of taps
+	impulse(ntaps, a, ha);
+	impulse(ntaps, b, hb);
+	for(int n=0; n<NLEN; n++) {
+		ya[n] = yb[n] = 0;
+		for(int k=0; k<NTAPS() && k<=n; k++) {
+			ya[n] += ha[k] * x[n-k];
+			yb[n] += hb[k] * x[n-k];
+		}
+		ya[n] = sbits(ya[n], OW());
+		yb[n] = sbits(yb[n], OW());
+	}
+
+	// Skip the start up, while the first taps are still being swapped in
+	cur = 0;
+	for(int n = 2*NTAPS() + 4; n + DELAY() < NLEN; n++) {
+		int64_t		out = y[n + DELAY()];
+		const int64_t	*expected;
+
+		while(cur+1 < ncommits && n >= commit_at[cur+1] + swapdelay)
+			cur++;
+		expected = (cur & 1) ? yb : ya;
+
+		if (out == expected[n])
+			continue;
+
+		printf("SWAP: Output[%d] = %ld, expected %ld (set %d, "
+			"committed at %d, in use from %d)\n", n, out,
+			expected[n], cur, commit_at[cur],
+			commit_at[cur] + swapdelay);
+		pass = false;
+		break;
+	}
+
+	if (pass && cur != NSWAPS) {
+		printf("SWAP: Only %d of %d swaps took place\n", cur, NSWAPS);
+		pass = false;
+	}
+
+	delete[] x;
+	delete[] y;
+	delete[] ya;
+	delete[] yb;
+	delete[] ha;
+	delete[] hb;
+	return pass;
+}
+// }}}
+
 // test_overflow
 // {{{
 template<class VFLTR> bool	FILTERTB<VFLTR>::test_overflow(void) {
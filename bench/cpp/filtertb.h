@@ -152,8 +152,21 @@ public:
 	virtual	void	response(int nfreq, COMPLEX *response, double mag= 1.0,
 				const char *fname = NULL);
 
+	// The NTAPS() long impulse response that loading ntaps coefficients
+	// should produce.  By default, that's the coefficients themselves.
+	// Filters that only load part of their response, such as the
+	// symmetric filters, override this.
+	virtual	void	impulse(int ntaps, const int64_t *taps, int64_t *h);
+
 	// Some canned tests we can apply
 	bool	test_overflow(void);
+	// Swap between two sets of taps, loaded into the shadow bank of an
+	// OPT_SHADOW filter while data streams through it.  The new taps must
+	// first be used for the output swapdelay samples after the commit.
+	// With pendwr, random taps are also written between each commit and
+	// the next sample, and the filter must ignore them.
+	bool	testswap(int ntaps, const int64_t *a, const int64_t *b,
+			int swapdelay, bool pendwr = false);
 	void	measure_lowpass(double &fp, double &fs, double &depth, double &ripple);
 };
 
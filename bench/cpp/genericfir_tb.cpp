@@ -47,6 +47,7 @@
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 #include "Vgenericfir.h"
+#include "Vgenericfir_shadow.h"
 #include "testb.h"
 #include "filtertb.h"
 #include "filtertb.cpp"
@@ -194,6 +195,26 @@ int	main(int argc, char **argv) {
 		assert(depth < -54);
 		assert(depth > -55);
 	}
+	// Coefficient hot swap
+	// {{{
+	{
+		FILTERTB<Vgenericfir_shadow>	*stb
+					= new FILTERTB<Vgenericfir_shadow>();
+		int64_t	alt[NTAPS];
+
+		stb->TW(::TW);
+		stb->IW(::IW);
+		stb->OW(::OW);
+		stb->NTAPS(::NTAPS);
+		stb->DELAY(::DELAY);
+
+		for(unsigned i=0; i<NTAPS; i++)
+			alt[i] = (int64_t)(rand() & ((1<<TW)-1)) - (1<<(TW-1));
+
+		assert(stb->testswap(NTAPS, tapvec, alt, 1));
+		delete stb;
+	}
+	// }}}
 	printf("SUCCESS\n");
 
 	exit(0);
@@ -0,0 +1,360 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	hbinterp_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test the full rate half-band interpolator, hbinterp, both
+//		producing one output per clock and, with OPT_DUAL, two.  As
+//	in shalfband_tb, every coefficient is loaded on its own, and the full
+//	impulse response is checked against it.  Thanks to the inserted zeros,
+//	a single impulse recovers every coefficient.  Every output is also
+//	checked, bit for bit, against HBMODEL.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ctype.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vhbinterp.h"
+#include "Vhbinterp_dual.h"
+#include "testb.h"
+#include "hbmodel.h"
+#include "twelvebfltr.h"
+
+const	unsigned IW = 16,
+		TW = 12,
+		OW = IW+TW+7,
+		NTAPS = 107;
+const	unsigned	MIDP = (NTAPS-1)/2,
+		QTRP = (NTAPS+1)/4,
+		// Input samples between an impulse and its first output
+		DELAY = QTRP+1;
+
+// sbits
+// {{{
+static	int64_t	sbits(int64_t val, int b) {
+	val <<= (64-b);
+	val >>= (64-b);
+	return val;
+}
+// }}}
+
+// getlane
+// {{{
+// Pull one OW bit output from whatever type Verilator has chosen for the
+// port
+static	int64_t	getlane(uint64_t v, int ln) {
+	assert(ln == 0);
+	return sbits(v, OW);
+}
+
+template <class WIDE> static int64_t getlane(const WIDE &v, int ln) {
+	uint64_t	r = 0;
+
+	for(unsigned b=0; b<OW; b++) {
+		unsigned	pos = ln*OW + b;
+
+		r |= (uint64_t)((v[pos/32] >> (pos&31)) & 1) << b;
+	}
+
+	return sbits(r, OW);
+}
+// }}}
+
+template <class VA> class	HBINTERP_TB : public TESTB<VA> {
+public:
+	HBMODEL		m_model;
+	const int	m_lanes;
+	// Statistics from the last run
+	uint64_t	m_clocks;
+
+	// HBINTERP_TB
+	// {{{
+	HBINTERP_TB(int lanes) : m_model(NTAPS, IW, TW, OW), m_lanes(lanes) {
+		m_clocks = 0;
+	}
+	// }}}
+
+	// reset
+	// {{{
+	void	reset(void) {
+		TESTB<VA>::m_core->i_tap_wr = 0;
+		TESTB<VA>::m_core->i_tap    = 0;
+		TESTB<VA>::m_core->i_ce     = 0;
+		TESTB<VA>::m_core->i_sample = 0;
+		TESTB<VA>::reset();
+	}
+	// }}}
+
+	// load
+	// {{{
+	void	load(int nlen, const int64_t *data) {
+		assert(nlen == (int)QTRP);
+		reset();
+
+		TESTB<VA>::m_core->i_tap_wr = 1;
+		for(int k=0; k<nlen; k++) {
+			TESTB<VA>::m_core->i_tap = data[k] & ((1<<TW)-1);
+			TESTB<VA>::tick();
+		}
+		TESTB<VA>::m_core->i_tap_wr = 0;
+
+		m_model.load(data);
+	}
+	// }}}
+
+	// run
+	// {{{
+	// Interpolate nlen samples, offering the core a new sample every pace
+	// clocks.  The 2*nlen results are returned in out[], with the filter's
+	// delay removed.  Without OPT_DUAL, pace must be at least two.
+	void	run(int nlen, const int64_t *in, int64_t *out, int pace) {
+		const int	nout = 2*nlen, skip = 2*DELAY;
+		int	nin = 0, got = 0;
+
+		assert(pace * m_lanes >= 2);
+		reset();
+
+		m_clocks = 0;
+		for(int clk=0; got < nout + skip; clk++) {
+			VA	*core = TESTB<VA>::m_core;
+
+			if (nin < nlen)
+				m_clocks++;
+
+			core->i_ce = 0;
+			if ((clk % pace) == 0) {
+				// Once we run out of samples, push zeros through
+				// to flush the filter
+				int64_t	s = (nin < nlen) ? in[nin] : 0;
+
+				core->i_ce = 1;
+				core->i_sample = s & ((1<<IW)-1);
+				nin++;
+			}
+
+			TESTB<VA>::tick();
+
+			if (core->o_ce) {
+				for(int ln=0; ln<m_lanes; ln++, got++)
+					if (got >= skip && got-skip < nout)
+						out[got-skip] = getlane(
+							core->o_result, ln);
+			}
+		}
+		TESTB<VA>::m_core->i_ce = 0;
+	}
+	// }}}
+
+	// check
+	// {{{
+	// Run a vector through both the core and our model, and compare
+	bool	check(int nlen, const int64_t *in, int pace) {
+		int64_t	*out = new int64_t[2*nlen],
+			*expected = new int64_t[2*nlen];
+		bool	pass = true;
+
+		run(nlen, in, out, pace);
+		m_model.reset();
+		m_model.interpolate(nlen, in, expected);
+
+		for(int k=0; k<2*nlen; k++) {
+			if (out[k] != expected[k]) {
+				if (pass)
+					printf("OUT[%4d] = %12ld != %12ld (expected)\n",
+						k, out[k], expected[k]);
+				pass = false;
+			}
+		}
+
+		delete[] out;
+		delete[] expected;
+		return pass;
+	}
+	// }}}
+
+	// minpace
+	// {{{
+	// The fastest rate the core can accept samples at
+	int	minpace(void) const { return (m_lanes > 1) ? 1 : 2; }
+	// }}}
+
+	// testload
+	// {{{
+	// Load a set of coefficients, and check the filter's impulse response
+	// against them.
+	void	testload(int nlen, const int64_t *data) {
+		const int64_t	IMPULSE = -(1<<(IW-1));
+		int64_t		ivec[NTAPS], ovec[2*NTAPS];
+
+		load(nlen, data);
+
+		for(unsigned i=0; i<NTAPS; i++)
+			ivec[i] = 0;
+		ivec[0] = IMPULSE;
+
+		run(NTAPS, ivec, ovec, minpace());
+
+		for(unsigned k=0; k<2*NTAPS; k++) {
+			int64_t	m = -(ovec[k] >> (IW-1));
+
+			if ((k&1)&&(k<MIDP))
+				assert(m == 0);
+			else if (k < MIDP)
+				assert(data[k/2] == m);
+			else if (k == MIDP)
+				assert(m == (1<<(TW-1))-1);
+			else if ((k < NTAPS)&&(((k-MIDP)&1)==0))
+				assert(m == 0);
+			else if (k < NTAPS)
+				assert(m ==  data[((NTAPS-1-k))/2]);
+			else
+				assert(m == 0);
+
+			assert(m == m_model[k]);
+		}
+	}
+	// }}}
+
+	// test_overflow
+	// {{{
+	// Line up the largest possible inputs with the signs of the filter's
+	// coefficients, so that one output is as large as it can be.
+	bool	test_overflow(void) {
+		const int64_t	maxv = (1<<(IW-1))-1;
+		int64_t	ivec[2*NTAPS];
+
+		// Only the even coefficients meet on an even output.  Build
+		// the peak on output NTAPS+1.
+		for(unsigned k=0; k<2*NTAPS; k++) {
+			if (m_model[NTAPS+1-2*k] < 0)
+				ivec[k] = -maxv-1;
+			else
+				ivec[k] =  maxv;
+		}
+
+		return check(2*NTAPS, ivec, minpace());
+	}
+	// }}}
+};
+
+// runtests
+// {{{
+template <class VA> bool	runtests(const char *name, HBINTERP_TB<VA> *tb) {
+	const int64_t	TAPVALUE =  (1<<(TW-1))-1;
+	const int	NRAND = 2048;
+	int64_t		tapvec[QTRP];
+	int64_t		*rvec = new int64_t[NRAND];
+	bool		pass = true;
+
+	printf("%s: Impulse tests\n", name);
+	for(unsigned k=0; k<QTRP; k++) {
+		// Initialize a new coefficient vector with all zeros, then
+		// set one value to non-zero
+		for(unsigned i=0; i<QTRP; i++)
+			tapvec[i] = 0;
+		tapvec[k] = TAPVALUE;
+
+		// Test whether or not this coefficient vector loads properly
+		// into the filter, and then whether or not the filter
+		// overflows
+		tb->testload(QTRP, tapvec);
+		pass = tb->test_overflow() && pass;
+	}
+
+	// The half-band low-pass filter from shalfband_tb
+	// {{{
+	printf("%s: Low-pass filter test\n", name);
+	assert(HALFCOEF == QTRP);
+	for(int i=0; i<HALFCOEF; i++)
+		tapvec[i] = halfcoef[i];
+
+	tb->testload(QTRP, tapvec);
+	pass = tb->test_overflow() && pass;
+
+	for(int k=0; k<NRAND; k++)
+		rvec[k] = sbits(rand(), IW);
+
+	for(int pace=tb->minpace(); pace<=3; pace++) {
+		bool	ok = tb->check(NRAND, rvec, pace);
+
+		printf("%-8s pace = %d: %6.3f outputs/clk%s\n", name, pace,
+			2*NRAND / (double)tb->m_clocks,
+			(ok) ? "" : "  -- FAILED");
+		pass = ok && pass;
+	}
+	// }}}
+
+	delete[] rvec;
+	return pass;
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	bool	pass = true;
+
+	assert((NTAPS & 3)==3);
+
+	{
+		HBINTERP_TB<Vhbinterp>	*tb = new HBINTERP_TB<Vhbinterp>(1);
+
+		// tb->opentrace("trace.vcd");
+		pass = runtests("Single", tb) && pass;
+		delete tb;
+	}
+
+	{
+		HBINTERP_TB<Vhbinterp_dual>	*tb
+				= new HBINTERP_TB<Vhbinterp_dual>(2);
+
+		pass = runtests("Dual", tb) && pass;
+		delete tb;
+	}
+
+	if (!pass) {
+		printf("TEST FAILURE!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	printf("SUCCESS!!\n");
+	exit(0);
+}
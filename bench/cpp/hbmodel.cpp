@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	hbmodel.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A bit exact software model of the half-band decimator and
+//		interpolator, hbdecim.v and hbinterp.v.  See hbmodel.h for
+//	details.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "hbmodel.h"
+
+// sbits
+// {{{
+static int64_t	sbits(int64_t val, int b) {
+	val <<= (64-b);
+	val >>= (64-b);
+	return val;
+}
+// }}}
+
+HBMODEL::HBMODEL(int ntaps, int iw, int tw, int ow)
+		: m_ntaps(ntaps), m_iw(iw), m_tw(tw), m_ow(ow) {
+	assert((ntaps & 3) == 3);
+
+	m_coef = new int64_t[m_ntaps];
+	m_hist = new int64_t[m_ntaps];
+
+	for(int k=0; k<m_ntaps; k++)
+		m_coef[k] = 0;
+	// The center tap is fixed
+	m_coef[(m_ntaps-1)/2] = (1<<(m_tw-1))-1;
+
+	reset();
+}
+
+HBMODEL::~HBMODEL(void) {
+	delete[] m_coef;
+	delete[] m_hist;
+}
+
+void	HBMODEL::load(const int64_t *coeffs) {
+	for(int k=0; k<NQTR(); k++) {
+		int64_t	c = sbits(coeffs[k], m_tw);
+
+		m_coef[2*k] = c;
+		m_coef[m_ntaps-1-2*k] = c;
+	}
+}
+
+int64_t	HBMODEL::operator[](const int k) const {
+	if (k < 0 || k >= m_ntaps)
+		return 0;
+	return m_coef[k];
+}
+
+void	HBMODEL::reset(void) {
+	for(int k=0; k<m_ntaps; k++)
+		m_hist[k] = 0;
+	m_pos = 0;
+}
+
+int64_t	HBMODEL::apply(int64_t x) {
+	int64_t	acc = 0;
+
+	m_pos = (m_pos + 1) % m_ntaps;
+	m_hist[m_pos] = sbits(x, m_iw);
+
+	for(int k=0; k<m_ntaps; k++)
+		acc += m_coef[k] * m_hist[(m_pos + m_ntaps - k) % m_ntaps];
+
+	return sbits(acc, m_ow);
+}
+
+void	HBMODEL::decimate(int nlen, const int64_t *in, int64_t *out) {
+	for(int k=0; k+1<nlen; k+=2) {
+		apply(in[k]);
+		out[k/2] = apply(in[k+1]);
+	}
+}
+
+void	HBMODEL::interpolate(int nlen, const int64_t *in, int64_t *out) {
+	for(int k=0; k<nlen; k++) {
+		out[2*k  ] = apply(in[k]);
+		out[2*k+1] = apply(0);
+	}
+}
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	hbmodel.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A bit exact software model of a half-band filter, such as
+//		shalfband.v, together with the decimate by two (hbdecim.v) and
+//	interpolate by two (hbinterp.v) filters built from one.  The model is
+//	a plain full rate filter, with every one of its NTAPS coefficients.
+//	Decimating keeps every odd output, and interpolating filters the input
+//	with zeros inserted between samples.  It makes no use of the tricks
+//	the RTL uses to skip the zero coefficients, so it can be used to check
+//	them.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	HBMODEL_H
+#define	HBMODEL_H
+
+#include <stdint.h>
+
+class	HBMODEL {
+	int		m_ntaps, m_iw, m_tw, m_ow;
+	int64_t		*m_coef, *m_hist;
+	unsigned	m_pos;
+
+public:
+	HBMODEL(int ntaps, int iw, int tw, int ow);
+	~HBMODEL(void);
+
+	int	NTAPS(void) const { return m_ntaps; }
+	// The number of unique coefficients, not counting the center
+	int	NQTR(void) const { return (m_ntaps+1)/4; }
+
+	// Load NQTR() coefficients, in the same order as shalfband.v
+	void	load(const int64_t *coeffs);
+
+	// The full impulse response, h[0] through h[NTAPS-1]
+	int64_t	operator[](const int k) const;
+
+	// Clear the filter's history
+	void	reset(void);
+
+	// Apply one sample to the full rate filter, and return the result
+	int64_t	apply(int64_t x);
+
+	// Decimate nlen samples, producing nlen/2 outputs
+	void	decimate(int nlen, const int64_t *in, int64_t *out);
+
+	// Interpolate nlen samples, producing 2*nlen outputs
+	void	interpolate(int nlen, const int64_t *in, int64_t *out);
+};
+
+#endif
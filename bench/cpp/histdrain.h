@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	histdrain.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A host side client, to continuously drain completed histograms
+//		from histogram.v.  Following every interrupt, the client reads
+//	the inactive memory using back to back (pipelined) AXI-lite reads.
+//	Each completed frame is then published into a lock-free, single
+//	producer/single consumer queue, from which a separate thread may
+//	process it.
+//
+//	If the next interrupt arrives before a frame has been completely read,
+//	the memory being read has been swapped back into use, and that frame is
+//	lost.  Any unissued reads are cancelled, those in flight are discarded,
+//	and the client moves on to the new frame.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	HISTDRAIN_H
+#define	HISTDRAIN_H
+
+#include <stdint.h>
+#include <atomic>
+#include "axilbfm.h"
+
+// HISTFRAME
+// {{{
+typedef	struct	{
+	uint64_t	m_frame;	// Interrupt number this frame followed
+	uint64_t	m_clock;	// Clock of the interrupt
+	uint32_t	*m_bins;
+} HISTFRAME;
+// }}}
+
+// FRAMEQ
+// {{{
+// A lock-free single producer, single consumer ring of histogram frames.
+// The producer claim()s a free frame, fills it, and then publish()es it.
+// The consumer peek()s at the oldest published frame, and release()s it once
+// it is done with it.  Frames are never copied.
+class	FRAMEQ {
+	unsigned		m_nslots, m_nbins;
+	HISTFRAME		*m_slot;
+	std::atomic<unsigned>	m_head, m_tail;
+public:
+	FRAMEQ(unsigned nslots, unsigned nbins)
+			: m_nslots(nslots), m_nbins(nbins), m_head(0),
+			m_tail(0) {
+		m_slot = new HISTFRAME[nslots];
+		for(unsigned k=0; k<nslots; k++)
+			m_slot[k].m_bins = new uint32_t[nbins];
+	}
+
+	~FRAMEQ(void) {
+		for(unsigned k=0; k<m_nslots; k++)
+			delete[] m_slot[k].m_bins;
+		delete[] m_slot;
+	}
+
+	unsigned nbins(void) const { return m_nbins; }
+
+	// Producer side
+	// {{{
+	HISTFRAME *claim(void) {
+		unsigned	h = m_head.load(std::memory_order_relaxed);
+
+		if (h - m_tail.load(std::memory_order_acquire) >= m_nslots)
+			return NULL;	// Full
+		return &m_slot[h % m_nslots];
+	}
+
+	void	publish(void) {
+		m_head.store(m_head.load(std::memory_order_relaxed) + 1,
+			std::memory_order_release);
+	}
+	// }}}
+
+	// Consumer side
+	// {{{
+	const HISTFRAME *peek(void) {
+		unsigned	t = m_tail.load(std::memory_order_relaxed);
+
+		if (t == m_head.load(std::memory_order_acquire))
+			return NULL;	// Empty
+		return &m_slot[t % m_nslots];
+	}
+
+	void	release(void) {
+		m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+			std::memory_order_release);
+	}
+	// }}}
+};
+// }}}
+
+template <class VA>	class HISTDRAIN {
+	AXILBFM<VA>	&m_bus;
+	FRAMEQ		&m_q;
+	HISTFRAME	*m_fr;		// The frame being filled, if any
+	unsigned	m_nbins, m_rd_bin, m_discard;
+	bool		m_draining, m_pending;
+	uint64_t	m_int_clock;
+
+	// start
+	// {{{
+	void	start(void) {
+		m_pending = false;
+		m_fr = m_q.claim();
+		if (!m_fr) {
+			// The consumer has fallen behind.  There's nowhere
+			// to put this frame, so don't bother reading it.
+			m_qfull++;
+			return;
+		}
+
+		m_fr->m_frame = m_interrupts;
+		m_fr->m_clock = m_int_clock;
+		m_draining = true;
+		m_rd_bin   = 0;
+		for(unsigned k=0; k<m_nbins; k++)
+			m_bus.read(k << 2);
+	}
+	// }}}
+public:
+	// Statistics
+	uint64_t	m_interrupts, m_frames, m_lost, m_qfull,
+			m_drain_clocks, m_max_drain;
+
+	HISTDRAIN(AXILBFM<VA> &bus, FRAMEQ &q) : m_bus(bus), m_q(q) {
+		m_nbins = q.nbins();
+		m_fr = NULL;
+		m_rd_bin = m_discard = 0;
+		m_draining = m_pending = false;
+		m_int_clock = 0;
+		clear_stats();
+	}
+
+	void	clear_stats(void) {
+		m_interrupts = m_frames = m_lost = m_qfull = 0;
+		m_drain_clocks = m_max_drain = 0;
+	}
+
+	bool	busy(void) const {
+		return m_draining || m_pending || m_discard > 0; }
+
+	// interrupt
+	// {{{
+	// To be called on every clock with o_int set
+	void	interrupt(uint64_t now) {
+		m_interrupts++;
+
+		if (m_draining) {
+			// Too late.  The memory we were reading is now being
+			// cleared.
+			m_lost++;
+			m_draining = false;
+			m_bus.cancel_reads();
+			m_discard = m_bus.reads_outstanding();
+		} else if (m_pending)
+			// We never even got started on the last frame
+			m_lost++;
+
+		m_int_clock = now;
+		if (m_discard > 0)
+			m_pending = true;
+		else
+			start();
+	}
+	// }}}
+
+	// step
+	// {{{
+	// To be called once per clock, after the bus has been stepped
+	void	step(uint64_t now) {
+		uint32_t	v;
+
+		while(m_bus.rdata(v)) {
+			if (m_discard > 0) {
+				if (--m_discard == 0 && m_pending)
+					start();
+				continue;
+			}
+
+			assert(m_draining);
+			m_fr->m_bins[m_rd_bin++] = v;
+			if (m_rd_bin >= m_nbins) {
+				uint64_t	clocks = now - m_int_clock;
+
+				m_q.publish();
+				m_fr = NULL;
+				m_draining = false;
+				m_frames++;
+				m_drain_clocks += clocks;
+				if (clocks > m_max_drain)
+					m_max_drain = clocks;
+			}
+		}
+	}
+	// }}}
+};
+
+#endif
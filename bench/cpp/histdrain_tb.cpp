@@ -0,0 +1,243 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	histdrain_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To determine whether a host, reading histograms out of the
+//		AXI-lite histogram core over the bus, can keep up with the
+//	core at a given sample rate.  Samples are fed to the core at the
+//	requested rate, while a HISTDRAIN client reads out every completed
+//	histogram and passes it, through a lock-free queue, to a second thread.
+//	That thread checks that every frame holds exactly NAVGS samples.
+//
+// Usage:	histdrain_tb [sample rate (MHz) [clock rate (MHz)]]
+//
+//	With no arguments, a range of sample rates is tested at a 100MHz clock.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <verilatedos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "axilbfm.h"
+#include "histdrain.h"
+#include "Vhistwrapper.h"
+
+const	unsigned	NFRAMES = 8,	// Interrupts per test
+			NSLOTS  = 4;	// Frames in our queue
+
+// CONSUMER
+// {{{
+// The other side of the queue.  Runs in its own thread, checking every
+// frame it is handed.
+class	CONSUMER {
+	FRAMEQ			&m_q;
+	unsigned		m_navgs;
+public:
+	std::atomic<bool>	m_done;
+	uint64_t		m_frames, m_errors, m_last_frame;
+
+	CONSUMER(FRAMEQ &q, unsigned navgs) : m_q(q), m_navgs(navgs),
+			m_done(false) {
+		m_frames = m_errors = m_last_frame = 0;
+	}
+
+	void	run(void) {
+		while(1) {
+			const HISTFRAME	*fr = m_q.peek();
+			uint64_t	sum = 0;
+
+			if (!fr) {
+				// Check the queue one last time after
+				// we've been told we're done
+				if (m_done.load() && !m_q.peek())
+					break;
+				std::this_thread::yield();
+				continue;
+			}
+
+			for(unsigned k=0; k<m_q.nbins(); k++)
+				sum += fr->m_bins[k];
+			if (sum != m_navgs || fr->m_frame <= m_last_frame) {
+				printf("Frame %ld: %ld samples, expected %d\n",
+					(long)fr->m_frame, (long)sum, m_navgs);
+				m_errors++;
+			}
+			m_last_frame = fr->m_frame;
+			m_frames++;
+			m_q.release();
+		}
+	}
+};
+// }}}
+
+class	DRAIN_TB : public TESTB<Vhistwrapper> {
+public:
+	AXILBFM<Vhistwrapper>	m_bus;
+	FRAMEQ			m_q;
+	HISTDRAIN<Vhistwrapper>	m_drain;
+	unsigned		m_navgs, m_nbins;
+	uint64_t		m_clocks;
+
+	DRAIN_TB(void) : m_bus(m_core), m_q(NSLOTS, nbins_of(m_core)),
+			m_drain(m_bus, m_q) {
+		m_navgs  = m_core->o_navgs;
+		m_nbins  = m_q.nbins();
+		m_clocks = 0;
+	}
+
+	static unsigned	nbins_of(Vhistwrapper *core) {
+		core->eval();
+		return 1u << core->o_aw;
+	}
+
+	void	tick(void) {
+		m_bus.before_tick();
+		TESTB<Vhistwrapper>::tick();
+		m_bus.after_tick();
+
+		m_clocks++;
+		m_drain.step(m_clocks);
+		if (m_core->o_int)
+			m_drain.interrupt(m_clocks);
+	}
+
+	// restart
+	// {{{
+	void	restart(void) {
+		m_core->i_ce = 0;
+		m_bus.clear();
+		reset();
+		m_bus.write(0, 0);
+		while(!m_bus.idle())
+			tick();
+		for(unsigned k=0; k<m_nbins+8; k++)
+			tick();
+		m_drain.clear_stats();
+	}
+	// }}}
+
+	// run
+	// {{{
+	// Returns true if the host kept up with the core
+	bool	run(double sample_mhz, double clock_mhz, bool &pass) {
+		CONSUMER	consumer(m_q, m_navgs);
+		std::thread	cthread(&CONSUMER::run, &consumer);
+		const unsigned	den = 1000;
+		unsigned	num, duty = 0;
+		uint64_t	start, clocks, nbusy = 0;
+		double		period;
+		bool		keptup;
+
+		num = (unsigned)(sample_mhz / clock_mhz * den + 0.5);
+		if (num > den)
+			num = den;
+
+		restart();
+		start = m_clocks;
+		while(m_drain.m_interrupts < NFRAMES) {
+			duty += num;
+			m_core->i_ce = (duty >= den);
+			if (duty >= den)
+				duty -= den;
+			m_core->i_sample = rand();
+			tick();
+		}
+		clocks = m_clocks - start;
+
+		// Let any last frame finish
+		m_core->i_ce = 0;
+		while(m_drain.busy()) {
+			assert(nbusy++ < 8ul * m_nbins);
+			tick();
+		}
+
+		consumer.m_done = true;
+		cthread.join();
+
+		period = clocks / (double)m_drain.m_interrupts;
+		keptup = (m_drain.m_lost == 0 && m_drain.m_qfull == 0);
+		printf("%6.1f MS/s at %5.1f MHz: %ld of %ld frames drained, "
+			"drain %6.0f avg %6ld max of %6.0f clocks, %s\n",
+			sample_mhz, clock_mhz,
+			(long)consumer.m_frames, (long)m_drain.m_interrupts,
+			(m_drain.m_frames) ? m_drain.m_drain_clocks
+				/ (double)m_drain.m_frames : 0.0,
+			(long)m_drain.m_max_drain, period,
+			(keptup) ? "KEEPS UP" : "FALLS BEHIND");
+
+		if (consumer.m_errors > 0 || consumer.m_frames != m_drain.m_frames)
+			pass = false;
+
+		return keptup;
+	}
+	// }}}
+};
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	DRAIN_TB	*tb = new DRAIN_TB;
+	bool		pass = true;
+
+	if (argc > 1) {
+		double	clock_mhz = (argc > 2) ? atof(argv[2]) : 100.0;
+
+		tb->run(atof(argv[1]), clock_mhz, pass);
+	} else {
+		const double	rates[] = { 25, 50, 75, 85, 88, 90, 95, 100 };
+		double		best = 0;
+
+		for(unsigned k=0; k<sizeof(rates)/sizeof(rates[0]); k++) {
+			if (tb->run(rates[k], 100.0, pass) && rates[k] > best)
+				best = rates[k];
+		}
+
+		printf("Fastest sample rate drained: %.1f MS/s, "
+			"NAVGS = %d, %d bins\n", best, tb->m_navgs,
+			tb->m_nbins);
+	}
+
+	delete	tb;
+
+	if (!pass)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,390 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	histogram_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test the AXI-lite version of the histogram core.  Samples
+//		are fed to the core at a variety of duty cycles, while an
+//	AXI-lite bus master reads every bin of the inactive memory back out
+//	following each interrupt.  Everything read is compared against a
+//	reference histogram, whose control path follows the core clock for
+//	clock, but whose bins are simply incremented in software.  The test
+//	then reports what sample rate the core sustained while the host was
+//	reading the other buffer, and whether the host was able to keep up.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <verilatedos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "axilbfm.h"
+#include "Vhistwrapper.h"
+
+// The clock rate assumed when reporting samples per second
+const	double	CLOCK_RATE_HZ = 100e6;
+
+class	HISTOGRAM_TB : public TESTB<Vhistwrapper> {
+	AXILBFM<Vhistwrapper>	m_bus;
+	unsigned	m_aw, m_navgs, m_mask;
+
+	// Our model of the core
+	// {{{
+	// The control path registers are followed exactly, so that we know
+	// which samples land in which memory, and when each memory gets
+	// cleared.  The bins themselves are simply incremented.
+	unsigned	m_count, m_cepipe, m_read_addr, m_r_sample, m_memaddr;
+	bool		m_start_reset, m_first_reset_clock, m_resetpipe,
+			m_activemem, m_int, m_memzero;
+	uint32_t	*m_ref;
+	// }}}
+
+	// Readout state
+	// {{{
+	unsigned	m_rd_bin, m_errors;
+	bool		m_draining, m_stale;
+	uint64_t	m_sum, m_int_clock;
+	// }}}
+public:
+	// Statistics from the last run
+	uint64_t	m_clocks, m_offered, m_counted, m_frames, m_checked,
+			m_overruns, m_drain_clocks;
+	bool		m_fail;
+
+	HISTOGRAM_TB(void) : m_bus(m_core) {
+		m_core->eval();
+		m_aw    = m_core->o_aw;
+		m_navgs = m_core->o_navgs;
+		m_mask  = (1u << m_aw)-1;
+
+		m_ref = new uint32_t[2u << m_aw];
+		for(unsigned k=0; k < (2u << m_aw); k++)
+			m_ref[k] = 0;
+
+		// Initial values, as found in histogram.v
+		m_count  = 0;
+		m_cepipe = 0;
+		m_read_addr = m_r_sample = m_memaddr = 0;
+		m_start_reset = true;
+		m_first_reset_clock = m_resetpipe = false;
+		m_activemem = m_int = m_memzero = false;
+
+		m_draining = m_stale = false;
+		m_rd_bin = m_errors = 0;
+		m_sum = m_int_clock = 0;
+		m_fail = false;
+		clear_stats();
+	}
+
+	~HISTOGRAM_TB(void) {
+		delete[] m_ref;
+	}
+
+	unsigned nbins(void) const { return 1u << m_aw; }
+
+	void	clear_stats(void) {
+		m_clocks = m_offered = m_counted = m_frames = m_checked = 0;
+		m_overruns = m_drain_clocks = 0;
+	}
+
+	// model_step
+	// {{{
+	// Advance our model by one clock.  bus_write is true if a write was
+	// accepted on this clock.
+	void	model_step(bool ce, unsigned sample, bool reset,
+			bool bus_write) {
+		// Values prior to the clock edge
+		const bool	active = m_activemem,
+				start  = m_start_reset,
+				first  = m_first_reset_clock,
+				rpipe  = m_resetpipe;
+		const unsigned	cepipe = m_cepipe, memaddr = m_memaddr;
+		const bool	last = (cepipe & 1) && (m_count == m_navgs-1);
+
+		// Clock three: write to memory
+		if (cepipe & 4) {
+			if (m_memzero)
+				m_ref[memaddr] = 0;
+			else
+				m_ref[memaddr]++;
+		}
+
+		// Count the samples within each average
+		if (start || rpipe)
+			m_count = 0;
+		else if (cepipe & 1) {
+			m_count = (last) ? 0 : m_count + 1;
+			m_counted++;
+		}
+
+		// Reset control: start a new average
+		m_start_reset = (last || bus_write) && !rpipe;
+		if (reset)
+			m_start_reset = true;
+		m_first_reset_clock = start;
+
+		if (start || first)
+			m_resetpipe = true;
+		else if ((memaddr & m_mask) == m_mask)
+			m_resetpipe = false;
+
+		// Switch memories once every NAVGS samples
+		m_int = false;
+		if (last && !start) {
+			m_activemem = !active;
+			m_int = true;
+		}
+		if (reset)
+			m_int = false;
+
+		m_cepipe = (rpipe) ? 4 : (((cepipe << 1) | (ce ? 1:0)) & 7);
+
+		// The address pipeline
+		if (rpipe) {
+			m_memaddr = (first) ? 0 : ((memaddr + 1) & m_mask);
+			m_memaddr |= (active ? 1:0) << m_aw;
+		} else
+			m_memaddr = m_r_sample;
+		m_memzero = rpipe;
+
+		m_r_sample = m_read_addr;
+		if (ce && !rpipe)
+			m_read_addr = ((active ? 1:0) << m_aw) | (sample & m_mask);
+		else // A bus read
+			m_read_addr = ((active ? 0:1) << m_aw);
+	}
+	// }}}
+
+	// readout
+	// {{{
+	// Check any bus read returns against the inactive memory.  Must be
+	// called before the model is stepped, so that the model still reflects
+	// the state of the memory prior to the clock edge.
+	void	readout(void) {
+		uint32_t	v;
+
+		while(m_bus.rdata(v)) {
+			unsigned	bin = m_rd_bin++;
+
+			if (!m_stale) {
+				uint32_t	expected;
+
+				expected = m_ref[((m_activemem ? 0:1) << m_aw)
+						| bin];
+				if (v != expected) {
+					if (m_errors++ < 8)
+						printf("Frame %4ld, BIN[%4d] = %6d, "
+							"expected %6d\n",
+							(long)m_frames, bin,
+							v, expected);
+					m_fail = true;
+				}
+				m_sum += v;
+			}
+
+			if (m_rd_bin >= nbins()) {
+				// This drain is complete
+				if (!m_stale) {
+					if (m_sum != m_navgs) {
+						printf("Frame %4ld: %ld samples "
+							"counted, not %d\n",
+							(long)m_frames,
+							(long)m_sum, m_navgs);
+						m_fail = true;
+					}
+					m_checked++;
+					m_drain_clocks += m_clocks-m_int_clock;
+				}
+				m_draining = false;
+				m_stale    = false;
+			}
+		}
+	}
+	// }}}
+
+	// interrupt
+	// {{{
+	// On an interrupt, read the entire inactive memory.  If we are still
+	// reading out the last one, it has now been overwritten, so we've
+	// overrun.
+	void	interrupt(void) {
+		m_frames++;
+
+		if (m_draining) {
+			m_overruns++;
+			m_stale = true;
+			return;
+		}
+
+		m_draining  = true;
+		m_rd_bin    = 0;
+		m_sum       = 0;
+		m_int_clock = m_clocks;
+		for(unsigned k=0; k<nbins(); k++)
+			m_bus.read(k << 2);
+	}
+	// }}}
+
+	// tick
+	// {{{
+	void	tick(void) {
+		bool		ce = m_core->i_ce, reset = m_core->i_reset;
+		unsigned	sample = m_core->i_sample;
+
+		m_bus.before_tick();
+		TESTB<Vhistwrapper>::tick();
+		m_bus.after_tick();
+
+		readout();
+		// With BREADY held high, BVALID follows every accepted write
+		// by one clock
+		model_step(ce, sample, reset, m_core->S_AXI_BVALID);
+
+		m_clocks++;
+		if (ce)
+			m_offered++;
+
+		if (m_core->o_int != m_int) {
+			printf("O_INT MISMATCH at clock %ld\n", (long)m_clocks);
+			m_fail = true;
+		}
+
+		if (m_int)
+			interrupt();
+	}
+	// }}}
+
+	// restart
+	// {{{
+	// Reset the core, then issue a write to restart the average.  Wait
+	// for the memory to be cleared before returning.
+	void	restart(void) {
+		m_core->i_ce     = 0;
+		m_core->i_sample = 0;
+		m_bus.clear();
+		m_draining = m_stale = false;
+		reset();
+
+		m_bus.write(0, 0);
+		for(int k=0; !m_bus.idle(); k++) {
+			assert(k < 16);
+			tick();
+		}
+
+		while(m_start_reset || m_first_reset_clock || m_resetpipe)
+			tick();
+	}
+	// }}}
+
+	// run
+	// {{{
+	// Offer num samples every den clocks, for nframes interrupts.  Returns
+	// true if all readouts matched.
+	bool	run(unsigned num, unsigned den, unsigned nframes) {
+		unsigned	duty = 0, last_sample = 0;
+
+		restart();
+		clear_stats();
+		m_errors = 0;
+
+		while(m_frames < nframes) {
+			unsigned	s;
+
+			duty += num;
+			m_core->i_ce = (duty >= den);
+			if (duty >= den)
+				duty -= den;
+
+			// Favor the center bins, and repeat the same bin
+			// often enough to exercise the core's forwarding
+			if (rand() & 3)
+				s = ((rand() & m_mask) + (rand() & m_mask)) >> 1;
+			else
+				s = last_sample;
+			m_core->i_sample = s;
+			if (m_core->i_ce)
+				last_sample = s;
+
+			tick();
+		}
+
+		// Let the last drain finish
+		m_core->i_ce = 0;
+		for(int k=0; !m_bus.idle(); k++) {
+			assert(k < 8 * (int)nbins());
+			tick();
+		}
+
+		printf("Duty %2d/%2d: %6.4f samples/clk (%6.1f MS/s), "
+			"%5.2f%% dropped while clearing, ",
+			num, den,
+			m_counted / (double)m_clocks,
+			m_counted / (double)m_clocks * CLOCK_RATE_HZ / 1e6,
+			100.0 * (m_offered - m_counted) / (double)m_offered);
+		if (m_overruns == 0)
+			printf("readout kept up (%5.1f%% of frame)\n",
+				100.0 * m_drain_clocks * m_frames
+					/ (double)m_checked / (double)m_clocks);
+		else
+			printf("readout overran %ld/%ld frames\n",
+				(long)m_overruns, (long)m_frames);
+
+		return !m_fail;
+	}
+	// }}}
+};
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	HISTOGRAM_TB	*tb = new HISTOGRAM_TB;
+	const unsigned	duty[][2] = {
+		{ 1, 4 }, { 1, 2 }, { 3, 4 }, { 7, 8 }, { 15, 16 }, { 1, 1 } };
+	bool	pass = true;
+
+	// tb->opentrace("histogram.vcd");
+
+	for(unsigned k=0; k<sizeof(duty)/sizeof(duty[0]); k++)
+		pass = tb->run(duty[k][0], duty[k][1], 6) && pass;
+
+	delete	tb;
+
+	if (!pass)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,282 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	histogramn_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To show that the multiple sample per clock histogram,
+//		histogramn, produces exactly the same histogram as the single
+//	lane histogram.v, when given the same NAVGS samples.  Several
+//	collision heavy sample streams are used: every sample in the same
+//	bin, alternating bins, a handful of bins, and runs of repeated bins,
+//	as well as uniformly random samples.  Each is histogrammed in software,
+//	by histogram.v (one sample per clock), and by histogramn with two,
+//	three, and four lanes.  All five results must match bin for bin.
+//	Since NAVGS isn't a multiple of three, the three lane core's last
+//	clock is padded with random samples that must not be counted.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <verilatedos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "Vhistogram.h"
+#include "Vhistogramn.h"
+#include "Vhistogramn_4.h"
+#include "Vhistogramn_3.h"
+
+// These must match the parameters the cores were built with
+const	unsigned	AW = 12,
+			NBINS = (1u << AW),
+			NAVGS = 65536;
+
+template <class VA> class HISTN_TB : public TESTB<VA> {
+	unsigned	m_nlanes;
+public:
+	// Clocks spent feeding the last frame
+	unsigned	m_clocks;
+
+	HISTN_TB(unsigned nlanes) : m_nlanes(nlanes) {
+		m_clocks = 0;
+	}
+
+	// restart
+	// {{{
+	// Reset the core, then write to it to restart the average.  Wait
+	// long enough for the memory to be cleared before returning.
+	void	restart(void) {
+		VA	*core = TESTB<VA>::m_core;
+
+		core->i_ce     = 0;
+		core->i_sample = 0;
+		core->i_wb_cyc = 0;
+		core->i_wb_stb = 0;
+		core->i_wb_we  = 0;
+		core->i_wb_addr= 0;
+		core->i_wb_data= 0;
+		core->i_wb_sel = 15;
+		TESTB<VA>::reset();
+
+		core->i_wb_cyc = 1;
+		core->i_wb_stb = 1;
+		core->i_wb_we  = 1;
+		TESTB<VA>::tick();
+		core->i_wb_stb = 0;
+		core->i_wb_we  = 0;
+		while(!core->o_wb_ack)
+			TESTB<VA>::tick();
+		core->i_wb_cyc = 0;
+
+		for(unsigned k=0; k<NBINS+8; k++)
+			TESTB<VA>::tick();
+	}
+	// }}}
+
+	// wb_read
+	// {{{
+	unsigned	wb_read(unsigned addr) {
+		VA	*core = TESTB<VA>::m_core;
+		int	timeout = 0;
+
+		core->i_wb_cyc = 1;
+		core->i_wb_stb = 1;
+		core->i_wb_we  = 0;
+		core->i_wb_addr= addr;
+		assert(!core->o_wb_stall);
+		TESTB<VA>::tick();
+		core->i_wb_stb = 0;
+		while(!core->o_wb_ack) {
+			assert(timeout++ < 8);
+			TESTB<VA>::tick();
+		}
+		core->i_wb_cyc = 0;
+
+		return core->o_wb_data;
+	}
+	// }}}
+
+	// frame
+	// {{{
+	// Histogram NAVGS samples, m_nlanes at a time, and then read the
+	// result back out.  If gaps is true, i_ce is randomly dropped between
+	// clocks, to vary the spacing between repeated bins.  Returns false
+	// if the core never signaled that it was done.
+	bool	frame(const unsigned *samples, uint32_t *result, bool gaps) {
+		VA	*core = TESTB<VA>::m_core;
+		bool	done = false;
+
+		restart();
+
+		m_clocks = 0;
+		for(unsigned k=0; k<NAVGS; ) {
+			if (gaps && (rand() & 7) == 0) {
+				core->i_ce = 0;
+			} else {
+				uint64_t	v = 0;
+
+				for(unsigned ln=0; ln<m_nlanes; ln++) {
+					// Pad past NAVGS with junk
+					uint64_t	s = (k+ln < NAVGS)
+						? samples[k+ln] : rand() % NBINS;
+					v |= s << (ln*AW);
+				}
+				core->i_ce     = 1;
+				core->i_sample = v;
+				k += m_nlanes;
+			}
+
+			TESTB<VA>::tick();
+			m_clocks++;
+			done = done || core->o_int;
+		}
+		core->i_ce = 0;
+
+		for(int k=0; k<8; k++) {
+			TESTB<VA>::tick();
+			done = done || core->o_int;
+		}
+
+		for(unsigned k=0; k<NBINS; k++)
+			result[k] = wb_read(k);
+
+		return done;
+	}
+	// }}}
+};
+
+// compare
+// {{{
+static	bool	compare(const char *name, const uint32_t *ref,
+			const uint32_t *result) {
+	unsigned	nerr = 0;
+
+	for(unsigned k=0; k<NBINS; k++) {
+		if (ref[k] != result[k]) {
+			if (nerr++ < 4)
+				printf("  %s: BIN[%4d] = %6d, expected %6d\n",
+					name, k, result[k], ref[k]);
+		}
+	}
+
+	return (nerr == 0);
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	HISTN_TB<Vhistogram>	*tb1 = new HISTN_TB<Vhistogram>(1);
+	HISTN_TB<Vhistogramn>	*tb2 = new HISTN_TB<Vhistogramn>(2);
+	HISTN_TB<Vhistogramn_3>	*tb3 = new HISTN_TB<Vhistogramn_3>(3);
+	HISTN_TB<Vhistogramn_4>	*tb4 = new HISTN_TB<Vhistogramn_4>(4);
+	const char	*names[] = { "One bin", "Alternating bins",
+				"Three bins", "Runs", "Uniform" };
+	unsigned	*samples = new unsigned[NAVGS];
+	uint32_t	*ref  = new uint32_t[NBINS],
+			*res1 = new uint32_t[NBINS],
+			*res2 = new uint32_t[NBINS],
+			*res3 = new uint32_t[NBINS],
+			*res4 = new uint32_t[NBINS];
+	bool		pass = true;
+
+	for(int test=0; test<5; test++) {
+		unsigned	a = rand() % NBINS, b = rand() % NBINS,
+				c = rand() % NBINS, run = 0;
+		bool		ok;
+
+		// Generate the test stream
+		// {{{
+		for(unsigned k=0; k<NAVGS; k++) {
+			if (test == 0)
+				samples[k] = a;
+			else if (test == 1)
+				samples[k] = (k & 1) ? a : b;
+			else if (test == 2) {
+				unsigned	r = rand() % 3;
+				samples[k] = (r == 0) ? a : (r == 1) ? b : c;
+			} else if (test == 3) {
+				if (run == 0) {
+					a = rand() % NBINS;
+					run = 1 + (rand() & 7);
+				}
+				run--;
+				samples[k] = a;
+			} else
+				samples[k] = rand() % NBINS;
+		}
+		// }}}
+
+		for(unsigned k=0; k<NBINS; k++)
+			ref[k] = 0;
+		for(unsigned k=0; k<NAVGS; k++)
+			ref[samples[k]]++;
+
+		ok = tb1->frame(samples, res1, false);
+		ok = tb2->frame(samples, res2, (test & 1)) && ok;
+		ok = tb3->frame(samples, res3, (test & 1)) && ok;
+		ok = tb4->frame(samples, res4, (test & 1) == 0) && ok;
+		if (!ok)
+			printf("  No interrupt!\n");
+
+		ok = compare("histogram", ref, res1) && ok;
+		ok = compare("histogramn, 2 lanes", ref, res2) && ok;
+		ok = compare("histogramn, 3 lanes", ref, res3) && ok;
+		ok = compare("histogramn, 4 lanes", ref, res4) && ok;
+
+		printf("%-16s: %6d, %6d, %6d, %6d clocks for 1, 2, 3, 4 lanes%s\n",
+			names[test], tb1->m_clocks, tb2->m_clocks,
+			tb3->m_clocks, tb4->m_clocks,
+			(ok) ? "" : "  -- FAILED");
+		pass = pass && ok;
+	}
+
+	delete	tb1;
+	delete	tb2;
+	delete	tb3;
+	delete	tb4;
+	delete[] samples;
+	delete[] ref;
+	delete[] res1;
+	delete[] res2;
+	delete[] res3;
+	delete[] res4;
+
+	if (!pass)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,457 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename:	iiravg_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	Tests the recursive averager, iiravg.v, and its channelized
+//		version, iiravg_tdm.v, against a bit exact model.  Each is
+//	tested with two sets of parameters: the defaults, and a faster average
+//	(LGALPHA=2) that resets to a non-zero (negative) value.
+//
+//	The tests cover random data, resets, and convergence: a constant input
+//	must be followed to within 2^LGALPHA, and a step must be (about) 1-1/e
+//	of the way there after 2^LGALPHA samples.  The channelized core is also fed
+//	one sample on every clock, from random channels, and the number of
+//	channel samples it handles per clock is reported.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "iiravgmodel.h"
+#include "Viiravg.h"
+#include "Viiravg_a2.h"
+#include "Viiravg_tdm.h"
+#include "Viiravg_tdm_a2.h"
+
+const	int	IW = 15, OW = 16, LGNCHAN = 8, NCHAN = (1<<LGNCHAN);
+// Outputs the model has produced, which the core hasn't yet
+const	int	LGFIFO = 3;
+
+// sbits
+// {{{
+static	int64_t	sbits(int64_t val, int b) {
+	val <<= (64-b);
+	val >>= (64-b);
+	return val;
+}
+// }}}
+
+// halfscale
+// {{{
+// A random input, of no more than half scale.  The difference between the
+// input and the average is only OW bits wide, as in iiravg.v, so larger steps
+// would overflow it.
+static	uint64_t	halfscale(void) {
+	int64_t	v = (rand() % ((1<<(IW-1))-1)) - ((1<<(IW-2))-1);
+
+	return v & ((1<<IW)-1);
+}
+// }}}
+
+// The core's parameters, and those of its variant
+const	int		LGALPHA = 4, LGALPHA_A2 = 2;
+const	uint64_t	RESET_VALUE = 0, RESET_VALUE_A2 = 49152;
+
+//
+// converged
+// {{{
+// Check a series of averages, taken while applying a constant input, for
+// convergence.  step[k] is the average after k+1 samples, starting from
+// start.  Returns true if all is well.
+bool	converged(const char *name, int lgalpha, uint64_t data, uint64_t start,
+		int nsteps, const uint64_t *step) {
+	double	target = (double)sbits(data << (OW-IW), OW),
+		initial = (double)sbits(start, OW),
+		expected, actual, final;
+	int	tc = (1<<lgalpha);
+	bool	pass = true;
+
+	assert(nsteps > tc);
+
+	// After one time constant, 2^LGALPHA samples, we should be within
+	// (1-2^-LGALPHA)^(2^LGALPHA), or about 1/e, of the target
+	expected = target + (initial - target) * pow(1.0 - 1.0/tc, tc);
+	actual = (double)sbits(step[tc-1], OW);
+	if (fabs(actual - expected) > 0.05 * fabs(initial - target) + tc) {
+		printf("%s: After %d samples, %.0f is too far from %.0f\n",
+			name, tc, actual, expected);
+		pass = false;
+	}
+
+	// Eventually, we should be as close as the LGALPHA shift allows
+	final = (double)sbits(step[nsteps-1], OW);
+	if (fabs(final - target) >= tc) {
+		printf("%s: Failed to converge, %.0f != %.0f\n",
+			name, final, target);
+		pass = false;
+	}
+
+	return pass;
+}
+// }}}
+
+//
+// test_iiravg
+// {{{
+// Test a single channel iiravg core
+template<class VA>	bool	test_iiravg(const char *name, int lgalpha,
+			uint64_t reset_value) {
+	const	int	NTESTS = 200000,
+			NCONVERGE = OW*(4<<lgalpha);
+	TESTB<VA>	*tb = new TESTB<VA>();
+	IIRAVGMODEL	model(IW, OW, lgalpha, reset_value);
+	uint64_t	step[NCONVERGE];
+	bool		pass = true;
+
+	tb->m_core->i_ce   = 0;
+	tb->m_core->i_data = 0;
+	tb->reset();
+
+	// The reset value
+	// {{{
+	if (tb->m_core->o_data != reset_value) {
+		printf("%s: O_DATA = %04x != RESET_VALUE = %04lx\n", name,
+			tb->m_core->o_data, (unsigned long)reset_value);
+		pass = false;
+	}
+	// }}}
+
+	// Random data, i_ce, and resets
+	// {{{
+	for(int k=0; k<NTESTS && pass; k++) {
+		uint64_t	data = rand() & ((1<<IW)-1);
+
+		tb->m_core->i_ce   = (rand() & 3) != 0;
+		tb->m_core->i_data = data;
+		if ((rand() & 0x3fff) == 0) {
+			tb->reset();
+			model.reset();
+		} else {
+			tb->tick();
+			if (tb->m_core->i_ce)
+				model.apply(data);
+		}
+
+		if (tb->m_core->o_data != model.average()) {
+			printf("%s: O_DATA[%d] = %04x != %04lx (expected)\n",
+				name, k, tb->m_core->o_data,
+				(unsigned long)model.average());
+			pass = false;
+		}
+	}
+	// }}}
+
+	// Convergence
+	// {{{
+	for(int t=0; t<8 && pass; t++) {
+		uint64_t	data = halfscale();
+
+		// A step from the reset value to a random constant
+		tb->m_core->i_ce = 0;
+		tb->reset();
+		tb->m_core->i_ce   = 1;
+		tb->m_core->i_data = data;
+		for(int k=0; k<NCONVERGE; k++) {
+			tb->tick();
+			step[k] = tb->m_core->o_data;
+		}
+
+		pass = converged(name, lgalpha, data, reset_value,
+						NCONVERGE, step);
+	}
+	// }}}
+
+	delete tb;
+	printf("%s: %s\n", name, (pass) ? "PASS" : "FAIL");
+	return pass;
+}
+// }}}
+
+//
+// IIRAVG_TDM_TB
+// {{{
+template<class VA>	class	IIRAVG_TDM_TB : public TESTB<VA> {
+	IIRAVGMODEL	*m_model[NCHAN];
+
+	// Results we expect, in the order we expect them
+	uint64_t	m_expected[1<<LGFIFO];
+	unsigned	m_echan[1<<LGFIFO];
+	unsigned	m_wr, m_rd;
+public:
+	// If m_steps is set, each channel's first m_nsteps results are
+	// recorded there, channel by channel
+	uint64_t	*m_steps;
+	int		m_nsteps, m_count[NCHAN];
+	// Statistics
+	uint64_t	m_clocks, m_samples;
+	const char	*m_name;
+	bool		m_fail;
+
+	IIRAVG_TDM_TB(const char *name, int lgalpha, uint64_t reset_value) {
+		m_name = name;
+		for(int c=0; c<NCHAN; c++) {
+			m_model[c] = new IIRAVGMODEL(IW, OW, lgalpha,
+						reset_value);
+			m_count[c] = 0;
+		}
+		m_steps = NULL;
+		m_nsteps = 0;
+		m_wr = m_rd = 0;
+		m_clocks = m_samples = 0;
+		m_fail = false;
+	}
+
+	~IIRAVG_TDM_TB(void) {
+		for(int c=0; c<NCHAN; c++)
+			delete m_model[c];
+	}
+
+	// tick
+	// {{{
+	// Step the core, and check any result it produces against the next
+	// one we are expecting
+	void	tick(void) {
+		TESTB<VA>::tick();
+		m_clocks++;
+
+		if (TESTB<VA>::m_core->o_ce) {
+			uint64_t	result = TESTB<VA>::m_core->o_data;
+			unsigned	chan = TESTB<VA>::m_core->o_chan;
+
+			if (m_rd == m_wr) {
+				printf("%s: Unexpected output, CH[%3d] = %04lx\n",
+					m_name, chan, (unsigned long)result);
+				m_fail = true;
+			} else {
+				unsigned	ptr = m_rd & ((1<<LGFIFO)-1);
+
+				if (chan != m_echan[ptr]
+						|| result != m_expected[ptr]) {
+					printf("%s: CH[%3d] = %04lx != CH[%3d] = %04lx (expected)\n",
+						m_name, chan,
+						(unsigned long)result,
+						m_echan[ptr],
+						(unsigned long)m_expected[ptr]);
+					m_fail = true;
+				}
+				m_rd++;
+			}
+
+			if (m_steps && m_count[chan] < m_nsteps)
+				m_steps[chan*m_nsteps+m_count[chan]] = result;
+			m_count[chan]++;
+		}
+	}
+	// }}}
+
+	// reset
+	// {{{
+	void	reset(void) {
+		TESTB<VA>::m_core->i_ce   = 0;
+		TESTB<VA>::m_core->i_chan = 0;
+		TESTB<VA>::m_core->i_data = 0;
+		TESTB<VA>::reset();
+		for(int c=0; c<NCHAN; c++) {
+			m_model[c]->reset();
+			m_count[c] = 0;
+		}
+		m_wr = m_rd = 0;
+	}
+	// }}}
+
+	// sample
+	// {{{
+	// Offer one sample to the core on the given channel, followed by gap
+	// idle clocks
+	void	sample(unsigned chan, uint64_t data, unsigned gap = 0) {
+		unsigned	ptr = m_wr & ((1<<LGFIFO)-1);
+
+		assert(m_wr - m_rd < (1u<<LGFIFO));
+		m_echan[ptr]    = chan;
+		m_expected[ptr] = m_model[chan]->apply(data);
+		m_wr++;
+		m_samples++;
+
+		TESTB<VA>::m_core->i_ce   = 1;
+		TESTB<VA>::m_core->i_chan = chan;
+		TESTB<VA>::m_core->i_data = data & ((1<<IW)-1);
+		tick();
+
+		TESTB<VA>::m_core->i_ce   = 0;
+		for(unsigned k=0; k<gap; k++)
+			tick();
+	}
+	// }}}
+
+	// flush
+	// {{{
+	// Wait for every expected output to be produced
+	void	flush(void) {
+		TESTB<VA>::m_core->i_ce = 0;
+		for(int k=0; k<4 && m_rd != m_wr; k++)
+			tick();
+		if (m_rd != m_wr) {
+			printf("%s: %d outputs never produced\n", m_name,
+				m_wr - m_rd);
+			m_fail = true;
+		}
+	}
+	// }}}
+};
+// }}}
+
+//
+// test_tdm
+// {{{
+// Test a channelized iiravg_tdm core
+template<class VA>	bool	test_tdm(const char *name, int lgalpha,
+			uint64_t reset_value) {
+	const	int	NTESTS = 500000,
+			NCONVERGE = OW*(4<<lgalpha);
+	IIRAVG_TDM_TB<VA>	*tb = new IIRAVG_TDM_TB<VA>(name, lgalpha,
+						reset_value);
+	uint64_t	*steps = new uint64_t[NCHAN*NCONVERGE],
+			data[NCHAN];
+	bool		pass = true;
+
+	tb->reset();
+
+	// Random data on random channels, at full rate
+	// {{{
+	// A quarter of the time, the sample is from the same channel as the
+	// last one.  This must be handled as though the last sample had
+	// already been written to memory.
+	{
+		unsigned	chan = 0;
+		uint64_t	clocks;
+		double		rate;
+
+		tb->m_clocks = tb->m_samples = 0;
+		for(int k=0; k<NTESTS && !tb->m_fail; k++) {
+			if (rand() & 3)
+				chan = rand() & (NCHAN-1);
+			tb->sample(chan, rand() & ((1<<IW)-1));
+		}
+		clocks = tb->m_clocks;
+		tb->flush();
+
+		rate = tb->m_samples / (double)clocks;
+		printf("%s: %ld samples in %ld clocks, %.3f channel samples per clock\n",
+			name, (unsigned long)tb->m_samples,
+			(unsigned long)clocks, rate);
+		printf("%s: Supports %d channels, at up to 1/%.0f of the clock rate each\n",
+			name, NCHAN, NCHAN / rate);
+		if (tb->m_samples != clocks)
+			pass = false;
+	}
+	// }}}
+
+	// Random gaps, and resets
+	// {{{
+	for(int k=0; k<NTESTS && !tb->m_fail; k++) {
+		if ((rand() & 0x3fff) == 0) {
+			tb->flush();
+			tb->reset();
+		}
+		tb->sample(rand() & (NCHAN-1), rand() & ((1<<IW)-1),
+			(rand() & 1) ? 0 : (rand() & 3));
+	}
+	tb->flush();
+	// }}}
+
+	// RESET_VALUE
+	// {{{
+	// Every channel should start again from the reset value, even those
+	// that have been written before
+	tb->reset();
+	for(int c=0; c<NCHAN && !tb->m_fail; c++)
+		tb->sample(c, 0);
+	tb->flush();
+	// }}}
+
+	// Convergence
+	// {{{
+	// Every channel gets its own constant input, and they are interleaved
+	// at full rate
+	if (!tb->m_fail) {
+		tb->reset();
+		tb->m_steps  = steps;
+		tb->m_nsteps = NCONVERGE;
+		for(int c=0; c<NCHAN; c++)
+			data[c] = halfscale();
+		for(int k=0; k<NCONVERGE; k++)
+			for(int c=0; c<NCHAN; c++)
+				tb->sample(c, data[c]);
+		tb->flush();
+		tb->m_steps = NULL;
+
+		for(int c=0; c<NCHAN && pass; c++)
+			pass = converged(name, lgalpha, data[c], reset_value,
+					NCONVERGE, &steps[c*NCONVERGE]);
+	}
+	// }}}
+
+	pass = pass && !tb->m_fail;
+	delete[] steps;
+	delete tb;
+	printf("%s: %s\n", name, (pass) ? "PASS" : "FAIL");
+	return pass;
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	bool	pass = true;
+
+	pass = test_iiravg<Viiravg>("IIRAVG", LGALPHA, RESET_VALUE) && pass;
+	pass = test_iiravg<Viiravg_a2>("IIRAVG-A2", LGALPHA_A2,
+			RESET_VALUE_A2) && pass;
+	pass = test_tdm<Viiravg_tdm>("IIRAVG-TDM", LGALPHA, RESET_VALUE)
+			&& pass;
+	pass = test_tdm<Viiravg_tdm_a2>("IIRAVG-TDM-A2", LGALPHA_A2,
+			RESET_VALUE_A2) && pass;
+
+	if (pass)
+		printf("SUCCESS!!\n");
+	else
+		printf("TEST FAILURE!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
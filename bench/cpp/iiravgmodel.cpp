@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	iiravgmodel.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A bit exact software model of the recursive averager, iiravg.v,
+//		and of each channel of its channelized version, iiravg_tdm.v.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "iiravgmodel.h"
+
+// sbits
+// {{{
+static int64_t	sbits(int64_t val, int b) {
+	val <<= (64-b);
+	val >>= (64-b);
+	return val;
+}
+// }}}
+
+IIRAVGMODEL::IIRAVGMODEL(int iw, int ow, int lgalpha, uint64_t reset_value)
+		: m_iw(iw), m_ow(ow), m_lgalpha(lgalpha) {
+	assert(iw <= ow);
+	assert(ow < 64);
+	assert(lgalpha < ow);
+
+	m_reset_value = reset_value & ((1ul << ow)-1);
+	reset();
+}
+
+// apply
+// {{{
+uint64_t	IIRAVGMODEL::apply(uint64_t data) {
+	const	uint64_t	mask = (1ul << m_ow)-1;
+	int64_t	difference, adjustment;
+
+	// The difference is taken at OW bits, and may overflow
+	data &= (1ul << m_iw)-1;
+	difference = sbits((data << (m_ow-m_iw)) - m_average, m_ow);
+
+	// An arithmetic shift right, rounding towards minus infinity
+	adjustment = difference >> m_lgalpha;
+
+	m_average = (m_average + adjustment) & mask;
+	return m_average;
+}
+// }}}
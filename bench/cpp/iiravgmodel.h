@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	iiravgmodel.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A bit exact software model of the recursive averager, iiravg.v,
+//		and of each channel of its channelized version, iiravg_tdm.v.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	IIRAVGMODEL_H
+#define	IIRAVGMODEL_H
+
+#include <stdint.h>
+
+class	IIRAVGMODEL {
+	int		m_iw, m_ow, m_lgalpha;
+	uint64_t	m_reset_value, m_average;
+public:
+	IIRAVGMODEL(int iw, int ow, int lgalpha, uint64_t reset_value);
+
+	// Equivalent to i_reset
+	void	reset(void) { m_average = m_reset_value; }
+
+	// Apply one sample, as with i_ce, and return the new average.  Both
+	// the sample and the average are returned as unsigned bit vectors,
+	// iw and ow bits wide respectively.
+	uint64_t	apply(uint64_t data);
+
+	uint64_t	average(void) const { return m_average; }
+};
+
+#endif
@@ -39,6 +39,7 @@
 // }}}
 #include <verilatedos.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
@@ -48,6 +49,8 @@
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 #include "Vlfsr.h"
+#include "lfsrmodel.h"
+#include "prbscapture.h"
 
 #ifdef	ROOT_VERILATOR
 #include "Vlfsr___024root.h"
@@ -65,8 +68,22 @@ int	main(int argc, char **argv) {
 	Verilated::commandArgs(argc, argv);
 	Vlfsr		tb;
 	int		nout = 0;
-	unsigned	clocks = 0, ones = 0, nbits = 0;
+	unsigned	clocks = 0, ones = 0, nbits = 0, mismatch = 0;
 	const	int	LN = 8, WS = 24;
+	const	uint64_t TAPS = 0x2d;
+	LFSRMODEL	model(LN, TAPS, false, WS);
+	PRBSCAPTURE	capture(LN, TAPS, WS);
+	const char	*capfile = NULL;
+	bool		text = false;
+
+	// -t	Print the first output bits as text
+	// -o	Write the packed binary capture to the given file
+	for(int k=1; k<argc; k++) {
+		if (strcmp(argv[k], "-t") == 0)
+			text = true;
+		else if (strcmp(argv[k], "-o") == 0 && k+1 < argc)
+			capfile = argv[++k];
+	}
 
 #define	VCDTRACE
 #ifdef	VCDTRACE
@@ -97,6 +114,10 @@ int	main(int argc, char **argv) {
 	assert(((tb.sreg)&((1<<LN)-1)) == 1);
 	assert(tb.sreg != 0);
 
+	model.reset(1);
+	if (tb.o_word != model.word())
+		mismatch++;
+
 	while(clocks < 16*32*32) {
 		int	ch;
 
@@ -108,9 +129,12 @@ int	main(int argc, char **argv) {
 		tb.eval();
 		TRACE_NEGEDGE;
 
-		for(int k=0; k<WS; k++) {
+		if (tb.o_word != model.word())
+			mismatch++;
+		capture.append(tb.o_word);
+
+		for(int k=0; text && k<WS; k++) {
 			ch    = ((tb.o_word>>k)&1) ? '1' : '0';
-			ones += ((tb.o_word>>k)&1);
 			putchar(ch);
 			nout++;
 			if ((nout & 0x07)==0) {
@@ -120,7 +144,7 @@ int	main(int argc, char **argv) {
 				} else
 					putchar(' ');
 			}
-		} nbits += WS;
+		}
 		clocks++;
 
 		assert(tb.sreg != 0);
@@ -138,12 +162,16 @@ int	main(int argc, char **argv) {
 		tb.eval();
 		TRACE_NEGEDGE;
 
-		for(int k=0; k<WS; k++) {
-			ones += ((tb.o_word>>k)&1);
-		} nbits += WS;
+		if (tb.o_word != model.word())
+			mismatch++;
+		capture.append(tb.o_word);
+
 		clocks++;
 		assert(tb.sreg != 0);
 	}
+
+	ones  = capture.ones();
+	nbits = capture.size();
 	printf("\n\nSimulation complete: %d clocks (%08x), %d ones, %d bits\n", clocks, clocks, ones, nbits);
 
 	bool	failed = false;
@@ -161,6 +189,92 @@ int	main(int argc, char **argv) {
 		else if (no != (1<<(LN-1)))
 			failed = true;
 	}
+
+	if (mismatch > 0) {
+		printf("%d words differed from the model\n", mismatch);
+		failed = true;
+	}
+
+	// The capture holds a whole number of periods, so its circular
+	// statistics should be those of an m-sequence
+	// {{{
+	if (!failed) {
+		const unsigned	period = (1u << LN) - 1,
+				nperiods = nbits / period;
+		uint64_t	zruns[LN+2], oruns[LN+2], nruns;
+		bool		stats_ok = true;
+
+		// Runs: per period, 2^(LN-k-2) runs each of zeros and ones of
+		// length k < LN-1, one run of LN-1 zeros, and one of LN ones
+		nruns = capture.runs(zruns, oruns, LN+1);
+		if (nruns != nperiods * (1u << (LN-1)))
+			stats_ok = false;
+		for(int k=1; k<=LN+1; k++) {
+			uint64_t	ez = 0, eo = 0;
+
+			if (k <= LN-2)
+				ez = eo = (1u << (LN-k-2));
+			else if (k == LN-1)
+				ez = 1;
+			else if (k == LN)
+				eo = 1;
+			if (zruns[k] != ez * nperiods
+					|| oruns[k] != eo * nperiods)
+				stats_ok = false;
+		}
+
+		// Autocorrelation: -1 per period at every lag but multiples
+		// of the period
+		for(unsigned lag=1; lag<=period; lag++) {
+			int64_t	expected = (lag == period) ? (int64_t)nbits
+						: -(int64_t)nperiods;
+
+			if (capture.autocorr(lag) != expected)
+				stats_ok = false;
+		}
+
+		printf("Statistics: %ld runs, balance %+ld, "
+			"R[1] = %ld, R[%d] = %ld%s\n",
+			(long)nruns, (long)(2*(int64_t)ones - nbits),
+			(long)capture.autocorr(1), period,
+			(long)capture.autocorr(period),
+			(stats_ok) ? "" : "  -- NOT AN M-SEQUENCE");
+		failed = failed || !stats_ok;
+	}
+	// }}}
+
+	if (capfile && !capture.write(capfile)) {
+		fprintf(stderr, "ERR: Could not write %s\n", capfile);
+		failed = true;
+	}
+
+	// Now check the core at arbitrary offsets into its sequence.  Rather
+	// than simulating up to each offset, jump the model there, and load
+	// the core's shift register with the model's next LN+WS-1 bits.
+	for(int k=0; k<16; k++) {
+		uint64_t	offset;
+
+		offset = ((uint64_t)rand() << 32) ^ rand();
+		model.reset(1);
+		model.jump(offset);
+		tb.sreg = model.peek(LN+WS-1);
+
+		// The shift register now holds our first output word
+		model.jump(WS);
+		for(int j=0; j<4; j++) {
+			tb.i_clk = 1;
+			tb.i_ce  = 1;
+			tb.eval();
+			tb.i_clk = 0;
+			tb.eval();
+
+			if (tb.o_word != model.word()) {
+				printf("Mismatch at offset %016lx + %d words\n",
+					(unsigned long)offset, j+1);
+				failed = true;
+			}
+		}
+	}
 	if (!failed)
 		printf("SUCCESS!\n");
 	else
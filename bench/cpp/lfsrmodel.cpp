@@ -0,0 +1,239 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	lfsrmodel.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	The implementation of LFSRMODEL, a word parallel GF(2) model
+//		of the LFSRs in this repository.  See lfsrmodel.h for details.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "lfsrmodel.h"
+
+static	inline	unsigned	parity(uint64_t v) {
+	return __builtin_parityll(v);
+}
+
+// GF2MATRIX
+// {{{
+GF2MATRIX::GF2MATRIX(unsigned n) : m_n(n) {
+	assert(n >= 1 && n <= 64);
+	for(unsigned k=0; k<64; k++)
+		m_row[k] = 0;
+}
+
+void	GF2MATRIX::identity(void) {
+	for(unsigned k=0; k<64; k++)
+		m_row[k] = (k < m_n) ? (1ull << k) : 0;
+}
+
+bool	GF2MATRIX::is_identity(void) const {
+	for(unsigned k=0; k<m_n; k++)
+		if (m_row[k] != (1ull << k))
+			return false;
+	return true;
+}
+
+bool	GF2MATRIX::operator==(const GF2MATRIX &b) const {
+	if (m_n != b.m_n)
+		return false;
+	for(unsigned k=0; k<m_n; k++)
+		if (m_row[k] != b.m_row[k])
+			return false;
+	return true;
+}
+
+uint64_t	GF2MATRIX::apply(uint64_t x) const {
+	uint64_t	y = 0;
+
+	for(unsigned k=0; k<m_n; k++)
+		y |= (uint64_t)parity(m_row[k] & x) << k;
+	return y;
+}
+
+GF2MATRIX	GF2MATRIX::operator*(const GF2MATRIX &b) const {
+	GF2MATRIX	r(m_n);
+
+	assert(m_n == b.m_n);
+
+	// Row i of the product is the sum of those rows of b selected by
+	// the bits of our row i
+	for(unsigned i=0; i<m_n; i++) {
+		uint64_t	a = m_row[i], acc = 0;
+
+		while(a) {
+			unsigned	j = __builtin_ctzll(a);
+
+			acc ^= b.m_row[j];
+			a &= a-1;
+		}
+		r.m_row[i] = acc;
+	}
+
+	return r;
+}
+// }}}
+
+// LFSRMODEL
+// {{{
+LFSRMODEL::LFSRMODEL(unsigned ln, uint64_t taps, bool galois, unsigned ws)
+		: m_ln(ln), m_ws(ws), m_galois(galois), m_step(ln) {
+	uint64_t	rows[64];
+
+	assert(ln >= 2 && ln <= 64);
+	assert(ws >= 1 && ws <= 64);
+
+	m_mask   = (ln >= 64) ? ~0ull : ((1ull << ln)-1);
+	m_taps   = taps & m_mask;
+	m_nbytes = (ln+7)/8;
+	m_state  = 1;
+
+	// The one step transition matrix
+	// {{{
+	for(unsigned i=0; i<ln; i++) {
+		uint64_t	r = 0;
+
+		if (i+1 < ln)
+			r = 1ull << (i+1);	// Shift right
+		if (galois) {
+			// sreg <= (sreg >> 1) ^ (sreg[0] ? TAPS : 0)
+			if ((m_taps >> i) & 1)
+				r |= 1;
+		} else if (i == ln-1)
+			// sreg[LN-1] <= ^(sreg & TAPS)
+			r = m_taps;
+		m_step.m_row[i] = r;
+	}
+	// }}}
+
+	// Powers of two of the step matrix
+	// {{{
+	m_pow[0] = m_step;
+	for(unsigned k=1; k<64; k++)
+		m_pow[k] = m_pow[k-1] * m_pow[k-1];
+	// }}}
+
+	// Output bit k is bit zero of A^k * s, so its row is row zero of A^k
+	// {{{
+	{
+		GF2MATRIX	ak(ln);
+
+		ak.identity();
+		for(unsigned k=0; k<64; k++) {
+			rows[k] = ak.m_row[0];
+			ak = ak * m_step;
+		}
+	}
+	// }}}
+
+	m_out  = new uint64_t[m_nbytes * 256];
+	m_next = new uint64_t[m_nbytes * 256];
+	build_table(m_out, rows, 64);
+	build_table(m_next, power(ws).m_row, ln);
+}
+
+LFSRMODEL::~LFSRMODEL(void) {
+	delete[] m_out;
+	delete[] m_next;
+}
+
+// build_table
+// {{{
+// Tabulate the linear map whose output bit k is parity(rows[k] & s), one
+// byte of s at a time
+void	LFSRMODEL::build_table(uint64_t *tbl, const uint64_t *rows,
+			unsigned nrows) {
+	for(unsigned b=0; b<m_nbytes; b++) {
+		for(unsigned v=0; v<256; v++) {
+			uint64_t	s = (uint64_t)v << (8*b), y = 0;
+
+			for(unsigned k=0; k<nrows; k++)
+				y |= (uint64_t)parity(rows[k] & s) << k;
+			tbl[b*256 + v] = y;
+		}
+	}
+}
+// }}}
+
+static	inline	uint64_t	lookup(const uint64_t *tbl, unsigned nbytes,
+			uint64_t s) {
+	uint64_t	y = 0;
+
+	for(unsigned b=0; b<nbytes; b++, s >>= 8)
+		y ^= tbl[b*256 + (s & 0x0ff)];
+	return y;
+}
+
+unsigned	LFSRMODEL::bit(void) {
+	unsigned	b = m_state & 1;
+
+	m_state = m_step.apply(m_state);
+	return b;
+}
+
+uint64_t	LFSRMODEL::word(void) {
+	uint64_t	w = peek(m_ws);
+
+	m_state = lookup(m_next, m_nbytes, m_state);
+	return w;
+}
+
+uint64_t	LFSRMODEL::peek(unsigned nbits) const {
+	uint64_t	w = lookup(m_out, m_nbytes, m_state);
+
+	assert(nbits <= 64);
+	if (nbits < 64)
+		w &= (1ull << nbits)-1;
+	return w;
+}
+
+void	LFSRMODEL::jump(uint64_t n) {
+	for(unsigned k=0; n != 0; k++, n >>= 1)
+		if (n & 1)
+			m_state = m_pow[k].apply(m_state);
+}
+
+GF2MATRIX	LFSRMODEL::power(uint64_t n) const {
+	GF2MATRIX	r(m_ln);
+
+	r.identity();
+	for(unsigned k=0; n != 0; k++, n >>= 1)
+		if (n & 1)
+			r = r * m_pow[k];
+	return r;
+}
+// }}}
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	lfsrmodel.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A word parallel software model of the LFSRs in this
+//		repository: lfsr.v, lfsr_fib.v, and lfsr_gal.v.
+//
+//	Any LFSR is a linear map over GF(2): one step takes the state s to
+//	A*s, and the output bit is c*s for some row vector c.  The output
+//	bits from time n through n+63 are therefore a linear function of the
+//	state at time n, as is the state at time n+WS.  Both of these functions
+//	are precomputed into byte-wise lookup tables, so that producing WS
+//	output bits takes only one table lookup per byte of state.
+//
+//	Jumping ahead by an arbitrary count n is done by multiplying the state
+//	by A^n.  The matrices A^(2^k) are computed once, so any jump takes at
+//	most 64 matrix-vector products.  This allows the output of a long LFSR
+//	to be checked at any point, without stepping through the whole period.
+//
+//	The state is kept in the register order of the RTL.  For a Fibonacci
+//	LFSR (lfsr.v and lfsr_fib.v), bit k of the state is the k'th next
+//	output bit.  For a Galois LFSR (lfsr_gal.v), the state is sreg.  In
+//	both cases, the output bit is bit zero of the state, and LN may be up
+//	to 64 bits.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	LFSRMODEL_H
+#define	LFSRMODEL_H
+
+#include <stdint.h>
+
+// GF2MATRIX
+// {{{
+// An LN x LN matrix over GF(2), stored by rows.  Bit j of m_row[i] is
+// element (i,j).
+class	GF2MATRIX {
+public:
+	unsigned	m_n;
+	uint64_t	m_row[64];
+
+	GF2MATRIX(unsigned n = 64);
+
+	void		identity(void);
+	bool		is_identity(void) const;
+	bool		operator==(const GF2MATRIX &b) const;
+
+	// Matrix-vector product, y = M * x
+	uint64_t	apply(uint64_t x) const;
+
+	// Matrix product, M * b
+	GF2MATRIX	operator*(const GF2MATRIX &b) const;
+};
+// }}}
+
+class	LFSRMODEL {
+	unsigned	m_ln, m_ws, m_nbytes;
+	uint64_t	m_taps, m_mask, m_state;
+	bool		m_galois;
+
+	GF2MATRIX	m_step;		// A
+	GF2MATRIX	m_pow[64];	// A^(2^k)
+
+	// Byte-wise lookup tables
+	uint64_t	*m_out,		// Next 64 output bits
+			*m_next;	// State WS steps from now
+
+	void		build_table(uint64_t *tbl, const uint64_t *rows,
+				unsigned nrows);
+public:
+	LFSRMODEL(unsigned ln, uint64_t taps, bool galois = false,
+			unsigned ws = 64);
+	~LFSRMODEL(void);
+
+	// The lookup tables make copying expensive, so don't
+	LFSRMODEL(const LFSRMODEL &) = delete;
+	LFSRMODEL &operator=(const LFSRMODEL &) = delete;
+
+	unsigned	LN(void) const	{ return m_ln; }
+	unsigned	WS(void) const	{ return m_ws; }
+	uint64_t	TAPS(void) const { return m_taps; }
+
+	// Set, or read back, the state of the LFSR
+	void		reset(uint64_t fill = 1) { m_state = fill & m_mask; }
+	uint64_t	state(void) const { return m_state; }
+
+	// The next output bit, stepping one clock
+	unsigned	bit(void);
+
+	// The next WS output bits (LSB first), stepping WS clocks
+	uint64_t	word(void);
+
+	// The next nbits (<= 64) of output, without stepping
+	uint64_t	peek(unsigned nbits = 64) const;
+
+	// Step the LFSR forward n clocks
+	void		jump(uint64_t n);
+
+	// The one step transition matrix, A, and A^n
+	const GF2MATRIX &step(void) const { return m_step; }
+	GF2MATRIX	power(uint64_t n) const;
+};
+
+#endif
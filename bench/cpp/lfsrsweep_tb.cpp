@@ -0,0 +1,443 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	lfsrsweep_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	Checks lfsr, lfsr_fib, and lfsr_gal across the table of
+//		maximal length polynomials found in bench/rtl/lfsrsweep.v,
+//	without simulating any of them for a full period.
+//
+//	For each entry, the jump-ahead model (lfsrmodel.cpp) is used to prove
+//	1. that the polynomial is maximal length, since A^(2^LN-1) = I while
+//	   A^((2^LN-1)/p) != I for every prime factor p of 2^LN-1,
+//	2. that the Galois form, with reversed taps, produces the same output
+//	   as the Fibonacci form for any input.  Both are linear, so it's
+//	   enough that they agree for 2*LN outputs from the common fill, which
+//	   is also the state an input bit enters with.
+//	3. how many clocks it takes before the states visited from reset span
+//	   the entire state space.  Since the RTL is linear, matching the model
+//	   over those clocks means matching it from every state.
+//
+//	The RTL is then checked against the model, both from reset, and after
+//	using i_in to load lfsr_fib and lfsr_gal with the state found at a
+//	random 64-bit offset into the sequence.  These trials, and the model
+//	checks above, are spread across all available cores.
+//
+//	Usage:	lfsrsweep_tb [-j threads] [-n trials]
+//
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <verilatedos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "lfsrmodel.h"
+#include "Vlfsrsweep.h"
+
+const	unsigned	MAXCFG = 64,
+			NRESET = 4096,	// Clocks to check from reset
+			NCHECK = 256;	// Clocks to check after each load
+
+static	inline	unsigned	parity(uint64_t v) {
+	return __builtin_parityll(v);
+}
+
+static	inline	uint64_t	lnmask(unsigned ln) {
+	return (ln >= 64) ? ~0ull : ((1ull << ln)-1);
+}
+
+// Our random numbers need to be reproducible, and thread safe
+static	uint64_t	xorshift(uint64_t &s) {
+	s ^= s >> 12;
+	s ^= s << 25;
+	s ^= s >> 27;
+	return s * 0x2545f4914f6cdd1dull;
+}
+
+// bits
+// {{{
+// Extract n <= 64 bits, starting at bit lsb, from a wide Verilator output
+template <class W> static uint64_t bits(const W &w, unsigned lsb, unsigned n) {
+	uint64_t	v = 0;
+
+	for(unsigned k=0; k<n; k++)
+		v |= (uint64_t)((w[(lsb+k)/32] >> ((lsb+k)&31)) & 1) << k;
+	return v;
+}
+// }}}
+
+static	uint64_t	bitrev(uint64_t v, unsigned ln) {
+	uint64_t	r = 0;
+
+	for(unsigned k=0; k<ln; k++)
+		r |= ((v >> (ln-1-k)) & 1ull) << k;
+	return r;
+}
+
+// parallel
+// {{{
+// Run f(job, thread) for every job, using up to nthreads threads
+template <class F> void parallel(unsigned njobs, unsigned nthreads, F f) {
+	std::atomic<unsigned>	next(0);
+	std::vector<std::thread> pool;
+
+	for(unsigned t=0; t<nthreads; t++)
+		pool.push_back(std::thread([&next, njobs, &f, t](void) {
+			unsigned	job;
+
+			while((job = next++) < njobs)
+				f(job, t);
+		}));
+
+	for(auto &th : pool)
+		th.join();
+}
+// }}}
+
+// maximal
+// {{{
+// Returns true if the LFSR described by m has period 2^LN-1
+static	bool	maximal(const LFSRMODEL &m) {
+	uint64_t	period = lnmask(m.LN()), n = period;
+
+	if (!m.power(period).is_identity())
+		return false;
+
+	// Trial division is quick enough for every entry in our table, since
+	// none of them has more than one large prime factor
+	for(uint64_t d = 2; n > 1; d += (d == 2) ? 1 : 2) {
+		if (d > n / d)
+			d = n;	// What remains is prime
+		if (n % d != 0)
+			continue;
+		if (m.power(period / d).is_identity())
+			return false;
+		while(n % d == 0)
+			n /= d;
+	}
+
+	return true;
+}
+// }}}
+
+// span_steps
+// {{{
+// Returns how many of the states s, M*s, M^2*s, ... it takes to span all LN
+// dimensions, or zero if the first limit states never do.
+static	unsigned span_steps(const GF2MATRIX &m, uint64_t s, unsigned limit) {
+	uint64_t	basis[64];
+	unsigned	rank = 0;
+
+	memset(basis, 0, sizeof(basis));
+	for(unsigned k=0; k<limit; k++) {
+		uint64_t	v = s;
+
+		while(v) {
+			unsigned	b = 63 - __builtin_clzll(v);
+
+			if (!basis[b]) {
+				basis[b] = v;
+				rank++;
+				break;
+			} v ^= basis[b];
+		}
+
+		if (rank == m.m_n)
+			return k+1;
+		s = m.apply(s);
+	}
+
+	return 0;
+}
+// }}}
+
+// CFGRESULT
+// {{{
+struct	CFGRESULT {
+	unsigned	m_ln;
+	uint64_t	m_taps;
+	bool		m_fib_max, m_gal_max, m_equiv;
+	unsigned	m_span;		// Clocks until lfsr.v's states span
+	std::atomic<unsigned>	m_fails;
+	std::atomic<uint64_t>	m_checked;
+};
+// }}}
+
+class	SWEEP_TB : public TESTB<Vlfsrsweep> {
+public:
+	unsigned	m_ncfg, m_ws;
+	unsigned	m_ln[MAXCFG];
+	uint64_t	m_taps[MAXCFG], m_fill[MAXCFG];
+
+	// Shadow of each lfsr_fib register, including the effects of i_in
+	uint64_t	m_shadow[MAXCFG];
+
+	SWEEP_TB(void) {
+		m_core->eval();
+		m_ncfg = m_core->o_ncfg;
+		m_ws   = m_core->o_ws;
+		assert(m_ncfg <= MAXCFG);
+		for(unsigned k=0; k<m_ncfg; k++) {
+			m_ln[k]   = (unsigned)bits(m_core->o_ln, 8*k, 8);
+			m_taps[k] = bits(m_core->o_taps, 64*k, 64);
+			m_fill[k] = 1ull << (m_ln[k]-1);
+		}
+	}
+
+	unsigned	fib(unsigned k) { return (m_core->o_fib >> k) & 1; }
+	unsigned	gal(unsigned k) { return (m_core->o_gal >> k) & 1; }
+	uint64_t	word(unsigned k) {
+		return bits(m_core->o_word, m_ws*k, m_ws); }
+
+	void	reset(void) {
+		m_core->i_ce = 1;
+		m_core->i_in = 0;
+		TESTB<Vlfsrsweep>::reset();
+		for(unsigned k=0; k<m_ncfg; k++)
+			m_shadow[k] = m_fill[k];
+	}
+
+	// Step every lfsr_fib shadow register along with the core
+	void	tick(void) {
+		for(unsigned k=0; k<m_ncfg; k++) {
+			unsigned	fb = parity(m_shadow[k] & m_taps[k])
+					^ (unsigned)((m_core->i_in >> k) & 1);
+
+			m_shadow[k] = (m_shadow[k] >> 1)
+					| ((uint64_t)fb << (m_ln[k]-1));
+		}
+		TESTB<Vlfsrsweep>::tick();
+	}
+};
+
+// model_check
+// {{{
+// Everything we can establish about a table entry without the RTL
+static	void	model_check(CFGRESULT &r, unsigned ws) {
+	unsigned	ln = r.m_ln;
+	uint64_t	fill = 1ull << (ln-1);
+	LFSRMODEL	fib(ln, r.m_taps, false, ws),
+			gal(ln, bitrev(r.m_taps, ln), true, ws);
+
+	r.m_fib_max = maximal(fib);
+	r.m_gal_max = maximal(gal);
+
+	fib.reset(fill);
+	gal.reset(fill);
+	r.m_equiv = true;
+	for(unsigned k=0; k<2*ln; k++)
+		if (fib.bit() != gal.bit())
+			r.m_equiv = false;
+
+	r.m_span = span_steps(fib.power(ws), fill, NRESET);
+}
+// }}}
+
+// rtl_trial
+// {{{
+// Trial zero checks the core from reset.  Every other trial also loads each
+// lfsr_fib and lfsr_gal with a state taken from a random place in its
+// sequence, and then checks the outputs following.
+static	void	rtl_trial(SWEEP_TB &tb, CFGRESULT *results, unsigned trial) {
+	const unsigned	ncfg = tb.m_ncfg;
+	unsigned	maxln = 0, nclocks;
+	uint64_t	seed = 0x9e3779b97f4a7c15ull * (trial + 1),
+			target[MAXCFG];
+	bool		failed[MAXCFG];
+	std::vector<LFSRMODEL *> word_model, bit_model;
+
+	for(unsigned k=0; k<ncfg; k++) {
+		word_model.push_back(new LFSRMODEL(tb.m_ln[k], tb.m_taps[k],
+				false, tb.m_ws));
+		bit_model.push_back(new LFSRMODEL(tb.m_ln[k], tb.m_taps[k]));
+		word_model[k]->reset(tb.m_fill[k]);
+		bit_model[k]->reset(tb.m_fill[k]);
+		failed[k] = false;
+		if (tb.m_ln[k] > maxln)
+			maxln = tb.m_ln[k];
+
+		// Where in the sequence should we go?
+		if (trial > 0) {
+			bit_model[k]->jump(xorshift(seed));
+			target[k] = bit_model[k]->state();
+		}
+	}
+
+	nclocks = (trial == 0) ? NRESET : (maxln + NCHECK);
+
+	tb.reset();
+	for(unsigned clk=0; clk <= nclocks; clk++) {
+		// Check this clock's outputs
+		// {{{
+		for(unsigned k=0; k<ncfg; k++) {
+			if (tb.word(k) != word_model[k]->word())
+				failed[k] = true;
+			if (tb.fib(k) != tb.gal(k))
+				failed[k] = true;
+			if (tb.fib(k) != (tb.m_shadow[k] & 1))
+				failed[k] = true;
+			if (trial == 0 || clk >= maxln) {
+				if (tb.fib(k) != bit_model[k]->bit())
+					failed[k] = true;
+			}
+		}
+		// }}}
+
+		// Then set up the inputs for the next
+		// {{{
+		// Each entry is loaded over the LN clocks ending at maxln,
+		// so that they all finish together.  The bit entering the
+		// MSB on load clock c ends up in bit c of the register.
+		uint64_t	in = 0;
+
+		if (trial > 0 && clk < maxln) {
+			for(unsigned k=0; k<ncfg; k++) {
+				unsigned	ln = tb.m_ln[k], c;
+
+				if (clk < maxln - ln)
+					continue;
+				c = clk - (maxln - ln);
+				in |= (uint64_t)(parity(tb.m_shadow[k]
+						& tb.m_taps[k])
+					^ ((target[k] >> c) & 1)) << k;
+			}
+		}
+
+		tb.m_core->i_in = in;
+		// }}}
+
+		if (clk < nclocks)
+			tb.tick();
+
+		if (trial > 0 && clk + 1 == maxln) {
+			for(unsigned k=0; k<ncfg; k++)
+				if (tb.m_shadow[k] != target[k])
+					failed[k] = true;
+		}
+	}
+
+	for(unsigned k=0; k<ncfg; k++) {
+		if (failed[k])
+			results[k].m_fails++;
+		results[k].m_checked += nclocks;
+		delete word_model[k];
+		delete bit_model[k];
+	}
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	unsigned	nthreads = std::thread::hardware_concurrency(),
+			ntrials = 64, ncfg, ws;
+	bool		pass = true;
+	time_t		start = time(NULL);
+
+	for(int k=1; k<argc; k++) {
+		if (strcmp(argv[k], "-j") == 0 && k+1 < argc)
+			nthreads = atoi(argv[++k]);
+		else if (strcmp(argv[k], "-n") == 0 && k+1 < argc)
+			ntrials = atoi(argv[++k]);
+	}
+	if (nthreads < 1)
+		nthreads = 1;
+	if (ntrials < 1)
+		ntrials = 1;
+
+	// One copy of the core per thread.  These are all built up front,
+	// since constructing a Verilated model touches global state.
+	std::vector<SWEEP_TB *>	tbs;
+	for(unsigned t=0; t<nthreads; t++)
+		tbs.push_back(new SWEEP_TB);
+	ncfg = tbs[0]->m_ncfg;
+	ws   = tbs[0]->m_ws;
+
+	CFGRESULT	results[MAXCFG];
+	for(unsigned k=0; k<ncfg; k++) {
+		results[k].m_ln   = tbs[0]->m_ln[k];
+		results[k].m_taps = tbs[0]->m_taps[k];
+		results[k].m_fails = 0;
+		results[k].m_checked = 0;
+	}
+
+	parallel(ncfg, nthreads, [&](unsigned job, unsigned) {
+		model_check(results[job], ws); });
+
+	parallel(ntrials, nthreads, [&](unsigned job, unsigned t) {
+		rtl_trial(*tbs[t], results, job); });
+
+	for(unsigned k=0; k<ncfg; k++) {
+		CFGRESULT	&r = results[k];
+		bool		ok;
+
+		// The reset check only proves lfsr.v for every state if
+		// the states it passed through span the state space, and it
+		// ran long enough to see each of them in the output
+		ok = r.m_fib_max && r.m_gal_max && r.m_equiv
+			&& r.m_span > 0
+			&& r.m_span + (r.m_ln + ws - 1)/ws <= NRESET
+			&& r.m_fails == 0;
+
+		printf("LN = %2d, TAPS = 0x%016lx: %s%s%s, spans in %3d clocks,"
+			" %8ld clocks checked%s\n",
+			r.m_ln, (unsigned long)r.m_taps,
+			(r.m_fib_max && r.m_gal_max) ? "maximal" : "NOT MAXIMAL",
+			(r.m_equiv) ? "" : ", FIB != GAL",
+			(r.m_fails) ? ", RTL MISMATCH" : "",
+			r.m_span, (unsigned long)r.m_checked,
+			(ok) ? "" : "  -- FAILED");
+
+		pass = pass && ok;
+	}
+
+	printf("%d configurations, %d trials, on %d threads, in %ld seconds\n",
+		ncfg, ntrials, nthreads, (long)(time(NULL) - start));
+
+	for(unsigned t=0; t<nthreads; t++)
+		delete tbs[t];
+
+	if (!pass)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,324 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	parfil_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test parfil, the filter with a parameterizable number of
+//		multiplies, across several choices of that number, P.  Each
+//	variant is given the same tests slowfil is given: impulse tests of
+//	every coefficient, an overflow check, block tests, and two low-pass
+//	filters.  Once done, the multiplies and memory used by each variant
+//	are reported next to the number of clocks it needs per sample.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <signal.h>
+#include <time.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vparfil.h"
+#include "Vparfil_p1.h"
+#include "Vparfil_p2.h"
+#include "Vparfil_p8.h"
+#include "Vparfil_p16.h"
+#include "Vparfil_p55.h"
+#include "testb.h"
+
+// #define	FILTER_HAS_O_CE
+#include "filtertb.h"
+#include "filtertb.cpp"
+#include "twelvebfltr.h"
+
+const	unsigned IW = 16,
+		TW = 16,
+		OW = IW+TW+7,
+		NTAPS = 110;
+
+static	int     nextlg(int vl) {
+	int     r;
+
+	for(r=1; r<vl; r<<=1)
+		;
+	return r;
+}
+
+static	int	clog2(int vl) {
+	int	r;
+
+	for(r=0; (1<<r)<vl; r++)
+		;
+	return r;
+}
+
+template <class VA> class	PARFIL_TB : public FILTERTB<VA> {
+public:
+	// The number of multiplies, and the number of taps each one handles
+	const	int	m_nmpy, m_nb;
+
+	// PARFIL_TB
+	// {{{
+	PARFIL_TB(int nmpy) : m_nmpy(nmpy), m_nb((NTAPS+nmpy-1)/nmpy) {
+		FILTERTB<VA>::IW(::IW);
+		FILTERTB<VA>::TW(::TW);
+		FILTERTB<VA>::OW(::OW);
+		FILTERTB<VA>::NTAPS(::NTAPS);
+		// Each lane needs NB clocks to work through its taps.  The
+		// result then needs two more clocks, plus one per level of the
+		// adder tree, to work its way to the output.
+		FILTERTB<VA>::DELAY(1+(clog2(m_nmpy)+2+m_nb-1)/m_nb);
+		FILTERTB<VA>::CKPCE(m_nb);
+	}
+	// }}}
+
+	// Resource usage
+	// {{{
+	int	multiplies(void) const { return m_nmpy; }
+	int	memwords(void) const { return 2*m_nmpy*nextlg(m_nb); }
+	// }}}
+
+	void	test(int nlen, int64_t *data) {
+		clear_filter();
+		FILTERTB<VA>::test(nlen, data);
+	}
+
+	void	load(int nlen, int64_t *data) {
+		FILTERTB<VA>::reset();
+		FILTERTB<VA>::load(nlen, data);
+	}
+
+	// clear_filter
+	// {{{
+	void	clear_filter(void) {
+		VA	*core = TESTB<VA>::m_core;
+
+		core->i_tap_wr = 0;
+
+		// Every lane's memory needs to be filled with zeros.  Samples
+		// only move from one lane to the next on an i_ce, so this
+		// takes more than a memory's worth of i_ce's per lane.  As
+		// with slowfil, the reset isn't sufficient.
+		core->i_ce     = 1;
+		core->i_sample = 0;
+		for(int k=0; k<m_nmpy * (nextlg(m_nb)+2); k++)
+			FILTERTB<VA>::tick();
+
+		core->i_ce = 0;
+		for(int k=0; k<m_nb + clog2(m_nmpy) + 2; k++)
+			FILTERTB<VA>::tick();
+	}
+	// }}}
+};
+
+// runtests
+// {{{
+template <class VA> void	runtests(PARFIL_TB<VA> *tb) {
+	const int64_t	TAPVALUE = -(1<<(TW-1));
+	const int64_t	IMPULSE  =  (1<<(IW-1))-1;
+
+	int64_t	tapvec[NTAPS];
+	int64_t	ivec[2*NTAPS];
+
+	// tb->opentrace("trace.vcd");
+	tb->reset();
+
+	printf("P = %2d: Impulse tests\n", tb->multiplies());
+	for(unsigned k=0; k<NTAPS; k++) {
+		//
+		// Create a new coefficient vector
+		//
+		// Initialize it with all zeros
+		for(unsigned i=0; i<NTAPS; i++)
+			tapvec[i] = 0;
+		// Then set one value to non-zero
+		tapvec[k] = TAPVALUE;
+
+		// Test whether or not this coefficient vector
+		// loads properly into the filter
+		tb->testload(NTAPS, tapvec);
+
+		// Then test whether or not the filter overflows
+		assert(tb->test_overflow());
+	}
+
+	//
+	// Block filter, impulse input
+	// {{{
+	printf("P = %2d: Block Fil, Impulse input\n", tb->multiplies());
+	for(unsigned i=0; i<NTAPS; i++)
+		tapvec[i] = TAPVALUE;
+
+	tb->testload(NTAPS, tapvec);
+
+	for(unsigned i=0; i<2*NTAPS; i++)
+		ivec[i] = 0;
+	ivec[0] = IMPULSE;
+
+	tb->test(2*NTAPS, ivec);
+
+	for(unsigned i=0; i<NTAPS; i++)
+		assert(ivec[i] == IMPULSE * TAPVALUE);
+	for(unsigned i=NTAPS; i<2*NTAPS; i++)
+		assert(0 == ivec[i]);
+	// }}}
+
+	//
+	// Block filter, block input
+	// {{{
+	printf("P = %2d: Block Fil, block input\n", tb->multiplies());
+	for(unsigned i=0; i<2*NTAPS; i++)
+		ivec[i] = IMPULSE;
+
+	// Now apply this vector to the filter
+	tb->test(2*NTAPS, ivec);
+
+	for(unsigned i=0; i<2*NTAPS; i++) {
+		int64_t	expected = ((i < NTAPS) ? i+1 : NTAPS)
+						* IMPULSE * TAPVALUE;
+		if (ivec[i] != expected) {
+			printf("OUT[%3d] = %12ld != %12ld\n",
+				i, ivec[i], expected);
+			assert(ivec[i] == expected);
+		}
+	}
+
+	assert(tb->test_overflow());
+
+	{
+		double fp,      // Passband frequency cutoff
+			fs,     // Stopband frequency cutoff,
+			depth,  // Depth of the stopband
+			ripple; // Maximum deviation within the passband
+
+		tb->measure_lowpass(fp, fs, depth, ripple);
+		printf("FP     = %f\n", fp);
+		printf("FS     = %f\n", fs);
+		printf("DEPTH  = %6.2f dB\n", depth);
+		printf("RIPPLE = %.2g\n", ripple);
+
+		// The depth of the filter should be between -14 and -13.
+		assert(depth < -13);
+		assert(depth > -14);
+	}
+	// }}}
+
+	//
+	// Low-pass filter
+	// {{{
+	assert(NCOEFFS < (int)NTAPS);
+	for(int i=0; i<NCOEFFS; i++)
+		tapvec[i] = icoeffs[i];
+
+	// Zero any taps beyond the filter's length
+	for(int i=NCOEFFS; i<(int)NTAPS; i++)
+		tapvec[i] = 0;
+
+	printf("P = %2d: Low-pass filter test\n", tb->multiplies());
+	tb->testload(NTAPS, tapvec);
+
+	{
+		double fp,      // Passband frequency cutoff
+			fs,     // Stopband frequency cutoff,
+			depth,  // Depth of the stopband
+			ripple; // Maximum deviation within the passband
+
+		tb->measure_lowpass(fp, fs, depth, ripple);
+		printf("FP     = %f\n", fp);
+		printf("FS     = %f\n", fs);
+		printf("DEPTH  = %6.2f dB\n", depth);
+		printf("RIPPLE = %.2g\n", ripple);
+
+		// The depth of this stopband should be between -55 and -54 dB
+		assert(depth < -54);
+		assert(depth > -55);
+	}
+	// }}}
+
+	printf("\n");
+}
+// }}}
+
+// report
+// {{{
+template <class VA> void	report(PARFIL_TB<VA> *tb) {
+	printf("%3d  %5d  %9d  %5d  %8.4f\n",
+		tb->multiplies(), tb->m_nb, tb->memwords(), tb->CKPCE(),
+		1.0 / tb->CKPCE());
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+
+	PARFIL_TB<Vparfil_p1>	*tb1  = new PARFIL_TB<Vparfil_p1>(1);
+	PARFIL_TB<Vparfil_p2>	*tb2  = new PARFIL_TB<Vparfil_p2>(2);
+	PARFIL_TB<Vparfil>	*tb4  = new PARFIL_TB<Vparfil>(4);
+	PARFIL_TB<Vparfil_p8>	*tb8  = new PARFIL_TB<Vparfil_p8>(8);
+	PARFIL_TB<Vparfil_p16>	*tb16 = new PARFIL_TB<Vparfil_p16>(16);
+	PARFIL_TB<Vparfil_p55>	*tb55 = new PARFIL_TB<Vparfil_p55>(55);
+
+	runtests(tb1);
+	runtests(tb2);
+	runtests(tb4);
+	runtests(tb8);
+	runtests(tb16);
+	runtests(tb55);
+
+	// The cost of each choice of P.  P = 1 matches slowfil, in both
+	// multiplies and memory.
+	printf("NTAPS = %d\n", NTAPS);
+	printf("MPY  TAPS/  MEM-WORDS  CLKS/  SAMPLES/\n");
+	printf("     LANE              SMPL   CLK\n");
+	report(tb1);
+	report(tb2);
+	report(tb4);
+	report(tb8);
+	report(tb16);
+	report(tb55);
+
+	delete	tb1;
+	delete	tb2;
+	delete	tb4;
+	delete	tb8;
+	delete	tb16;
+	delete	tb55;
+
+	printf("SUCCESS\n");
+	exit(0);
+}
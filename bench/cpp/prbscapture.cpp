@@ -0,0 +1,251 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	prbscapture.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	The implementation of PRBSCAPTURE.  See prbscapture.h for
+//		details.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "prbscapture.h"
+
+PRBSCAPTURE::PRBSCAPTURE(unsigned ln, uint64_t taps, unsigned ws)
+		: m_ln(ln), m_ws(ws), m_taps(taps) {
+	assert(ws >= 1 && ws <= 64);
+	m_nalloc = 1024;
+	m_data   = (uint64_t *)malloc(m_nalloc * sizeof(uint64_t));
+	m_nbits  = 0;
+}
+
+PRBSCAPTURE::~PRBSCAPTURE(void) {
+	free(m_data);
+}
+
+// append
+// {{{
+void	PRBSCAPTURE::append(uint64_t word, unsigned nbits) {
+	unsigned	sh = m_nbits & 63;
+	uint64_t	idx = m_nbits >> 6;
+
+	assert(nbits >= 1 && nbits <= 64);
+	if (nbits < 64)
+		word &= (1ull << nbits)-1;
+
+	if (idx + 2 > m_nalloc) {
+		m_nalloc *= 2;
+		m_data = (uint64_t *)realloc(m_data,
+				m_nalloc * sizeof(uint64_t));
+		assert(m_data);
+	}
+
+	if (sh == 0)
+		m_data[idx] = word;
+	else {
+		m_data[idx] |= word << sh;
+		if (sh + nbits > 64)
+			m_data[idx+1] = word >> (64-sh);
+	}
+	m_nbits += nbits;
+}
+// }}}
+
+// write
+// {{{
+bool	PRBSCAPTURE::write(const char *fname) const {
+	PRBSHEADER	hdr;
+	FILE		*fp;
+	size_t		nw = (m_nbits + 63) / 64;
+	bool		ok;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.m_magic, "PRBS", 4);
+	hdr.m_version = 1;
+	hdr.m_ln   = m_ln;
+	hdr.m_ws   = m_ws;
+	hdr.m_taps = m_taps;
+	hdr.m_nbits= m_nbits;
+
+	fp = fopen(fname, "wb");
+	if (!fp)
+		return false;
+	ok = (fwrite(&hdr, sizeof(hdr), 1, fp) == 1);
+	ok = ok && (fwrite(m_data, sizeof(uint64_t), nw, fp) == nw);
+	ok = (fclose(fp) == 0) && ok;
+
+	return ok;
+}
+// }}}
+
+// get, cget
+// {{{
+uint64_t	PRBSCAPTURE::get(uint64_t pos, unsigned n) const {
+	unsigned	sh = pos & 63;
+	uint64_t	idx = pos >> 6, v;
+
+	assert(n >= 1 && n <= 64 && pos + n <= m_nbits);
+
+	v = m_data[idx] >> sh;
+	if (sh != 0 && sh + n > 64)
+		v |= m_data[idx+1] << (64-sh);
+	if (n < 64)
+		v &= (1ull << n)-1;
+	return v;
+}
+
+uint64_t	PRBSCAPTURE::cget(uint64_t pos, unsigned n) const {
+	uint64_t	first;
+
+	pos %= m_nbits;
+	if (pos + n <= m_nbits)
+		return get(pos, n);
+
+	// Wrap around the end of the capture
+	first = m_nbits - pos;
+	assert(n - first <= m_nbits);
+	return get(pos, first) | (get(0, n - first) << first);
+}
+// }}}
+
+// ones
+// {{{
+uint64_t	PRBSCAPTURE::ones(void) const {
+	uint64_t	total = 0;
+
+	for(uint64_t p=0; p<m_nbits; p+=64) {
+		unsigned	n = (m_nbits - p < 64) ? m_nbits - p : 64;
+
+		total += __builtin_popcountll(get(p, n));
+	}
+
+	return total;
+}
+// }}}
+
+// runs
+// {{{
+// A run ends at bit n wherever x[n] != x[n+1].  We find those transitions a
+// word at a time, and then step from one to the next using ctz.
+uint64_t	PRBSCAPTURE::runs(uint64_t *zeros, uint64_t *ones,
+			unsigned maxlen, bool circular) const {
+	uint64_t	nruns = 0, last_end = 0, first_end = 0;
+	bool		any = false;
+	uint64_t	ntrans = (circular) ? m_nbits : m_nbits - 1;
+
+	for(unsigned k=0; k<=maxlen; k++)
+		zeros[k] = ones[k] = 0;
+	if (m_nbits == 0)
+		return 0;
+
+	for(uint64_t p=0; p<ntrans; p+=64) {
+		unsigned	n = (ntrans - p < 64) ? ntrans - p : 64;
+		uint64_t	d = get(p, n) ^ cget(p+1, n);
+
+		while(d) {
+			uint64_t	end = p + __builtin_ctzll(d);
+
+			d &= d-1;
+			if (!any) {
+				// The first run's length isn't known when
+				// circular, since it may have started at the
+				// end of the capture
+				any = true;
+				first_end = end;
+				if (!circular) {
+					uint64_t len = end + 1;
+					uint64_t *h = (get(end,1)) ? ones:zeros;
+					h[(len > maxlen) ? maxlen : len]++;
+					nruns++;
+				}
+			} else {
+				uint64_t len = end - last_end;
+				uint64_t *h = (get(end,1)) ? ones:zeros;
+
+				h[(len > maxlen) ? maxlen : len]++;
+				nruns++;
+			}
+			last_end = end;
+		}
+	}
+
+	// The final run
+	{
+		uint64_t	len;
+		// When circular, this run wraps around to end at first_end
+		uint64_t	*h = (get((any && circular) ? first_end
+					: m_nbits-1, 1)) ? ones : zeros;
+
+		if (!any)
+			len = m_nbits;
+		else if (circular)
+			len = (m_nbits - 1 - last_end) + first_end + 1;
+		else
+			len = m_nbits - 1 - last_end;
+
+		if (len > 0) {
+			h[(len > maxlen) ? maxlen : len]++;
+			nruns++;
+		}
+	}
+
+	return nruns;
+}
+// }}}
+
+// autocorr
+// {{{
+int64_t	PRBSCAPTURE::autocorr(uint64_t lag, bool circular) const {
+	uint64_t	nbits = m_nbits, diff = 0;
+
+	if (!circular) {
+		if (lag >= m_nbits)
+			return 0;
+		nbits = m_nbits - lag;
+	}
+
+	for(uint64_t p=0; p<nbits; p+=64) {
+		unsigned	n = (nbits - p < 64) ? nbits - p : 64;
+		uint64_t	a = get(p, n),
+				b = (circular) ? cget(p+lag, n) : get(p+lag, n);
+
+		diff += __builtin_popcountll(a ^ b);
+	}
+
+	return (int64_t)nbits - 2 * (int64_t)diff;
+}
+// }}}
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	prbscapture.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To capture the output of a PRBS generator, such as lfsr.v,
+//		into a packed array of 64-bit words, and to measure the
+//	statistics of that capture in place.  The capture can also be written
+//	to a binary file for later analysis.
+//
+//	Bit zero of word zero is the first bit captured.  The file starts with
+//	a fixed header (PRBSHEADER, below), recording the generator's LN, TAPS
+//	and WS, followed by the packed words in native (little-endian) order.
+//
+//	The statistics--balance, run lengths, and autocorrelation--all work on
+//	whole words at a time, using popcount and count-trailing-zeros, rather
+//	than bit by bit.  Any of them can be computed either over the capture
+//	as is, or circularly.  If the capture holds a whole number of periods,
+//	the circular statistics are those of the periodic sequence.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	PRBSCAPTURE_H
+#define	PRBSCAPTURE_H
+
+#include <stdint.h>
+
+// PRBSHEADER
+// {{{
+typedef	struct	{
+	char		m_magic[4];	// "PRBS"
+	uint32_t	m_version;	// 1
+	uint32_t	m_ln, m_ws;
+	uint64_t	m_taps;
+	uint64_t	m_nbits;	// Number of valid bits that follow
+} PRBSHEADER;
+// }}}
+
+class	PRBSCAPTURE {
+	unsigned	m_ln, m_ws;
+	uint64_t	m_taps;
+	uint64_t	*m_data, m_nbits, m_nalloc;
+
+	// Bits [pos, pos+n) of the capture, n <= 64
+	uint64_t	get(uint64_t pos, unsigned n) const;
+	// As above, but wrapping around the end of the capture
+	uint64_t	cget(uint64_t pos, unsigned n) const;
+public:
+	PRBSCAPTURE(unsigned ln, uint64_t taps, unsigned ws);
+	~PRBSCAPTURE(void);
+
+	PRBSCAPTURE(const PRBSCAPTURE &) = delete;
+	PRBSCAPTURE &operator=(const PRBSCAPTURE &) = delete;
+
+	void		clear(void) { m_nbits = 0; }
+	uint64_t	size(void) const { return m_nbits; }
+	const uint64_t	*data(void) const { return m_data; }
+
+	// Append the nbits (<= 64) LSBs of word.  Use nbits = WS to capture
+	// one output word of the generator.
+	void		append(uint64_t word, unsigned nbits);
+	void		append(uint64_t word) { append(word, m_ws); }
+
+	// Write the header and capture to a file.  Returns false on error.
+	bool		write(const char *fname) const;
+
+	// Statistics
+	// {{{
+	// The number of ones in the capture
+	uint64_t	ones(void) const;
+
+	// Histograms of the lengths of the runs of zeros and ones.  Element
+	// [k] of each counts runs of length k.  Runs longer than maxlen are
+	// counted in [maxlen].  Returns the total number of runs.
+	uint64_t	runs(uint64_t *zeros, uint64_t *ones, unsigned maxlen,
+				bool circular = true) const;
+
+	// The sum of (-1)^(x[n] ^ x[n+lag])
+	int64_t		autocorr(uint64_t lag, bool circular = true) const;
+	// }}}
+};
+
+#endif
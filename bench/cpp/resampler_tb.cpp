@@ -0,0 +1,291 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	resampler_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test the rational resampler, resampler.v, when upsampling
+//		by 5/4 and by 160/147, and when downsampling by 3/7.  Every
+//	output is checked, bit for bit, against a polyphase software model
+//	(resampmodel.cpp), both with random gaps on the input and random
+//	backpressure on the output and in a long run of over a million input
+//	samples.  At the end of each run the number of outputs must match
+//	floor((N*NUP-1)/NDOWN)+1 exactly, for N inputs, so that any drift
+//	in the core's phase tracking will be caught.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <verilatedos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "resampmodel.h"
+#include "Vresampler.h"
+#include "Vresampler_160_147.h"
+#include "Vresampler_3_7.h"
+
+// Outputs the model has produced, which the core hasn't yet
+const	int	NPENDING = 64;
+
+template <class VA> class RESAMPLER_TB : public TESTB<VA> {
+	int		m_iw, m_tw, m_ow, m_ncoeffs, m_nup, m_ndown, m_lggain;
+	RESAMPMODEL	*m_model;
+	int64_t		m_pending[NPENDING];
+	unsigned	m_head, m_tail;
+public:
+	// Statistics from the last run
+	uint64_t	m_clocks, m_ninputs, m_noutputs;
+
+	RESAMPLER_TB(void) {
+		// Get the parameters of the core we are testing
+		TESTB<VA>::m_core->eval();
+		m_iw      = TESTB<VA>::m_core->o_IW;
+		m_tw      = TESTB<VA>::m_core->o_TW;
+		m_ow      = TESTB<VA>::m_core->o_OW;
+		m_ncoeffs = TESTB<VA>::m_core->o_NCOEFFS;
+		m_nup     = TESTB<VA>::m_core->o_NUP;
+		m_ndown   = TESTB<VA>::m_core->o_NDOWN;
+		m_lggain  = TESTB<VA>::m_core->o_LGGAIN;
+
+		m_model = new RESAMPMODEL(m_nup, m_ndown, m_ncoeffs,
+				m_iw, m_tw, m_ow, m_lggain);
+		m_head = m_tail = 0;
+		m_clocks = m_ninputs = m_noutputs = 0;
+
+		TESTB<VA>::m_core->i_tap_wr     = 0;
+		TESTB<VA>::m_core->S_AXI_TVALID = 0;
+		TESTB<VA>::m_core->M_AXI_TREADY = 0;
+	}
+
+	~RESAMPLER_TB(void) {
+		delete m_model;
+	}
+
+	int	NUP(void) const { return m_nup; }
+	int	NDOWN(void) const { return m_ndown; }
+	int	NBRANCH(void) const { return m_model->NBRANCH(); }
+
+	// load
+	// {{{
+	// Reset the core, and load random coefficients into it and our model.
+	// The core's data memory isn't reset, so this should only be called
+	// once per core.
+	void	load(void) {
+		int64_t	*coeffs = new int64_t[m_ncoeffs];
+
+		TESTB<VA>::reset();
+		for(int k=0; k<m_ncoeffs; k++) {
+			coeffs[k] = rand() & ((1<<m_tw)-1);
+			TESTB<VA>::m_core->i_tap_wr = 1;
+			TESTB<VA>::m_core->i_tap    = (int)coeffs[k];
+			TESTB<VA>::tick();
+		}
+		TESTB<VA>::m_core->i_tap_wr = 0;
+
+		m_model->load(coeffs);
+		m_model->reset();
+		m_head = m_tail = 0;
+		delete[] coeffs;
+	}
+	// }}}
+
+	// run
+	// {{{
+	// Push nin random samples through the core, offering a new one with
+	// probability pvalid (in percent) every clock, and accepting outputs
+	// with probability pready.  Returns true on success.
+	bool	run(const char *name, uint64_t nin, int pvalid, int pready) {
+		VA		*core = TESTB<VA>::m_core;
+		int64_t		out[NPENDING];
+		uint64_t	expected;
+		bool		failed = false;
+		int		idle, stuck = 0;
+
+		load();
+		m_clocks = m_ninputs = m_noutputs = 0;
+
+		for(idle=0; idle < 4 * NBRANCH() + 16 && !failed; ) {
+			bool	ihandshake, ohandshake;
+
+			if (m_ninputs < nin) {
+				if (!core->S_AXI_TVALID
+						&& (rand() % 100) < pvalid) {
+					core->S_AXI_TVALID = 1;
+					core->S_AXI_TDATA  = rand()
+							& ((1<<m_iw)-1);
+				}
+				core->M_AXI_TREADY = ((rand() % 100) < pready);
+			} else {
+				// Drain the core
+				core->S_AXI_TVALID = 0;
+				core->M_AXI_TREADY = 1;
+			}
+
+			ihandshake = core->S_AXI_TVALID && core->S_AXI_TREADY;
+			ohandshake = core->M_AXI_TVALID && core->M_AXI_TREADY;
+
+			if (ohandshake) {
+				int64_t	v = core->M_AXI_TDATA;
+
+				v <<= (64-m_ow);
+				v >>= (64-m_ow);
+				if (m_head == m_tail) {
+					if (!failed)
+						printf("%s: Unexpected output "
+							"#%ld = %ld\n",
+							name, m_noutputs, v);
+					failed = true;
+				} else if (v != m_pending[m_tail]) {
+					if (!failed)
+						printf("%s: Output #%ld = %ld, "
+							"when it should be %ld\n",
+							name, m_noutputs, v,
+							m_pending[m_tail]);
+					failed = true;
+				}
+
+				if (m_head != m_tail)
+					m_tail = (m_tail + 1) % NPENDING;
+				m_noutputs++;
+			}
+
+			TESTB<VA>::tick();
+			m_clocks++;
+
+			if (ihandshake) {
+				int	nout = m_model->apply(
+						core->S_AXI_TDATA, out);
+
+				for(int k=0; k<nout; k++) {
+					m_pending[m_head] = out[k];
+					m_head = (m_head + 1) % NPENDING;
+					assert(m_head != m_tail);
+				}
+
+				core->S_AXI_TVALID = 0;
+				m_ninputs++;
+			}
+
+			if (m_ninputs >= nin && !ohandshake)
+				idle++;
+			else
+				idle = 0;
+
+			// Make sure the core hasn't locked up
+			if (ihandshake || ohandshake)
+				stuck = 0;
+			else if (++stuck > 1000 + 100 * NBRANCH()) {
+				printf("%s: No handshakes for %d clocks\n",
+					name, stuck);
+				failed = true;
+			}
+		}
+
+		expected = m_model->noutputs(nin);
+		if (m_noutputs != expected || m_head != m_tail) {
+			printf("%s: %ld outputs from %ld inputs, "
+				"when %ld were expected\n",
+				name, m_noutputs, m_ninputs, expected);
+			failed = true;
+		}
+
+		printf("%-16s %8ld in, %8ld out, %7.4f in/clk, "
+			"%5.2f clks/out (%d branches), %ld saturated%s\n",
+			name, m_ninputs, m_noutputs,
+			m_ninputs / (double)m_clocks,
+			m_clocks / (double)m_noutputs, NBRANCH(),
+			m_model->nsaturated(),
+			(failed) ? "  -- FAILED" : "");
+
+		return !failed;
+	}
+	// }}}
+};
+
+// testrate
+// {{{
+// The data memory isn't reset, so each run gets its own core
+template <class VA> bool testrate(const char *name) {
+	const	uint64_t	NLONG = (1<<20) + 13;
+	bool		pass = true;
+	char		label[64];
+
+	{
+		RESAMPLER_TB<VA>	tb;
+
+		sprintf(label, "%s,Random", name);
+		pass = tb.run(label, 50000, 50, 30) && pass;
+	}
+
+	{
+		RESAMPLER_TB<VA>	tb;
+
+		sprintf(label, "%s,Stalls", name);
+		pass = tb.run(label, 50000, 100, 95) && pass;
+	}
+
+	{
+		RESAMPLER_TB<VA>	tb;
+
+		// At full rate, each output should take NBRANCH clocks
+		sprintf(label, "%s,Long", name);
+		if (!tb.run(label, NLONG, 100, 100))
+			pass = false;
+		else if (tb.m_clocks > (tb.m_noutputs + 2) * tb.NBRANCH()
+					+ 4 * tb.NBRANCH() + 16) {
+			printf("%s: Throughput too low\n", label);
+			pass = false;
+		}
+	}
+
+	return pass;
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	bool	pass = true;
+
+	pass = testrate<Vresampler>("5/4") && pass;
+	pass = testrate<Vresampler_160_147>("160/147") && pass;
+	pass = testrate<Vresampler_3_7>("3/7") && pass;
+
+	if (!pass)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
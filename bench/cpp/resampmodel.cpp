@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	resampmodel.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A bit exact software model of the rational resampler,
+//		resampler.v.  Unlike the core, which keeps track of its phase
+//	and of the number of samples each output needs, this model is written
+//	directly from the polyphase filtering equation,
+//
+//		y[m] = SUM_{j=0}^{B-1} h[jL+p]x[n-j]
+//
+//	where n = floor(mD/L) and p = mD - nL.  Samples are pushed into the
+//	model one at a time, and any outputs that become computable are
+//	returned.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "resampmodel.h"
+
+// sbits
+// {{{
+static int64_t	sbits(int64_t val, int b) {
+	val <<= (64-b);
+	val >>= (64-b);
+	return val;
+}
+// }}}
+
+RESAMPMODEL::RESAMPMODEL(int nup, int ndown, int ncoeffs,
+		int iw, int tw, int ow, int lggain)
+		: m_nup(nup), m_ndown(ndown), m_ncoeffs(ncoeffs),
+		m_iw(iw), m_tw(tw), m_ow(ow), m_lggain(lggain) {
+	int	lgnb;
+
+	assert(nup >= 1 && ndown >= 1);
+	m_nbranch = (m_ncoeffs + m_nup - 1) / m_nup;
+
+	// The accumulator width used by the core
+	for(lgnb=0; (1<<lgnb) < m_nbranch; lgnb++)
+		;
+	m_aw = m_iw + m_tw + lgnb;
+	assert(m_aw - m_ow - m_lggain >= 1);
+
+	m_coef = new int64_t[m_nbranch * m_nup];
+	m_hist = new int64_t[m_nbranch];
+
+	for(int k=0; k<m_nbranch * m_nup; k++)
+		m_coef[k] = 0;
+
+	reset();
+}
+
+RESAMPMODEL::~RESAMPMODEL(void) {
+	delete[] m_coef;
+	delete[] m_hist;
+}
+
+uint64_t RESAMPMODEL::noutputs(uint64_t ninputs) const {
+	// Output m needs x[floor(mD/L)], so N inputs support every output
+	// with mD/L < N
+	if (ninputs == 0)
+		return 0;
+	return (ninputs * m_nup - 1) / m_ndown + 1;
+}
+
+void	RESAMPMODEL::load(const int64_t *coeffs) {
+	for(int k=0; k<m_ncoeffs; k++)
+		m_coef[k] = sbits(coeffs[k], m_tw);
+}
+
+void	RESAMPMODEL::reset(void) {
+	for(int k=0; k<m_nbranch; k++)
+		m_hist[k] = 0;
+	m_ninputs = m_noutputs = m_nsat = 0;
+}
+
+// round
+// {{{
+// Shift left by LGGAIN, then round (half up) and saturate to OW bits.  This
+// is the same as dropping AW-OW-LGGAIN bits from the full accumulator.
+int64_t	RESAMPMODEL::round(int64_t acc) {
+	int	drop = m_aw - m_ow - m_lggain;
+	int64_t	v, maxv = (1l << (m_ow-1)) - 1, minv = -maxv - 1;
+
+	v = (acc + (1l << (drop-1))) >> drop;
+	if (v > maxv) {
+		m_nsat++;
+		v = maxv;
+	} else if (v < minv) {
+		m_nsat++;
+		v = minv;
+	}
+
+	return v;
+}
+// }}}
+
+int	RESAMPMODEL::apply(int64_t x, int64_t *out) {
+	uint64_t	n = m_ninputs++;
+	int		nout = 0;
+
+	m_hist[n % m_nbranch] = sbits(x, m_iw);
+
+	// Produce every output, m, with floor(mD/L) == n
+	while((m_noutputs * m_ndown) / m_nup <= n) {
+		uint64_t	t = m_noutputs * m_ndown;
+		int		p = (int)(t - (t / m_nup) * m_nup);
+		int64_t		acc = 0;
+
+		assert(t / m_nup == n);
+		for(int j=0; j<m_nbranch && (uint64_t)j <= n; j++)
+			acc += m_coef[j*m_nup + p]
+				* m_hist[(n - j) % m_nbranch];
+
+		out[nout++] = round(acc);
+		m_noutputs++;
+	}
+
+	assert(nout <= maxout());
+	return nout;
+}
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	resampmodel.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A bit exact software model of the rational resampler,
+//		resampler.v.  Unlike the core, which keeps track of its phase
+//	and of the number of samples each output needs, this model is written
+//	directly from the polyphase filtering equation,
+//
+//		y[m] = SUM_{j=0}^{B-1} h[jL+p]x[n-j]
+//
+//	where n = floor(mD/L) and p = mD - nL.  Samples are pushed into the
+//	model one at a time, and any outputs that become computable are
+//	returned.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	RESAMPMODEL_H
+#define	RESAMPMODEL_H
+
+#include <stdint.h>
+
+class	RESAMPMODEL {
+	int		m_nup, m_ndown, m_ncoeffs, m_nbranch,
+			m_iw, m_tw, m_ow, m_lggain, m_aw;
+	int64_t		*m_coef, *m_hist;
+	uint64_t	m_ninputs, m_noutputs, m_nsat;
+
+	int64_t	round(int64_t acc);
+public:
+	RESAMPMODEL(int nup, int ndown, int ncoeffs,
+			int iw, int tw, int ow, int lggain);
+	~RESAMPMODEL(void);
+
+	int	NBRANCH(void) const { return m_nbranch; }
+
+	// The most outputs a single input sample can produce
+	int	maxout(void) const { return (m_nup + m_ndown - 1)/m_ndown; }
+
+	// The number of outputs that should follow ninputs samples
+	uint64_t	noutputs(uint64_t ninputs) const;
+
+	// How many of the outputs so far have been saturated
+	uint64_t	nsaturated(void) const { return m_nsat; }
+
+	// Load all NCOEFFS coefficients, h[0] first
+	void	load(const int64_t *coeffs);
+
+	// Clear the filter's history, and start again at y[0]
+	void	reset(void);
+
+	// Accept one input sample.  Any outputs it completes are written
+	// to out[], and their number returned.
+	int	apply(int64_t x, int64_t *out);
+};
+
+#endif
@@ -0,0 +1,350 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	scrambler_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	Tests the W bit per clock scrambler and descrambler, at W=32,
+//		64, and 128, against the bit exact model in scrmodel.cpp.  The
+//	scrambler's output is fed to the descrambler, and the round trip
+//	checked for integrity.  Along the way, we also check that
+//	1. a single bit error on the line becomes exactly one error per
+//	   feedback tap plus one in the data, and
+//	2. a descrambler reset in the middle of a stream recovers on its own
+//	   within LN bits.
+//	For each configuration, the number of data bits per clock, and the
+//	rate the simulation ran at, are reported.
+//
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <verilatedos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <deque>
+#include <vector>
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "testb.h"
+#include "scrmodel.h"
+#include "Vscrambler.h"
+#include "Vdescrambler.h"
+#include "Vscrambler_32.h"
+#include "Vdescrambler_32.h"
+#include "Vscrambler_128.h"
+#include "Vdescrambler_128.h"
+
+// The defaults within scrambler.v and descrambler.v
+const	unsigned	LN = 58;
+const	uint64_t	TAPS = 0x80001;
+
+typedef	std::vector<uint64_t>	WORD;
+
+// setw, getw
+// {{{
+// Move W bits between our packed 64-bit words and whatever type Verilator
+// has chosen for the port
+static	void	setw(uint32_t &v, const WORD &d) { v = (uint32_t)d[0]; }
+static	void	setw(uint64_t &v, const WORD &d) { v = d[0]; }
+template <class WIDE> static void setw(WIDE &v, const WORD &d) {
+	for(unsigned k=0; k<2*d.size(); k++)
+		v[k] = (uint32_t)(d[k/2] >> (32*(k&1)));
+}
+
+static	void	getw(uint32_t v, WORD &d) { d[0] = v; }
+static	void	getw(uint64_t v, WORD &d) { d[0] = v; }
+template <class WIDE> static void getw(const WIDE &v, WORD &d) {
+	for(unsigned k=0; k<d.size(); k++)
+		d[k] = v[2*k] | ((uint64_t)v[2*k+1] << 32);
+}
+// }}}
+
+static	uint64_t	rand64(void) {
+	return ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ rand();
+}
+
+static	unsigned	diffbits(const WORD &a, const WORD &b) {
+	unsigned	n = 0;
+
+	for(unsigned k=0; k<a.size(); k++)
+		n += __builtin_popcountll(a[k] ^ b[k]);
+	return n;
+}
+
+template <class VS, class VD> class SCRAMBLE_TB {
+	// {{{
+	TESTB<VS>	m_scr;
+	TESTB<VD>	m_dsc;
+	SCRMODEL	m_mscr, m_mdsc;
+	unsigned	m_w, m_nw;
+
+	// Words in flight, and what we expect of them
+	std::deque<WORD>	m_scr_expect,	// Scrambler output
+				m_sent;		// Data awaiting the descrambler
+	std::deque<std::pair<WORD, WORD> >	m_dsc_expect;
+	// }}}
+public:
+	// Statistics from the last run
+	uint64_t	m_clocks, m_accepted, m_mismatch, m_errors,
+			m_late_errors, m_flips, m_since_reset;
+
+	SCRAMBLE_TB(unsigned w) : m_mscr(LN, TAPS, w),
+			m_mdsc(LN, TAPS, w, true), m_w(w),
+			m_nw((w+63)/64) {}
+
+	unsigned	weight(void) const {
+		return __builtin_popcountll(TAPS) + 1; }
+
+	// random_word
+	// {{{
+	WORD	random_word(void) {
+		WORD	d(m_nw);
+
+		for(unsigned k=0; k<m_nw; k++)
+			d[k] = rand64();
+		if (m_w & 63)
+			d[m_nw-1] &= (1ull << (m_w & 63)) - 1;
+		return d;
+	}
+	// }}}
+
+	// reset
+	// {{{
+	void	reset(void) {
+		m_scr.m_core->i_ce = 0;
+		m_dsc.m_core->i_ce = 0;
+		m_scr.reset();
+		m_dsc.reset();
+		m_mscr.reset(1);
+		m_mdsc.reset(1);
+		m_scr_expect.clear();
+		m_sent.clear();
+		m_dsc_expect.clear();
+
+		m_clocks = m_accepted = m_mismatch = m_errors = 0;
+		m_late_errors = m_flips = 0;
+		m_since_reset = LN;
+	}
+	// }}}
+
+	// step
+	// {{{
+	// One clock of both cores.  If flip >= 0, that bit of any word on the
+	// line is inverted before it reaches the descrambler.
+	void	step(bool ce, bool dsc_reset, int flip) {
+		WORD	d(m_nw), s(m_nw), line(m_nw), x(m_nw), out(m_nw);
+		bool	line_valid;
+
+		// The scrambler
+		// {{{
+		if (ce) {
+			d = random_word();
+			m_mscr.apply(d.data(), s.data());
+			m_scr_expect.push_back(s);
+			m_sent.push_back(d);
+			m_accepted++;
+		}
+
+		m_scr.m_core->i_ce = ce;
+		setw(m_scr.m_core->i_data, d);
+		// }}}
+
+		// The line
+		// {{{
+		line_valid = m_scr.m_core->o_ce;
+		getw(m_scr.m_core->o_data, line);
+		if (line_valid && flip >= 0) {
+			line[flip/64] ^= 1ull << (flip & 63);
+			m_flips++;
+		}
+		// }}}
+
+		// The descrambler
+		// {{{
+		m_dsc.m_core->i_ce    = line_valid;
+		m_dsc.m_core->i_reset = dsc_reset;
+		setw(m_dsc.m_core->i_data, line);
+
+		if (line_valid) {
+			// A word arriving during a reset is lost
+			if (!dsc_reset) {
+				m_mdsc.apply(line.data(), x.data());
+				m_dsc_expect.push_back(std::make_pair(
+					m_sent.front(), x));
+			}
+			m_sent.pop_front();
+		}
+
+		if (dsc_reset) {
+			m_mdsc.reset(1);
+			m_since_reset = 0;
+		}
+		// }}}
+
+		m_scr.tick();
+		m_dsc.tick();
+		m_dsc.m_core->i_reset = 0;
+		m_clocks++;
+
+		// Check the results
+		// {{{
+		if (m_scr.m_core->o_ce) {
+			getw(m_scr.m_core->o_data, out);
+			assert(!m_scr_expect.empty());
+			if (diffbits(out, m_scr_expect.front()) != 0)
+				m_mismatch++;
+			m_scr_expect.pop_front();
+		}
+
+		if (m_dsc.m_core->o_ce) {
+			assert(!m_dsc_expect.empty());
+			const WORD	&orig = m_dsc_expect.front().first,
+					&model = m_dsc_expect.front().second;
+
+			getw(m_dsc.m_core->o_data, out);
+			if (diffbits(out, model) != 0)
+				m_mismatch++;
+
+			// Round trip errors.  Following a descrambler reset,
+			// the first LN are expected.
+			for(unsigned k=0; k<m_w; k++, m_since_reset++) {
+				if (((out[k/64] ^ orig[k/64]) >> (k&63)) & 1) {
+					m_errors++;
+					if (m_since_reset >= LN)
+						m_late_errors++;
+				}
+			}
+			m_dsc_expect.pop_front();
+		}
+		// }}}
+	}
+	// }}}
+
+	// run
+	// {{{
+	// Offer data on (on average) num of every den clocks.  Optionally,
+	// flip nflips line bits, or reset the descrambler part way through.
+	// Returns true on success.
+	bool	run(const char *name, int num, int den, unsigned nclocks,
+			unsigned nflips, bool resync) {
+		unsigned	spacing = 2 + (2*LN) / m_w, nwords = 0;
+		clock_t		start;
+		double		secs;
+		bool		pass;
+
+		reset();
+		start = clock();
+		for(unsigned clk=0; clk<nclocks; clk++) {
+			bool	ce = (rand() % den) < num;
+			int	flip = -1;
+
+			// Spread the errors out, so their effects don't overlap
+			if (m_scr.m_core->o_ce) {
+				nwords++;
+				if (m_flips < nflips && (nwords % spacing) == 0)
+					flip = rand() % m_w;
+			}
+
+			step(ce, resync && clk == nclocks/2, flip);
+		}
+
+		// Flush the pipeline
+		for(unsigned clk=0; clk<4; clk++)
+			step(false, false, -1);
+
+		secs = (clock() - start) / (double)CLOCKS_PER_SEC;
+
+		pass = (m_mismatch == 0);
+		if (nflips > 0)
+			pass = pass && (m_flips == nflips)
+				&& (m_errors == m_flips * weight());
+		else
+			pass = pass && (m_late_errors == 0)
+				&& (resync || m_errors == 0);
+
+		printf("%-10s W=%3d, duty %2d/%2d: %7.2f bits/clk, "
+			"%7.2f Mb/s simulated, %s",
+			name, m_w, num, den,
+			m_w * m_accepted / (double)m_clocks,
+			(secs > 0) ? m_w * m_accepted / secs / 1e6 : 0.0,
+			(m_mismatch) ? "NOT BIT EXACT" : "bit exact");
+		if (nflips > 0)
+			printf(", %ld line errors -> %ld data errors",
+				(unsigned long)m_flips, (unsigned long)m_errors);
+		else if (resync)
+			printf(", resync cost %ld errors", (unsigned long)m_errors);
+		else
+			printf(", %ld round trip errors", (unsigned long)m_errors);
+		printf("%s\n", (pass) ? "" : "  -- FAILED");
+
+		return pass;
+	}
+	// }}}
+
+	bool	run_all(const char *name) {
+		bool	pass = true;
+
+		pass = run(name, 1, 1, 16384, 0, false) && pass;
+		pass = run(name, 1, 2, 16384, 0, false) && pass;
+		pass = run(name, 1, 1,  4096, 64, false) && pass;
+		pass = run(name, 3, 4,  4096, 0, true) && pass;
+		return pass;
+	}
+};
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	bool	pass = true;
+
+	{
+		SCRAMBLE_TB<Vscrambler_32, Vdescrambler_32>	tb(32);
+		pass = tb.run_all("Narrow") && pass;
+	}
+
+	{
+		SCRAMBLE_TB<Vscrambler, Vdescrambler>	tb(64);
+		pass = tb.run_all("Default") && pass;
+	}
+
+	{
+		SCRAMBLE_TB<Vscrambler_128, Vdescrambler_128>	tb(128);
+		pass = tb.run_all("Wide") && pass;
+	}
+
+	if (!pass)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	scrmodel.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A bit exact software model of scrambler.v and descrambler.v.
+//		See scrmodel.h for details.
+//
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "scrmodel.h"
+
+SCRMODEL::SCRMODEL(unsigned ln, uint64_t taps, unsigned w, bool descramble)
+		: m_ln(ln), m_w(w), m_descramble(descramble) {
+	assert(ln >= 2 && ln <= 64);
+	assert(w >= 1);
+
+	m_mask  = (ln >= 64) ? ~0ull : ((1ull << ln)-1);
+	m_taps  = taps & m_mask;
+	m_state = 1;
+}
+
+unsigned	SCRMODEL::bit(unsigned b) {
+	unsigned	fb = __builtin_parityll(m_state & m_taps),
+			out = (b ^ fb) & 1;
+
+	// The register always holds what's on the line: our output when
+	// scrambling, our input when descrambling
+	m_state = (m_state >> 1)
+		| ((uint64_t)((m_descramble) ? (b&1) : out) << (m_ln-1));
+	return out;
+}
+
+void	SCRMODEL::apply(const uint64_t *in, uint64_t *out) {
+	for(unsigned k=0; k<nwords(); k++)
+		out[k] = 0;
+
+	for(unsigned k=0; k<m_w; k++) {
+		unsigned	b = (in[k/64] >> (k&63)) & 1;
+
+		out[k/64] |= (uint64_t)bit(b) << (k&63);
+	}
+}
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	scrmodel.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A bit exact software model of scrambler.v and descrambler.v,
+//		the self-synchronizing scrambler and descrambler.  Data is
+//	passed W bits at a time, packed into 64-bit words, with bit zero of
+//	the first word being the first bit in time--just as in the RTL.
+//
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	SCRMODEL_H
+#define	SCRMODEL_H
+
+#include <stdint.h>
+
+class	SCRMODEL {
+	unsigned	m_ln, m_w;
+	uint64_t	m_taps, m_mask, m_state;
+	bool		m_descramble;
+
+public:
+	SCRMODEL(unsigned ln, uint64_t taps, unsigned w,
+			bool descramble = false);
+
+	unsigned	LN(void) const	{ return m_ln; }
+	unsigned	W(void) const	{ return m_w; }
+	uint64_t	TAPS(void) const { return m_taps; }
+
+	// Number of 64-bit words needed to hold W bits
+	unsigned	nwords(void) const { return (m_w + 63) / 64; }
+
+	// Set, or read back, the last LN bits on the line.  Bit zero is the
+	// oldest.
+	void		reset(uint64_t fill = 1) { m_state = fill & m_mask; }
+	uint64_t	state(void) const { return m_state; }
+
+	// Scramble, or descramble, one bit
+	unsigned	bit(unsigned b);
+
+	// Process W bits, from in[] to out[]
+	void		apply(const uint64_t *in, uint64_t *out);
+};
+
+#endif
@@ -47,6 +47,7 @@
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 #include "Vshalfband.h"
+#include "Vshalfband_shadow.h"
 #include "testb.h"
 
 // #define	FILTER_HAS_O_CE
@@ -159,6 +160,41 @@ printf("ODD of %d is %d\n", v, ov);
 
 };
 
+// SHALFBAND_SHADOW_TB
+// {{{
+// The same filter, built with OPT_SHADOW.  testswap() needs to know the full
+// impulse response that loading the QTRP non-zero coefficients produces.
+class	SHALFBAND_SHADOW_TB : public FILTERTB<Vshalfband_shadow> {
+public:
+	SHALFBAND_SHADOW_TB(void) {
+		IW(::IW);
+		TW(::TW);
+		OW(::OW);
+		NTAPS(::NTAPS);
+		DELAY(::DELAY);
+		CKPCE(::CKPCE);
+	}
+
+	void	impulse(int ntaps, const int64_t *taps, int64_t *h) {
+		assert((unsigned)ntaps == QTRP);
+		for(int k=0; k<NTAPS(); k++) {
+			if ((k&1)&&((unsigned)k<MIDP))
+				h[k] = 0;
+			else if ((unsigned)k < MIDP)
+				h[k] = sbits(taps[k/2], TW());
+			else if ((unsigned)k == MIDP)
+				h[k] = (OPT_HILBERT) ? 0 : (1<<(TW()-1))-1;
+			else if (((k-MIDP)&1)==0)
+				h[k] = 0;
+			else if (OPT_HILBERT)
+				h[k] = -sbits(taps[(NTAPS()-1-k)/2], TW());
+			else
+				h[k] =  sbits(taps[(NTAPS()-1-k)/2], TW());
+		}
+	}
+};
+// }}}
+
 SHALFBAND_TB	*tb;
 
 int	main(int argc, char **argv) {
@@ -229,6 +265,24 @@ int	main(int argc, char **argv) {
 		}
 	}
 #endif
+	//
+	// Coefficient hot swap, between two random sets of taps, while data
+	// streams through the shadowed filter
+	// {{{
+	{
+		SHALFBAND_SHADOW_TB	*stb = new SHALFBAND_SHADOW_TB();
+		int64_t	alt[QTRP];
+
+		for(unsigned i=0; i<QTRP; i++) {
+			tapvec[i] = (int64_t)(rand() & ((1<<TW)-1)) - (1<<(TW-1));
+			alt[i]    = (int64_t)(rand() & ((1<<TW)-1)) - (1<<(TW-1));
+		}
+
+		printf("Hot swap test\n");
+		assert(stb->testswap(QTRP, tapvec, alt, 0, true));
+		delete stb;
+	}
+	// }}}
 	printf("SUCCESS\n");
 
 	exit(0);
@@ -47,6 +47,7 @@
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 #include "Vslowfil.h"
+#include "Vslowfil_shadow.h"
 #include "testb.h"
 
 // #define	FILTER_HAS_O_CE
@@ -239,6 +240,28 @@ int	main(int argc, char **argv) {
 		assert(depth < -54);
 		assert(depth > -55);
 	}
+	//
+	// Coefficient hot swap, between the low-pass filter above and a set
+	// of random taps, while data streams through the shadowed filter
+	{
+		FILTERTB<Vslowfil_shadow>	*stb
+					= new FILTERTB<Vslowfil_shadow>();
+		int64_t	alt[NTAPS];
+
+		stb->IW(::IW);
+		stb->TW(::TW);
+		stb->OW(::OW);
+		stb->NTAPS(::NTAPS);
+		stb->DELAY(::DELAY);
+		stb->CKPCE(::CKPCE);
+
+		for(unsigned i=0; i<NTAPS; i++)
+			alt[i] = (int64_t)(rand() & ((1<<TW)-1)) - (1<<(TW-1));
+
+		printf("Hot swap test\n");
+		assert(stb->testswap(NTAPS, tapvec, alt, 0, true));
+		delete stb;
+	}
 	printf("SUCCESS\n");
 
 	exit(0);
@@ -0,0 +1,325 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	slowfil_tdm_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test slowfil_tdm, the channelized version of slowfil.  Every
+//		channel is checked on its own against a software filter of
+//	its own, first with an impulse per channel--each at a different time,
+//	so that any leakage between channels shows up--and then with random
+//	samples arriving on random channels.  The number of multiplies needed
+//	per channel is reported, together with the rate each channel gets.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ctype.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vslowfil_tdm.h"
+#include "testb.h"
+#include "twelvebfltr.h"
+
+const	unsigned IW = 16,
+		TW = 16,
+		OW = IW+TW+7,
+		NTAPS = 110,
+		LGNCHAN = 5,
+		NCHAN = (1<<LGNCHAN);
+// Room for every result we might be waiting on
+const	unsigned	LGFIFO = 3;
+
+// sbits
+// {{{
+static	int64_t	sbits(int64_t val, int b) {
+	val <<= (64-b);
+	val >>= (64-b);
+	return val;
+}
+// }}}
+
+class	SLOWFIL_TDM_TB : public TESTB<Vslowfil_tdm> {
+	// Our software model: one coefficient set, and a sample history per
+	// channel
+	int64_t		m_coef[NTAPS];
+	int64_t		m_hist[NCHAN][NTAPS];
+	unsigned	m_pos[NCHAN];
+
+	// Results we expect, in the order we expect them
+	int64_t		m_expected[1<<LGFIFO];
+	unsigned	m_echan[1<<LGFIFO];
+	unsigned	m_wr, m_rd;
+public:
+	// The last result returned, for each channel
+	int64_t		m_last[NCHAN];
+	// Statistics
+	uint64_t	m_clocks, m_samples, m_outputs[NCHAN];
+	bool		m_fail;
+
+	// SLOWFIL_TDM_TB
+	// {{{
+	SLOWFIL_TDM_TB(void) {
+		for(unsigned k=0; k<NTAPS; k++)
+			m_coef[k] = 0;
+		for(unsigned c=0; c<NCHAN; c++) {
+			for(unsigned k=0; k<NTAPS; k++)
+				m_hist[c][k] = 0;
+			m_pos[c] = 0;
+		}
+		m_wr = m_rd = 0;
+		m_fail = false;
+		clear_stats();
+	}
+	// }}}
+
+	// clear_stats
+	// {{{
+	void	clear_stats(void) {
+		m_clocks = m_samples = 0;
+		for(unsigned c=0; c<NCHAN; c++) {
+			m_outputs[c] = 0;
+			m_last[c] = 0;
+		}
+	}
+	// }}}
+
+	// tick
+	// {{{
+	// Step the core, and check any result it produces against the next
+	// one we are expecting
+	void	tick(void) {
+		TESTB<Vslowfil_tdm>::tick();
+		m_clocks++;
+
+		if (m_core->o_ce) {
+			int64_t	result = sbits(m_core->o_result, OW);
+			unsigned	chan = m_core->o_chan;
+
+			if (m_rd == m_wr) {
+				printf("Unexpected output, CH[%2d] = %12ld\n",
+					chan, result);
+				m_fail = true;
+			} else {
+				unsigned	ptr = m_rd & ((1<<LGFIFO)-1);
+
+				if (chan != m_echan[ptr]
+						|| result != m_expected[ptr]) {
+					printf("CH[%2d] = %12ld != CH[%2d] = %12ld (expected)\n",
+						chan, result,
+						m_echan[ptr], m_expected[ptr]);
+					m_fail = true;
+				}
+				m_rd++;
+			}
+
+			m_outputs[chan]++;
+			m_last[chan] = result;
+		}
+	}
+	// }}}
+
+	// reset
+	// {{{
+	void	reset(void) {
+		m_core->i_tap_wr = 0;
+		m_core->i_tap    = 0;
+		m_core->i_ce     = 0;
+		m_core->i_chan   = 0;
+		m_core->i_sample = 0;
+		TESTB<Vslowfil_tdm>::reset();
+		m_wr = m_rd = 0;
+	}
+	// }}}
+
+	// load
+	// {{{
+	void	load(int nlen, const int64_t *data) {
+		assert(nlen <= (int)NTAPS);
+		reset();
+
+		m_core->i_tap_wr = 1;
+		for(unsigned k=0; k<NTAPS; k++) {
+			int64_t	v = (k < (unsigned)nlen) ? data[k] : 0;
+
+			m_core->i_tap = v & ((1ul<<TW)-1);
+			m_coef[k] = sbits(v, TW);
+			TESTB<Vslowfil_tdm>::tick();
+		}
+		m_core->i_tap_wr = 0;
+	}
+	// }}}
+
+	// sample
+	// {{{
+	// Offer one sample to the core on the given channel, and then wait
+	// for the given number of clocks before returning.
+	void	sample(unsigned chan, int64_t v, unsigned gap = NTAPS) {
+		int64_t	acc = 0;
+
+		assert(gap >= NTAPS);
+		assert(m_wr - m_rd < (1u<<LGFIFO));
+
+		// Update our model
+		m_pos[chan] = (m_pos[chan] + 1) % NTAPS;
+		m_hist[chan][m_pos[chan]] = sbits(v, IW);
+		for(unsigned k=0; k<NTAPS; k++)
+			acc += m_coef[k]
+				* m_hist[chan][(m_pos[chan]+NTAPS-k) % NTAPS];
+
+		m_expected[m_wr & ((1<<LGFIFO)-1)] = sbits(acc, OW);
+		m_echan[m_wr & ((1<<LGFIFO)-1)] = chan;
+		m_wr++;
+
+		// Then the core
+		m_core->i_ce     = 1;
+		m_core->i_chan   = chan;
+		m_core->i_sample = v & ((1<<IW)-1);
+		tick();
+		m_core->i_ce     = 0;
+		for(unsigned k=1; k<gap; k++)
+			tick();
+
+		m_samples++;
+	}
+	// }}}
+
+	// flush
+	// {{{
+	// Wait for every result we're expecting to come back
+	void	flush(void) {
+		for(unsigned k=0; k<NTAPS && m_rd != m_wr; k++)
+			tick();
+		if (m_rd != m_wr) {
+			printf("%d results never came back\n", m_wr - m_rd);
+			m_fail = true;
+		}
+	}
+	// }}}
+
+	// clear_filter
+	// {{{
+	// Fill every channel's history with zeros.  As with slowfil, the
+	// reset isn't sufficient for this.
+	void	clear_filter(void) {
+		for(unsigned k=0; k<NTAPS; k++)
+			for(unsigned c=0; c<NCHAN; c++)
+				sample(c, 0);
+		flush();
+	}
+	// }}}
+};
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	SLOWFIL_TDM_TB	*tb = new SLOWFIL_TDM_TB();
+
+	const int64_t	IMPULSE  =  (1<<(IW-1))-1;
+	const unsigned	NRAND = 64*NCHAN;
+	int64_t	tapvec[NTAPS];
+
+	// tb->opentrace("trace.vcd");
+	tb->reset();
+
+	// The low-pass filter from slowfil_tb
+	// {{{
+	assert(NCOEFFS < (int)NTAPS);
+	for(int i=0; i<NCOEFFS; i++)
+		tapvec[i] = icoeffs[i];
+	for(int i=NCOEFFS; i<(int)NTAPS; i++)
+		tapvec[i] = 0;
+
+	tb->load(NTAPS, tapvec);
+	tb->clear_filter();
+	// }}}
+
+	// Impulse tests
+	// {{{
+	// Channel c gets its impulse on round c.  Every channel should then
+	// see the filter's impulse response, and nothing else.
+	printf("Impulse tests\n");
+	for(unsigned r=0; r<NCHAN+NTAPS; r++) {
+		for(unsigned c=0; c<NCHAN; c++) {
+			tb->sample(c, (r == c) ? IMPULSE : 0);
+			tb->flush();
+
+			int64_t	expected = 0;
+			if (r >= c && r-c < NTAPS)
+				expected = IMPULSE * tapvec[r-c];
+			if (tb->m_last[c] != expected) {
+				printf("CH[%2d], H[%3d] = %12ld != %12ld\n",
+					c, r-c, tb->m_last[c], expected);
+				tb->m_fail = true;
+			}
+		}
+	}
+	// }}}
+
+	// Random channels, random data
+	// {{{
+	printf("Random channel test\n");
+	tb->clear_stats();
+	for(unsigned k=0; k<NRAND; k++)
+		tb->sample(rand() % NCHAN, sbits(rand(), IW),
+				NTAPS + (((rand() & 3) == 0) ? rand() % 7 : 0));
+	tb->flush();
+
+	for(unsigned c=0; c<NCHAN; c++) {
+		if (tb->m_outputs[c] == 0) {
+			printf("Channel %d was never tested\n", c);
+			tb->m_fail = true;
+		}
+	}
+
+	printf("%d channels, %d taps: %.4f channel-samples/clk, "
+		"%.4f multipliers per channel (vs 1.0 for %d slowfil's)\n",
+		NCHAN, NTAPS, tb->m_samples / (double)tb->m_clocks,
+		1.0 / NCHAN, NCHAN);
+	// }}}
+
+	if (tb->m_fail) {
+		printf("TEST FAILURE!\n");
+		delete tb;
+		exit(EXIT_FAILURE);
+	}
+
+	delete tb;
+	printf("SUCCESS!!\n");
+	exit(0);
+}
@@ -52,6 +52,7 @@
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 #include "Vslowsymf.h"
+#include "Vslowsymf_shadow.h"
 #include "testb.h"
 
 // #define	FILTER_HAS_O_CE
@@ -161,6 +162,35 @@ printf("ODD of %d is %d\n", v, ov);
 	// }}}
 };
 
+// SLOWSYMF_SHADOW_TB
+// {{{
+// The same filter, built with OPT_SHADOW.  Since only the first half of the
+// filter is loaded, testswap() needs to be told what the rest of it is.
+class	SLOWSYMF_SHADOW_TB : public FILTERTB<Vslowsymf_shadow> {
+public:
+	SLOWSYMF_SHADOW_TB(void) {
+		IW(::IW);
+		TW(::TW);
+		OW(::OW);
+		NTAPS(::NTAPS);
+		DELAY(::DELAY);
+		CKPCE(::CKPCE);
+	}
+
+	void	impulse(int ntaps, const int64_t *taps, int64_t *h) {
+		assert((unsigned)ntaps == MIDP);
+		for(int k=0; k<NTAPS(); k++) {
+			if ((unsigned)k < MIDP)
+				h[k] = sbits(taps[k], TW());
+			else if ((unsigned)k == MIDP)
+				h[k] = (1<<(TW()-1))-1;
+			else
+				h[k] = sbits(taps[NTAPS()-1-k], TW());
+		}
+	}
+};
+// }}}
+
 SLOWSYMF_TB	*tb;
 
 int	main(int argc, char **argv) {
@@ -298,6 +328,24 @@ int	main(int argc, char **argv) {
 		assert(depth > -55);
 	}
 #endif
+	//
+	// Coefficient hot swap, between two random sets of taps, while data
+	// streams through the shadowed filter
+	// {{{
+	{
+		SLOWSYMF_SHADOW_TB	*stb = new SLOWSYMF_SHADOW_TB();
+		int64_t	alt[MIDP];
+
+		for(unsigned i=0; i<MIDP; i++) {
+			tapvec[i] = (int64_t)(rand() & ((1<<TW)-1)) - (1<<(TW-1));
+			alt[i]    = (int64_t)(rand() & ((1<<TW)-1)) - (1<<(TW-1));
+		}
+
+		printf("Hot swap test\n");
+		assert(stb->testswap(MIDP, tapvec, alt, 0, true));
+		delete stb;
+	}
+	// }}}
 	printf("SUCCESS\n");
 
 	exit(0);
@@ -0,0 +1,405 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	subfildown_poly_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test subfildown_poly, the polyphase downsampler with NMPY
+//		multiplies.  Every output is checked, bit for bit, against a
+//	software model of the same filter--including subfildown's rounding
+//	and saturation.  Each coefficient is checked on its own, then random
+//	filters are run with random data, at full rate and with random gaps.
+//	Finally, the sustained input rate of each configuration is measured
+//	and compared against subfildown's.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vsubfildown_poly.h"
+#include "Vsubfildown_poly_m7.h"
+#include "Vsubfildown_poly_m4.h"
+#include "Vsubfildown_poly_d4.h"
+#include "testb.h"
+
+const	int	IW = 16,
+		OW = 24,
+		CW = 12,
+		SHIFT = 2,
+		MAXCOEFFS = 128;
+
+// sext
+// {{{
+static	int64_t	sext(int64_t val, int bits) {
+	val <<= (64-bits);
+	val >>= (64-bits);
+	return val;
+}
+// }}}
+
+template <class VA> class SUBFILDOWN_POLY_TB : public TESTB<VA> {
+	const	int	m_ndown, m_ncoeffs, m_nmpy, m_nstep, m_aw;
+
+	// Our software model of the core
+	int64_t	m_coeffs[MAXCOEFFS], m_hist[MAXCOEFFS];
+	int	m_phase;
+
+	// Outputs we are still expecting
+	int64_t	*m_expected;
+	int	m_head, m_tail;
+public:
+	// Statistics
+	uint64_t	m_clocks, m_samples, m_outputs, m_overflows;
+	bool		m_failed;
+
+	// SUBFILDOWN_POLY_TB
+	// {{{
+	SUBFILDOWN_POLY_TB(int ndown, int ncoeffs, int nmpy)
+		: m_ndown(ndown), m_ncoeffs(ncoeffs), m_nmpy(nmpy),
+		m_nstep(((ncoeffs+ndown-1)/ndown + nmpy-1)/nmpy),
+		m_aw(IW+CW+clog2(ncoeffs)) {
+		assert(ncoeffs <= MAXCOEFFS);
+		m_expected = new int64_t[MAXCOEFFS];
+		m_failed = false;
+		m_clocks = m_samples = m_outputs = m_overflows = 0;
+		for(int k=0; k<MAXCOEFFS; k++)
+			m_coeffs[k] = 0;
+		clear_model();
+	}
+
+	~SUBFILDOWN_POLY_TB(void) {
+		delete[] m_expected;
+	}
+	// }}}
+
+	static	int	clog2(int v) {
+		int	r;
+		for(r=0; (1<<r) < v; r++)
+			;
+		return r;
+	}
+
+	int	nstep(void) const { return m_nstep; }
+	int	ndown(void) const { return m_ndown; }
+	int	ncoeffs(void) const { return m_ncoeffs; }
+	int	nmpy(void) const { return m_nmpy; }
+
+	// clear_model
+	// {{{
+	void	clear_model(void) {
+		for(int k=0; k<MAXCOEFFS; k++)
+			m_hist[k] = 0;
+		m_phase = 0;
+		m_head = m_tail = 0;
+	}
+	// }}}
+
+	// round
+	// {{{
+	// The core's rounding and saturation, applied to an AW bit sum
+	int64_t	round(int64_t acc) {
+		const int64_t	one = 1;
+		int64_t	pre, rounded, sgnbits;
+		bool	sgn, overflow;
+
+		acc = sext(acc, m_aw);
+		sgn = (acc < 0);
+		pre = sext(acc << SHIFT, m_aw);
+		if ((pre >> (m_aw-OW-1)) & 1)
+			rounded = pre + (one << (m_aw-OW-1));
+		else
+			rounded = pre + (one << (m_aw-OW-1)) - 1;
+		rounded = sext(rounded, m_aw);
+
+		sgnbits = acc >> (m_aw-1-SHIFT);
+		overflow = (sgnbits != 0 && sgnbits != -1)
+				|| (!sgn && rounded < 0);
+		if (overflow) {
+			m_overflows++;
+			return (sgn) ? -(one << (OW-1)) : (one << (OW-1))-1;
+		}
+
+		return rounded >> (m_aw-OW);
+	}
+	// }}}
+
+	// tick
+	// {{{
+	// Step the core, checking any output it produces against the oldest
+	// output we are expecting
+	void	tick(void) {
+		TESTB<VA>::tick();
+		m_clocks++;
+
+		if (TESTB<VA>::m_core->o_ce) {
+			int64_t	v = sext(TESTB<VA>::m_core->o_result, OW);
+
+			if (m_head == m_tail) {
+				if (!m_failed)
+					printf("Unexpected output: %ld\n", v);
+				m_failed = true;
+			} else {
+				if (v != m_expected[m_tail] && !m_failed) {
+					printf("OUT[%ld] = %ld != %ld\n",
+						m_outputs, v,
+						m_expected[m_tail]);
+					m_failed = true;
+				}
+				m_tail = (m_tail + 1) % MAXCOEFFS;
+			}
+			m_outputs++;
+		}
+	}
+	// }}}
+
+	// reset
+	// {{{
+	void	reset(void) {
+		TESTB<VA>::m_core->i_tap_wr = 0;
+		TESTB<VA>::m_core->i_tap    = 0;
+		TESTB<VA>::m_core->i_ce     = 0;
+		TESTB<VA>::m_core->i_sample = 0;
+		TESTB<VA>::reset();
+		clear_model();
+	}
+	// }}}
+
+	// load
+	// {{{
+	void	load(int ntaps, const int64_t *taps) {
+		assert(ntaps <= m_ncoeffs);
+		reset();
+
+		TESTB<VA>::m_core->i_tap_wr = 1;
+		for(int k=0; k<m_ncoeffs; k++) {
+			m_coeffs[k] = (k < ntaps) ? sext(taps[k], CW) : 0;
+			TESTB<VA>::m_core->i_tap = m_coeffs[k] & ((1<<CW)-1);
+			tick();
+		}
+		TESTB<VA>::m_core->i_tap_wr = 0;
+
+		// Coefficients are loaded following a reset, and need a reset
+		// after to clear the filter
+		reset();
+	}
+	// }}}
+
+	// push
+	// {{{
+	// Send one sample to the core, followed by enough idle clocks to
+	// make up the given pace
+	void	push(int64_t sample, int pace) {
+		sample = sext(sample, IW);
+
+		for(int k=m_ncoeffs-1; k>0; k--)
+			m_hist[k] = m_hist[k-1];
+		m_hist[0] = sample;
+
+		if (m_phase == 0) {
+			int64_t	acc = 0;
+
+			for(int k=0; k<m_ncoeffs; k++)
+				acc += m_coeffs[k] * m_hist[k];
+			m_expected[m_head] = round(acc);
+			m_head = (m_head + 1) % MAXCOEFFS;
+			assert(m_head != m_tail);
+			m_phase = m_ndown-1;
+		} else
+			m_phase--;
+
+		TESTB<VA>::m_core->i_ce     = 1;
+		TESTB<VA>::m_core->i_sample = sample & ((1<<IW)-1);
+		tick();
+		TESTB<VA>::m_core->i_ce     = 0;
+		for(int k=1; k<pace; k++)
+			tick();
+		m_samples++;
+	}
+	// }}}
+
+	// flush
+	// {{{
+	// Wait for every expected output to be produced
+	void	flush(void) {
+		for(int k=0; k<m_nstep+8; k++)
+			tick();
+		if (m_head != m_tail) {
+			if (!m_failed)
+				printf("Missing output(s)\n");
+			m_failed = true;
+		}
+	}
+	// }}}
+
+	// run
+	// {{{
+	// Run nsamples of random data through the core.  If gaps is set, a
+	// random number of extra idle clocks are added between samples.
+	void	run(int nsamples, bool gaps, int64_t amplitude) {
+		m_clocks = m_samples = 0;
+		for(int k=0; k<nsamples; k++) {
+			int	pace = m_nstep;
+
+			if (gaps && (rand() & 1))
+				pace += rand() & 7;
+			push((rand() % (2*amplitude+1)) - amplitude, pace);
+		}
+	}
+	// }}}
+};
+
+// runtests
+// {{{
+template <class VA> bool runtests(const char *name,
+				SUBFILDOWN_POLY_TB<VA> *tb) {
+	const int	NCOEFFS = tb->ncoeffs();
+	const int64_t	MAXIN   = (1<<(IW-1))-1,
+			MAXTAP  = (1<<(CW-1))-1;
+	int64_t	taps[MAXCOEFFS];
+	double	rate;
+
+	printf("%s: NDOWN = %d, NCOEFFS = %d, NMPY = %d\n", name,
+		tb->ndown(), NCOEFFS, tb->nmpy());
+
+	// Each coefficient, on its own
+	// {{{
+	for(int k=0; k<NCOEFFS; k++) {
+		for(int i=0; i<NCOEFFS; i++)
+			taps[i] = 0;
+		taps[k] = -MAXTAP-1;
+
+		tb->load(NCOEFFS, taps);
+		tb->run(NCOEFFS + 3*tb->ndown(), false, MAXIN);
+		tb->flush();
+		if (tb->m_failed) {
+			printf("%s: Coefficient %d test failed\n", name, k);
+			return false;
+		}
+	}
+	// }}}
+
+	// Random filters, with random data--with and without gaps
+	// {{{
+	for(int trial=0; trial<4; trial++) {
+		for(int i=0; i<NCOEFFS; i++)
+			taps[i] = (rand() % (2*MAXTAP+1)) - MAXTAP;
+
+		tb->load(NCOEFFS, taps);
+		tb->run(8*NCOEFFS, (trial & 1), MAXIN);
+		tb->flush();
+		if (tb->m_failed) {
+			printf("%s: Random filter test %d failed\n",
+				name, trial);
+			return false;
+		}
+	}
+	// }}}
+
+	// Saturation
+	// {{{
+	// A maximum filter with maximum inputs will overflow, and so needs
+	// to saturate
+	for(int i=0; i<NCOEFFS; i++)
+		taps[i] = MAXTAP;
+	tb->load(NCOEFFS, taps);
+	tb->m_overflows = 0;
+	for(int k=0; k<4*NCOEFFS; k++)
+		tb->push((k < 2*NCOEFFS) ? MAXIN : -MAXIN-1, tb->nstep());
+	tb->flush();
+	if (tb->m_failed) {
+		printf("%s: Saturation test failed\n", name);
+		return false;
+	}
+	assert(tb->m_overflows > 0);
+	// }}}
+
+	// Sustained input rate
+	// {{{
+	tb->run(16*NCOEFFS, false, MAXIN);
+	rate = tb->m_samples / (double)tb->m_clocks;
+	tb->flush();
+	if (tb->m_failed)
+		return false;
+
+	printf("%s: %5.3f samples/clk, vs %5.3f for subfildown\n", name,
+		rate, 1.0 / ((NCOEFFS+1) / tb->ndown() + 1));
+	// }}}
+
+	return true;
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+	bool	pass = true;
+
+	{
+		SUBFILDOWN_POLY_TB<Vsubfildown_poly>	*tb
+			= new SUBFILDOWN_POLY_TB<Vsubfildown_poly>(5, 103, 21);
+		// tb->opentrace("trace.vcd");
+		pass = runtests("Full rate", tb) && pass;
+		delete tb;
+	}
+
+	{
+		SUBFILDOWN_POLY_TB<Vsubfildown_poly_m7>	*tb
+			= new SUBFILDOWN_POLY_TB<Vsubfildown_poly_m7>(5, 103, 7);
+		pass = runtests("NMPY=7", tb) && pass;
+		delete tb;
+	}
+
+	{
+		SUBFILDOWN_POLY_TB<Vsubfildown_poly_m4>	*tb
+			= new SUBFILDOWN_POLY_TB<Vsubfildown_poly_m4>(5, 103, 4);
+		pass = runtests("NMPY=4", tb) && pass;
+		delete tb;
+	}
+
+	{
+		SUBFILDOWN_POLY_TB<Vsubfildown_poly_d4>	*tb
+			= new SUBFILDOWN_POLY_TB<Vsubfildown_poly_d4>(4, 32, 3);
+		pass = runtests("NDOWN=4", tb) && pass;
+		delete tb;
+	}
+
+	if (!pass)
+		printf("TEST FAILURE!\n");
+	else
+		printf("SUCCESS!!\n");
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,231 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	subfilup_tb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To test subfilup, the 1:NUP polyphase upsampler.  Each
+//		coefficient is loaded and read back on its own, random filters
+//	and saturating filters are checked bit for bit against UPSAMPLETB's
+//	software model, and then a windowed sinc interpolator is loaded to
+//	measure how well the images of several input tones are rejected.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <signal.h>
+#include <time.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "verilated.h"
+#include "verilated_vcd_c.h"
+#include "Vsubfilup.h"
+#include "Vsubfilup_u4.h"
+#include "testb.h"
+#include "filtertb.h"
+#include "filtertb.cpp"
+
+#include "upsampletb.h"
+#include "upsampletb.cpp"
+
+const	int	IW = 16,
+		TW = 12,
+		OW = 24,
+		SHIFT = 2,
+		MAXTAPS = 128;
+
+// clog2
+// {{{
+static	int	clog2(int vl) {
+	int	r;
+
+	for(r=0; (1<<r)<vl; r++)
+		;
+	return r;
+}
+// }}}
+
+template <class VA> class	SUBFILUP_TB : public UPSAMPLETB<VA> {
+public:
+	// SUBFILUP_TB
+	// {{{
+	SUBFILUP_TB(int nup, int ncoeffs) {
+		int	nbranch = (ncoeffs + nup - 1) / nup;
+
+		UPSAMPLETB<VA>::IW(::IW);
+		UPSAMPLETB<VA>::TW(::TW);
+		UPSAMPLETB<VA>::OW(::OW);
+		UPSAMPLETB<VA>::NTAPS(ncoeffs);
+		UPSAMPLETB<VA>::NUP(nup);
+		// One multiply per clock, and NBRANCH multiplies per output
+		FILTERTB<VA>::CKPCE(nup * nbranch);
+		// The accumulator is IW+TW+clog2(NBRANCH) bits.  Of these,
+		// SHIFT are dropped from the top, and OW kept.
+		UPSAMPLETB<VA>::SHIFT(::IW + ::TW + clog2(nbranch)
+							- ::OW - ::SHIFT);
+	}
+	// }}}
+
+	void	load(int nlen, int64_t *data) {
+		UPSAMPLETB<VA>::reset();
+		UPSAMPLETB<VA>::load(nlen, data);
+	}
+};
+
+// runtests
+// {{{
+template <class VA> void	runtests(SUBFILUP_TB<VA> *tb) {
+	const	int	NTAPS = tb->NTAPS(), NUP = tb->NUP();
+	const	int64_t	TAPVALUE = -(1<<(TW-1)),
+			MAXTAP   = (1<<(TW-1))-1,
+			MAXIN    = (1<<(IW-1))-1;
+	const	int	NLEN = 4 * MAXTAPS / NUP;
+
+	int64_t	tapvec[MAXTAPS], ivec[NLEN];
+
+	assert(NTAPS <= MAXTAPS);
+	tb->reset();
+
+	// Impulse tests
+	// {{{
+	printf("NUP = %d, NTAPS = %3d: Impulse tests\n", NUP, NTAPS);
+	for(int k=0; k<NTAPS; k++) {
+		for(int i=0; i<NTAPS; i++)
+			tapvec[i] = 0;
+		tapvec[k] = TAPVALUE;
+
+		tb->testload(NTAPS, tapvec);
+	}
+	// }}}
+
+	// Random filters, random data
+	// {{{
+	printf("NUP = %d, NTAPS = %3d: Random filters\n", NUP, NTAPS);
+	for(int trial=0; trial<4; trial++) {
+		for(int i=0; i<NTAPS; i++)
+			tapvec[i] = (rand() % (2*MAXTAP+1)) - MAXTAP;
+		tb->load(NTAPS, tapvec);
+
+		for(int i=0; i<NLEN; i++)
+			ivec[i] = (rand() % (2*MAXIN+1)) - MAXIN;
+		assert(tb->test_model(NLEN, ivec));
+	}
+	// }}}
+
+	// Saturation
+	// {{{
+	// Every coefficient at its maximum, with full scale inputs, will
+	// overflow OW bits
+	printf("NUP = %d, NTAPS = %3d: Saturation\n", NUP, NTAPS);
+	{
+		int64_t	*expected = new int64_t[NLEN * NUP];
+		bool	saturated = false;
+
+		for(int i=0; i<NTAPS; i++)
+			tapvec[i] = MAXTAP;
+		tb->load(NTAPS, tapvec);
+
+		for(int i=0; i<NLEN; i++)
+			ivec[i] = (i < NLEN/2) ? MAXIN : -MAXIN-1;
+		assert(tb->test_model(NLEN, ivec));
+
+		tb->model(NLEN, ivec, expected);
+		for(int k=0; k<NLEN * NUP; k++)
+			if (expected[k] == (1l<<(OW-1))-1)
+				saturated = true;
+		assert(saturated);
+		delete[] expected;
+	}
+	// }}}
+
+	// Image rejection
+	// {{{
+	// A windowed sinc interpolator, with each polyphase branch having
+	// a gain of (about) 2^(TW-1)
+	printf("NUP = %d, NTAPS = %3d: Image rejection\n", NUP, NTAPS);
+	for(int k=0; k<NTAPS; k++) {
+		double	t = (k - (NTAPS-1)/2.0) / NUP,
+			w = 0.42 - 0.5 * cos(2.0*M_PI*k/(NTAPS-1))
+				+ 0.08 * cos(4.0*M_PI*k/(NTAPS-1)),
+			sinc = (t == 0.0) ? 1.0 : sin(M_PI*t) / (M_PI*t);
+
+		tapvec[k] = (int64_t)round(MAXTAP * sinc * w);
+	}
+
+	tb->testload(NTAPS, tapvec);
+
+	{
+		const double	freqs[] = { 0.05, 0.1, 0.2 };
+
+		for(unsigned k=0; k<sizeof(freqs)/sizeof(freqs[0]); k++) {
+			double	gain, images;
+
+			images = tb->measure_images(freqs[k], gain);
+			printf("F = %4.2f: GAIN = %6.4f, WORST IMAGE = %6.2f dB\n",
+				freqs[k], gain, images);
+
+			// The passband should be flat, and every image
+			// should be at least 60 dB down
+			assert(gain > 0.98 && gain < 1.01);
+			assert(images < -60.0);
+		}
+	}
+	// }}}
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	Verilated::commandArgs(argc, argv);
+
+	{
+		SUBFILUP_TB<Vsubfilup>	*tb = new SUBFILUP_TB<Vsubfilup>(5, 103);
+
+		// tb->opentrace("trace.vcd");
+		runtests(tb);
+		delete tb;
+	}
+
+	{
+		SUBFILUP_TB<Vsubfilup_u4> *tb
+				= new SUBFILUP_TB<Vsubfilup_u4>(4, 64);
+
+		runtests(tb);
+		delete tb;
+	}
+
+	printf("SUCCESS\n");
+	exit(0);
+}
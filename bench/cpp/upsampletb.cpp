@@ -0,0 +1,367 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	upsampletb.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A generic upsampling/filter testbench class
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <math.h>
+#include "upsampletb.h"
+
+// tick
+// {{{
+template<class VFLTR> void	UPSAMPLETB<VFLTR>::tick(void) {
+	bool	i_ce, o_ce;
+	int64_t	vec[2];
+
+	i_ce = (TESTB<VFLTR>::m_core->i_ce);
+	if (i_ce)
+		vec[0] = sbits(TESTB<VFLTR>::m_core->i_sample, IW());
+	else
+		vec[0] = 0;
+
+	TESTB<VFLTR>::tick();
+
+	o_ce = (TESTB<VFLTR>::m_core->o_ce);
+	if (o_ce)
+		vec[1] = sbits(TESTB<VFLTR>::m_core->o_result, OW());
+	else
+		vec[1] = 0;
+
+	if (this->result_fp)
+		fwrite(vec, sizeof(int64_t), 2, this->result_fp);
+}
+// }}}
+
+// reset
+// {{{
+template<class VFLTR> void	UPSAMPLETB<VFLTR>::reset(void) {
+	TESTB<VFLTR>::m_core->i_tap     = 0;
+	TESTB<VFLTR>::m_core->i_sample  = 0;
+	TESTB<VFLTR>::m_core->i_ce      = 0;
+	TESTB<VFLTR>::m_core->i_tap_wr  = 0;
+
+	TESTB<VFLTR>::reset();
+
+	TESTB<VFLTR>::m_core->i_reset = 0;
+}
+// }}}
+
+// clear_filter
+// {{{
+template<class VFLTR> void	UPSAMPLETB<VFLTR>::clear_filter(void) {
+	int	nzeros = (NTAPS()+NUP()-1) / NUP();
+
+	TESTB<VFLTR>::m_core->i_tap_wr = 0;
+	TESTB<VFLTR>::m_core->i_sample = 0;
+	for(int k=0; k<nzeros; k++) {
+		TESTB<VFLTR>::m_core->i_ce = 1;
+		for(int i=0; i<FILTERTB<VFLTR>::CKPCE(); i++) {
+			tick();
+			TESTB<VFLTR>::m_core->i_ce = 0;
+		}
+	}
+
+	// Let the last of the outputs from these zeros work their way out
+	for(int k=0; k<FILTERTB<VFLTR>::CKPCE() + 16; k++)
+		tick();
+}
+// }}}
+
+// apply
+// {{{
+template<class VFLTR> int	UPSAMPLETB<VFLTR>::apply(int nlen,
+				const int64_t *data, int64_t *result) {
+	const	int	maxout = nlen * NUP();
+	int	nout = 0;
+
+	TESTB<VFLTR>::m_core->i_reset  = 0;
+	TESTB<VFLTR>::m_core->i_tap_wr = 0;
+	for(int i=0; i<nlen; i++) {
+		TESTB<VFLTR>::m_core->i_ce     = 1;
+		// Strip off any excess bits
+		TESTB<VFLTR>::m_core->i_sample = ubits(data[i], IW());
+
+		for(int k=0; k<FILTERTB<VFLTR>::CKPCE(); k++) {
+			tick();
+			TESTB<VFLTR>::m_core->i_ce = 0;
+
+			if (TESTB<VFLTR>::m_core->o_ce) {
+				assert(nout < maxout);
+				// Sign extend the result
+				result[nout++] = sbits(
+					TESTB<VFLTR>::m_core->o_result, OW());
+			}
+		}
+	}
+
+	// Collect the outputs from the last sample
+	for(int k=0; nout < maxout && k<FILTERTB<VFLTR>::CKPCE()+16; k++) {
+		tick();
+		if (TESTB<VFLTR>::m_core->o_ce)
+			result[nout++] = sbits(
+				TESTB<VFLTR>::m_core->o_result, OW());
+	}
+
+	return nout;
+}
+// }}}
+
+// test
+// {{{
+template<class VFLTR> int	UPSAMPLETB<VFLTR>::test(int nlen,
+				const int64_t *data, int64_t *result) {
+	reset();
+	clear_filter();
+	return apply(nlen, data, result);
+}
+// }}}
+
+// model
+// {{{
+template<class VFLTR> void	UPSAMPLETB<VFLTR>::model(int nlen,
+				const int64_t *data, int64_t *result) {
+	const	int64_t	one = 1,
+			maxv = (one << (OW()-1))-1, minv = -maxv-1;
+
+	for(int n=0; n<nlen; n++) {
+		for(int p=0; p<NUP(); p++) {
+			int64_t	acc = 0;
+
+			for(int k=p; k<NTAPS(); k+= NUP()) {
+				int	j = (k-p) / NUP();
+
+				if (m_taps && n >= j)
+					acc += m_taps[k] * sbits(data[n-j], IW());
+			}
+
+			// Round half up, and then saturate
+			if (m_shift > 0)
+				acc = (acc + (one << (m_shift-1))) >> m_shift;
+			if (acc > maxv)
+				acc = maxv;
+			else if (acc < minv)
+				acc = minv;
+
+			result[n*NUP()+p] = acc;
+		}
+	}
+}
+// }}}
+
+// load
+// {{{
+template<class VFLTR> void	UPSAMPLETB<VFLTR>::load(int  ntaps,
+				int64_t *data) {
+	if (!m_taps)
+		m_taps = new int64_t[NTAPS()];
+	for(int k=0; k<NTAPS(); k++)
+		m_taps[k] = (k < ntaps) ? sbits(data[k], TW()) : 0;
+
+	TESTB<VFLTR>::m_core->i_reset    = 0;
+	TESTB<VFLTR>::m_core->i_ce       = 0;
+	TESTB<VFLTR>::m_core->i_tap_wr   = 1;
+	for(int i=0; i<ntaps; i++) {
+		// Strip off any excess bits
+		TESTB<VFLTR>::m_core->i_tap   = ubits(data[i], TW());
+
+		tick();
+	}
+	TESTB<VFLTR>::m_core->i_tap_wr   = 0;
+
+	FILTERTB<VFLTR>::clear_cache();
+}
+// }}}
+
+// operator[]
+// {{{
+// Read back the impulse response, at the output rate
+template<class VFLTR> int	UPSAMPLETB<VFLTR>::operator[](const int tap) {
+
+	if ((tap < 0)||(tap >= 2*NTAPS()))
+		return 0;
+	else if (!this->m_hk) {
+		int	nin = (2*NTAPS()+NUP()-1) / NUP();
+		int64_t	*impulse = new int64_t[nin],
+			*result  = new int64_t[nin * NUP()];
+
+		// Create an input vector with a single impulse in it
+		for(int k=0; k<nin; k++)
+			impulse[k] = 0;
+		impulse[0] = -(1<<(IW()-1));
+
+		// Apply the filter to the impulse vector
+		int	nout = test(nin, impulse, result);
+		assert(nout == nin * NUP());
+
+		this->m_hk = new int64_t[2*NTAPS()];
+		for(int k=0; k<2*NTAPS(); k++) {
+			// Undo the filter's shift, and then our impulse's
+			// scale
+			this->m_hk[k] = -((result[k] << m_shift) >> (IW()-1));
+		}
+
+		delete[] impulse;
+		delete[] result;
+	}
+
+	return this->m_hk[tap];
+}
+// }}}
+
+// testload
+// {{{
+template<class VFLTR> void	UPSAMPLETB<VFLTR>::testload(int nlen,
+				int64_t *data) {
+	bool	mismatch = false;
+
+	load(nlen, data);
+	reset();
+
+	for(int k=0; k<2*NTAPS(); k++) {
+		int64_t	expected = (k < nlen) ? sbits(data[k], TW()) : 0;
+		int	m = (*this)[k];
+
+		if (expected != m) {
+			printf("Err: Data[%3d] = %8ld != (*this)[%3d] = %8d\n",
+				k, expected, k, m);
+			mismatch = true;
+		}
+	}
+
+	if (mismatch) {
+		fflush(stdout);
+		assert(!mismatch);
+	}
+}
+// }}}
+
+// test_model
+// {{{
+template<class VFLTR> bool	UPSAMPLETB<VFLTR>::test_model(int nlen,
+				const int64_t *data) {
+	int64_t	*result   = new int64_t[nlen * NUP()],
+		*expected = new int64_t[nlen * NUP()];
+	bool	pass = true;
+	int	nout;
+
+	nout = test(nlen, data, result);
+	model(nlen, data, expected);
+
+	if (nout != nlen * NUP()) {
+		printf("Only %d of %d outputs produced\n", nout, nlen*NUP());
+		pass = false;
+	}
+
+	for(int k=0; pass && k<nout; k++) {
+		if (result[k] != expected[k]) {
+			printf("OUT[%4d] = %10ld != %10ld\n",
+				k, result[k], expected[k]);
+			pass = false;
+		}
+	}
+
+	delete[] result;
+	delete[] expected;
+	return pass;
+}
+// }}}
+
+// dftmag
+// {{{
+// The magnitude of a single DFT bin of an nlen point sequence
+static	double	dftmag(int nlen, const int64_t *data, int bin) {
+	COMPLEX	acc = 0;
+
+	for(int k=0; k<nlen; k++) {
+		double	theta = -2.0 * M_PI * bin * k / (double)nlen;
+
+		acc += (double)data[k] * COMPLEX(cos(theta), sin(theta));
+	}
+
+	return abs(acc);
+}
+// }}}
+
+// measure_images
+// {{{
+// Send a sinusoid of freq cycles per input sample through the filter, and
+// measure the output at both the sinusoid's frequency and at each of its
+// images.  The frequency is adjusted so that both the signal and its images
+// fall on DFT bins.  Returns the largest image, in dB relative to the
+// signal.  The passband gain, in units of 2^(TW-1), is returned in gain.
+template<class VFLTR> double	UPSAMPLETB<VFLTR>::measure_images(double freq,
+				double &gain) {
+	const	int	NLEN = 256,
+			NSETTLE = (NTAPS()+NUP()-1) / NUP() + 1,
+			NOUT = NLEN * NUP();
+	const	double	amplitude = (1<<(IW()-1))-1;
+	int	bin = (int)(freq * NLEN + 0.5), nout;
+	int64_t	*input  = new int64_t[NSETTLE + NLEN],
+		*result = new int64_t[(NSETTLE + NLEN) * NUP()];
+	double	signal, worst = 0.0;
+
+	assert(bin > 0 && 2*bin < NLEN);
+	for(int k=0; k<NSETTLE+NLEN; k++)
+		input[k] = (int64_t)round(amplitude
+				* cos(2.0 * M_PI * bin * k / (double)NLEN));
+
+	nout = test(NSETTLE+NLEN, input, result);
+	assert(nout == (NSETTLE+NLEN)*NUP());
+
+	signal = dftmag(NOUT, &result[NSETTLE*NUP()], bin);
+	for(int m=1; m<NUP(); m++) {
+		double	image;
+
+		image = dftmag(NOUT, &result[NSETTLE*NUP()], m*NLEN - bin);
+		if (image > worst)
+			worst = image;
+		image = dftmag(NOUT, &result[NSETTLE*NUP()], m*NLEN + bin);
+		if (image > worst)
+			worst = image;
+	}
+
+	// A cosine of amplitude A produces a DFT peak of A*N/2
+	gain = signal / (amplitude * NOUT / 2.0)
+			* pow(2.0, m_shift - (TW()-1));
+
+	delete[] input;
+	delete[] result;
+
+	if (worst <= 0.0)
+		return -400.0;
+	return 20.0 * log10(worst / signal);
+}
+// }}}
@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	upsampletb.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A generic upsampling/filter testbench class
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	UPSAMPLETB_H
+#define	UPSAMPLETB_H
+
+#include "filtertb.h"
+
+// UPSAMPLETB is DOWNSAMPLETB's counterpart, for filters producing NUP
+// outputs for every input.  The filter's impulse response is read back at
+// the output rate, so (*this)[k] should return the k'th coefficient.
+// SHIFT is the number of bits the filter drops from its full precision
+// result.  The filter is expected to round that result, half up, and then
+// to saturate it to OW bits.
+template <class VFLTR> class UPSAMPLETB : public FILTERTB<VFLTR> {
+	int	m_nup, m_shift;
+	int64_t	*m_taps;
+public:
+	UPSAMPLETB(void) : m_nup(1), m_shift(0), m_taps(NULL) {}
+	~UPSAMPLETB(void) { if (m_taps) delete[] m_taps; }
+
+	int	IW(int k)	{ return FILTERTB<VFLTR>::IW(k); }
+	int	IW(void) const	{ return FILTERTB<VFLTR>::IW(); }
+	int	OW(int k)	{ return FILTERTB<VFLTR>::OW(k); }
+	int	OW(void) const	{ return FILTERTB<VFLTR>::OW(); }
+	int	TW(int k)	{ return FILTERTB<VFLTR>::TW(k); }
+	int	TW(void) const	{ return FILTERTB<VFLTR>::TW(); }
+	int	NTAPS(int k)	{ return FILTERTB<VFLTR>::NTAPS(k); }
+	int  NTAPS(void) const	{ return FILTERTB<VFLTR>::NTAPS(); }
+	int	NUP(int k)	{ return m_nup = k; }
+	int  NUP(void) const	{ return m_nup; }
+	int	SHIFT(int k)	{ return m_shift = k; }
+	int  SHIFT(void) const	{ return m_shift; }
+	void	tick(void);
+	void	reset(void);
+
+	// Push zeros through the filter, to clear its memory
+	virtual	void	clear_filter(void);
+
+	// Send nlen samples through the filter, CKPCE clocks apart, and
+	// return the number of outputs placed into result.  result must
+	// have room for NUP*nlen outputs.
+	int	apply(int nlen, const int64_t *data, int64_t *result);
+	// As apply(), but starting from a reset and cleared filter
+	int	test(int nlen, const int64_t *data, int64_t *result);
+
+	// Our reference: what the filter should produce, given the taps
+	// last loaded.
+	void	model(int nlen, const int64_t *data, int64_t *result);
+
+	void	load(int  ntaps, int64_t *data);
+	int	operator[](const int tap);
+	void	testload(int nlen, int64_t *data);
+
+	// Compare the filter's output, bit for bit, against the model
+	bool	test_model(int nlen, const int64_t *data);
+
+	// Measure the worst image, in dB relative to the signal, produced
+	// from a full scale input sinusoid at freq cycles per input sample.
+	double	measure_images(double freq, double &gain);
+};
+
+#endif
@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	histwrapper.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	To wrap the AXI-lite version of histogram.v so that it can be
+//		driven by our Verilator test bench classes.  Those expect a
+//	clock named i_clk and an active high reset named i_reset, whereas the
+//	AXI-lite histogram uses S_AXI_ACLK and S_AXI_ARESETN.  The wrapper
+//	also picks a smaller histogram than the default, so that a simulation
+//	can run through many frames in a reasonable amount of time.
+//
+//	This file must be Verilated with AXILITE defined.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2017-2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	histwrapper #(
+		// {{{
+		parameter	NAVGS = 16384,
+		parameter	AW = 10,
+		localparam	DW = 32,
+		localparam	ADDRLSB = $clog2(DW/8)
+		// }}}
+	) (
+		// {{{
+		input	wire				i_clk, i_reset,
+		//
+		input	wire				S_AXI_AWVALID,
+		output	wire				S_AXI_AWREADY,
+		input	wire	[AW+ADDRLSB-1:0]	S_AXI_AWADDR,
+		input	wire	[2:0]			S_AXI_AWPROT,
+		//
+		input	wire				S_AXI_WVALID,
+		output	wire				S_AXI_WREADY,
+		input	wire	[DW-1:0]		S_AXI_WDATA,
+		input	wire	[DW/8-1:0]		S_AXI_WSTRB,
+		//
+		output	wire				S_AXI_BVALID,
+		input	wire				S_AXI_BREADY,
+		output	wire	[1:0]			S_AXI_BRESP,
+		//
+		input	wire 				S_AXI_ARVALID,
+		output	wire 				S_AXI_ARREADY,
+		input	wire [AW+ADDRLSB-1:0]		S_AXI_ARADDR,
+		input	wire	[2:0]			S_AXI_ARPROT,
+		//
+		output	wire				S_AXI_RVALID,
+		input	wire				S_AXI_RREADY,
+		output	wire	[DW-1:0]		S_AXI_RDATA,
+		output	wire	[1:0]			S_AXI_RRESP,
+		//
+		input	wire				i_ce,
+		input	wire	[AW-1:0]		i_sample,
+		//
+		output	wire				o_int,
+		//
+		output	wire	[31:0]			o_navgs,
+		output	wire	[31:0]			o_aw
+		// }}}
+	);
+
+	assign	o_navgs = NAVGS;
+	assign	o_aw    = AW;
+
+	// Instantiate the MUT: module under test
+	// {{{
+	histogram #(
+		// {{{
+		.NAVGS(NAVGS), .AW(AW)
+		// }}}
+	) hist (
+		// {{{
+		.S_AXI_ACLK(i_clk), .S_AXI_ARESETN(!i_reset),
+		//
+		.S_AXI_AWVALID(S_AXI_AWVALID), .S_AXI_AWREADY(S_AXI_AWREADY),
+		.S_AXI_AWADDR(S_AXI_AWADDR),   .S_AXI_AWPROT(S_AXI_AWPROT),
+		//
+		.S_AXI_WVALID(S_AXI_WVALID), .S_AXI_WREADY(S_AXI_WREADY),
+		.S_AXI_WDATA(S_AXI_WDATA),   .S_AXI_WSTRB(S_AXI_WSTRB),
+		//
+		.S_AXI_BVALID(S_AXI_BVALID), .S_AXI_BREADY(S_AXI_BREADY),
+		.S_AXI_BRESP(S_AXI_BRESP),
+		//
+		.S_AXI_ARVALID(S_AXI_ARVALID), .S_AXI_ARREADY(S_AXI_ARREADY),
+		.S_AXI_ARADDR(S_AXI_ARADDR),   .S_AXI_ARPROT(S_AXI_ARPROT),
+		//
+		.S_AXI_RVALID(S_AXI_RVALID), .S_AXI_RREADY(S_AXI_RREADY),
+		.S_AXI_RDATA(S_AXI_RDATA),   .S_AXI_RRESP(S_AXI_RRESP),
+		//
+		.i_ce(i_ce), .i_sample(i_sample),
+		.o_int(o_int)
+		// }}}
+	);
+	// }}}
+endmodule
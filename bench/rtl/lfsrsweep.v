@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	lfsrsweep.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	Instantiates lfsr, lfsr_fib, and lfsr_gal once for each entry
+//		in a table of maximal length (primitive) feedback polynomials,
+//	of lengths from 3 through 64 bits, so that all three implementations
+//	can be checked against each other and against a software model from a
+//	single Verilated model.
+//
+//	TAPS are given in the Fibonacci form used by lfsr_fib and lfsr.  The
+//	Galois implementation uses the bit reversed taps, and all three start
+//	from an INITIAL_FILL of only the MSB set.  With this fill, the Galois
+//	and Fibonacci outputs are identical, even while i_in is being used
+//	(see bench/formal/lfsr_equiv.v).  The table itself is available to the
+//	test bench as o_ln and o_taps.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	lfsrsweep #(
+		// {{{
+		parameter	WS = 8,		// Bits per clock, for lfsr.v
+		localparam	NCFG = 34	// Entries in our table
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset, i_ce,
+		input	wire	[NCFG-1:0]	i_in,
+		//
+		output	wire	[NCFG*WS-1:0]	o_word,
+		output	wire	[NCFG-1:0]	o_fib, o_gal,
+		//
+		output	wire	[NCFG*8-1:0]	o_ln,
+		output	wire	[NCFG*64-1:0]	o_taps,
+		output	wire	[31:0]		o_ws, o_ncfg
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	// Entry zero is in the least significant bits
+	localparam	[NCFG*8-1:0]	CFG_LN = {
+			8'd64, 8'd56, 8'd48, 8'd40,
+			8'd32, 8'd31, 8'd30, 8'd29, 8'd28, 8'd27, 8'd26, 8'd25,
+			8'd24, 8'd23, 8'd22, 8'd21, 8'd20, 8'd19, 8'd18, 8'd17,
+			8'd16, 8'd15, 8'd14, 8'd13, 8'd12, 8'd11, 8'd10, 8'd9,
+			8'd8,  8'd7,  8'd6,  8'd5,  8'd4,  8'd3 };
+
+	localparam	[NCFG*64-1:0]	CFG_TAPS = {
+			64'h0807, 64'h0400_0000_0007,
+			64'h1000_000b, 64'h08_0000_0007,
+			//
+			64'h0040_0007, 64'h0000_0009,	// 32, 31
+			64'h0080_0007, 64'h0000_0005,	// 30, 29
+			64'h0000_0009, 64'h0000_0027,	// 28, 27
+			64'h0000_0047, 64'h0000_0009,	// 26, 25
+			64'h0000_0087, 64'h0000_0021,	// 24, 23
+			64'h0000_0003, 64'h0000_0005,	// 22, 21
+			64'h0000_0009, 64'h0000_0027,	// 20, 19
+			64'h0000_0081, 64'h0000_0009,	// 18, 17
+			64'h0000_100b, 64'h0000_0003,	// 16, 15
+			64'h0000_1007, 64'h0000_0027,	// 14, 13
+			64'h0000_0107, 64'h0000_0005,	// 12, 11
+			64'h0000_0009, 64'h0000_0011,	// 10,  9
+			64'h0000_002d, 64'h0000_0003,	//  8,  7
+			64'h0000_0003, 64'h0000_0005,	//  6,  5
+			64'h0000_0003, 64'h0000_0003 };	//  4,  3
+
+	// bitrev
+	// {{{
+	// Reverse the bottom ln bits of v, converting Fibonacci taps to
+	// Galois taps
+	function automatic [63:0] bitrev(input [63:0] v, input integer ln);
+		// {{{
+		integer	ik;
+	begin
+		bitrev = 64'h0;
+		for(ik=0; ik<ln; ik=ik+1)
+			bitrev[ik] = v[ln-1-ik];
+	end endfunction
+	// }}}
+	// }}}
+	// }}}
+
+	assign	o_ln   = CFG_LN;
+	assign	o_taps = CFG_TAPS;
+	assign	o_ws   = WS;
+	assign	o_ncfg = NCFG;
+
+	genvar	gk;
+	generate for(gk=0; gk<NCFG; gk=gk+1)
+	begin : CFG
+		// {{{
+		localparam	integer		LN = { 24'h0, CFG_LN[8*gk +: 8] };
+		localparam	[63:0]		FIB_TAPS = CFG_TAPS[64*gk +: 64];
+		localparam	[63:0]		GAL_TAPS = bitrev(FIB_TAPS, LN);
+		localparam	[LN-1:0]	FILL = { 1'b1, {(LN-1){1'b0}} };
+
+		lfsr #(
+			.WS(WS), .LN(LN), .TAPS(FIB_TAPS[LN-1:0]),
+			.INITIAL_FILL(FILL)
+		) u_lfsr (
+			i_clk, i_reset, i_ce, o_word[WS*gk +: WS]
+		);
+
+		lfsr_fib #(
+			.LN(LN), .TAPS(FIB_TAPS[LN-1:0]), .INITIAL_FILL(FILL)
+		) u_fib (
+			i_clk, i_reset, i_ce, i_in[gk], o_fib[gk]
+		);
+
+		lfsr_gal #(
+			.LN(LN), .TAPS(GAL_TAPS[LN-1:0]), .INITIAL_FILL(FILL)
+		) u_gal (
+			i_clk, i_reset, i_ce, i_in[gk], o_gal[gk]
+		);
+		// }}}
+	end endgenerate
+endmodule
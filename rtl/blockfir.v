@@ -0,0 +1,243 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	blockfir.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A FIR filter for sample rates above the clock rate.  Where
+//		fastfir.v accepts one sample per clock, this filter accepts
+//	NLANES samples per clock, and produces NLANES outputs per clock in
+//	return.  The oldest sample of each block is found in the low order
+//	bits of i_sample, and likewise for o_result.
+//
+//	Split the taps and samples into NLANES phases, so that
+//	h_p[m] = h[NLANES*m+p] and x_q[n] = x[NLANES*n+q].  Then output lane j
+//	of block n is
+//
+//		y[NLANES*n+j] = SUM_m SUM_p h_p[m] * x[NLANES*(n-m) + j - p]
+//
+//	where a negative j-p reaches back into the block before.  For each
+//	lane, this is a transposed form filter running at the block rate, of
+//	(NTAPS+NLANES-1)/NLANES stages, where each stage adds NLANES products
+//	to the partial sum passed from the stage before.  Every lane uses the
+//	same taps, so there's only the one set of tap registers, loaded just
+//	like fastfir's: NTAPS writes of i_tap_wr, first coefficient first.
+//	There are, however, NLANES*NTAPS multiplies.
+//
+//	Each output block is available one block after its inputs, so the
+//	first output of an impulse arriving with block n appears with block
+//	n+1.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	blockfir #(
+		// {{{
+		parameter		NTAPS=128, IW=12, TW=IW, OW=2*IW+7,
+		// The number of samples per clock
+		parameter		NLANES=4,
+		parameter [0:0]		FIXED_TAPS=0,
+		// Used by FIXED_TAPS
+		parameter		INITIAL_COEFFS = "taps.hex",
+		//
+		localparam		NSTAGES = (NTAPS+NLANES-1)/NLANES,
+		localparam		PW = TW+IW	// Product width
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		//
+		input	wire			i_tap_wr,	// Ignored if FIXED_TAPS
+		input	wire	[(TW-1):0]	i_tap,		// Ignored if FIXED_TAPS
+		//
+		input	wire			i_ce,
+		input	wire	[(NLANES*IW-1):0]	i_sample,
+		output	wire	[(NLANES*OW-1):0]	o_result
+`ifdef	VERILATORTB
+		, output wire	[31:0]		o_NLANES,
+		output	wire	[31:0]		o_IW,
+		output	wire	[31:0]		o_OW
+`endif
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	reg	[(TW-1):0]		tap	[0:NTAPS-1];
+	reg	[(NLANES*IW-1):0]	last_block;
+	// chain[lane*(NSTAGES+1)+stage] is the partial sum leaving stage
+	// "stage" of lane "lane".  The last stage of each lane starts from zero.
+	wire	[(OW-1):0]	chain	[0:NLANES*(NSTAGES+1)-1];
+	integer			ik;
+	genvar			lane, stage, phase;
+	// }}}
+
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Coefficients
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	generate if (FIXED_TAPS)
+	begin : LOAD_TAPS
+		initial $readmemh(INITIAL_COEFFS, tap);
+
+		// Verilator lint_off UNUSED
+		wire	[TW:0]	unused_taps;
+		assign	unused_taps = { i_tap_wr, i_tap };
+		// Verilator lint_on  UNUSED
+	end else begin : GEN_TAP_UPDATES
+		initial for(ik=0; ik<NTAPS; ik=ik+1)
+			tap[ik] = 0;
+
+		// Taps shift in from the top, so that after NTAPS writes the
+		// first tap written is found in tap[0], just as the first tap
+		// written to fastfir ends up multiplying the newest sample
+		always @(posedge i_clk)
+		if (i_tap_wr)
+		begin
+			for(ik=0; ik<NTAPS-1; ik=ik+1)
+				tap[ik] <= tap[ik+1];
+			tap[NTAPS-1] <= i_tap;
+		end
+	end endgenerate
+	// }}}
+
+	// last_block
+	// {{{
+	// Lanes whose taps reach back past the start of the current block
+	// need the samples of the block before it
+	initial	last_block = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		last_block <= 0;
+	else if (i_ce)
+		last_block <= i_sample;
+	// }}}
+
+	////////////////////////////////////////////////////////////////////////
+	//
+	// The filter itself
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	generate for(lane=0; lane<NLANES; lane=lane+1)
+	begin : LANE
+		localparam	CBASE = lane*(NSTAGES+1);
+
+		assign	chain[CBASE+NSTAGES] = 0;
+
+		for(stage=0; stage<NSTAGES; stage=stage+1)
+		begin : STAGE
+			wire	[(NLANES*OW-1):0]	products;
+			reg	signed [(OW-1):0]	psum, acc;
+			integer				ip;
+
+			// The products of this stage, one per phase
+			// {{{
+			for(phase=0; phase<NLANES; phase=phase+1)
+			begin : PHASE
+				localparam	K = stage*NLANES + phase;
+
+				if (K >= NTAPS)
+				begin : NO_TAP
+					// Taps beyond the end of the filter are
+					// all zero
+					assign	products[phase*OW +: OW] = 0;
+
+				end else begin : GEN_PRODUCT
+					wire	signed [(IW-1):0]	sample;
+					reg	signed [(PW-1):0]	product;
+
+					if (phase <= lane)
+					begin : THIS_BLOCK
+						assign	sample = i_sample[(lane-phase)*IW +: IW];
+					end else begin : LAST_BLOCK
+						assign	sample = last_block[(lane-phase+NLANES)*IW +: IW];
+					end
+
+					initial	product = 0;
+					always @(posedge i_clk)
+					if (i_reset)
+						product <= 0;
+					else if (i_ce)
+						product <= $signed(tap[K]) * sample;
+
+					assign	products[phase*OW +: OW]
+						= { {(OW-PW){product[PW-1]}}, product };
+				end
+			end
+			// }}}
+
+			// Add this stage's products to the partial sum from
+			// the stage after, as fastfir's taps do
+			// {{{
+			always @(*)
+			begin
+				psum = chain[CBASE+stage+1];
+				for(ip=0; ip<NLANES; ip=ip+1)
+					psum = psum + products[ip*OW +: OW];
+			end
+
+			initial	acc = 0;
+			always @(posedge i_clk)
+			if (i_reset)
+				acc <= 0;
+			else if (i_ce)
+				acc <= psum;
+
+			assign	chain[CBASE+stage] = acc;
+			// }}}
+		end
+
+		assign	o_result[lane*OW +: OW] = chain[CBASE];
+	end endgenerate
+	// }}}
+
+`ifdef	VERILATORTB
+	assign	o_NLANES = NLANES;
+	assign	o_IW     = IW;
+	assign	o_OW     = OW;
+`endif
+
+	// Make verilator happy
+	// {{{
+	// The oldest sample of the last block is never needed
+	// verilator lint_off UNUSED
+	wire	[(IW-1):0]	unused;
+	assign	unused = last_block[(IW-1):0];
+	// verilator lint_on UNUSED
+	// }}}
+endmodule
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cfastfir.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A complex version of fastfir.v: a high speed (1-output per
+//		clock), adjustable tap FIR, whose input and output samples are
+//	complex.  Both are packed as { real, imaginary } into one word.
+//
+//	With OPT_CTAPS clear, the taps are real, and so the filter acts on
+//	the real and imaginary halves of its input separately--just as two
+//	fastfir's would, but from one set of taps, loaded once.  With
+//	OPT_CTAPS set, each tap is complex, also packed as { real, imaginary },
+//	and its product requires either four multiplies or, with OPT_3MPY,
+//	three.  See cmpy.v.
+//
+//	Taps are loaded as with fastfir, one tap per i_tap_wr, so that the
+//	impulse response matches the order the taps were written in.
+//
+//	The default OW is one bit wider than fastfir's, since the imaginary
+//	part of a complex product, ad+bc, may reach 2^(IW+TW-1) when all four
+//	parts are at their most negative.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	cfastfir #(
+		// {{{
+		parameter		NTAPS=128, IW=12, TW=IW, OW=2*IW+8,
+		parameter [0:0]		FIXED_TAPS=0,
+		// Complex taps, rather than real ones
+		parameter [0:0]		OPT_CTAPS=1'b1,
+		// Use three multiplies per complex tap, rather than four
+		parameter [0:0]		OPT_3MPY=1'b0,
+		localparam		CTW = OPT_CTAPS ? 2*TW : TW
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		//
+		input	wire			i_tap_wr,	// Ignored if FIXED_TAPS
+		input	wire	[(CTW-1):0]	i_tap,		// Ignored if FIXED_TAPS
+		//
+		input	wire			i_ce,
+		input	wire	[(2*IW-1):0]	i_sample,
+		output	wire	[(2*OW-1):0]	o_result
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	wire	[(CTW-1):0]	tap		[NTAPS:0];
+	wire	[(CTW-1):0]	tapout		[NTAPS:0];
+	wire	[(2*IW-1):0]	sample		[NTAPS:0];
+	wire	[(2*OW-1):0]	result		[NTAPS:0];
+	wire			tap_wr;
+	genvar	k;
+	// }}}
+
+	// The first sample in our sample chain is the sample we are given
+	assign	sample[0]	= i_sample;
+	// Initialize the partial summing accumulator with zero
+	assign	result[0]	= 0;
+
+	// Initialize coefficients
+	// {{{
+	generate if(FIXED_TAPS)
+	begin : LOAD_TAPS
+		initial $readmemh("taps.hex", tap);
+
+		assign	tap_wr = 1'b0;
+	end else begin : GEN_TAP_UPDATES
+		assign	tap_wr = i_tap_wr;
+		assign	tap[0] = i_tap;
+	end endgenerate
+	// }}}
+
+	assign	tapout[0] = 0;
+
+	generate for(k=0; k<NTAPS; k=k+1)
+	begin: FILTER
+
+		cfirtap #(
+			// {{{
+			.FIXED_TAPS(FIXED_TAPS),
+				.IW(IW), .OW(OW), .TW(TW),
+				.OPT_CTAPS(OPT_CTAPS), .OPT_3MPY(OPT_3MPY),
+				.INITIAL_VALUE(0)
+			// }}}
+		) tapk(
+			// {{{
+			i_clk, i_reset,
+			// Tap update circuitry
+			tap_wr, tap[k], tapout[k+1],
+			// Sample delay line
+				// We'll let the optimizer trim away sample[k+1]
+			i_ce, sample[0], sample[k+1],
+			// The output accumulator
+			result[k], result[k+1]
+			// }}}
+		);
+
+		if (!FIXED_TAPS)
+		begin : FORWARD_TAP
+			assign	tap[k+1] = tapout[k+1];
+		end
+
+		// Make verilator happy
+		// {{{
+		// verilator lint_off UNUSED
+		wire	[(CTW-1):0]	unused_tap;
+		if (FIXED_TAPS)
+		begin : UNUSED_TAP
+			assign	unused_tap    = tapout[k+1];
+		end
+		// verilator lint_on UNUSED
+		// }}}
+	end endgenerate
+
+	assign	o_result = result[NTAPS];
+
+	// Make verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	[CTW:0]	unused;
+	assign	unused = { i_tap_wr, i_tap };
+	// verilator lint_on UNUSED
+	// }}}
+endmodule
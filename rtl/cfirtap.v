@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cfirtap.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A single tap within a complex FIR filter, such as cfastfir.v.
+//		This is firtap.v, only the samples and the partial sums are
+//	now complex, packed as { real, imaginary }.  The tap itself may be
+//	either real or complex (OPT_CTAPS), and is multiplied with the sample
+//	by cmpy.v.  As with firtap, the taps are strung together from one
+//	cfirtap to the next, so that a single chain of tap registers serves
+//	both the real and imaginary halves of the filter.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	cfirtap #(
+		// {{{
+		parameter		IW=16, TW=IW, OW=IW+TW+8,
+		parameter [0:0]		FIXED_TAPS=0,
+		parameter [0:0]		OPT_CTAPS=1'b1,
+		parameter [0:0]		OPT_3MPY=1'b0,
+		localparam		CTW = OPT_CTAPS ? 2*TW : TW,
+		parameter [(CTW-1):0]	INITIAL_VALUE=0
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		// Coefficient setting/handling
+		// {{{
+		input	wire			i_tap_wr,
+		input	wire	[(CTW-1):0]	i_tap,
+		output	wire	[(CTW-1):0]	o_tap,
+		// }}}
+		// Data pipeline
+		// {{{
+		input	wire			i_ce,
+		input	wire	[(2*IW-1):0]	i_sample,
+		output	reg	[(2*IW-1):0]	o_sample,
+		// }}}
+		// Output "results"
+		// {{{
+		input	wire	[(2*OW-1):0]	i_partial_acc,
+		output	reg	[(2*OW-1):0]	o_acc
+		// }}}
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	localparam		PW = IW+TW+(OPT_CTAPS ? 1:0);
+
+	reg		[(2*IW-1):0]	delayed_sample;
+	wire		[(CTW-1):0]	active_tap;
+	wire	signed	[(PW-1):0]	product_re, product_im;
+	wire	signed	[(OW-1):0]	partial_re, partial_im;
+	// }}}
+
+	// Determine the tap we are using
+	// {{{
+	generate if (FIXED_TAPS != 0)
+	begin : NO_TAP_UPDATES
+		// If our taps are fixed, the tap is given by the i_tap
+		// external input, as with firtap.v
+		assign	o_tap = i_tap;
+		assign	active_tap = i_tap;
+	end else begin : GEN_TAP_UPDATE_LOGIC
+		// Otherwise, i_tap_wr shifts every tap forward by one
+		reg	[(CTW-1):0]	tap;
+
+		initial	tap = INITIAL_VALUE;
+		always @(posedge i_clk)
+		if (i_tap_wr)
+			tap <= i_tap;
+		assign o_tap = tap;
+		assign active_tap = tap;
+	end endgenerate
+	// }}}
+
+	// o_sample, delayed_sample
+	// {{{
+	// Forward the sample on down the line, with the same two sample delay
+	// as firtap.v
+	initial	o_sample = 0;
+	initial	delayed_sample = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		delayed_sample <= 0;
+		o_sample <= 0;
+	end else if (i_ce)
+	begin
+		delayed_sample <= i_sample;
+		o_sample <= delayed_sample;
+	end
+	// }}}
+
+	// Multiply the filter tap by the incoming sample
+	// {{{
+	cmpy #(
+		.IW(IW), .TW(TW), .OPT_CTAPS(OPT_CTAPS), .OPT_3MPY(OPT_3MPY)
+	) mpy(
+		i_clk, i_reset, i_ce, i_sample, active_tap,
+		product_re, product_im
+	);
+	// }}}
+
+	// Continue summing together the output components of the FIR filter
+	// {{{
+	assign	{ partial_re, partial_im } = i_partial_acc;
+
+	initial	o_acc = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		o_acc <= 0;
+	else if (i_ce)
+		o_acc <= {
+			partial_re + { {(OW-PW){product_re[PW-1]}}, product_re },
+			partial_im + { {(OW-PW){product_im[PW-1]}}, product_im } };
+	// }}}
+
+	// Make verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	unused;
+	assign	unused = i_tap_wr;
+	// verilator lint_on  UNUSED
+	// }}}
+endmodule
@@ -0,0 +1,417 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cicdecim.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A cascaded integrator comb (CIC) decimator.  This is the
+//		boxcar.v running sum, y[n] = y[n-1] + x[n] - x[n-RM], split
+//	into its two halves and repeated NSTAGES times.  The integrators run
+//	at the input rate, and the combs at the output rate, so no multiplies
+//	are required at all, no matter how large the decimation rate is.
+//
+//	Transfer function:
+//		H(z) = [ (1 - z^{-RM}) / (1 - z^{-1}) ]^N
+//
+//		where R is the decimation rate, M the differential delay
+//		(DIFFDELAY), and N the number of stages (NSTAGES).
+//
+//	The full precision of such a filter requires BW = IW+N*log2(RM) bits.
+//	However, as Hogenauer showed, many of the least significant bits of
+//	the later stages may be dropped without adding more noise than the
+//	final truncation to OW bits will add anyway.  The number of bits
+//	dropped at the input of each stage is given by the PRUNE parameter,
+//	eight bits per stage, with the first integrator in the least
+//	significant bits and the last comb in the most significant.  These
+//	values can be calculated by CICMODEL::hogenauer() in
+//	bench/cpp/cicmodel.cpp.  Since the later stages add less noise at
+//	higher rates, PRUNE should be calculated for the slowest rate the
+//	core will be used with.  The default, zero, prunes nothing.  Since
+//	the dropped bits are truncated, a pruned CIC will also have a small
+//	DC offset to it--a couple of output LSBs, negative, in practice.
+//
+//	Both the rate, R = i_rate+1, and the output shift, i_shift, are set
+//	while i_reset is high, as with boxcar.v.  The full precision result is
+//	shifted left by i_shift, then rounded and saturated to OW bits.  At a
+//	rate of R, a shift of N*log2(2^LGMAXRATE/R) will keep the gain
+//	between one half and one.
+//
+//	If OPT_COMPFIR is set, the output of the CIC is then filtered by a
+//	slowfil.v, to compensate for the droop in the CIC's passband.  The
+//	compensation filter's coefficients are loaded via i_tap_wr and i_tap,
+//	or read from COMP_COEFFS if FIXED_COMP is set.  A coefficient of
+//	2^(CTW-1) has a gain of one.  Like slowfil, the compensation filter's
+//	output is that of the sample before, and it requires NCTAPS clocks
+//	between CIC outputs.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+//
+// }}}
+module	cicdecim #(
+		// {{{
+		parameter	IW = 16,	// Input bit width
+		parameter	OW = 16,	// Output bit width
+		parameter	NSTAGES = 5,	// N, the number of stages
+		parameter	LGMAXRATE = 14,	// Max rate of R = 2^LGMAXRATE
+		parameter	DIFFDELAY = 1,	// M, the differential delay
+		localparam	BW = IW+NSTAGES*(LGMAXRATE+$clog2(DIFFDELAY)),
+		localparam	LGSHIFT = $clog2(BW),
+		//
+		// Bits dropped at the input of each stage, eight bits per stage
+		parameter [16*NSTAGES-1:0]	PRUNE = 0,
+		//
+		// The optional compensation filter
+		parameter [0:0]	OPT_COMPFIR = 1'b0,
+		parameter	LGCTAPS = 5,
+		parameter	NCTAPS = 31,
+		parameter	CTW = 16,
+		parameter [0:0]	FIXED_COMP = 1'b0,
+		parameter	COMP_COEFFS = ""
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+`ifdef	VERILATORTB
+		output	wire	[31:0]		o_IW,
+		output	wire	[31:0]		o_OW,
+		output	wire	[31:0]		o_NSTAGES,
+		output	wire	[31:0]		o_LGMAXRATE,
+		output	wire	[31:0]		o_DIFFDELAY,
+		output	wire	[31:0]		o_NCTAPS,
+		output	wire	[31:0]		o_CTW,
+		input	wire	[7:0]		i_stage,
+		output	wire	[7:0]		o_prune,
+`endif
+		// Rate and gain, both set during reset
+		// {{{
+		input	wire	[LGMAXRATE-1:0]	i_rate,
+		input	wire	[LGSHIFT-1:0]	i_shift,
+		// }}}
+		// Compensation filter coefficients
+		// {{{
+		input	wire			i_tap_wr,
+		input	wire	[CTW-1:0]	i_tap,
+		// }}}
+		input	wire			i_ce,
+		input	wire	[IW-1:0]	i_sample,
+		//
+		output	wire			o_ce,
+		output	wire	[OW-1:0]	o_result
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	reg	[LGMAXRATE-1:0]	r_rate, count;
+	reg	[LGSHIFT-1:0]	r_shift;
+	reg			dec_ce;
+
+	wire	[BW-1:0]	xin;
+	// Every stage's output, scaled back up to BW bits so that the LSB
+	// always has the same weight
+	wire	[BW-1:0]	sv	[0:2*NSTAGES-1];
+	wire	[NSTAGES:0]	comb_ce;
+
+	wire	signed	[BW-1:0]	cic_out, prerounded;
+	wire	[BW-1:0]		rounded_result;
+	wire				sgn, overflow;
+	reg				cic_ce;
+	reg	[OW-1:0]		cic_result;
+
+`ifdef	VERILATORTB
+	assign	o_IW        = IW;
+	assign	o_OW        = OW;
+	assign	o_NSTAGES   = NSTAGES;
+	assign	o_LGMAXRATE = LGMAXRATE;
+	assign	o_DIFFDELAY = DIFFDELAY;
+	assign	o_NCTAPS    = (OPT_COMPFIR) ? NCTAPS : 0;
+	assign	o_CTW       = CTW;
+	assign	o_prune     = PRUNE[8*i_stage +: 8];
+`endif
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Rate and shift, set during reset
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	initial	r_rate  = 0;
+	initial	r_shift = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		r_rate  <= i_rate;
+		r_shift <= i_shift;
+	end
+
+	// Produce an output on every R'th input, starting with the first
+	initial	count = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		count <= 0;
+	else if (i_ce)
+	begin
+		if (count == 0)
+			count <= r_rate;
+		else
+			count <= count - 1'b1;
+	end
+
+	// dec_ce is true when the last integrator holds a value for the combs
+	initial	dec_ce = 1'b0;
+	always @(posedge i_clk)
+		dec_ce <= !i_reset && i_ce && (count == 0);
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Integrators, at the input rate
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	xin = { {(BW-IW){i_sample[IW-1]}}, i_sample };
+
+	genvar	gk;
+	generate for(gk=0; gk<NSTAGES; gk=gk+1)
+	begin : INTEGRATOR
+		// {{{
+		localparam [7:0]	P = PRUNE[8*gk +: 8];
+		localparam		W = BW - P;
+
+		wire	[W-1:0]		in_val;
+		reg	[W-1:0]		r_int;
+		wire	[BW:0]		ext;
+
+		if (gk == 0)
+		begin : FIRST
+			assign	in_val = xin[BW-1:P];
+		end else begin : NEXT
+			assign	in_val = sv[gk-1][BW-1:P];
+		end
+
+		initial	r_int = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			r_int <= 0;
+		else if (i_ce)
+			r_int <= r_int + in_val;
+
+		assign	ext = { r_int, {(P+1){1'b0}} };
+		assign	sv[gk] = ext[BW:1];
+
+		// Verilator lint_off UNUSED
+		wire	unused_ext;
+		assign	unused_ext = ext[0];
+		// Verilator lint_on  UNUSED
+		// }}}
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Combs, at the output rate
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	comb_ce[0] = dec_ce;
+
+	generate for(gk=0; gk<NSTAGES; gk=gk+1)
+	begin : COMB
+		// {{{
+		localparam [7:0]	P = PRUNE[8*(NSTAGES+gk) +: 8];
+		localparam		W = BW - P;
+
+		wire	[W-1:0]		in_val;
+		reg	[W-1:0]		r_comb;
+		reg	[W-1:0]		dly	[0:DIFFDELAY-1];
+		reg			r_ce;
+		wire	[BW:0]		ext;
+		integer			ik;
+
+		assign	in_val = sv[NSTAGES+gk-1][BW-1:P];
+
+		initial	r_comb = 0;
+		initial	for(ik=0; ik<DIFFDELAY; ik=ik+1)
+			dly[ik] = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+		begin
+			r_comb <= 0;
+			for(ik=0; ik<DIFFDELAY; ik=ik+1)
+				dly[ik] <= 0;
+		end else if (comb_ce[gk])
+		begin
+			r_comb <= in_val - dly[DIFFDELAY-1];
+			dly[0] <= in_val;
+			for(ik=1; ik<DIFFDELAY; ik=ik+1)
+				dly[ik] <= dly[ik-1];
+		end
+
+		initial	r_ce = 1'b0;
+		always @(posedge i_clk)
+			r_ce <= !i_reset && comb_ce[gk];
+
+		assign	comb_ce[gk+1] = r_ce;
+
+		assign	ext = { r_comb, {(P+1){1'b0}} };
+		assign	sv[NSTAGES+gk] = ext[BW:1];
+
+		// Verilator lint_off UNUSED
+		wire	unused_ext;
+		assign	unused_ext = ext[0];
+		// Verilator lint_on  UNUSED
+		// }}}
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Shift, round, and saturate the result to OW bits
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	cic_out    = sv[2*NSTAGES-1];
+	assign	sgn        = cic_out[BW-1];
+	assign	prerounded = cic_out << r_shift;
+	assign	rounded_result = prerounded
+				+ { {(OW){1'b0}}, prerounded[BW-OW-1],
+					{(BW-OW-1){!prerounded[BW-OW-1]}} };
+
+	// We overflow if either the shift loses any bits, or if rounding a
+	// positive number makes it negative
+	assign	overflow = ((prerounded >>> r_shift) != cic_out)
+				|| (!sgn && rounded_result[BW-1]);
+
+	initial	cic_ce = 1'b0;
+	always @(posedge i_clk)
+		cic_ce <= !i_reset && comb_ce[NSTAGES];
+
+	initial	cic_result = 0;
+	always @(posedge i_clk)
+	if (comb_ce[NSTAGES])
+	begin
+		if (overflow)
+			cic_result <= (sgn) ? { 1'b1, {(OW-1){1'b0}} }
+					: { 1'b0, {(OW-1){1'b1}} };
+		else
+			cic_result <= rounded_result[BW-1:BW-OW];
+	end
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Optional compensation filter
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	generate if (OPT_COMPFIR)
+	begin : COMPENSATION
+		// {{{
+		localparam	FW = OW+CTW+LGCTAPS;
+
+		wire			fir_ce;
+		wire	[FW-1:0]	fir_result, fir_rounded;
+		wire	[FW-CTW:0]	fir_shifted;
+		wire			fir_overflow;
+		reg			r_ce;
+		reg	[OW-1:0]	r_result;
+
+		slowfil #(
+			// {{{
+			.LGNTAPS(LGCTAPS), .IW(OW), .TW(CTW), .OW(FW),
+			.NTAPS(NCTAPS),
+			.FIXED_TAPS(FIXED_COMP), .INITIAL_COEFFS(COMP_COEFFS)
+			// }}}
+		) compfil (
+			// {{{
+			.i_clk(i_clk), .i_reset(i_reset),
+			.i_tap_wr(i_tap_wr), .i_tap(i_tap), .i_tap_commit(1'b0),
+			.i_ce(cic_ce), .i_sample(cic_result),
+			.o_ce(fir_ce), .o_result(fir_result)
+			// }}}
+		);
+
+		// Round away the CTW-1 bits of coefficient scaling
+		assign	fir_rounded = fir_result
+			+ { {(FW-CTW+1){1'b0}}, 1'b1, {(CTW-2){1'b0}} };
+		assign	fir_shifted = fir_rounded[FW-1:CTW-1];
+		assign	fir_overflow = (|fir_shifted[FW-CTW:OW-1])
+					&& !(&fir_shifted[FW-CTW:OW-1]);
+
+		initial	r_ce = 1'b0;
+		always @(posedge i_clk)
+			r_ce <= !i_reset && fir_ce;
+
+		initial	r_result = 0;
+		always @(posedge i_clk)
+		if (fir_ce)
+		begin
+			if (fir_overflow)
+				r_result <= (fir_shifted[FW-CTW])
+					? { 1'b1, {(OW-1){1'b0}} }
+					: { 1'b0, {(OW-1){1'b1}} };
+			else
+				r_result <= fir_shifted[OW-1:0];
+		end
+
+		assign	o_ce     = r_ce;
+		assign	o_result = r_result;
+
+		// Verilator lint_off UNUSED
+		wire	unused_fir;
+		assign	unused_fir = &{ 1'b0, fir_rounded[CTW-2:0] };
+		// Verilator lint_on  UNUSED
+		// }}}
+	end else begin : NO_COMPENSATION
+		// {{{
+		assign	o_ce     = cic_ce;
+		assign	o_result = cic_result;
+
+		// Verilator lint_off UNUSED
+		wire	unused_taps;
+		assign	unused_taps = &{ 1'b0, i_tap_wr, i_tap };
+		// Verilator lint_on  UNUSED
+		// }}}
+	end endgenerate
+	// }}}
+
+	// Make Verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	unused;
+	assign	unused = &{ 1'b0, rounded_result[BW-OW-1:0] };
+	// verilator lint_on  UNUSED
+	// }}}
+endmodule
@@ -0,0 +1,392 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cicinterp.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A cascaded integrator comb (CIC) interpolator, the
+//		counterpart to cicdecim.v.  NSTAGES combs run at the input rate.
+//	R-1 zeros are then inserted after every comb output, and the result is
+//	integrated NSTAGES times at the output rate.
+//
+//	Transfer function:
+//		H(z) = [ (1 - z^{-RM}) / (1 - z^{-1}) ]^N
+//
+//		where R is the interpolation rate, M the differential delay
+//	(DIFFDELAY), and N the number of stages (NSTAGES).
+//
+//	Unlike the decimator, no bits may be dropped from an interpolator's
+//	integrators without the error growing without bound.  Instead, each
+//	stage is given only as many bits as its own maximum gain requires, as
+//	Hogenauer describes.  The combs grow by one bit each, to IW+N bits.
+//	Integrator j, counting from one, has a gain of 2^(N-j)(RM)^j/R, for
+//	a final width of BW = IW+N*log2(RM)-log2(R) bits at the maximum rate.
+//
+//	Both the rate, R = i_rate+1, and the output shift, i_shift, are set
+//	while i_reset is high, as with boxcar.v.  The result is shifted left by
+//	i_shift, then rounded and saturated to OW bits.
+//
+//	Every input produces R outputs, one per clock, so there must be at
+//	least R clocks between input samples.
+//
+//	If OPT_COMPFIR is set, the input is first filtered by a slowfil.v, to
+//	compensate for the droop in the CIC's passband.  A coefficient of
+//	2^(CTW-1) has a gain of one, and the filtered result is rounded and
+//	saturated back to IW bits.  As with slowfil, each filtered sample is
+//	that of the sample before, and there must then also be at least
+//	NCTAPS clocks between input samples.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+//
+// }}}
+module	cicinterp #(
+		// {{{
+		parameter	IW = 16,	// Input bit width
+		parameter	OW = 16,	// Output bit width
+		parameter	NSTAGES = 4,	// N, the number of stages
+		parameter	LGMAXRATE = 10,	// Max rate of R = 2^LGMAXRATE
+		parameter	DIFFDELAY = 1,	// M, the differential delay
+		localparam	GROWTH = LGMAXRATE+$clog2(DIFFDELAY),
+		localparam	BW = IW+NSTAGES*GROWTH-LGMAXRATE,
+		localparam	LGSHIFT = $clog2(BW),
+		//
+		// The optional compensation filter
+		parameter [0:0]	OPT_COMPFIR = 1'b0,
+		parameter	LGCTAPS = 5,
+		parameter	NCTAPS = 31,
+		parameter	CTW = 16,
+		parameter [0:0]	FIXED_COMP = 1'b0,
+		parameter	COMP_COEFFS = ""
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+`ifdef	VERILATORTB
+		output	wire	[31:0]		o_IW,
+		output	wire	[31:0]		o_OW,
+		output	wire	[31:0]		o_NSTAGES,
+		output	wire	[31:0]		o_LGMAXRATE,
+		output	wire	[31:0]		o_DIFFDELAY,
+		output	wire	[31:0]		o_NCTAPS,
+		output	wire	[31:0]		o_CTW,
+`endif
+		// Rate and gain, both set during reset
+		// {{{
+		input	wire	[LGMAXRATE-1:0]	i_rate,
+		input	wire	[LGSHIFT-1:0]	i_shift,
+		// }}}
+		// Compensation filter coefficients
+		// {{{
+		input	wire			i_tap_wr,
+		input	wire	[CTW-1:0]	i_tap,
+		// }}}
+		input	wire			i_ce,
+		input	wire	[IW-1:0]	i_sample,
+		//
+		output	reg			o_ce,
+		output	reg	[OW-1:0]	o_result
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	reg	[LGMAXRATE-1:0]	r_rate, count;
+	reg	[LGSHIFT-1:0]	r_shift;
+
+	wire			cin_ce;
+	wire	[IW-1:0]	cin_val;
+
+	// Every stage's output, sign extended to BW+1 bits
+	wire	[BW:0]		sv	[0:2*NSTAGES-1];
+	wire	[NSTAGES:0]	comb_ce;
+	wire			int_ce;
+	reg			r_ce;
+
+	wire	signed	[BW-1:0]	int_out, prerounded;
+	wire	[BW-1:0]		rounded_result;
+	wire				sgn, overflow;
+
+`ifdef	VERILATORTB
+	assign	o_IW        = IW;
+	assign	o_OW        = OW;
+	assign	o_NSTAGES   = NSTAGES;
+	assign	o_LGMAXRATE = LGMAXRATE;
+	assign	o_DIFFDELAY = DIFFDELAY;
+	assign	o_NCTAPS    = (OPT_COMPFIR) ? NCTAPS : 0;
+	assign	o_CTW       = CTW;
+`endif
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Rate and shift, set during reset
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	initial	r_rate  = 0;
+	initial	r_shift = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		r_rate  <= i_rate;
+		r_shift <= i_shift;
+	end
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Optional compensation filter
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	generate if (OPT_COMPFIR)
+	begin : COMPENSATION
+		// {{{
+		localparam	FW = IW+CTW+LGCTAPS;
+
+		wire			fir_ce;
+		wire	[FW-1:0]	fir_result, fir_rounded;
+		wire	[FW-CTW:0]	fir_shifted;
+		wire			fir_overflow;
+		reg			r_fir_ce;
+		reg	[IW-1:0]	r_fir_result;
+
+		slowfil #(
+			// {{{
+			.LGNTAPS(LGCTAPS), .IW(IW), .TW(CTW), .OW(FW),
+			.NTAPS(NCTAPS),
+			.FIXED_TAPS(FIXED_COMP), .INITIAL_COEFFS(COMP_COEFFS)
+			// }}}
+		) compfil (
+			// {{{
+			.i_clk(i_clk), .i_reset(i_reset),
+			.i_tap_wr(i_tap_wr), .i_tap(i_tap), .i_tap_commit(1'b0),
+			.i_ce(i_ce), .i_sample(i_sample),
+			.o_ce(fir_ce), .o_result(fir_result)
+			// }}}
+		);
+
+		// Round away the CTW-1 bits of coefficient scaling
+		assign	fir_rounded = fir_result
+			+ { {(FW-CTW+1){1'b0}}, 1'b1, {(CTW-2){1'b0}} };
+		assign	fir_shifted = fir_rounded[FW-1:CTW-1];
+		assign	fir_overflow = (|fir_shifted[FW-CTW:IW-1])
+					&& !(&fir_shifted[FW-CTW:IW-1]);
+
+		initial	r_fir_ce = 1'b0;
+		always @(posedge i_clk)
+			r_fir_ce <= !i_reset && fir_ce;
+
+		initial	r_fir_result = 0;
+		always @(posedge i_clk)
+		if (fir_ce)
+		begin
+			if (fir_overflow)
+				r_fir_result <= (fir_shifted[FW-CTW])
+					? { 1'b1, {(IW-1){1'b0}} }
+					: { 1'b0, {(IW-1){1'b1}} };
+			else
+				r_fir_result <= fir_shifted[IW-1:0];
+		end
+
+		assign	cin_ce  = r_fir_ce;
+		assign	cin_val = r_fir_result;
+
+		// Verilator lint_off UNUSED
+		wire	unused_fir;
+		assign	unused_fir = &{ 1'b0, fir_rounded[CTW-2:0] };
+		// Verilator lint_on  UNUSED
+		// }}}
+	end else begin : NO_COMPENSATION
+		// {{{
+		assign	cin_ce  = i_ce;
+		assign	cin_val = i_sample;
+
+		// Verilator lint_off UNUSED
+		wire	unused_taps;
+		assign	unused_taps = &{ 1'b0, i_tap_wr, i_tap };
+		// Verilator lint_on  UNUSED
+		// }}}
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Combs, at the input rate
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	comb_ce[0] = cin_ce;
+
+	genvar	gk;
+	generate for(gk=0; gk<NSTAGES; gk=gk+1)
+	begin : COMB
+		// {{{
+		localparam	W = IW + gk + 1;
+
+		wire	[W-1:0]		in_val;
+		reg	[W-1:0]		r_comb;
+		reg	[W-1:0]		dly	[0:DIFFDELAY-1];
+		reg			r_comb_ce;
+		integer			ik;
+
+		if (gk == 0)
+		begin : FIRST
+			assign	in_val = { cin_val[IW-1], cin_val };
+		end else begin : NEXT
+			assign	in_val = sv[gk-1][W-1:0];
+		end
+
+		initial	r_comb = 0;
+		initial	for(ik=0; ik<DIFFDELAY; ik=ik+1)
+			dly[ik] = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+		begin
+			r_comb <= 0;
+			for(ik=0; ik<DIFFDELAY; ik=ik+1)
+				dly[ik] <= 0;
+		end else if (comb_ce[gk])
+		begin
+			r_comb <= in_val - dly[DIFFDELAY-1];
+			dly[0] <= in_val;
+			for(ik=1; ik<DIFFDELAY; ik=ik+1)
+				dly[ik] <= dly[ik-1];
+		end
+
+		initial	r_comb_ce = 1'b0;
+		always @(posedge i_clk)
+			r_comb_ce <= !i_reset && comb_ce[gk];
+
+		assign	comb_ce[gk+1] = r_comb_ce;
+		assign	sv[gk] = { {(BW+1-W){r_comb[W-1]}}, r_comb };
+		// }}}
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Integrators, at the output rate
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Each comb output is followed by R-1 zeros
+	//
+	initial	count = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		count <= 0;
+	else if (comb_ce[NSTAGES])
+		count <= r_rate;
+	else if (count != 0)
+		count <= count - 1'b1;
+
+	assign	int_ce = comb_ce[NSTAGES] || (count != 0);
+
+	generate for(gk=0; gk<NSTAGES; gk=gk+1)
+	begin : INTEGRATOR
+		// {{{
+		localparam	W = IW + (NSTAGES-1-gk) + (gk+1)*GROWTH
+								- LGMAXRATE;
+
+		wire	[W-1:0]		in_val;
+		reg	[W-1:0]		r_int;
+
+		if (gk == 0)
+		begin : FIRST
+			assign	in_val = (comb_ce[NSTAGES])
+					? sv[NSTAGES-1][W-1:0] : {(W){1'b0}};
+		end else begin : NEXT
+			assign	in_val = sv[NSTAGES+gk-1][W-1:0];
+		end
+
+		initial	r_int = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			r_int <= 0;
+		else if (int_ce)
+			r_int <= r_int + in_val;
+
+		assign	sv[NSTAGES+gk] = { {(BW+1-W){r_int[W-1]}}, r_int };
+		// }}}
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Shift, round, and saturate the result to OW bits
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	int_out    = sv[2*NSTAGES-1][BW-1:0];
+	assign	sgn        = int_out[BW-1];
+	assign	prerounded = int_out << r_shift;
+	assign	rounded_result = prerounded
+				+ { {(OW){1'b0}}, prerounded[BW-OW-1],
+					{(BW-OW-1){!prerounded[BW-OW-1]}} };
+
+	// We overflow if either the shift loses any bits, or if rounding a
+	// positive number makes it negative
+	assign	overflow = ((prerounded >>> r_shift) != int_out)
+				|| (!sgn && rounded_result[BW-1]);
+
+	// r_ce is true when the last integrator holds a new output
+	initial	r_ce = 1'b0;
+	always @(posedge i_clk)
+		r_ce <= !i_reset && int_ce;
+
+	initial	o_ce = 1'b0;
+	always @(posedge i_clk)
+		o_ce <= !i_reset && r_ce;
+
+	initial	o_result = 0;
+	always @(posedge i_clk)
+	if (r_ce)
+	begin
+		if (overflow)
+			o_result <= (sgn) ? { 1'b1, {(OW-1){1'b0}} }
+					: { 1'b0, {(OW-1){1'b1}} };
+		else
+			o_result <= rounded_result[BW-1:BW-OW];
+	end
+	// }}}
+
+	// Make Verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	unused;
+	assign	unused = &{ 1'b0, rounded_result[BW-OW-1:0],
+				sv[2*NSTAGES-1][BW] };
+	// verilator lint_on  UNUSED
+	// }}}
+endmodule
@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cmpy.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	The product stage of the complex filters, cfirtap.v (and so
+//		cfastfir.v) and cslowfil.v.  Multiplies a complex sample by
+//	either a real tap (OPT_CTAPS=0), or a complex one (OPT_CTAPS=1).
+//	Complex values are packed with the real part in the high order bits,
+//	{ real, imaginary }.
+//
+//	A complex tap normally requires four multiplies,
+//
+//		(a+jb)(c+jd) = (ac - bd) + j(ad + bc)
+//
+//	With OPT_3MPY, the same result is found from three multiplies and
+//	three pre-adds, at the cost of one more bit into each multiply,
+//
+//		k1 = c(a+b),	k2 = a(d-c),	k3 = b(c+d)
+//		(a+jb)(c+jd) = (k1 - k3) + j(k1 + k2)
+//
+//	Either way, the products are registered on i_ce.  The final sums,
+//	ac-bd and ad+bc (or k1-k3 and k1+k2), are then formed here,
+//	combinatorially from those registers, so o_re and o_im hold the full
+//	complex product on the clock following i_ce.  The result is the same,
+//	bit for bit, with or without OPT_3MPY.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	cmpy #(
+		// {{{
+		parameter		IW=12, TW=IW,
+		// Complex taps, rather than real ones
+		parameter [0:0]		OPT_CTAPS = 1'b1,
+		// Use three multiplies per complex tap, rather than four
+		parameter [0:0]		OPT_3MPY = 1'b0,
+		localparam		CTW = OPT_CTAPS ? 2*TW : TW,
+		localparam		PW = IW+TW+(OPT_CTAPS ? 1:0)
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset, i_ce,
+		input	wire	[(2*IW-1):0]	i_sample,
+		input	wire	[(CTW-1):0]	i_tap,
+		output	wire signed [(PW-1):0]	o_re, o_im
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	wire	signed	[(IW-1):0]	a, b;
+
+	assign	{ a, b } = i_sample;
+	// }}}
+
+	generate if (!OPT_CTAPS)
+	begin : REAL_TAPS
+		// {{{
+		wire	signed	[(TW-1):0]	c;
+		reg	signed	[(PW-1):0]	ac, bc;
+
+		assign	c = i_tap;
+
+		initial	{ ac, bc } = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			{ ac, bc } <= 0;
+		else if (i_ce)
+		begin
+			ac <= a * c;
+			bc <= b * c;
+		end
+
+		assign	o_re = ac;
+		assign	o_im = bc;
+		// }}}
+	end else if (!OPT_3MPY)
+	begin : FOUR_MPY
+		// {{{
+		wire	signed	[(TW-1):0]	c, d;
+		reg	signed	[(IW+TW-1):0]	ac, bd, ad, bc;
+
+		assign	{ c, d } = i_tap;
+
+		initial	{ ac, bd, ad, bc } = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			{ ac, bd, ad, bc } <= 0;
+		else if (i_ce)
+		begin
+			ac <= a * c;
+			bd <= b * d;
+			ad <= a * d;
+			bc <= b * c;
+		end
+
+		assign	o_re = { ac[IW+TW-1], ac } - { bd[IW+TW-1], bd };
+		assign	o_im = { ad[IW+TW-1], ad } + { bc[IW+TW-1], bc };
+		// }}}
+	end else begin : THREE_MPY
+		// {{{
+		wire	signed	[(TW-1):0]	c, d;
+		wire	signed	[IW:0]		a_plus_b;
+		wire	signed	[TW:0]		d_minus_c, c_plus_d;
+		reg	signed	[(PW-1):0]	k1, k2, k3;
+
+		assign	{ c, d } = i_tap;
+
+		assign	a_plus_b  = { a[IW-1], a } + { b[IW-1], b };
+		assign	d_minus_c = { d[TW-1], d } - { c[TW-1], c };
+		assign	c_plus_d  = { c[TW-1], c } + { d[TW-1], d };
+
+		initial	{ k1, k2, k3 } = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			{ k1, k2, k3 } <= 0;
+		else if (i_ce)
+		begin
+			k1 <= c * a_plus_b;
+			k2 <= a * d_minus_c;
+			k3 <= b * c_plus_d;
+		end
+
+		// Both results are known to fit within PW bits, so there's
+		// no need to extend k1, k2, or k3 before adding them
+		assign	o_re = k1 - k3;
+		assign	o_im = k1 + k2;
+		// }}}
+	end endgenerate
+endmodule
@@ -0,0 +1,328 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	cslowfil.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A complex version of slowfil.v.  As with slowfil, one product
+//		is calculated per clock, so there must be at least NTAPS clocks
+//	between incoming samples.  Input and output samples are complex, each
+//	packed as { real, imaginary } into a single word.
+//
+//	The taps are held in one coefficient memory, written just as they are
+//	for slowfil.  With OPT_CTAPS clear the taps are real, and each is
+//	applied to both halves of the sample.  With OPT_CTAPS set, each tap is
+//	complex, packed as { real, imaginary }.  The complex product then
+//	takes four multiplies or, with OPT_3MPY, three.  See cmpy.v.  As with
+//	cfastfir, OW defaults to one bit more than slowfil's, to allow for the
+//	growth of a complex product.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	cslowfil #(
+		// {{{
+		parameter	LGNTAPS = 7, IW=12, TW=12,
+				OW = IW+TW+LGNTAPS+1,
+		parameter	[LGNTAPS:0]	NTAPS = 110, // (1<<LGNTAPS);
+		parameter	[0:0]		FIXED_TAPS = 1'b0,
+		parameter			INITIAL_COEFFS  = "",
+		// Complex taps, rather than real ones
+		parameter	[0:0]		OPT_CTAPS = 1'b1,
+		// Use three multiplies per complex tap, rather than four
+		parameter	[0:0]		OPT_3MPY = 1'b0,
+		localparam	MEMSZ = (1<<LGNTAPS),
+		localparam	CTW = OPT_CTAPS ? 2*TW : TW
+		// }}}
+	) (
+		// {{{
+		// Control inputs (wires)
+		input	wire		i_clk, i_reset,
+		//
+		// Coefficient control -- allows you to update coefficients
+		// {{{
+		// in the filter
+		input	wire			i_tap_wr,
+		input	wire	[(CTW-1):0]	i_tap,
+		// }}}
+		// New sample input(s)--a new sample comes in any time i_ce is
+		// {{{
+		// true.  There must be at least NTAPS idle's between every
+		// pair of valid i_ce's.
+		input	wire			i_ce,
+		input	wire	[(2*IW-1):0]	i_sample,
+		// }}}
+		// The output--valid any time o_ce is true.
+		// {{{
+		output	reg			o_ce,
+		output	reg	[(2*OW-1):0]	o_result
+		// }}}
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	localparam	PW = IW+TW+(OPT_CTAPS ? 1:0);
+
+	reg	[(CTW-1):0]	tapmem	[0:(MEMSZ-1)];	// Coef memory
+	reg	[(CTW-1):0]	tap;		// Value read from coef memory
+
+	reg	[(LGNTAPS-1):0]	dwidx, didx;	// Data write and read indices
+	reg	[(LGNTAPS-1):0]	tidx;		// Coefficient read index
+	reg	[(2*IW-1):0]	dmem	[0:(MEMSZ-1)];	// Data memory
+	reg	[(2*IW-1):0]	data;		// Data value read from memory
+
+	// Traveling CE values
+	reg	d_ce, p_ce, m_ce;
+	//
+	// The product and accumulator values for the filter
+	wire	signed [(PW-1):0]	product_re, product_im;
+	reg	signed [(OW-1):0]	r_acc_re, r_acc_im;
+	wire	last_tap_index;
+	reg	[2:0]	pre_acc_ce;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Allow the user to set the taps
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Starting at zero on reset, increment the tap write index on any
+	// write of a new tap.
+	generate if (FIXED_TAPS || INITIAL_COEFFS != 0)
+	begin : LOAD_TAPS
+		initial $readmemh(INITIAL_COEFFS, tapmem);
+	end
+
+	if (FIXED_TAPS)
+	begin : NO_UPDATED_LOGIC
+
+		// Make Verilators -Wall happy
+		// {{{
+		// Verilator lint_off UNUSED
+		wire	[CTW:0]	ignored_inputs;
+		assign	ignored_inputs = { i_tap_wr, i_tap };
+		// Verilator lint_on  UNUSED
+		// }}}
+	end else begin : UPDATE_COEFFICIENTS
+		// Coef memory write index
+		reg	[(LGNTAPS-1):0]	tapwidx;
+
+		initial	tapwidx = 0;
+		always @(posedge i_clk)
+		if(i_reset)
+			tapwidx <= 0;
+		else if (i_tap_wr)
+			tapwidx <= tapwidx + 1'b1;
+
+		always @(posedge i_clk)
+		if (i_tap_wr)
+			tapmem[tapwidx] <= i_tap;
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Record the incoming data into a local memory
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// As with slowfil, this is independent of the reset
+	initial	dwidx = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		dwidx <= dwidx + 1'b1;
+
+	always @(posedge i_clk)
+	if (i_ce)
+		dmem[dwidx] <= i_sample;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Calculate the indexes of the filter table
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Determine if the next clock (not this one) will contain the last
+	// valid index, and so whether or not we need to stop.
+	assign	last_tap_index = (NTAPS[LGNTAPS-1:0]-tidx <= 1);
+
+	// pre_acc_ce[0]
+	// {{{
+	// pre_acc_ce[0] means that the tap index is valid
+	// pre_acc_ce[1] means that the tap value is valid
+	// pre_acc_ce[2] means that the product is valid
+	initial	pre_acc_ce = 3'h0;
+	always @(posedge i_clk)
+	if (i_reset)
+		pre_acc_ce[0] <= 1'b0;
+	else if (i_ce)
+		pre_acc_ce[0] <= 1'b1;
+	else if ((pre_acc_ce[0])&&(!last_tap_index))
+		pre_acc_ce[0] <= 1'b1;
+	else
+		pre_acc_ce[0] <= 1'b0;
+	// }}}
+
+	// pre_acc_ce[2:1]
+	// {{{
+	always @(posedge i_clk)
+	if (i_reset)
+		pre_acc_ce[2:1] <= 2'b0;
+	else
+		pre_acc_ce[2:1] <= pre_acc_ce[1:0];
+	// }}}
+
+	// didx, tidx
+	// {{{
+	initial	didx = 0;
+	initial	tidx = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+	begin
+		didx <= dwidx;
+		tidx <= 0;
+	end else begin
+		didx <= didx - 1'b1;
+		tidx <= tidx + 1'b1;
+	end
+	// }}}
+
+	// m_ce is valid when the first index is valid
+	// {{{
+	initial	m_ce = 1'b0;
+	always @(posedge i_clk)
+		m_ce <= (i_ce)&&(!i_reset);
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Read from memory cycle
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// tap
+	// {{{
+	initial	tap = 0;
+	always @(posedge i_clk)
+		tap <= tapmem[tidx];
+	// }}}
+
+	// data
+	// {{{
+	initial	data = 0;
+	always @(posedge i_clk)
+		data <= dmem[didx];
+	// }}}
+
+	// d_ce is valid when the first data from memory is read/valid
+	// {{{
+	initial	d_ce = 0;
+	always @(posedge i_clk)
+		d_ce <= (m_ce)&&(!i_reset);
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Apply the product to the tap and data just read
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// p_ce is valid on the first valid product
+	// {{{
+	initial	p_ce = 1'b0;
+	always @(posedge i_clk)
+		p_ce <= (d_ce)&&(!i_reset);
+	// }}}
+
+	// product_re, product_im
+	// {{{
+	cmpy #(
+		.IW(IW), .TW(TW), .OPT_CTAPS(OPT_CTAPS), .OPT_3MPY(OPT_3MPY)
+	) mpy(
+		i_clk, 1'b0, 1'b1, data, tap,
+		product_re, product_im
+	);
+	// }}}
+
+	// r_acc_re, r_acc_im
+	// {{{
+	initial	r_acc_re = 0;
+	initial	r_acc_im = 0;
+	always @(posedge i_clk)
+	if (p_ce)
+	begin
+		r_acc_re <= { {(OW-PW){product_re[PW-1]}}, product_re };
+		r_acc_im <= { {(OW-PW){product_im[PW-1]}}, product_im };
+	end else if (pre_acc_ce[2])
+	begin
+		r_acc_re <= r_acc_re + { {(OW-PW){product_re[PW-1]}},
+					product_re };
+		r_acc_im <= r_acc_im + { {(OW-PW){product_im[PW-1]}},
+					product_im };
+	end
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Copy the result to the output
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// o_result
+	// {{{
+	initial	o_result = 0;
+	always @(posedge i_clk)
+	if (p_ce)
+		o_result <= { r_acc_re, r_acc_im };
+	// }}}
+
+	// o_ce
+	// {{{
+	initial	o_ce = 1'b0;
+	always @(posedge i_clk)
+		o_ce <= (p_ce)&&(!i_reset);
+	// }}}
+	// }}}
+endmodule
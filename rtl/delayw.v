@@ -7,6 +7,18 @@
 // Purpose:	To delay an input word by a programmable number of clocks with
 //		respect to a second word.
 //
+//	OPT_BRAM is meant for long delays, of thousands of words or more, and
+//	for delays that change while the data is flowing.  i_delay is then
+//	registered on every i_ce before it is used for anything.  The memory
+//	address is calculated from that register alone, and the memory is
+//	read from this registered address into a register, with nothing but
+//	the memory between the two.  The output chooses between the memory
+//	and the two short delays (0 and 1) based upon registered flags.
+//	Changes to i_delay take effect three samples (i_ce's) after they are
+//	first presented with an i_ce.  Every o_delayed is then the word from
+//	exactly the delay in effect at that time, so a change never produces
+//	a word that belongs to neither the old nor the new delay.
+//
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
 //
@@ -62,7 +74,13 @@ module delayw #(
 		// {{{
 		// If your application requires a fixed, non-zero delay--set it
 		// here.  Subsequent values in i_delay will then be ignored.
-		parameter [(LGDLY-1):0]	FIXED_DELAY=0
+		parameter [(LGDLY-1):0]	FIXED_DELAY=0,
+		// }}}
+		// OPT_BRAM
+		// {{{
+		// Pipeline the delay, for block RAM sized delay lines whose
+		// delay may change at run time.  See above.
+		parameter [0:0]		OPT_BRAM=1'b0
 		// }}}
 		// }}}
 	) (
@@ -115,67 +133,156 @@ module delayw #(
 		mem[wraddr] <= i_word;	// clock 1
 	// }}}
 
-	// rdaddr
-	// {{{
-	// rdaddr contains the 'read-from-memory' address.  To keep things
-	// simple, we'll force rdaddr to be re-calculated on every clock based
-	// upon wraddr.
-	//
-	initial	rdaddr = 1; // one;
-	always @(posedge i_clk)
-	if (i_reset)
-		rdaddr <= one -w_delay;
-	else if (i_ce)
-		rdaddr <= wraddr + two - w_delay;
-	else
-		rdaddr <= wraddr + one - w_delay;
-	// }}}
+	generate if (!OPT_BRAM)
+	begin : REGISTERED_DELAY
+		// rdaddr
+		// {{{
+		// rdaddr contains the 'read-from-memory' address.  To keep things
+		// simple, we'll force rdaddr to be re-calculated on every clock based
+		// upon wraddr.
+		//
+		initial	rdaddr = 1; // one;
+		always @(posedge i_clk)
+		if (i_reset)
+			rdaddr <= one -w_delay;
+		else if (i_ce)
+			rdaddr <= wraddr + two - w_delay;
+		else
+			rdaddr <= wraddr + one - w_delay;
+		// }}}
 
-	//
-	// Read from memory
-	// {{{
-	// Note: As with the always block that writes to memory, reading from
-	// memory must also be done simply--or the synthesizer might choose
-	// not to use block RAM.
-	//
-	always @(posedge i_clk)
-	if (i_ce)
-		memval <= mem[rdaddr];	// clock 2
-	// }}}
+		//
+		// Read from memory
+		// {{{
+		// Note: As with the always block that writes to memory, reading from
+		// memory must also be done simply--or the synthesizer might choose
+		// not to use block RAM.
+		//
+		always @(posedge i_clk)
+		if (i_ce)
+			memval <= mem[rdaddr];	// clock 2
+		// }}}
 
-	// o_word, o_delayed
-	// {{{
-	// Process the incoming data stream
-	always @(posedge i_clk)
-	if (i_ce)
-	begin
-		if (w_delay == 0)
+		// o_word, o_delayed
+		// {{{
+		// Process the incoming data stream
+		always @(posedge i_clk)
+		if (i_ce)
 		begin
-			// If the delay is zero, forward the input to both
-			// output and delayed output.
-			o_word <= i_word;
-			o_delayed <= i_word;
-		end else if (w_delay == 1)
+			if (w_delay == 0)
+			begin
+				// If the delay is zero, forward the input to both
+				// output and delayed output.
+				o_word <= i_word;
+				o_delayed <= i_word;
+			end else if (w_delay == 1)
+			begin
+				// If we wish to delay by one, then the o_word value
+				// works as a nice buffer to capture what once was in
+				// our input.
+				o_word <= i_word;
+				o_delayed <= o_word;
+			end else begin
+				// Otherwise ... we need to go to memory to get the
+				// delayed value back out.  Why 2 or more?  Count the
+				// delay stages below:
+				//
+				//   0        1            2         3
+				// i_word | o_word
+				// i_word | mem[wraddr] | memval | o_delayed
+				//
+				o_word <= i_word;
+				o_delayed <= memval;
+			end
+		end
+		// }}}
+	end else begin : BRAM_DELAY
+		// {{{
+		reg	[(LGDLY-1):0]	next_delay;
+		reg			next_zero, next_unit,
+					zero_delay, unit_delay;
+
+		// next_delay
+		// {{{
+		// i_delay, registered on each i_ce.  Nothing else in this
+		// delay line looks at i_delay, so it never reaches the memory
+		// address (or anything else) combinatorially.
+		initial	next_delay = 0;
+		always @(posedge i_clk)
+		if (i_reset || i_ce)
+			next_delay <= w_delay;
+		// }}}
+
+		// next_zero, next_unit, zero_delay, unit_delay
+		// {{{
+		// The delay, reduced to the two special cases that don't use
+		// the memory, and then delayed by one more sample so that
+		// zero_delay and unit_delay apply to the next sample
+		initial	next_zero  = 1'b1;
+		initial	next_unit  = 1'b0;
+		initial	zero_delay = 1'b1;
+		initial	unit_delay = 1'b0;
+		always @(posedge i_clk)
+		if (i_reset)
+		begin
+			next_zero  <= (w_delay == 0);
+			next_unit  <= (w_delay == 1);
+			zero_delay <= (w_delay == 0);
+			unit_delay <= (w_delay == 1);
+		end else if (i_ce)
+		begin
+			next_zero  <= (next_delay == 0);
+			next_unit  <= (next_delay == 1);
+			zero_delay <= next_zero;
+			unit_delay <= next_unit;
+		end
+		// }}}
+
+		// rdaddr
+		// {{{
+		// Unlike above, rdaddr only changes on an i_ce.  The word it
+		// points to is read on the next i_ce, and becomes o_delayed
+		// on the one after that.  Since wraddr doesn't change between
+		// samples, rdaddr doesn't need to either.
+		initial	rdaddr = 1;
+		always @(posedge i_clk)
+		if (i_ce)
+			rdaddr <= wraddr + two - next_delay;
+		// }}}
+
+		// Read from memory
+		// {{{
+		always @(posedge i_clk)
+		if (i_ce)
+			memval <= mem[rdaddr];
+		// }}}
+
+		// o_word, o_delayed
+		// {{{
+		always @(posedge i_clk)
+		if (i_ce)
 		begin
-			// If we wish to delay by one, then the o_word value
-			// works as a nice buffer to capture what once was in
-			// our input.
-			o_word <= i_word;
-			o_delayed <= o_word;
-		end else begin
-			// Otherwise ... we need to go to memory to get the
-			// delayed value back out.  Why 2 or more?  Count the
-			// delay stages below:
-			//
-			//   0        1            2         3
-			// i_word | o_word
-			// i_word | mem[wraddr] | memval | o_delayed
-			//
 			o_word <= i_word;
-			o_delayed <= memval;
+
+			if (zero_delay)
+				o_delayed <= i_word;
+			else if (unit_delay)
+				o_delayed <= o_word;
+			else
+				o_delayed <= memval;
 		end
-	end
-	// }}}
+		// }}}
+
+		// Keep Verilator happy
+		// {{{
+		// Verilator lint_off UNUSED
+		wire	unused;
+		assign	unused = &{ 1'b0, one };
+		// Verilator lint_on UNUSED
+		// }}}
+		// }}}
+	end endgenerate
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -215,51 +322,111 @@ module delayw #(
 			assert(o_word == $past(o_word));
 	end
 
-	reg	[LGDLY:0]	f_counts_til_valid;
-	initial	f_counts_til_valid = -1;
 	always @(posedge i_clk)
-		if ((i_reset)||(w_delay != $past(w_delay)))
-			f_counts_til_valid <= { 1'b0,  w_delay } +1'b1;
-		else if (i_ce)
-			f_counts_til_valid <= f_counts_til_valid - 1'b1;
+		if ((f_past_valid)&&(!$past(i_ce)))
+		begin
+			assert(o_delayed == $past(o_delayed));
+			assert(o_word    == $past(o_word));
+		end
 
-	wire	f_valid_output;
-	assign	f_valid_output = (f_counts_til_valid == 0);
+	generate if (!OPT_BRAM)
+	begin : F_REGISTERED
+		// {{{
+		// These properties describe the default, !OPT_BRAM, delay line
+		reg	[LGDLY:0]	f_counts_til_valid;
+		initial	f_counts_til_valid = -1;
+		always @(posedge i_clk)
+			if ((i_reset)||(w_delay != $past(w_delay)))
+				f_counts_til_valid <= { 1'b0,  w_delay } +1'b1;
+			else if (i_ce)
+				f_counts_til_valid <= f_counts_til_valid - 1'b1;
 
-	// Let's do an alternate form of a delay line, this time in the form
-	// of a shift register.  On every clock, we'll move the shift register
-	// right by one.  
-	reg	[((1<<LGDLY)*DW-1):0]	shiftreg;
-	initial	shiftreg = 0;
-	always @(posedge i_clk)
-	if (i_ce)
-	begin
-		shiftreg <= { {(DW){1'b0}}, shiftreg[(1<<LGDLY)*DW-1:DW] };
-		shiftreg[(w_delay*DW) +: DW] <= i_word;
+		wire	f_valid_output;
+		assign	f_valid_output = (f_counts_til_valid == 0);
 
-		if((f_valid_output)&&(f_past_valid)&&(w_delay ==$past(w_delay)))
-			assert(shiftreg[DW-1:0] == o_delayed);
-	end
+		// Let's do an alternate form of a delay line, this time in the form
+		// of a shift register.  On every clock, we'll move the shift register
+		// right by one.  
+		reg	[((1<<LGDLY)*DW-1):0]	shiftreg;
+		initial	shiftreg = 0;
+		always @(posedge i_clk)
+		if (i_ce)
+		begin
+			shiftreg <= { {(DW){1'b0}}, shiftreg[(1<<LGDLY)*DW-1:DW] };
+			shiftreg[(w_delay*DW) +: DW] <= i_word;
 
-	always @(posedge i_clk)
-		if ((f_past_valid)&&(!$past(i_ce)))
+			if((f_valid_output)&&(f_past_valid)&&(w_delay ==$past(w_delay)))
+				assert(shiftreg[DW-1:0] == o_delayed);
+		end
+
+		always @(posedge i_clk)
+		if ((f_past_valid)&&($past(f_past_valid))
+				&&($past(f_past_valid,2))
+				&&($past(f_past_valid,3)))
 		begin
-			assert(o_delayed == $past(o_delayed));
-			assert(o_word    == $past(o_word));
+			if ((f_valid_output)&&(w_delay == 2)
+					&&(w_delay == $past(w_delay))
+					&&($past(i_ce))
+					&&($past(i_ce,2))
+					&&($past(i_ce,3)))
+				assert(o_delayed == $past(o_word,2));
 		end
+		// }}}
+	end else begin : F_BRAM
+		// {{{
+		// In the OPT_BRAM delay line, each o_delayed is the word from
+		// the delay presented with the sample three i_ce's earlier.
+		// f_hist holds the last (1<<LGDLY) words, the most recent in
+		// f_hist[DW-1:0], and f_dly the delays given with the last
+		// four samples, the oldest in the top LGDLY bits.
+		reg	[((1<<LGDLY)*DW-1):0]	f_hist;
+		reg	[(4*LGDLY-1):0]		f_dly;
+		reg	[(LGDLY-1):0]		f_this_delay;
+		reg	[LGDLY:0]		f_nwritten;
+		reg	[1:0]			f_nreset;
+		wire				f_valid;
 
-	always @(posedge i_clk)
-	if ((f_past_valid)&&($past(f_past_valid))
-			&&($past(f_past_valid,2))
-			&&($past(f_past_valid,3)))
-	begin
-		if ((f_valid_output)&&(w_delay == 2)
-				&&(w_delay == $past(w_delay))
-				&&($past(i_ce))
-				&&($past(i_ce,2))
-				&&($past(i_ce,3)))
-			assert(o_delayed == $past(o_word,2));
-	end
+		always @(posedge i_clk)
+		if (i_ce)
+			f_hist <= { f_hist[((1<<LGDLY)-1)*DW-1:0], i_word };
+
+		// The delay pipeline, like the one it checks, is filled with
+		// w_delay on a reset
+		initial	f_dly = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			f_dly <= {(4){w_delay}};
+		else if (i_ce)
+			f_dly <= { f_dly[(3*LGDLY-1):0], w_delay };
+
+		always @(*)
+			f_this_delay = f_dly[(4*LGDLY-1) -: LGDLY];
+
+		// The memory starts out with unknown contents.  Count the
+		// words written to it, up to (1<<LGDLY).
+		initial	f_nwritten = 0;
+		always @(posedge i_clk)
+		if (i_ce && !f_nwritten[LGDLY])
+			f_nwritten <= f_nwritten + 1'b1;
+
+		// rdaddr isn't reset, so the first two samples following a
+		// reset may read from the wrong address.  Count three samples
+		// following any reset before checking o_delayed.
+		initial	f_nreset = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			f_nreset <= 0;
+		else if (i_ce && !(&f_nreset))
+			f_nreset <= f_nreset + 1'b1;
+
+		assign	f_valid = (&f_nreset)
+				&& (f_nwritten > { 1'b0, f_this_delay });
+
+		always @(*)
+		if (f_valid)
+			assert(o_delayed == f_hist[(f_this_delay*DW) +: DW]);
+		// }}}
+	end endgenerate
 `endif
 // }}}
 endmodule
@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	descrambler.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	Undoes scrambler.v, W bits per clock.  Since the scrambler
+//		feeds back its output, the descrambler only needs the last
+//	LN received bits,
+//
+//		d[n+LN] = s[n+LN] ^ (^(TAPS & s[n +: LN]))
+//
+//	No bit depends upon any other output, so nothing needs unrolling here.
+//	The descrambler also doesn't need to start in the same state as the
+//	scrambler: it synchronizes itself after LN bits.  A bit error on the
+//	line, however, will be multiplied by the number of taps plus one.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	descrambler #(
+		// {{{
+		parameter	W  = 64,	// Data bits per clock
+				LN = 58,	// Scrambler register length
+		parameter [(LN-1):0]	TAPS = 58'h80001,
+				INITIAL_FILL = { { (LN-1){1'b0}}, 1'b1 }
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset, i_ce,
+		input	wire	[(W-1):0]	i_data,
+		output	reg			o_ce,
+		output	reg	[(W-1):0]	o_data
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	genvar	k;
+
+	// The last LN received bits, with the oldest in bit zero
+	reg	[(LN-1):0]	sreg;
+	wire	[(W-1):0]	descrambled;
+	wire	[(LN+W-1):0]	ext;
+	// }}}
+
+	assign	ext = { i_data, sreg };
+
+	// descrambled
+	// {{{
+	generate for(k=0; k<W; k=k+1)
+	begin : FEEDFORWARD
+		assign	descrambled[k] = ext[LN+k] ^ (^(ext[k +: LN] & TAPS));
+	end endgenerate
+	// }}}
+
+	// sreg
+	// {{{
+	initial	sreg = INITIAL_FILL;
+	always @(posedge i_clk)
+	if (i_reset)
+		sreg <= INITIAL_FILL;
+	else if (i_ce)
+		sreg <= ext[(LN+W-1):W];
+	// }}}
+
+	// o_ce, o_data
+	// {{{
+	initial	o_ce = 1'b0;
+	always @(posedge i_clk)
+	if (i_reset)
+		o_ce <= 1'b0;
+	else
+		o_ce <= i_ce;
+
+	initial	o_data = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		o_data <= descrambled;
+	// }}}
+endmodule
@@ -4,7 +4,10 @@
 // {{{
 // Project:	DSP Filtering Example Project
 //
-// Purpose:	
+// Purpose:	Choose between two sample streams, i_sample if i_en is set and
+//		i_bypass otherwise.  The choice is made on i_ce, so it only
+//	changes on a sample boundary.  See filtchain.v for an example of its
+//	use.
 //
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
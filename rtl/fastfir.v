@@ -9,6 +9,12 @@
 //	attempts to optimize the algorithm via the use of a better delay
 //	structure for the input samples.
 //
+//	Setting OPT_SHADOW allows the filter to be retuned while it is in
+//	use.  i_tap_wr then loads a shadow copy of the taps, which only
+//	replaces the taps in use on i_tap_commit.  (See firtap.v.)  The
+//	shadow copy is in use until the commit has passed through every tap,
+//	NTAPS samples later, and so it shouldn't be written to until then.
+//
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
 //
@@ -49,7 +55,10 @@ module	fastfir #(
 `else
 		parameter		NTAPS=128, IW=12, TW=IW, OW=2*IW+7,
 `endif
-		parameter [0:0]		FIXED_TAPS=0
+		parameter [0:0]		FIXED_TAPS=0,
+		// Load new coefficients into a shadow bank, and only swap
+		// them in on i_tap_commit
+		parameter [0:0]		OPT_SHADOW=0
 		// }}}
 	) (
 		// {{{
@@ -57,6 +66,7 @@ module	fastfir #(
 		//
 		input	wire			i_tap_wr,	// Ignored if FIXED_TAPS
 		input	wire	[(TW-1):0]	i_tap,		// Ignored if FIXED_TAPS
+		input	wire			i_tap_commit,	// Requires OPT_SHADOW
 		//
 		input	wire			i_ce,
 		input	wire	[(IW-1):0]	i_sample,
@@ -71,6 +81,7 @@ module	fastfir #(
 	wire	[(IW-1):0] sample	[NTAPS:0];
 	wire	[(OW-1):0] result	[NTAPS:0];
 	wire		tap_wr;
+	wire	[NTAPS:0]	commit;
 	genvar	k;
 	// }}}
 
@@ -92,6 +103,27 @@ module	fastfir #(
 	end endgenerate
 	// }}}
 
+	// Coefficient commits
+	// {{{
+	// A commit is passed from tap to tap on each new sample, starting
+	// with the first sample following i_tap_commit.
+	generate if (OPT_SHADOW && !FIXED_TAPS)
+	begin : GEN_COMMIT
+		reg	commit_pending;
+
+		initial	commit_pending = 1'b0;
+		always @(posedge i_clk)
+		if (i_reset || i_ce)
+			commit_pending <= 1'b0;
+		else if (i_tap_commit)
+			commit_pending <= 1'b1;
+
+		assign	commit[0] = i_tap_commit || commit_pending;
+	end else begin : NO_COMMIT
+		assign	commit[0] = 1'b0;
+	end endgenerate
+	// }}}
+
 	assign	tapout[0] = 0;
 
 	generate for(k=0; k<NTAPS; k=k+1)
@@ -101,7 +133,8 @@ module	fastfir #(
 			// {{{
 			.FIXED_TAPS(FIXED_TAPS),
 				.IW(IW), .OW(OW), .TW(TW),
-				.INITIAL_VALUE(0)
+				.INITIAL_VALUE(0),
+				.OPT_SHADOW(OPT_SHADOW)
 			// }}}
 		) tapk(
 			// {{{
@@ -112,7 +145,9 @@ module	fastfir #(
 				// We'll let the optimizer trim away sample[k+1]
 			i_ce, sample[0], sample[k+1],
 			// The output accumulator
-			result[k], result[k+1]
+			result[k], result[k+1],
+			// Coefficient bank swaps
+			commit[k], commit[k+1]
 			// }}}
 		);
 
@@ -138,8 +173,8 @@ module	fastfir #(
 	// Make verilator happy
 	// {{{
 	// verilator lint_off UNUSED
-	wire	[(TW):0]	unused;
-	assign	unused = { i_tap_wr, i_tap };
+	wire	[(TW+2):0]	unused;
+	assign	unused = { i_tap_wr, i_tap, i_tap_commit, commit[NTAPS] };
 	// verilator lint_on UNUSED
 	// }}}
 ////////////////////////////////////////////////////////////////////////////////
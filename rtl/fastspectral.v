@@ -0,0 +1,541 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fastspectral.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A full rate version of cheapspectral.v.  Like cheapspectral,
+//		this core creates an autocorrelation estimate of an incoming
+//	signal, by accumulating 2^LGNAVG products of every incoming sample
+//	against each of the 2^LGLAGS samples before it.  Unlike cheapspectral,
+//	which uses a single multiply and so needs 2^LGLAGS clocks per sample
+//	(skipping any samples that arrive in the meantime), this core uses
+//	NLANES = 2^LGPAR multiplies in parallel.  Each of these "lanes"
+//	calculates one lag per clock, so a sample requires only
+//	NSTEPS = 2^(LGLAGS-LGPAR) clocks to process.  Set LGPAR = LGLAGS, and
+//	the core can correlate one sample on every clock.
+//
+// Usage:	The bus interface is identical to that of cheapspectral.  Write
+//		to the core (any address) to request a new estimate.  Once the
+//	core has completed its estimate, it will set o_int high for one cycle.
+//	At that point, the correlations can be read out in the order
+//	R[-N+1 : 0], just as before.
+//
+//	The incoming data stream now comes with a ready signal:
+//
+//		TVALID = i_data_ce
+//		TREADY = o_data_ready
+//		TDATA  = i_data
+//
+//	If OPT_TREADY is set, the core applies backpressure: samples are only
+//	accepted (and recorded) when o_data_ready is also true, so every
+//	accepted sample is correlated against every lag.  If OPT_TREADY is
+//	clear, samples are always recorded as "previous data", but any sample
+//	arriving while o_data_ready is low will not be correlated--much like
+//	cheapspectral.  In this case, o_data_ready is advisory only, and
+//	every sample will contribute to every lag as long as the source
+//	never provides more than one sample every NSTEPS clocks.
+//
+// Algorithm: Given a sample, x[n], accepted on clock 0,
+//
+//	Clock 1+s, for s = 0 ... NSTEPS-1:
+//		- Each lane, p, reads x[n+1+s*NLANES+p] = x[n-(L-1-s*NLANES-p)]
+//		  from its own copy of the data memory.  Lanes are given
+//		  their own copy of the (small) data memory, so that each
+//		  may read from it independently.
+//	Clock 2+s:
+//		- Multiply the delayed data by x[n]
+//		- Read the last average value for this lag.  Lane p keeps the
+//		  averages for every lag (L-1-k) where k mod NLANES == p,
+//		  at index k/NLANES within its own memory.
+//	Clock 3+s:
+//		- Add the product to the last average.  If this is the first
+//		  sample of the average, just sign extend the product.
+//		  Since a new sample may start every NSTEPS clocks, the last
+//		  average may not yet have been written to memory.  Two
+//		  levels of operand forwarding are used to fix this.
+//	Clock 4+s:
+//		- Write the new average back to memory
+//
+//	As with cheapspectral, samples are processed oldest lag first.  This
+//	keeps any new data, recorded while a sample is being processed, from
+//	overwriting the data that sample still needs.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2020-2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	fastspectral #(
+		// {{{
+		parameter [0:0]	OPT_DBLBUFFER = 1'b0,
+		parameter [0:0]	OPT_AUTO_RESTART = OPT_DBLBUFFER,
+		parameter [0:0]	OPT_TREADY = 1'b1,
+		parameter	LGLAGS = 6,
+		parameter	LGPAR  = 2,	// Log_2 of the number of mpys
+		parameter	IW = 10,	// Input data Width
+		parameter	LGNAVG = 15,
+		localparam	NLANES = (1<<LGPAR),
+		localparam	LGSTEPS = LGLAGS-LGPAR,
+		localparam	SW = (LGSTEPS > 0) ? LGSTEPS : 1,
+		localparam	LW = (LGPAR > 0) ? LGPAR : 1,
+		localparam	AW = SW+((OPT_DBLBUFFER) ? 1:0),
+		localparam	DW = 32	// Bus data width
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		// Incoming data
+		// {{{
+		input	wire			i_data_ce,
+		output	wire			o_data_ready,
+		input	wire	[IW-1:0]	i_data,
+		// }}}
+		// Wishbone interface
+		// {{{
+		input	wire			i_wb_cyc, i_wb_stb, i_wb_we,
+		input	wire	[LGLAGS-1:0]	i_wb_addr,
+		input	wire	[DW-1:0]	i_wb_data,
+		input	wire	[DW/8-1:0]	i_wb_sel,
+		output	wire			o_wb_stall,
+		output	reg			o_wb_ack,
+		output	reg	[DW-1:0]	o_wb_data,
+		// }}}
+		output	reg			o_int
+`ifdef	VERILATOR
+		// Communicate the details of our setup with our Verilator
+		// test bench
+		// {{{
+		, output reg	[0:0]		o_dblbuffer, o_restart, o_tready,
+		output	reg	[4:0]		o_width,
+		output	reg	[9:0]		o_lglags, o_lgnavg, o_lgpar
+		// }}}
+`endif
+		// }}}
+	);
+
+`ifdef	VERILATOR
+	// {{{
+	always @(*)
+	begin
+		o_dblbuffer = OPT_DBLBUFFER;
+		o_restart   = OPT_AUTO_RESTART;
+		o_tready    = OPT_TREADY;
+		o_width     = IW[4:0];
+		o_lglags    = LGLAGS;
+		o_lgnavg    = LGNAVG;
+		o_lgpar     = LGPAR;
+	end
+	// }}}
+`endif
+
+	// Local declarations
+	// {{{
+	localparam	PRODUCT_WIDTH = 2*IW, PW = PRODUCT_WIDTH;
+	localparam	AVERAGE_BITS  = PW + LGNAVG, AB = AVERAGE_BITS;
+	localparam [SW-1:0]	LAST_STEP = (1<<LGSTEPS)-1;
+
+	reg	[LGLAGS-1:0]	data_write_address;
+	wire			data_write, accept;
+
+	reg			collecting, running, wbuf;
+	reg	[LGNAVG-1:0]	avcounts;
+	reg	[SW-1:0]	rstep;
+	wire			last_step;
+	wire	[LGLAGS:0]	wide_step;
+	wire	[LGLAGS-1:0]	step_offset;
+
+	reg	[LGLAGS-1:0]	rd_base;
+	reg	signed	[IW-1:0]	new_data;
+	reg			s_first, s_last, s_buf;
+
+	// Pipeline stage 1: delayed data (and new_data) valid
+	reg			v1, f1, l1;
+	reg	[AW-1:0]	a1;
+	reg	signed	[IW-1:0]	nd1;
+
+	// Pipeline stage 2: product and last average valid
+	reg			v2, f2, l2, byp_active;
+	reg	[AW-1:0]	a2;
+
+	// Pipeline stage 3: new average valid, and written to memory
+	reg			v3, l3;
+	reg	[AW-1:0]	a3;
+
+	wire	[AW-1:0]	bus_addr;
+	reg	[LW-1:0]	bus_lane;
+	wire	[LGLAGS-1:0]	bus_index, bus_lane_full;
+	wire	[AB-1:0]	lane_data	[0:NLANES-1];
+	wire	[AB-1:0]	data_out;
+	// }}}
+
+	////////////////////////////////////////////////////////////////////////
+	//
+	// New data logic
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Without backpressure, samples are always recorded--even if they
+	// won't be correlated.  With backpressure, only accepted samples are
+	// recorded.
+	assign	data_write = i_data_ce && (!OPT_TREADY || o_data_ready);
+
+	// We can start a new sample as soon as the last step of the prior
+	// sample has been issued
+	assign	o_data_ready = !running || last_step;
+
+	assign	accept = i_data_ce && o_data_ready && collecting;
+
+	initial	data_write_address = 0;
+	always @(posedge i_clk)
+	if (data_write)
+		data_write_address <= data_write_address + 1;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Averaging control
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// collecting, avcounts
+	// {{{
+	// We start collecting on any reset or bus write, and continue until
+	// 2^LGNAVG samples have been accepted.  avcounts counts the samples
+	// accepted so far, so that the first and last samples of any average
+	// may be identified.
+	initial	collecting = 1'b1;
+	initial	avcounts = 0;
+	always @(posedge i_clk)
+	if (i_reset || (i_wb_stb && i_wb_we))
+	begin
+		collecting <= 1'b1;
+		avcounts   <= 0;
+	end else if (accept)
+	begin
+		avcounts <= avcounts + 1;
+		if (!OPT_AUTO_RESTART && (&avcounts))
+			collecting <= 1'b0;
+	end
+	// }}}
+
+	// wbuf: which buffer are we writing into?
+	// {{{
+	generate if (OPT_DBLBUFFER)
+	begin : GEN_WRITE_BUFFER
+		initial	wbuf = 1'b0;
+		always @(posedge i_clk)
+		if (i_reset)
+			wbuf <= 1'b0;
+		else if (accept && (&avcounts))
+			wbuf <= !wbuf;
+	end else begin : NO_WRITE_BUFFER
+		always @(*)
+			wbuf = 1'b0;
+	end endgenerate
+	// }}}
+
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Clock 0: Accept a new sample
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// running, rstep
+	// {{{
+	assign	last_step = (rstep == LAST_STEP);
+
+	initial	running = 1'b0;
+	initial	rstep   = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		running <= 1'b0;
+		rstep   <= 0;
+	end else if (accept)
+	begin
+		running <= 1'b1;
+		rstep   <= 0;
+	end else if (running)
+	begin
+		if (last_step)
+			running <= 1'b0;
+		else
+			rstep <= rstep + 1;
+	end
+	// }}}
+
+	// new_data, rd_base, s_first, s_last, s_buf
+	// {{{
+	// Capture everything we need to know about this sample, so that it
+	// can travel down the pipeline with the sample.
+	always @(posedge i_clk)
+	if (accept)
+	begin
+		new_data <= i_data;
+		rd_base  <= data_write_address + 1;
+		s_first  <= (avcounts == 0);
+		s_last   <= (&avcounts);
+		s_buf    <= wbuf;
+	end
+	// }}}
+
+	assign	wide_step   = { {(LGLAGS+1-SW){1'b0}}, rstep };
+	assign	step_offset = wide_step[LGLAGS-1:0] << LGPAR;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Control pipeline, common to all lanes
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Stage 1: read delayed data
+	// {{{
+	initial	v1 = 1'b0;
+	always @(posedge i_clk)
+	if (i_reset)
+		v1 <= 1'b0;
+	else
+		v1 <= running;
+
+	always @(posedge i_clk)
+	begin
+		nd1 <= new_data;
+		f1  <= s_first;
+		l1  <= s_last && last_step;
+	end
+
+	generate if (OPT_DBLBUFFER)
+	begin : GEN_DBLADDR
+		always @(posedge i_clk)
+			a1 <= { s_buf, rstep };
+	end else begin : GEN_SGLADDR
+		always @(posedge i_clk)
+			a1 <= rstep;
+	end endgenerate
+	// }}}
+
+	// Stage 2: multiply, read the last average
+	// {{{
+	initial	v2 = 1'b0;
+	always @(posedge i_clk)
+	if (i_reset)
+		v2 <= 1'b0;
+	else
+		v2 <= v1;
+
+	always @(posedge i_clk)
+	begin
+		a2 <= a1;
+		f2 <= f1;
+		l2 <= l1;
+	end
+
+	// If the average we are reading is being written this cycle, the
+	// read will return the old value.  Remember the new one instead.
+	always @(posedge i_clk)
+		byp_active <= v3 && (a3 == a1);
+	// }}}
+
+	// Stage 3: accumulate
+	// {{{
+	initial	v3 = 1'b0;
+	always @(posedge i_clk)
+	if (i_reset)
+		v3 <= 1'b0;
+	else
+		v3 <= v2;
+
+	always @(posedge i_clk)
+	begin
+		a3 <= a2;
+		l3 <= v2 && l2;
+	end
+	// }}}
+
+	// o_int
+	// {{{
+	// The last average is written on the clock when v3 && l3.  It can
+	// be read back on the next clock.
+	initial	o_int = 0;
+	always @(posedge i_clk)
+	if (i_reset || (i_wb_stb && i_wb_we))
+		o_int <= 1'b0;
+	else
+		o_int <= v3 && l3;
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// The lanes themselves
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	assign	bus_index = i_wb_addr >> LGPAR;
+	assign	bus_lane_full = i_wb_addr & (NLANES-1);
+
+	generate if (OPT_DBLBUFFER)
+	begin : GEN_DBLBUS
+		assign	bus_addr = { !wbuf, bus_index[SW-1:0] };
+	end else begin : GEN_SGLBUS
+		assign	bus_addr = bus_index[SW-1:0];
+	end endgenerate
+
+	genvar	gk;
+	generate for(gk=0; gk<NLANES; gk=gk+1)
+	begin : LANE
+		// {{{
+		localparam [LGLAGS-1:0]	LANE_OFFSET = gk;
+
+		reg		[IW-1:0]	dmem	[0:(1<<LGLAGS)-1];
+		reg	signed	[IW-1:0]	delayed_data;
+		reg	signed	[PW-1:0]	product;
+		reg	signed	[AB-1:0]	avmem	[0:(1<<AW)-1];
+		reg	signed	[AB-1:0]	last_average, byp_value,
+						operand, new_average;
+		reg		[AB-1:0]	bus_data;
+
+		// Every lane gets its own copy of the data history
+		always @(posedge i_clk)
+		if (data_write)
+			dmem[data_write_address] <= i_data;
+
+		// Stage 1: Read the delayed data for this lane's lag
+		always @(posedge i_clk)
+			delayed_data <= dmem[rd_base + step_offset + LANE_OFFSET];
+
+		// Stage 2: Multiply, and read the last average
+		always @(posedge i_clk)
+			product <= delayed_data * nd1;
+
+		always @(posedge i_clk)
+			last_average <= avmem[a1];
+
+		always @(posedge i_clk)
+			byp_value <= new_average;
+
+		// Stage 3: Accumulate
+		always @(*)
+		if (f2)
+			operand = 0;
+		else if (v3 && (a3 == a2))
+			operand = new_average;
+		else if (byp_active)
+			operand = byp_value;
+		else
+			operand = last_average;
+
+		always @(posedge i_clk)
+			new_average <= operand
+				+ { {(LGNAVG){product[PW-1]}}, product };
+
+		// Stage 4: Write the result back to memory
+		always @(posedge i_clk)
+		if (v3)
+			avmem[a3] <= new_average;
+
+		// Bus reads
+		always @(posedge i_clk)
+			bus_data <= avmem[bus_addr];
+
+		assign	lane_data[gk] = bus_data;
+		// }}}
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Handling the bus interaction
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	assign	o_wb_stall = 1'b0;
+
+	// o_wb_ack
+	// {{{
+	initial	o_wb_ack = 1'b0;
+	always @(posedge i_clk)
+		o_wb_ack <= !i_reset && i_wb_stb;
+	// }}}
+
+	// bus_lane, data_out
+	// {{{
+	always @(posedge i_clk)
+		bus_lane <= bus_lane_full[LW-1:0];
+
+	assign	data_out = lane_data[bus_lane];
+	// }}}
+
+	// o_wb_data
+	// {{{
+	generate if (AB == DW)
+	begin : PERFECT_BITWIDTH
+
+		always @(*)
+			o_wb_data = data_out;
+
+	end else if (AB < DW)
+	begin : NOT_ENOUGH_BITS
+
+		always @(*)
+			o_wb_data = { {(DW-AB){data_out[AB-1]}}, data_out };
+
+	end else begin : TOO_MANY_BITS
+
+		always @(*)
+			o_wb_data = data_out[AB-1:AB-DW];
+
+		wire	unused;
+		assign	unused = &{ data_out[AB-DW-1:0] };
+	end endgenerate
+	// }}}
+	// }}}
+
+	// Keep Verilator happy
+	// {{{
+	// Verilator lint_off UNUSED
+	wire	unused;
+	assign	unused = &{ 1'b0, i_wb_cyc, i_wb_data, i_wb_sel,
+				bus_index, bus_lane_full, s_buf, wide_step };
+	// Verilator lint_on  UNUSED
+	// }}}
+endmodule
@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	fastsymf.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A full rate (one sample per clock) symmetric FIR filter.  This
+//		is the full rate counterpart to slowsymf.v: any linear phase
+//	filter has h[k] = h[NTAPS-1-k], so the two samples sharing a
+//	coefficient can be added together before they are multiplied.  The
+//	filter then needs only (NTAPS+1)/2 multiplies, rather than NTAPS.  Both
+//	even and odd NTAPS are supported.  For odd NTAPS, the center tap
+//	multiplies a single sample.
+//
+//	The filter is built from a chain of symtap.v components.  As in
+//	genericfir.v, samples move forward through two delays per tap, while
+//	the partial sums move forward through one.  The mirror sample, which
+//	every tap adds to its own, is the sample at the end of that delay line.
+//
+//	Coefficients are loaded through i_tap_wr and i_tap, one per write, for
+//	h[0] through h[(NTAPS+1)/2-1].  The rest follow by symmetry.  The first
+//	output of an impulse appears (NTAPS+1)/2+1 samples after the impulse.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	fastsymf #(
+		// {{{
+		parameter		NTAPS=107, IW=16, TW=12, OW=IW+TW+7,
+		parameter [0:0]		FIXED_TAPS=0,
+		// Number of multiplies, and so of unique coefficients
+		localparam		NMPY = (NTAPS+1)/2,
+		localparam [0:0]	OPT_ODD = (NTAPS % 2) != 0
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		//
+		input	wire			i_tap_wr,	// Ignored if FIXED_TAPS
+		input	wire	[(TW-1):0]	i_tap,		// Ignored if FIXED_TAPS
+		//
+		input	wire			i_ce,
+		input	wire	[(IW-1):0]	i_sample,
+		output	wire	[(OW-1):0]	o_result
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	wire	[(TW-1):0]	tap		[0:NMPY-1];
+	wire	[(TW-1):0]	tapout		[0:NMPY-1];
+	wire	[(IW-1):0]	sample		[0:NMPY];
+	wire	[(OW-1):0]	result		[0:NMPY];
+	wire	[(IW-1):0]	mirror;
+	wire			tap_wr;
+	genvar	k;
+	// }}}
+
+	// The first sample in our sample chain is the sample we are given
+	assign	sample[0]	= i_sample;
+	// Initialize the partial summing accumulator with zero
+	assign	result[0]	= 0;
+
+	// Initialize coefficients
+	// {{{
+	// Taps shift from the last symtap toward the first, so that the first
+	// coefficient written ends up in tap zero
+	generate if(FIXED_TAPS)
+	begin : LOAD_TAPS
+		reg	[(TW-1):0]	fixed_taps	[0:NMPY-1];
+
+		initial $readmemh("taps.hex", fixed_taps);
+
+		assign	tap_wr = 1'b0;
+		for(k=0; k<NMPY; k=k+1)
+		begin : ASSIGN_TAP
+			assign	tap[k] = fixed_taps[k];
+		end
+
+		// Verilator lint_off UNUSED
+		wire	unused_taps;
+		assign	unused_taps = &{ 1'b0, tapout[0] };
+		// Verilator lint_on  UNUSED
+	end else begin : GEN_TAP_UPDATES
+		assign	tap_wr = i_tap_wr;
+		assign	tap[NMPY-1] = i_tap;
+
+		for(k=0; k<NMPY-1; k=k+1)
+		begin : FORWARD_TAP
+			assign	tap[k] = tapout[k+1];
+		end
+
+		// Verilator lint_off UNUSED
+		wire	[(TW-1):0]	unused_tap;
+		assign	unused_tap = tapout[0];
+		// Verilator lint_on  UNUSED
+	end endgenerate
+	// }}}
+
+	// mirror
+	// {{{
+	// The sample sharing tap k's coefficient is NTAPS-1-2k samples older
+	// than tap k's own.  Since the partial sums meet each tap one clock
+	// later than the one before, and samples two clocks later, this is the
+	// same sample for every tap: NTAPS-1 samples old.  For an odd number of
+	// taps, that's the sample arriving at the last tap.  For an even number,
+	// it's one sample older still.
+	generate if (OPT_ODD)
+	begin : ODD_MIRROR
+		assign	mirror = sample[NMPY-1];
+	end else begin : EVEN_MIRROR
+		reg	[(IW-1):0]	r_mirror;
+
+		initial	r_mirror = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			r_mirror <= 0;
+		else if (i_ce)
+			r_mirror <= sample[NMPY-1];
+
+		assign	mirror = r_mirror;
+	end endgenerate
+	// }}}
+
+	generate for(k=0; k<NMPY; k=k+1)
+	begin: FILTER
+
+		symtap #(
+			// {{{
+			.FIXED_TAPS(FIXED_TAPS),
+				.IW(IW), .OW(OW), .TW(TW),
+				.INITIAL_VALUE(0),
+				.OPT_CENTER(OPT_ODD && (k == NMPY-1))
+			// }}}
+		) tapk(
+			// {{{
+			i_clk, i_reset,
+			// Tap update circuitry
+			tap_wr, tap[k], tapout[k],
+			// Sample delay line, and its far end
+			i_ce, sample[k], mirror, sample[k+1],
+			// The output accumulator
+			result[k], result[k+1]
+			// }}}
+		);
+
+	end endgenerate
+
+	assign	o_result = result[NMPY];
+
+	// Make verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	[(TW+IW):0]	unused;
+	assign	unused = { i_tap_wr, i_tap, sample[NMPY] };
+	// verilator lint_on UNUSED
+	// }}}
+endmodule
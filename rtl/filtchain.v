@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	filtchain.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A chain of NSTAGES filters, any of which may be switched in or
+//		out of the signal path while the data is flowing.
+//
+//	Each stage consists of a filter (fastfir), a bypass path (delayw), and
+//	a dspswitch to choose between them.  The filter is always running,
+//	whether or not it is selected, so that it has a full history when it
+//	is switched in.  The bypass path is delayed to match the filter's
+//	latency, so switching doesn't jump forwards or backwards in time.  For
+//	the linear phase filters this is intended for, that latency is the
+//	filter's group delay, GRPDELAY = (NTAPS-1)/2, plus the one sample the
+//	filter takes to produce its output.
+//
+//	Filter outputs are returned to IW bits by dropping TW-1 bits.  A tap
+//	of 2^(TW-1) therefore has a gain of one, and each filter should be
+//	designed with unity gain (in its passband) for the switch to be
+//	seamless.
+//
+//	The switch only changes on a sample boundary: i_en[k] is sampled on
+//	the clock when stage k accepts a new sample.  Stage k accepts its
+//	samples k clocks after i_ce, so the latency through the chain is
+//	NSTAGES*(GRPDELAY+2) samples plus NSTAGES clocks--whether or not any
+//	filter is enabled.
+//
+//	Taps are loaded into stage k via i_tap_wr[k] and i_tap, exactly as
+//	fastfir loads them.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	filtchain #(
+		// {{{
+		parameter		NSTAGES = 2,
+		parameter		NTAPS=31, IW=12, TW=IW,
+		// GRPDELAY
+		// {{{
+		// The delay of each filter, in samples, not counting its
+		// one sample of pipeline delay.  The bypass path is delayed
+		// by GRPDELAY+1 samples to match.
+		parameter		GRPDELAY = (NTAPS-1)/2,
+		// }}}
+		localparam		OW = IW+TW+$clog2(NTAPS),
+		localparam		BYPASS_DELAY = GRPDELAY+1,
+		localparam		LGDLY = $clog2(BYPASS_DELAY+1)
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		// Which filters to apply
+		input	wire	[(NSTAGES-1):0]	i_en,
+		//
+		input	wire	[(NSTAGES-1):0]	i_tap_wr,
+		input	wire	[(TW-1):0]	i_tap,
+		//
+		input	wire			i_ce,
+		input	wire	[(IW-1):0]	i_sample,
+		//
+		output	wire			o_ce,
+		output	wire	[(IW-1):0]	o_sample
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	wire	[(IW-1):0]	stage_sample	[0:NSTAGES];
+	wire	[NSTAGES:0]	stage_ce;
+
+	genvar	k;
+	// }}}
+
+	assign	stage_ce[0]     = i_ce;
+	assign	stage_sample[0] = i_sample;
+
+	generate for(k=0; k<NSTAGES; k=k+1)
+	begin : STAGE
+		// {{{
+		wire	[(OW-1):0]	filtered;
+		wire	[(IW-1):0]	delayed, unused_word;
+
+		// The filter
+		// {{{
+		fastfir #(
+			// {{{
+			.NTAPS(NTAPS), .IW(IW), .TW(TW), .OW(OW)
+			// }}}
+		) fir (
+			// {{{
+			.i_clk(i_clk), .i_reset(i_reset),
+			.i_tap_wr(i_tap_wr[k]), .i_tap(i_tap),
+			.i_tap_commit(1'b0),
+			.i_ce(stage_ce[k]), .i_sample(stage_sample[k]),
+			.o_result(filtered)
+			// }}}
+		);
+		// }}}
+
+		// The bypass path, delayed to match the filter
+		// {{{
+		delayw #(
+			// {{{
+			.LGDLY(LGDLY), .DW(IW),
+			.FIXED_DELAY(BYPASS_DELAY[(LGDLY-1):0])
+			// }}}
+		) align (
+			// {{{
+			.i_clk(i_clk), .i_reset(i_reset),
+			.i_delay({(LGDLY){1'b0}}),
+			.i_ce(stage_ce[k]), .i_word(stage_sample[k]),
+			.o_word(unused_word), .o_delayed(delayed)
+			// }}}
+		);
+		// }}}
+
+		// Choose between them, on the next sample
+		// {{{
+		dspswitch #(
+			// {{{
+			.DW(IW)
+			// }}}
+		) switch (
+			// {{{
+			.i_clk(i_clk), .i_areset_n(!i_reset), .i_en(i_en[k]),
+			.i_ce(stage_ce[k]),
+			.i_sample(filtered[(TW-1) +: IW]), .i_bypass(delayed),
+			.o_ce(stage_ce[k+1]), .o_sample(stage_sample[k+1])
+			// }}}
+		);
+		// }}}
+
+		// Make verilator happy
+		// {{{
+		// verilator lint_off UNUSED
+		wire	unused;
+		assign	unused = &{ 1'b0, unused_word,
+				filtered[(OW-1):(IW+TW-1)],
+				filtered[(TW-2):0] };
+		// verilator lint_on UNUSED
+		// }}}
+		// }}}
+	end endgenerate
+
+	assign	o_ce     = stage_ce[NSTAGES];
+	assign	o_sample = stage_sample[NSTAGES];
+endmodule
@@ -20,6 +20,14 @@
 //	minimizing the number of bits in each tap, and/or the number of bits
 //	in the input (and output) samples.
 //
+//	If OPT_SHADOW is set, i_tap_wr shifts coefficients into a second,
+//	shadow register per tap instead, while the tap in use is left alone.
+//	i_commit then copies the shadow register into the active tap on the
+//	next i_ce, and passes the commit on to the next tap's i_commit via
+//	o_commit--one tap per sample, in step with the partial accumulator.
+//	Each output is then calculated entirely with either the old or the
+//	new coefficients.
+//
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
 //
@@ -56,7 +64,8 @@ module	firtap #(
 		// {{{
 		parameter		IW=16, TW=IW, OW=IW+TW+8,
 		parameter [0:0]		FIXED_TAPS=0,
-		parameter [(TW-1):0]	INITIAL_VALUE=0
+		parameter [(TW-1):0]	INITIAL_VALUE=0,
+		parameter [0:0]		OPT_SHADOW=0
 		// }}}
 	) (
 		// {{{
@@ -76,7 +85,12 @@ module	firtap #(
 		// Output "results"
 		// {{{
 		input	wire	[(OW-1):0]	i_partial_acc,
-		output	reg	[(OW-1):0]	o_acc
+		output	reg	[(OW-1):0]	o_acc,
+		// }}}
+		// Coefficient bank swaps, when using OPT_SHADOW
+		// {{{
+		input	wire			i_commit,
+		output	wire			o_commit
 		// }}}
 		// }}}
 	);
@@ -85,6 +99,7 @@ module	firtap #(
 	// {{{
 	reg		[(IW-1):0]	delayed_sample;
 	reg	signed	[(TW+IW-1):0]	product;
+	wire	signed	[(TW-1):0]	active_tap;
 	// }}}
 
 	// Determine the tap we are using
@@ -94,8 +109,15 @@ module	firtap #(
 		// external input.  This allows the parent module to be
 		// able to use readmemh to set all of the taps in a filter
 		assign	o_tap = i_tap;
+		assign	active_tap = i_tap;
+		assign	o_commit = 1'b0;
 
-	end else begin : GEN_TAP_UPDATE_LOGIC
+		// Verilator lint_off UNUSED
+		wire	unused_commit;
+		assign	unused_commit = i_commit;
+		// Verilator lint_on  UNUSED
+	end else if (!OPT_SHADOW)
+	begin : GEN_TAP_UPDATE_LOGIC
 		// If the taps are adjustable, then use the i_tap_wr signal
 		// to know when to adjust the tap.  In this case, taps are
 		// strung together through the filter structure--our output
@@ -108,7 +130,40 @@ module	firtap #(
 		if (i_tap_wr)
 			tap <= i_tap;
 		assign o_tap = tap;
+		assign active_tap = tap;
+		assign o_commit = 1'b0;
+
+		// Verilator lint_off UNUSED
+		wire	unused_commit;
+		assign	unused_commit = i_commit;
+		// Verilator lint_on  UNUSED
+	end else begin : GEN_SHADOW_TAP
+		// As above, only now it's the shadow registers that are
+		// strung together.  The tap in use only changes when the
+		// commit reaches it, and then only on a new sample.
+		reg	[(TW-1):0]	shadow, tap;
+		reg			r_commit;
+
+		initial	shadow = INITIAL_VALUE;
+		always @(posedge i_clk)
+		if (i_tap_wr)
+			shadow <= i_tap;
+
+		initial	tap = INITIAL_VALUE;
+		always @(posedge i_clk)
+		if (i_ce && i_commit)
+			tap <= shadow;
+
+		initial	r_commit = 1'b0;
+		always @(posedge i_clk)
+		if (i_reset)
+			r_commit <= 1'b0;
+		else if (i_ce)
+			r_commit <= i_commit;
 
+		assign o_tap = shadow;
+		assign active_tap = tap;
+		assign o_commit = r_commit;
 	end endgenerate
 
 	// o_sample, delayed_sample
@@ -138,13 +193,13 @@ module	firtap #(
 		if (i_reset)
 			product <= 0;
 		else if (i_ce)
-			product <= o_tap * i_sample;
+			product <= active_tap * i_sample;
 `else
 	// {{{
 	wire	[(TW+IW-1):0]	w_pre_product;
 
 	abs_mpy #(.AW(TW), .BW(IW), .OPT_SIGNED(1'b1))
-		abs_bypass(i_clk, i_reset, o_tap, i_sample, w_pre_product);
+		abs_bypass(i_clk, i_reset, active_tap, i_sample, w_pre_product);
 
 	initial	product = 0;
 	always @(posedge i_clk)
@@ -6,6 +6,10 @@
 //
 // Purpose:	Implement a high speed (1-output per clock), adjustable tap FIR
 //
+//	With OPT_SHADOW, new taps may be loaded while the filter is running.
+//	They take effect on i_tap_commit, as described in firtap.v.  No new
+//	taps should be written for NTAPS samples following a commit.
+//
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
 //
@@ -42,7 +46,10 @@
 module	genericfir #(
 		// {{{
 		parameter		NTAPS=128, IW=12, TW=IW, OW=2*IW+7,
-		parameter [0:0]		FIXED_TAPS=0
+		parameter [0:0]		FIXED_TAPS=0,
+		// Load new coefficients into a shadow bank, and only swap
+		// them in on i_tap_commit
+		parameter [0:0]		OPT_SHADOW=0
 		// }}}
 	) (
 		// {{{
@@ -50,6 +57,7 @@ module	genericfir #(
 		//
 		input	wire			i_tap_wr,	// Ignored if FIXED_TAPS
 		input	wire	[(TW-1):0]	i_tap,		// Ignored if FIXED_TAPS
+		input	wire			i_tap_commit,	// Requires OPT_SHADOW
 		//
 		input	wire			i_ce,
 		input	wire	[(IW-1):0]	i_sample,
@@ -64,6 +72,7 @@ module	genericfir #(
 	wire	[(IW-1):0] sample	[NTAPS:0];
 	wire	[(OW-1):0] result	[NTAPS:0];
 	wire		tap_wr;
+	wire	[NTAPS:0]	commit;
 
 	genvar	k;
 	// }}}
@@ -83,17 +92,39 @@ module	genericfir #(
 	end else begin : GEN_TAP_UPDATE_LOGIC
 		assign	tap_wr = i_tap_wr;
 		assign	tap[0] = i_tap;
-	end
+	end endgenerate
+	// }}}
+
+	// Coefficient commits
+	// {{{
+	// A commit is passed from tap to tap on each new sample, starting
+	// with the first sample following i_tap_commit.
+	generate if (OPT_SHADOW && !FIXED_TAPS)
+	begin : GEN_COMMIT
+		reg	commit_pending;
+
+		initial	commit_pending = 1'b0;
+		always @(posedge i_clk)
+		if (i_reset || i_ce)
+			commit_pending <= 1'b0;
+		else if (i_tap_commit)
+			commit_pending <= 1'b1;
+
+		assign	commit[0] = i_tap_commit || commit_pending;
+	end else begin : NO_COMMIT
+		assign	commit[0] = 1'b0;
+	end endgenerate
 	// }}}
 
-	for(k=0; k<NTAPS; k=k+1)
+	generate for(k=0; k<NTAPS; k=k+1)
 	begin: FILTER
 
 		firtap #(
 			// {{{
 			.FIXED_TAPS(FIXED_TAPS),
 			.IW(IW), .OW(OW), .TW(TW),
-			.INITIAL_VALUE(0)
+			.INITIAL_VALUE(0),
+			.OPT_SHADOW(OPT_SHADOW)
 			// }}}
 		) tapk(
 			// {{{
@@ -103,7 +134,9 @@ module	genericfir #(
 			// Sample delay line
 			i_ce, sample[k], sample[k+1],
 			// The output accumulator
-			result[k], result[k+1]
+			result[k], result[k+1],
+			// Coefficient bank swaps
+			commit[k], commit[k+1]
 			// }}}
 		);
 
@@ -129,8 +162,8 @@ module	genericfir #(
 	// Make verilator happy
 	// {{{
 	// verilator lint_off UNUSED
-	wire	[(TW):0]	unused;
-	assign	unused = { i_tap_wr, i_tap };
+	wire	[(TW+2):0]	unused;
+	assign	unused = { i_tap_wr, i_tap, i_tap_commit, commit[NTAPS] };
 	// verilator lint_on UNUSED
 	// }}}
 endmodule
@@ -0,0 +1,317 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	hbdecim.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A full rate half-band decimate by two filter.  Where
+//		shalfband.v needs many clocks per sample, this filter can
+//	accept one sample every clock--or, with OPT_DUAL set, two samples
+//	every clock.  In both cases, it produces one output for every two
+//	inputs.
+//
+//	Half of a half-band filter's coefficients are zero.  Of the rest, all
+//	but the center tap are found at an even distance from the center, and
+//	they are symmetric.  Hence, if NTAPS = 4*NMPY-1, then every output is
+//	built from only NMPY multiplies, each of a coefficient by the sum of
+//	two samples, plus the center tap.  As with shalfband.v, the center tap
+//	is fixed at 2^(TW-1)-1, and so it is applied with a shift and a
+//	subtract, rather than a multiply.
+//
+//	Incoming samples are gathered into pairs.  The newer sample of each
+//	pair feeds a symmetric filter of 2*NMPY taps, built from symtap.v's
+//	just like fastsymf.v.  The older sample of each pair is delayed and
+//	multiplied by the center tap, and becomes the initial value of that
+//	filter's accumulator chain.  All of this runs at the output rate, so
+//	every multiply is used once every two input samples.
+//
+//	With OPT_DUAL, the oldest sample is found in the low order bits of
+//	i_sample.  Without it, samples may arrive as often as once per clock,
+//	and every second sample completes a pair.  Either way, the outputs
+//	are the odd outputs of a full rate filter: y[n] = sum h[k] x[2n+1-k].
+//
+//	The coefficients are loaded in the same order as shalfband.v, via
+//	i_tap_wr and i_tap, for the (NTAPS+1)/4 unique non-zero coefficients
+//	not counting the center.  The first output of an impulse appears
+//	(NTAPS+1)/4+1 output samples after the impulse.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	hbdecim #(
+		// {{{
+		parameter			LGNTAPS = 7, IW=16, TW=12,
+						OW = IW+TW+LGNTAPS,
+		parameter	[LGNTAPS:0]	NTAPS = 107,
+		parameter	[0:0]		FIXED_TAPS = 1'b0,
+		parameter			INITIAL_COEFFS  = "",
+		// Set OPT_DUAL to accept two samples per clock
+		parameter	[0:0]		OPT_DUAL = 1'b0,
+		//
+		localparam			NMPY = (NTAPS+1)/4,
+		localparam			NLANES = OPT_DUAL ? 2 : 1
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		//
+		input	wire			i_tap_wr,	// Ignored if FIXED_TAPS
+		input	wire	[(TW-1):0]	i_tap,		// Ignored if FIXED_TAPS
+		//
+		input	wire			i_ce,
+		input	wire	[(NLANES*IW-1):0]	i_sample,
+		//
+		output	reg			o_ce,
+		output	wire	[(OW-1):0]	o_result
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	reg			pair_ce;
+	reg	[(IW-1):0]	pair_new, pair_old;
+
+	wire	[(TW-1):0]	tap		[0:NMPY-1];
+	wire	[(TW-1):0]	tapout		[0:NMPY-1];
+	wire	[(IW-1):0]	sample		[0:NMPY];
+	wire	[(OW-1):0]	result		[0:NMPY];
+	reg	[(IW-1):0]	mirror;
+	reg	[(IW-1):0]	cdelay		[0:NMPY-1];
+	reg	[(OW-1):0]	center;
+	wire			tap_wr;
+	integer			ik;
+	genvar	k;
+	// }}}
+
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Gather incoming samples into pairs
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	generate if (OPT_DUAL)
+	begin : GEN_DUAL
+		// {{{
+		initial	pair_ce  = 1'b0;
+		initial	pair_new = 0;
+		initial	pair_old = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+		begin
+			pair_ce  <= 1'b0;
+			pair_new <= 0;
+			pair_old <= 0;
+		end else begin
+			pair_ce <= i_ce;
+			if (i_ce)
+				{ pair_new, pair_old } <= i_sample;
+		end
+		// }}}
+	end else begin : GEN_PAIRS
+		// {{{
+		reg	phase;
+
+		initial	phase    = 1'b0;
+		initial	pair_ce  = 1'b0;
+		initial	pair_new = 0;
+		initial	pair_old = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+		begin
+			phase    <= 1'b0;
+			pair_ce  <= 1'b0;
+			pair_new <= 0;
+			pair_old <= 0;
+		end else begin
+			pair_ce <= i_ce && phase;
+			if (i_ce)
+			begin
+				phase <= !phase;
+				if (phase)
+					pair_new <= i_sample;
+				else
+					pair_old <= i_sample;
+			end
+		end
+		// }}}
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Coefficients
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Taps shift from the last symtap toward the first, so that the first
+	// coefficient written ends up in tap zero
+	generate if (FIXED_TAPS)
+	begin : LOAD_TAPS
+		reg	[(TW-1):0]	fixed_taps	[0:NMPY-1];
+
+		initial $readmemh(INITIAL_COEFFS, fixed_taps);
+
+		assign	tap_wr = 1'b0;
+		for(k=0; k<NMPY; k=k+1)
+		begin : ASSIGN_TAP
+			assign	tap[k] = fixed_taps[k];
+		end
+
+		// Verilator lint_off UNUSED
+		wire	unused_taps;
+		assign	unused_taps = &{ 1'b0, tapout[0] };
+		// Verilator lint_on  UNUSED
+	end else begin : GEN_TAP_UPDATES
+		assign	tap_wr = i_tap_wr;
+		assign	tap[NMPY-1] = i_tap;
+
+		for(k=0; k<NMPY-1; k=k+1)
+		begin : FORWARD_TAP
+			assign	tap[k] = tapout[k+1];
+		end
+
+		// Verilator lint_off UNUSED
+		wire	[(TW-1):0]	unused_tap;
+		assign	unused_tap = tapout[0];
+		// Verilator lint_on  UNUSED
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// The center tap
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// cdelay
+	// {{{
+	// The older sample of each pair lines up with the center tap NMPY-1
+	// pairs later.  The extra pairs of delay here are to match the
+	// pre-add and multiply of each symtap.
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		for(ik=0; ik<NMPY; ik=ik+1)
+			cdelay[ik] <= 0;
+	end else if (pair_ce)
+	begin
+		cdelay[0] <= pair_old;
+		for(ik=1; ik<NMPY; ik=ik+1)
+			cdelay[ik] <= cdelay[ik-1];
+	end
+	// }}}
+
+	// center
+	// {{{
+	// Multiply by 2^(TW-1)-1, just like shalfband's midprod
+	initial	center = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		center <= 0;
+	else if (pair_ce)
+		center <= { {(OW-IW-TW+1){cdelay[NMPY-1][IW-1]}},
+				cdelay[NMPY-1], {(TW-1){1'b0}} }
+			- { {(OW-IW){cdelay[NMPY-1][IW-1]}}, cdelay[NMPY-1] };
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// The symmetric filter, applied to the newer sample of each pair
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	sample[0] = pair_new;
+	assign	result[0] = center;
+
+	// mirror
+	// {{{
+	// With 2*NMPY taps, the sample paired with tap k's own sample is
+	// 2*NMPY-1-2k pairs older.  As in fastsymf.v, that's one more than the
+	// sample arriving at the last tap.
+	initial	mirror = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		mirror <= 0;
+	else if (pair_ce)
+		mirror <= sample[NMPY-1];
+	// }}}
+
+	generate for(k=0; k<NMPY; k=k+1)
+	begin: FILTER
+
+		symtap #(
+			// {{{
+			.FIXED_TAPS(FIXED_TAPS),
+				.IW(IW), .OW(OW), .TW(TW),
+				.INITIAL_VALUE(0)
+			// }}}
+		) tapk(
+			// {{{
+			i_clk, i_reset,
+			// Tap update circuitry
+			tap_wr, tap[k], tapout[k],
+			// Sample delay line
+			pair_ce, sample[k], mirror, sample[k+1],
+			// The output accumulator
+			result[k], result[k+1]
+			// }}}
+		);
+
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Outputs
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	initial	o_ce = 1'b0;
+	always @(posedge i_clk)
+		o_ce <= pair_ce && !i_reset;
+
+	assign	o_result = result[NMPY];
+	// }}}
+
+	// Make verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	[(TW+IW):0]	unused;
+	assign	unused = { i_tap_wr, i_tap, sample[NMPY] };
+	// verilator lint_on UNUSED
+	// }}}
+endmodule
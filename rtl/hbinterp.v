@@ -0,0 +1,269 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	hbinterp.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A full rate half-band interpolate by two filter, the
+//		counterpart to hbdecim.v.  Each input sample produces two
+//	outputs.  With OPT_DUAL set, both are produced together, and a new
+//	sample may be accepted every clock.  Without it, the two outputs are
+//	produced on consecutive clocks, and so there must be at least one idle
+//	clock between input samples.
+//
+//	Interpolating by two is the same as filtering the input with a zero
+//	inserted after every sample.  With a half-band filter of
+//	NTAPS = 4*NMPY-1 taps, the first (even) output of each pair is then a
+//	symmetric filter of 2*NMPY taps applied to the input, and the second
+//	(odd) output is simply a delayed input sample times the center tap.
+//	Every output pair therefore costs NMPY multiplies.  As with
+//	shalfband.v and hbdecim.v, the center tap is fixed at 2^(TW-1)-1.
+//
+//	With OPT_DUAL, the even (first) output is found in the low order bits
+//	of o_result.  Because of the inserted zeros, the gain of this filter is
+//	half the gain of hbdecim.v given the same coefficients.
+//
+//	The coefficients are loaded in the same order as shalfband.v, via
+//	i_tap_wr and i_tap, for the (NTAPS+1)/4 unique non-zero coefficients
+//	not counting the center.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	hbinterp #(
+		// {{{
+		parameter			LGNTAPS = 7, IW=16, TW=12,
+						OW = IW+TW+LGNTAPS,
+		parameter	[LGNTAPS:0]	NTAPS = 107,
+		parameter	[0:0]		FIXED_TAPS = 1'b0,
+		parameter			INITIAL_COEFFS  = "",
+		// Set OPT_DUAL to produce both outputs on the same clock
+		parameter	[0:0]		OPT_DUAL = 1'b0,
+		//
+		localparam			NMPY = (NTAPS+1)/4,
+		localparam			NLANES = OPT_DUAL ? 2 : 1
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		//
+		input	wire			i_tap_wr,	// Ignored if FIXED_TAPS
+		input	wire	[(TW-1):0]	i_tap,		// Ignored if FIXED_TAPS
+		//
+		input	wire			i_ce,
+		input	wire	[(IW-1):0]	i_sample,
+		//
+		output	reg			o_ce,
+		output	wire	[(NLANES*OW-1):0]	o_result
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	wire	[(TW-1):0]	tap		[0:NMPY-1];
+	wire	[(TW-1):0]	tapout		[0:NMPY-1];
+	wire	[(IW-1):0]	sample		[0:NMPY];
+	wire	[(OW-1):0]	result		[0:NMPY];
+	reg	[(IW-1):0]	mirror, mid_sample;
+	reg	[(OW-1):0]	odd_result;
+	wire			tap_wr;
+	genvar	k;
+	// }}}
+
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Coefficients
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Taps shift from the last symtap toward the first, so that the first
+	// coefficient written ends up in tap zero
+	generate if (FIXED_TAPS)
+	begin : LOAD_TAPS
+		reg	[(TW-1):0]	fixed_taps	[0:NMPY-1];
+
+		initial $readmemh(INITIAL_COEFFS, fixed_taps);
+
+		assign	tap_wr = 1'b0;
+		for(k=0; k<NMPY; k=k+1)
+		begin : ASSIGN_TAP
+			assign	tap[k] = fixed_taps[k];
+		end
+
+		// Verilator lint_off UNUSED
+		wire	unused_taps;
+		assign	unused_taps = &{ 1'b0, tapout[0] };
+		// Verilator lint_on  UNUSED
+	end else begin : GEN_TAP_UPDATES
+		assign	tap_wr = i_tap_wr;
+		assign	tap[NMPY-1] = i_tap;
+
+		for(k=0; k<NMPY-1; k=k+1)
+		begin : FORWARD_TAP
+			assign	tap[k] = tapout[k+1];
+		end
+
+		// Verilator lint_off UNUSED
+		wire	[(TW-1):0]	unused_tap;
+		assign	unused_tap = tapout[0];
+		// Verilator lint_on  UNUSED
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// The even outputs: a symmetric filter of 2*NMPY taps
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	sample[0] = i_sample;
+	assign	result[0] = 0;
+
+	// mirror
+	// {{{
+	// As in fastsymf.v, the sample paired with every tap's own sample is
+	// one sample older than the one arriving at the last tap
+	initial	mirror = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		mirror <= 0;
+	else if (i_ce)
+		mirror <= sample[NMPY-1];
+	// }}}
+
+	generate for(k=0; k<NMPY; k=k+1)
+	begin: FILTER
+
+		symtap #(
+			// {{{
+			.FIXED_TAPS(FIXED_TAPS),
+				.IW(IW), .OW(OW), .TW(TW),
+				.INITIAL_VALUE(0)
+			// }}}
+		) tapk(
+			// {{{
+			i_clk, i_reset,
+			// Tap update circuitry
+			tap_wr, tap[k], tapout[k],
+			// Sample delay line
+			i_ce, sample[k], mirror, sample[k+1],
+			// The output accumulator
+			result[k], result[k+1]
+			// }}}
+		);
+
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// The odd outputs: the center tap
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// The sample the center tap needs is one sample older than the mirror
+	// sample.  It also needs to come out alongside the even output, so
+	// it's delayed by one more sample to match the accumulator chain.
+	initial	mid_sample = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		mid_sample <= 0;
+	else if (i_ce)
+		mid_sample <= mirror;
+
+	// Multiply by 2^(TW-1)-1, just like shalfband's midprod
+	initial	odd_result = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		odd_result <= 0;
+	else if (i_ce)
+		odd_result <= { {(OW-IW-TW+1){mid_sample[IW-1]}},
+				mid_sample, {(TW-1){1'b0}} }
+			- { {(OW-IW){mid_sample[IW-1]}}, mid_sample };
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Outputs
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	generate if (OPT_DUAL)
+	begin : GEN_DUAL
+		// {{{
+		initial	o_ce = 1'b0;
+		always @(posedge i_clk)
+			o_ce <= i_ce && !i_reset;
+
+		assign	o_result = { odd_result, result[NMPY] };
+		// }}}
+	end else begin : GEN_SERIAL
+		// {{{
+		// Produce the even output the clock after it is produced, and
+		// the odd output the clock after that
+		reg			r_ce, second;
+		reg	[(OW-1):0]	r_result;
+
+		initial	{ o_ce, r_ce, second } = 3'b0;
+		always @(posedge i_clk)
+		if (i_reset)
+			{ o_ce, r_ce, second } <= 3'b0;
+		else begin
+			r_ce   <= i_ce;
+			second <= r_ce;
+			o_ce   <= r_ce || second;
+		end
+
+		initial	r_result = 0;
+		always @(posedge i_clk)
+		if (second)
+			r_result <= odd_result;
+		else
+			r_result <= result[NMPY];
+
+		assign	o_result = r_result;
+		// }}}
+	end endgenerate
+	// }}}
+
+	// Make verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	[(TW+IW):0]	unused;
+	assign	unused = { i_tap_wr, i_tap, sample[NMPY] };
+	// verilator lint_on UNUSED
+	// }}}
+endmodule
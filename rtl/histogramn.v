@@ -0,0 +1,367 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	histogramn.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A version of histogram.v that accepts NLANES samples per clock,
+//		rather than one.  This allows the histogram to keep up with
+//	an ADC producing samples at some multiple of the system clock rate.
+//
+//	The trick is that each sample lane gets its own ping-pong pair of
+//	memories.  Each lane's memory, therefore, only ever needs to handle
+//	one read-modify-write per clock--exactly as histogram.v does.  The
+//	same operand forwarding used there handles a lane hitting the same
+//	bin on back to back clocks.  Samples arriving on different lanes in
+//	the same clock can never collide, since they are counted in
+//	different memories.
+//
+//	Reading a bin over the bus reads that bin from every lane's memory,
+//	and returns the sum.  The result is therefore identical to what
+//	histogram.v would produce, had it been given the same NAVGS samples
+//	one at a time.
+//
+//	Lane 0 is found in the low order bits of i_sample, and is considered
+//	to be the first sample in time--although the order doesn't change
+//	the histogram.  NAVGS counts samples, not clocks, and so must be a
+//	multiple of NLANES.
+//
+//	All other behavior follows histogram.v: writing to the core restarts
+//	the current average, the memories swap and o_int is raised every
+//	NAVGS samples, and samples arriving while the new memory is being
+//	cleared are dropped.
+//
+// Resource usage: Each lane requires its own 2^(AW+1) words of memory,
+//		each of $clog2((NAVGS+NLANES-1)/NLANES+1) bits.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2017-2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	histogramn #(
+		// {{{
+		parameter	NAVGS = 65536,	// Samples per histogram
+		parameter	NLANES = 2,	// Samples per clock
+		localparam	ACCW = $clog2(NAVGS+1),
+		localparam	NCLOCKS = (NAVGS + NLANES - 1) / NLANES,
+		// Lanes counted on the last clock of an average
+		localparam	LASTLANES = NAVGS - (NCLOCKS-1) * NLANES,
+		localparam	LANEW = $clog2(NCLOCKS+1),
+		localparam	DW = 32,
+		parameter	AW = 12,
+		localparam	MEMSZ = (1<<(AW+1))
+		// }}}
+	) (
+		// {{{
+		input	wire				i_clk,
+		input	wire				i_reset,
+		// Wishbone interface
+		// {{{
+		input	wire				i_wb_cyc, i_wb_stb,
+							i_wb_we,
+		input	wire [AW-1:0]			i_wb_addr,
+		input	wire [32-1:0]			i_wb_data,
+		input	wire [3:0]			i_wb_sel,
+		output	reg				o_wb_stall,
+		output	reg				o_wb_ack,
+		output	reg [DW-1:0]			o_wb_data,
+		// }}}
+		//
+		input	wire			i_ce,
+		input	wire [NLANES*AW-1:0]	i_sample,
+		//
+		output	reg		o_int
+		// }}}
+	);
+
+	// Register wire declarations
+	// {{{
+	wire			bus_write, read_stall;
+	reg	[1:0]		pre_ack;
+
+	reg	[LANEW-1:0]		count;
+	reg				start_reset, resetpipe, activemem,
+					first_reset_clock;
+	reg	[2:0]			cepipe;
+	reg	[1:0]			lastpipe;
+	reg	[AW-1:0]		clear_addr;
+	wire	[AW-1:0]		next_clear_addr;
+	wire	[NLANES*LANEW-1:0]	lane_memval;
+	reg	[ACCW-1:0]		sum, lane_value;
+	integer				sk;
+
+	assign	bus_write  = i_wb_stb && i_wb_we;
+	assign	read_stall = i_ce && !resetpipe;
+	// }}}
+
+	//
+	// Count how many clocks (NLANES samples each) we've used in our
+	// block average
+	// {{{
+	initial	count = 0;
+	always @(posedge i_clk)
+	if (start_reset || resetpipe)
+		count <= 0;
+	else if (cepipe[0])
+	begin
+		if (count == NCLOCKS[LANEW-1:0]-1)
+			count <= 0;
+		else
+			count <= count + 1;
+	end
+	// }}}
+
+	//
+	// Control when we start our reset cycle.
+	// {{{
+	// As with histogram.v, there are three possible reasons to start the
+	// reset cycle: an external reset, writing the last sample of our
+	// average set, or a bus write.  Only the second swaps memories.
+	//
+	initial	start_reset = 1;
+	always @(posedge i_clk)
+	begin
+		start_reset <= 0;
+
+		if (cepipe[0] && (count == NCLOCKS[LANEW-1:0]-1))
+			start_reset <= 1;
+
+		if (bus_write)
+			start_reset <= 1;
+
+		if (resetpipe)
+			start_reset <= 0;
+		if (i_reset)
+			start_reset <= 1;
+	end
+
+	always @(posedge i_clk)
+		first_reset_clock <= start_reset;
+
+	initial	resetpipe = 0;
+	always @(posedge i_clk)
+	if (start_reset || first_reset_clock)
+		resetpipe <= 1;
+	else if (&clear_addr)
+		resetpipe <= 0;
+
+	// clear_addr: the address being cleared, shared by all lanes
+	assign	next_clear_addr = (first_reset_clock) ? {(AW){1'b0}}
+					: (clear_addr + 1'b1);
+
+	initial	clear_addr = 0;
+	always @(posedge i_clk)
+	if (resetpipe)
+		clear_addr <= next_clear_addr;
+	// }}}
+
+	// activemem, o_int: select between one of two memories to record into
+	// {{{
+	initial	activemem = 0;
+	initial	o_int = 0;
+	always @(posedge i_clk)
+	begin
+		o_int <= 0;
+		if (cepipe[0] && !start_reset && count == NCLOCKS[LANEW-1:0]-1)
+		begin
+			activemem <= !activemem;
+			o_int <= 1;
+		end
+
+		if (i_reset)
+			o_int <= 0;
+	end
+	// }}}
+
+	// cepipe: Track i_ce through our three clocks of operations.
+	// {{{
+	initial	cepipe = 0;
+	always @(posedge i_clk)
+	if (resetpipe)
+		cepipe <= 3'b100;
+	else
+		cepipe <= { cepipe[1:0], i_ce };
+	// }}}
+
+	// lastpipe: Track the last clock of an average through the pipeline
+	// {{{
+	// Lanes beyond NAVGS on this clock must not be written to memory.
+	initial	lastpipe = 0;
+	always @(posedge i_clk)
+	if (resetpipe)
+		lastpipe <= 2'b00;
+	else
+		lastpipe <= { lastpipe[0],
+				cepipe[0] && (count == NCLOCKS[LANEW-1:0]-1) };
+	// }}}
+
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Per lane memories
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	genvar	gk;
+	generate for(gk=0; gk<NLANES; gk=gk+1)
+	begin : LANE
+		// {{{
+		reg	[LANEW-1:0]	mem	[0:MEMSZ-1];
+		reg	[LANEW-1:0]	memval_raw, memnew, bypass_value;
+		wire	[LANEW-1:0]	memval;
+		reg	[AW:0]		read_addr, r_sample, memaddr;
+		reg			bypass_active;
+		wire			lane_write;
+		integer			ik;
+
+		// Lanes past NAVGS on the last clock of an average don't count
+		assign	lane_write = cepipe[2] && (gk < LASTLANES || !lastpipe[1]);
+
+		// Zero out our memory initially
+		// {{{
+		initial	begin
+			for(ik=0; ik<MEMSZ; ik=ik+1)
+				mem[ik] = 0;
+		end
+		// }}}
+
+		// Cycle one: Read from memory on an input sample, from bus
+		// otherwise
+		// {{{
+		always @(posedge i_clk)
+		if (read_stall)
+			read_addr <= { activemem, i_sample[gk*AW +: AW] };
+		else
+			read_addr <= { !activemem, i_wb_addr };
+		// }}}
+
+		// Cycle two: Read from memory, keep track of the address
+		// {{{
+		always @(posedge i_clk)
+			memval_raw <= mem[read_addr];
+
+		always @(posedge i_clk)
+			bypass_value <= memnew;
+
+		always @(posedge i_clk)
+			bypass_active <= lane_write && (read_addr == memaddr);
+
+		assign	memval = (bypass_active) ? bypass_value : memval_raw;
+
+		always @(posedge i_clk)
+			r_sample <= read_addr;
+		// }}}
+
+		// Cycle two: Add to our memory value, or clear it
+		// {{{
+		initial	memaddr = 0;
+		initial	memnew  = 0;
+		always @(posedge i_clk)
+		if (resetpipe)
+		begin
+			memnew  <= 0;
+			memaddr <= { activemem, next_clear_addr };
+		end else begin
+			memaddr <= r_sample;
+
+			memnew  <= memval + 1;
+
+			// Unless ... we just calculated this value and it
+			// hasn't been written to memory yet
+			if (lane_write && r_sample == memaddr)
+				memnew  <= memnew + 1;
+		end
+		// }}}
+
+		// Clock three: Write to memory
+		// {{{
+		always @(posedge i_clk)
+		if (lane_write)
+			mem[memaddr] <= memnew;
+		// }}}
+
+		assign	lane_memval[gk*LANEW +: LANEW] = memval;
+		// }}}
+	end endgenerate
+	// }}}
+
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Handle the bus read interactions
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Add the lanes together for the bus
+	// {{{
+	always @(*)
+	begin
+		sum = 0;
+		for(sk=0; sk<NLANES; sk=sk+1)
+		begin
+			lane_value = 0;
+			lane_value[LANEW-1:0] = lane_memval[sk*LANEW +: LANEW];
+			sum = sum + lane_value;
+		end
+	end
+	// }}}
+
+	always @(posedge i_clk)
+	begin
+		o_wb_data <= 0;
+		o_wb_data[ACCW-1:0] <= sum;
+	end
+
+	initial pre_ack = 2'b00;
+	always @(posedge i_clk)
+	if (i_reset || !i_wb_cyc)
+		pre_ack <= 2'b00;
+	else
+		pre_ack <= { pre_ack[0], i_wb_stb && !o_wb_stall };
+
+	initial o_wb_ack = 0;
+	always @(posedge i_clk)
+		o_wb_ack <= !i_reset && i_wb_cyc && pre_ack[1];
+
+	always @(*)
+		o_wb_stall = read_stall;
+	// }}}
+
+	// Keep Verilator happy
+	// {{{
+	// Verilator lint_off UNUSED
+	wire	unused;
+	assign	unused = &{ 1'b0, i_wb_data, i_wb_sel };
+	// Verilator lint_on UNUSED
+	// }}}
+endmodule
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	iiravg_tdm.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A channelized version of iiravg.v, for keeping hundreds of
+//		averages (such as power estimates) at once.  Samples from all
+//	channels arrive, interleaved in time, on the same i_ce/i_data
+//	interface, tagged with the channel they belong to.  Each channel's
+//	average is kept in a block RAM, and updated exactly as iiravg.v would
+//	update it.  The new average is then produced, tagged with the same
+//	channel, two clocks later.
+//
+//	One sample may be accepted on every clock, from any channel, in any
+//	order--including the same channel twice in a row.  Up to 2^LGNCHAN
+//	channels may therefore share this core, so long as their sample rates
+//	sum to no more than the clock rate.
+//
+//	A reset returns every channel to RESET_VALUE at once.  This is done
+//	with one flag per channel, marking whether it's been written since the
+//	reset, rather than by clearing the memory.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	iiravg_tdm #(
+		// {{{
+		parameter	IW=15, OW=16, LGALPHA=4,
+		parameter	[OW-1:0]	RESET_VALUE = 0,
+		// Log (base two) of the number of channels
+		parameter	LGNCHAN = 8,
+		localparam	AW=OW,
+		localparam	NCHAN = (1<<LGNCHAN)
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		//
+		input	wire			i_ce,
+		input	wire	[(LGNCHAN-1):0]	i_chan,
+		input	wire	[(IW-1):0]	i_data,
+		//
+		output	reg			o_ce,
+		output	reg	[(LGNCHAN-1):0]	o_chan,
+		output	reg	[(OW-1):0]	o_data
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	reg	[(AW-1):0]	mem	[0:(NCHAN-1)];
+	reg	[(NCHAN-1):0]	chan_valid;
+
+	reg			r_ce, r_valid, r_forward;
+	reg	[(LGNCHAN-1):0]	r_chan;
+	reg	[(IW-1):0]	r_data;
+	reg	[(AW-1):0]	r_memval;
+
+	wire	[(AW-1):0]	r_average, next_average;
+	wire	signed [(AW-1):0]	difference, adjustment;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Clock one: Read the channel's last average
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// r_ce
+	// {{{
+	initial	r_ce = 1'b0;
+	always @(posedge i_clk)
+	if (i_reset)
+		r_ce <= 1'b0;
+	else
+		r_ce <= i_ce;
+	// }}}
+
+	// r_chan, r_data
+	// {{{
+	always @(posedge i_clk)
+	if (i_ce)
+	begin
+		r_chan <= i_chan;
+		r_data <= i_data;
+	end
+	// }}}
+
+	// Read from memory
+	// {{{
+	// As with delayw.v, keep this simple so it maps to block RAM
+	always @(posedge i_clk)
+	if (i_ce)
+		r_memval <= mem[i_chan];
+	// }}}
+
+	// r_forward, r_valid
+	// {{{
+	// If the last sample was from this same channel, its result won't have
+	// been written to memory in time to be read above.  Instead, we'll
+	// pick it up from o_data on the next clock.  Channels that haven't
+	// been written since the last reset use RESET_VALUE instead of memory.
+	initial	r_forward = 1'b0;
+	initial	r_valid   = 1'b0;
+	always @(posedge i_clk)
+	if (i_ce)
+	begin
+		r_forward <= r_ce && (r_chan == i_chan);
+		r_valid   <= chan_valid[i_chan];
+	end
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Clock two: Update the average, exactly as iiravg.v does
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	assign	r_average = (r_forward) ? o_data
+			: (r_valid) ? r_memval : RESET_VALUE;
+
+	assign	difference = { r_data, {(AW-IW){1'b0}} } - r_average;
+	assign	adjustment ={ {(LGALPHA){(difference[(AW-1)])}},
+				difference[(AW-1):LGALPHA] };
+	assign	next_average = r_average + adjustment;
+
+	// Write to memory
+	// {{{
+	always @(posedge i_clk)
+	if (r_ce)
+		mem[r_chan] <= next_average;
+	// }}}
+
+	// chan_valid
+	// {{{
+	initial	chan_valid = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		chan_valid <= 0;
+	else if (r_ce)
+		chan_valid[r_chan] <= 1'b1;
+	// }}}
+
+	// o_ce
+	// {{{
+	initial	o_ce = 1'b0;
+	always @(posedge i_clk)
+	if (i_reset)
+		o_ce <= 1'b0;
+	else
+		o_ce <= r_ce;
+	// }}}
+
+	// o_chan, o_data
+	// {{{
+	initial	o_chan = 0;
+	initial	o_data = RESET_VALUE;
+	always @(posedge i_clk)
+	if (r_ce)
+	begin
+		o_chan <= r_chan;
+		o_data <= next_average;
+	end
+	// }}}
+	// }}}
+endmodule
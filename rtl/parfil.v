@@ -0,0 +1,388 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	parfil.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A filter somewhere between slowfil.v and fastfir.v.  slowfil.v
+//		uses one multiply, and so needs NTAPS clocks per sample.
+//	fastfir.v uses NTAPS multiplies, and can accept a sample every clock.
+//	This filter uses P multiplies, and needs NB = ceil(NTAPS/P) clocks
+//	per sample.  The coefficient loading interface is the same as
+//	slowfil's.
+//
+//	The taps are split into P lanes of NB taps each.  Lane p handles taps
+//	p*NB through p*NB+NB-1, and works just like a slowfil of NB taps,
+//	having its own multiply, coefficient memory, and sample memory.  Each
+//	lane reads its samples oldest first.  The first sample each lane reads
+//	is then the newest sample the next lane will need on the next i_ce, so
+//	it is passed on to the next lane's sample memory.  Each lane's memory,
+//	therefore, only needs to hold NB samples.  The P products from each
+//	clock are summed with a pipelined adder tree, and then accumulated.
+//
+//	There must be at least NB clocks between any two i_ce's.  NB must be
+//	at least two--for P > NTAPS/2, use fastfir.v.  As with slowfil, the
+//	sample memories are not reset.  The result of each sample is produced,
+//	with o_ce, as soon as it is ready.
+//
+// Resource usage: P multiplies, and 2*P*2^ceil(log_2(NB)) memory words:
+//		half for coefficients, and half for samples.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	parfil #(
+		// {{{
+		parameter	LGNTAPS = 7, IW=16, TW=16, OW = IW+TW+LGNTAPS,
+		parameter	[LGNTAPS:0]	NTAPS = 110, // (1<<LGNTAPS);
+		// P is the number of multiplies
+		parameter			P = 4,
+		// NB is the number of taps per lane, and clocks per sample
+		localparam			NB = (NTAPS+P-1)/P,
+		localparam			LGNB = $clog2(NB),
+		localparam			LGP = $clog2(P),
+		localparam			MEMSZ = (1<<LGNB)
+		// }}}
+	) (
+		// {{{
+		// Control inputs (wires)
+		input	wire		i_clk, i_reset,
+		//
+		// Coefficient control -- allows you to update coefficients
+		// {{{
+		// in the filter
+		input	wire			i_tap_wr,
+		input	wire	[(TW-1):0]	i_tap,
+		// }}}
+		// New sample input(s)--a new sample comes in any time i_ce is
+		// {{{
+		// true.  There must be at least NB clocks between every pair
+		// of valid i_ce's.
+		input	wire			i_ce,
+		input	wire	[(IW-1):0]	i_sample,
+		// }}}
+		// The output--valid any time o_ce is true.
+		// {{{
+		output	reg			o_ce,
+		output	reg	[(OW-1):0]	o_result
+		// }}}
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	localparam	[(LGNB-1):0]	LAST_TAP = NB-1;
+
+	// Which lane, and which index within it, the next tap is written to
+	reg	[LGP:0]		twlane;
+	reg	[(LGNB-1):0]	twidx;
+
+	// Coefficient read index, shared by all lanes
+	reg	[(LGNB-1):0]	tidx;
+	wire			last_tap_index;
+
+	// Traveling CE values.  pre_acc_ce[0] means the indexes are valid,
+	// and pre_acc_ce[LGP+2] means the sum of all lane products is valid.
+	// first_ce and last_ce mark the first and last of these for each
+	// sample.
+	reg			m_ce, d_ce;
+	reg	[LGP+2:0]	pre_acc_ce, first_ce, last_ce;
+
+	wire	[(IW-1):0]	lane_data	[0:P];
+	wire	[(OW-1):0]	lane_product	[0:(1<<LGP)-1];
+	wire	[(OW-1):0]	sum;
+
+	reg	signed [(OW-1):0]	r_acc;
+	wire	signed [(OW-1):0]	next_acc;
+	genvar	gk;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Allow the user to set the taps
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Starting at zero on reset, walk through each lane in turn on any
+	// write of a new tap.  As with slowfil, changing coefficients will
+	// require a reset.
+	initial	twlane = 0;
+	initial	twidx  = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		twlane <= 0;
+		twidx  <= 0;
+	end else if (i_tap_wr)
+	begin
+		if (twidx == LAST_TAP)
+		begin
+			twlane <= twlane + 1'b1;
+			twidx  <= 0;
+		end else
+			twidx  <= twidx + 1'b1;
+	end
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Calculate the indexes of the filter table
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Taps are read from the oldest sample (index NB-1) to the newest
+	// (index zero)
+	assign	last_tap_index = (tidx == 0);
+
+	// pre_acc_ce[0]
+	// {{{
+	initial	pre_acc_ce = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		pre_acc_ce[0] <= 1'b0;
+	else if (i_ce)
+		pre_acc_ce[0] <= 1'b1;
+	else if ((pre_acc_ce[0])&&(!last_tap_index))
+		pre_acc_ce[0] <= 1'b1;
+	else
+		pre_acc_ce[0] <= 1'b0;
+	// }}}
+
+	// pre_acc_ce[LGP+2:1], first_ce, last_ce
+	// {{{
+	initial	first_ce = 0;
+	initial	last_ce  = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		pre_acc_ce[LGP+2:1] <= 0;
+		first_ce <= 0;
+		last_ce  <= 0;
+	end else begin
+		pre_acc_ce[LGP+2:1] <= pre_acc_ce[LGP+1:0];
+		first_ce <= { first_ce[LGP+1:0], i_ce };
+		last_ce  <= { last_ce[LGP+1:1],
+				(pre_acc_ce[0])&&(last_tap_index), 1'b0 };
+	end
+	// }}}
+
+	// tidx
+	// {{{
+	initial	tidx = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		tidx <= LAST_TAP;
+	else if (tidx != 0)
+		tidx <= tidx - 1'b1;
+	// }}}
+
+	// m_ce is valid when the first index is valid, d_ce when the first
+	// data from memory is valid
+	// {{{
+	initial	m_ce = 1'b0;
+	initial	d_ce = 1'b0;
+	always @(posedge i_clk)
+	begin
+		m_ce <= (i_ce)&&(!i_reset);
+		d_ce <= (m_ce)&&(!i_reset);
+	end
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// The lanes
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Lane zero's newest sample is our input
+	assign	lane_data[0] = i_sample;
+
+	generate for(gk=0; gk<P; gk=gk+1)
+	begin : LANE
+		// {{{
+		localparam	[LGP:0]	LANE_ID = gk;
+
+		reg	[(TW-1):0]	tapmem	[0:(MEMSZ-1)];
+		reg	[(IW-1):0]	dmem	[0:(MEMSZ-1)];
+		reg	[(LGNB-1):0]	dwidx, didx;
+		reg signed [(TW-1):0]	tap;
+		reg signed [(IW-1):0]	data;
+		reg signed [(IW+TW-1):0]	product;
+		wire			dwr;
+		integer			ik;
+
+		// Coefficients
+		// {{{
+		// Any taps beyond NTAPS in the last lane are never written, and
+		// so must start at zero.
+		initial	for(ik=0; ik<MEMSZ; ik=ik+1)
+			tapmem[ik] = 0;
+
+		always @(posedge i_clk)
+		if ((i_tap_wr)&&(twlane == LANE_ID))
+			tapmem[twidx] <= i_tap;
+		// }}}
+
+		// Record the newest sample
+		// {{{
+		// Lane zero writes a sample on every i_ce.  Every other lane
+		// writes the first (oldest) sample read by the lane before it,
+		// once it's been read.
+		if (gk == 0)
+		begin : FROM_INPUT
+			assign	dwr = i_ce;
+		end else begin : FROM_LANE
+			assign	dwr = d_ce;
+		end
+
+		initial	dwidx = 0;
+		always @(posedge i_clk)
+		if (dwr)
+			dwidx <= dwidx + 1'b1;
+
+		always @(posedge i_clk)
+		if (dwr)
+			dmem[dwidx] <= lane_data[gk];
+		// }}}
+
+		// didx
+		// {{{
+		// Start from the oldest of the NB newest samples--counting
+		// any sample being written on this same clock
+		initial	didx = 0;
+		always @(posedge i_clk)
+		if ((i_ce)&&(dwr))
+			didx <= dwidx - LAST_TAP;
+		else if (i_ce)
+			didx <= dwidx - LAST_TAP - 1'b1;
+		else
+			didx <= didx + 1'b1;
+		// }}}
+
+		// Read from memory, and multiply
+		// {{{
+		initial	tap = 0;
+		always @(posedge i_clk)
+			tap <= tapmem[tidx];
+
+		initial	data = 0;
+		always @(posedge i_clk)
+			data <= dmem[didx];
+
+		initial	product = 0;
+		always @(posedge i_clk)
+			product <= tap * data;
+		// }}}
+
+		assign	lane_data[gk+1] = data;
+		assign	lane_product[gk] = { {(OW-(IW+TW)){product[(IW+TW-1)]}},
+						product };
+		// }}}
+	end for(gk=P; gk<(1<<LGP); gk=gk+1)
+	begin : UNUSED_LANE
+		assign	lane_product[gk] = 0;
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Sum the lane products together
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	generate if (LGP == 0)
+	begin : NO_TREE
+		assign	sum = lane_product[0];
+	end else begin : ADDER_TREE
+		// A binary tree, one registered level at a time.  Node k's
+		// children are nodes 2k+1 and 2k+2, and the leaves are the
+		// lane products.
+		reg	[(OW-1):0]	node	[0:(1<<LGP)-2];
+		wire	[(OW-1):0]	child	[0:(2<<LGP)-2];
+		integer			ik;
+
+		for(gk=0; gk<(1<<LGP)-1; gk=gk+1)
+		begin : NODE
+			assign	child[gk] = node[gk];
+		end
+
+		for(gk=0; gk<(1<<LGP); gk=gk+1)
+		begin : LEAF
+			assign	child[(1<<LGP)-1+gk] = lane_product[gk];
+		end
+
+		initial	for(ik=0; ik<(1<<LGP)-1; ik=ik+1)
+			node[ik] = 0;
+		always @(posedge i_clk)
+		for(ik=0; ik<(1<<LGP)-1; ik=ik+1)
+			node[ik] <= child[2*ik+1] + child[2*ik+2];
+
+		assign	sum = node[0];
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Accumulate, and produce an output
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	next_acc = ((first_ce[LGP+2]) ? 0 : r_acc) + sum;
+
+	initial	r_acc = 0;
+	always @(posedge i_clk)
+	if (pre_acc_ce[LGP+2])
+		r_acc <= next_acc;
+
+	initial	o_result = 0;
+	always @(posedge i_clk)
+	if (last_ce[LGP+2])
+		o_result <= next_acc;
+
+	initial	o_ce = 1'b0;
+	always @(posedge i_clk)
+		o_ce <= (last_ce[LGP+2])&&(!i_reset);
+	// }}}
+
+	// Make verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	unused;
+	assign	unused = &{ 1'b0, lane_data[P], last_ce[0] };
+	// verilator lint_on UNUSED
+	// }}}
+endmodule
@@ -0,0 +1,254 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	pipefir.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A fully pipelined version of fastfir.v, for large numbers of
+//		taps.  Like fastfir, this is a transposed form filter: each
+//	incoming sample is multiplied by every tap at once, and the products
+//	are summed along a chain of partial accumulators, one register per
+//	tap.  Every adder therefore only ever adds two numbers together.
+//
+//	The problem with fastfir at large NTAPS is that single input sample,
+//	which must drive all NTAPS multipliers.  Here, the sample is instead
+//	distributed through a tree of registers, with no register driving more
+//	than 2^LGFANOUT others.  OPT_MPYREG adds one more register per tap, in
+//	front of the multiply, as a DSP's input register would.
+//
+//	Every pipeline stage moves only on i_ce, so the result is identical to
+//	fastfir's, only delayed by LATENCY more samples.  LATENCY is available
+//	to a test bench through the o_latency output.
+//
+//	OPT_SHADOW and i_tap_commit work as they do in fastfir.v.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	pipefir #(
+		// {{{
+		parameter		NTAPS=128, IW=12, TW=IW, OW=2*IW+7,
+		parameter [0:0]		FIXED_TAPS=0,
+		// Load new coefficients into a shadow bank, and only swap
+		// them in on i_tap_commit
+		parameter [0:0]		OPT_SHADOW=0,
+		// Each sample register drives at most 2^LGFANOUT others
+		parameter		LGFANOUT=4,
+		// Register the sample again in front of each multiply
+		parameter [0:0]		OPT_MPYREG=1,
+		//
+		localparam	LGNTAPS = $clog2(NTAPS),
+		localparam	NTREE = (LGNTAPS + LGFANOUT - 1) / LGFANOUT,
+		localparam	NLVL  = NTREE + (OPT_MPYREG ? 1:0),
+		// Samples of delay beyond fastfir
+		localparam	LATENCY = NLVL
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		//
+		input	wire			i_tap_wr,	// Ignored if FIXED_TAPS
+		input	wire	[(TW-1):0]	i_tap,		// Ignored if FIXED_TAPS
+		input	wire			i_tap_commit,	// Requires OPT_SHADOW
+		//
+		input	wire			i_ce,
+		input	wire	[(IW-1):0]	i_sample,
+		output	wire	[(OW-1):0]	o_result,
+		//
+		output	wire	[31:0]		o_latency
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	wire	[(TW-1):0] tap		[NTAPS:0];
+	wire	[(TW-1):0] tapout	[NTAPS:0];
+	wire	[(IW-1):0] sample	[0:NTAPS-1];
+	wire	[(OW-1):0] result	[NTAPS:0];
+	wire		tap_wr;
+	wire	[NTAPS:0]	commit;
+	genvar	k, lvl;
+
+	// lvlshift
+	// {{{
+	// Each register at level lvl of the distribution tree feeds
+	// 2^lvlshift(lvl) taps
+	function integer lvlshift(input integer l);
+	begin
+		if (l < NTREE)
+			lvlshift = LGFANOUT * (NTREE - l);
+		else
+			lvlshift = 0;
+	end endfunction
+	// }}}
+	// }}}
+
+	// Initialize the partial summing accumulator with zero
+	assign	result[0]	= 0;
+
+	// Initialize coefficients
+	// {{{
+	generate if(FIXED_TAPS)
+	begin : LOAD_TAPS
+		initial $readmemh("taps.hex", tap);
+
+		assign	tap_wr = 1'b0;
+	end else begin : GEN_TAP_UPDATES
+		assign	tap_wr = i_tap_wr;
+		assign	tap[0] = i_tap;
+	end endgenerate
+	// }}}
+
+	// Coefficient commits
+	// {{{
+	// A commit is passed from tap to tap on each new sample, starting
+	// with the first sample following i_tap_commit.
+	generate if (OPT_SHADOW && !FIXED_TAPS)
+	begin : GEN_COMMIT
+		reg	commit_pending;
+
+		initial	commit_pending = 1'b0;
+		always @(posedge i_clk)
+		if (i_reset || i_ce)
+			commit_pending <= 1'b0;
+		else if (i_tap_commit)
+			commit_pending <= 1'b1;
+
+		assign	commit[0] = i_tap_commit || commit_pending;
+	end else begin : NO_COMMIT
+		assign	commit[0] = 1'b0;
+	end endgenerate
+	// }}}
+
+	assign	tapout[0] = 0;
+
+	// Sample distribution tree
+	// {{{
+	// Register m of level lvl is found in bcast[lvl*NTAPS+m].  Only the
+	// first ((NTAPS-1) >> lvlshift(lvl))+1 of each level are used.
+	generate if (NLVL == 0)
+	begin : NO_DISTRIBUTION
+		for(k=0; k<NTAPS; k=k+1)
+		begin : SAMPLE
+			assign	sample[k] = i_sample;
+		end
+	end else begin : DISTRIBUTION_TREE
+		reg	[(IW-1):0]	bcast	[0:NLVL*NTAPS-1];
+
+		for(lvl=0; lvl<NLVL; lvl=lvl+1)
+		begin : LEVEL
+			for(k=0; k <= ((NTAPS-1) >> lvlshift(lvl)); k=k+1)
+			begin : REGISTER
+				wire	[(IW-1):0]	source;
+
+				if (lvl == 0)
+				begin : FROM_INPUT
+					assign	source = i_sample;
+				end else begin : FROM_PARENT
+					assign	source = bcast[(lvl-1)*NTAPS
+					+ (k >> (lvlshift(lvl-1)-lvlshift(lvl)))];
+				end
+
+				initial	bcast[lvl*NTAPS+k] = 0;
+				always @(posedge i_clk)
+				if (i_reset)
+					bcast[lvl*NTAPS+k] <= 0;
+				else if (i_ce)
+					bcast[lvl*NTAPS+k] <= source;
+			end
+		end
+
+		for(k=0; k<NTAPS; k=k+1)
+		begin : SAMPLE
+			assign	sample[k] = bcast[(NLVL-1)*NTAPS
+					+ (k >> lvlshift(NLVL-1))];
+		end
+	end endgenerate
+	// }}}
+
+	generate for(k=0; k<NTAPS; k=k+1)
+	begin: FILTER
+		// verilator lint_off UNUSED
+		wire	[(IW-1):0]	unused_sample;
+		// verilator lint_on  UNUSED
+
+		firtap #(
+			// {{{
+			.FIXED_TAPS(FIXED_TAPS),
+				.IW(IW), .OW(OW), .TW(TW),
+				.INITIAL_VALUE(0),
+				.OPT_SHADOW(OPT_SHADOW)
+			// }}}
+		) tapk(
+			// {{{
+			i_clk, i_reset,
+			// Tap update circuitry
+			tap_wr, tap[k], tapout[k+1],
+			// Sample delay line.  This is unused, since every
+			// tap gets its sample from the distribution tree.
+			i_ce, sample[k], unused_sample,
+			// The output accumulator
+			result[k], result[k+1],
+			// Coefficient bank swaps
+			commit[k], commit[k+1]
+			// }}}
+		);
+
+		if (!FIXED_TAPS)
+		begin : FORWARD_TAP
+			assign	tap[k+1] = tapout[k+1];
+		end
+
+		// Make verilator happy
+		// {{{
+		// verilator lint_off UNUSED
+		wire	[(TW-1):0]	unused_tap;
+		if (FIXED_TAPS)
+		begin : UNUSED_TAP
+			assign	unused_tap    = tapout[k+1];
+		end
+		// verilator lint_on UNUSED
+		// }}}
+	end endgenerate
+
+	assign	o_result  = result[NTAPS];
+	assign	o_latency = LATENCY;
+
+	// Make verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	[(TW+2):0]	unused;
+	assign	unused = { i_tap_wr, i_tap, i_tap_commit, commit[NTAPS] };
+	// verilator lint_on UNUSED
+	// }}}
+endmodule
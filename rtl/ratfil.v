@@ -8,6 +8,16 @@
 //		interface.  Due to its construction, this can *only* be a
 //	downsampling resampler.  Hence, the amount to upsample by (prior
 //	to downsampling) must be less than the downsample factor.
+//	For upsampling, or for any other rational rate change, see
+//	resampler.v.
+//
+//	If OPT_SHADOW is set, the coefficients can be changed while the
+//	filter runs.  i_tap_wr then writes into a second bank, and an
+//	i_tap_commit strobe swaps the two banks.  The swap takes place at
+//	the start of the first group of NS streams to be filtered that's
+//	accepted on the same clock as the commit or later, so all of the
+//	streams switch together.  The commit also resets the write index,
+//	and i_tap_wr is ignored from the commit until the swap.
 //
 // Implementation notes:
 //	Unfortunately, the verification of the *LAST* output based upon
@@ -63,6 +73,9 @@ module ratfil #(
 		localparam		LGNCOEFFS = $clog2(NCOEFFS),
 		parameter	[0:0]	OPT_SKIDBUFFER = 1'b0,
 		parameter	[0:0]	OPT_FIXED_TAPS = 1'b0,
+		// OPT_SHADOW: double buffer the coefficients, so they may be
+		// changed while the filter runs.  Ignored if OPT_FIXED_TAPS.
+		parameter	[0:0]	OPT_SHADOW = 1'b0,
 		parameter		INITIAL_COEFFS = ""
 		// }}}
 	) (
@@ -85,6 +98,8 @@ module ratfil #(
 		// {{{
 		input	wire			i_tap_wr,
 		input	wire	[TW-1:0]	i_tap,
+		// Swap coefficient banks.  Ignored unless OPT_SHADOW
+		input	wire			i_tap_commit,
 		// }}}
 		// Incoming data stream, at the faster clock rate
 		// {{{
@@ -111,12 +126,14 @@ module ratfil #(
 	localparam	PW = IW + TW;			// Product width
 	localparam	CBITS = $clog2(NCOEFFS+2*NUP)+1;
 	localparam	SKIPW = $clog2(NDOWN / NUP + 1);
+	localparam	LGCMEM = LGNCOEFFS + (OPT_SHADOW ? 1:0);
 
 	wire			skd_valid, skd_ready, skd_last;
 	wire	[IW-1:0]	skd_data;
 
 	reg	[IW-1:0]		dmem	[0:(1<<LGMEM)-1];
-	reg	[TW-1:0]		cmem	[0:(1<<LGNCOEFFS)-1];
+	reg	[TW-1:0]		cmem	[0:(1<<LGCMEM)-1];
+	wire	[LGCMEM-1:0]		caddr;
 
 	reg	[CBITS-1:0]		coefficient_index, starting_coefficient_index, next_firstc;
 	reg	[LGMEM-1:0]		data_index, data_write_address;
@@ -179,10 +196,13 @@ module ratfil #(
 		// {{{
 		// Verilator lint_off UNUSED
 		wire	ignored_inputs;
-		assign	ignored_inputs = &{ 1'b0, i_tap_wr, i_tap };
+		assign	ignored_inputs = &{ 1'b0, i_tap_wr, i_tap_commit, i_tap };
 		// Verilator lint_on  UNUSED
+
+		assign	caddr = coefficient_index[LGNCOEFFS-1:0];
 		// }}}
-	end else begin : LOAD_COEFFICIENTS
+	end else if (!OPT_SHADOW)
+	begin : LOAD_COEFFICIENTS
 		// {{{
 		reg	[LGNCOEFFS-1:0]	wr_coeff_index;
 
@@ -196,6 +216,70 @@ module ratfil #(
 		always @(posedge S_AXI_ACLK)
 		if (i_tap_wr)
 			cmem[wr_coeff_index] <= i_tap;
+
+		assign	caddr = coefficient_index[LGNCOEFFS-1:0];
+
+		// Verilator lint_off UNUSED
+		wire	ignored_commit;
+		assign	ignored_commit = i_tap_commit;
+		// Verilator lint_on  UNUSED
+		// }}}
+	end else begin : SHADOW_COEFFICIENTS
+		// {{{
+		// New coefficients are written to wr_bank, while the filter
+		// reads from rd_bank.  Every output is read on the clocks
+		// following the beat that starts it.  So that every stream
+		// switches on the same input sample, the banks only swap when
+		// a run starts with the first beat of a group.  A commit on
+		// that same clock applies to that very group.  Otherwise it's
+		// held pending until then, and coefficient writes are ignored
+		// in the meantime.
+		reg	[LGNCOEFFS-1:0]	wr_coeff_index;
+		reg			wr_bank, rd_bank, first_beat,
+					commit_pending;
+		wire			group_start, tap_wr, swap;
+
+		initial	first_beat = 1'b1;
+		always @(posedge S_AXI_ACLK)
+		if (!S_AXI_ARESETN)
+			first_beat <= 1'b1;
+		else if (skd_valid && skd_ready)
+			first_beat <= skd_last;
+
+		assign	group_start = skd_valid && skd_ready && !skip_run
+					&& first_beat;
+
+		initial	commit_pending = 1'b0;
+		always @(posedge S_AXI_ACLK)
+		if (!S_AXI_ARESETN || group_start)
+			commit_pending <= 1'b0;
+		else if (i_tap_commit)
+			commit_pending <= 1'b1;
+
+		assign	swap = group_start && (i_tap_commit || commit_pending);
+		assign	tap_wr = i_tap_wr && !i_tap_commit && !commit_pending;
+
+		initial	wr_coeff_index = 0;
+		always @(posedge S_AXI_ACLK)
+		if (!S_AXI_ARESETN || i_tap_commit)
+			wr_coeff_index <= 0;
+		else if (tap_wr)
+			wr_coeff_index <= wr_coeff_index + 1;
+
+		always @(posedge S_AXI_ACLK)
+		if (tap_wr)
+			cmem[{ wr_bank, wr_coeff_index }] <= i_tap;
+
+		initial	wr_bank = 1'b1;
+		initial	rd_bank = 1'b0;
+		always @(posedge S_AXI_ACLK)
+		if (swap)
+		begin
+			wr_bank <= rd_bank;
+			rd_bank <= wr_bank;
+		end
+
+		assign	caddr = { rd_bank, coefficient_index[LGNCOEFFS-1:0] };
 		// }}}
 	end endgenerate
 	// }}}
@@ -461,7 +545,7 @@ module ratfil #(
 	if (read_enable && !mem_stalled)
 	begin
 		dval <= dmem[data_index];
-		cval <= cmem[coefficient_index[LGNCOEFFS-1:0]];
+		cval <= cmem[caddr];
 	end
 
 `ifdef	FORMAL
@@ -0,0 +1,512 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	resampler.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A rational resampler, with an AXI stream interface, that can
+//		change the sample rate by NUP/NDOWN in either direction.
+//	Unlike ratfil.v, NUP may be greater than, less than, or equal to NDOWN,
+//	so this core can handle ratios such as 5/4 and 160/147 as well as 3/7.
+//
+//	Filtering equation:
+//		y[m] = SUM_{k=0}^{N-1} h[k]u[mD-k]
+//
+//		where u[nL] = x[n], and u[] is otherwise zero.  L is the
+//		upsample ratio, NUP, and D the downsample ratio, NDOWN.
+//
+//	Polyphase (non-zero only) filtering equation:
+//		y[m] = SUM_{j=0}^{B-1} h[jL+p]x[n-j]
+//
+//		where n = floor(mD/L), p = mD - nL, and B = ceil(N/L).
+//
+//	Rather than calculating n and p directly, the core keeps track of
+//	the phase, p, of the next output, and of how many more samples must
+//	come in before that output can be calculated.  Once an output has been
+//	started, the phase is advanced by D.  Every time it crosses L, one
+//	more input sample is needed.  The very first output, y[0], needs only
+//	x[0], and uses phase zero.  There is no drift: after N input samples,
+//	exactly floor((N*L-1)/D)+1 outputs will have been produced.
+//
+//	As with subfilup.v, one multiply is used for every system clock, and
+//	each output takes B = ceil(NCOEFFS/NUP) clocks.  New samples may be
+//	accepted while an output is being calculated, so the core can keep
+//	up with one output every B clocks as long as no more than B-1 new
+//	inputs are required per output.
+//
+// Usage:
+//	Coefficients
+//		Coefficients are loaded, h[0] first, via i_tap_wr and i_tap
+//		following any reset.  If OPT_FIXED_TAPS is set, they are
+//		instead read from the hex file INITIAL_COEFFS.  Coefficients
+//		beyond NCOEFFS read as zero.
+//
+//	Data processing:
+//		Samples are accepted from the S_AXI_* stream whenever the
+//		next output needs them, and produced on the M_AXI_* stream.
+//		If M_AXI_TREADY is held low, the core stops and holds its
+//		output, and S_AXI_TREADY will drop once it has all of the
+//		samples the next output needs.
+//
+//		The output is shifted left by LGGAIN bits, then rounded and
+//		saturated to OW bits, as with subfilup.v.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+//
+// }}}
+module	resampler #(
+		// {{{
+		parameter		IW = 12, // Input bit width
+		parameter		TW = 12, // Coefficient width
+		parameter		OW = 12, // Output bit width
+		parameter		NUP = 5, // Must be >= 1
+		parameter		NDOWN = 4, // Must be >= 1
+		parameter		LGGAIN = 0, // Bit shift at output
+		parameter		NCOEFFS = 55,
+		parameter	[0:0]	OPT_FIXED_TAPS = 1'b0,
+		parameter		INITIAL_COEFFS = "",
+		//
+		// Each output requires NBRANCH products, one from each of the
+		// NBRANCH most recent samples.  As with subfilup.v, the
+		// coefficients are kept in a memory of NBRANCH*NUP words.
+		localparam	NBRANCH = (NCOEFFS+NUP-1)/NUP,
+		localparam	LGNCOEFFS = $clog2(NBRANCH*NUP),
+		localparam	BW = $clog2(NBRANCH+1),
+		//
+		// Every output requires either DQ or DQ+1 new samples
+		localparam	DQ = NDOWN / NUP,
+		localparam	DR = NDOWN % NUP,
+		localparam	NW = $clog2(DQ+2),
+		localparam	PHW = $clog2(NUP)+1,
+		//
+		// The data memory must hold the NBRANCH samples being used,
+		// plus those coming in for the next output
+		localparam	LGMEM = $clog2(NBRANCH+DQ+1),
+		localparam	AW = IW+TW+$clog2(NBRANCH)
+		// }}}
+	) (
+		// {{{
+`ifdef	VERILATORTB
+		input	wire			i_clk,
+		input	wire			i_reset,
+		output	wire	[31:0]		o_IW,
+		output	wire	[31:0]		o_TW,
+		output	wire	[31:0]		o_OW,
+		output	wire	[31:0]		o_NCOEFFS,
+		output	wire	[31:0]		o_NUP,
+		output	wire	[31:0]		o_NDOWN,
+		output	wire	[31:0]		o_LGGAIN,
+`else
+		input	wire			S_AXI_ACLK,
+		input	wire			S_AXI_ARESETN,
+`endif
+		// Filter adjustment
+		// {{{
+		input	wire			i_tap_wr,
+		input	wire	[TW-1:0]	i_tap,
+		// }}}
+		// Incoming data stream
+		// {{{
+		input	wire			S_AXI_TVALID,
+		output	wire			S_AXI_TREADY,
+		input	wire	[IW-1:0]	S_AXI_TDATA,
+		// }}}
+		// Outgoing data stream
+		// {{{
+		output	reg			M_AXI_TVALID,
+		input	wire			M_AXI_TREADY,
+		output	reg	[OW-1:0]	M_AXI_TDATA
+		// }}}
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	localparam	[BW-1:0]	LAST_BRANCH = NBRANCH-1;
+	localparam	[LGNCOEFFS-1:0]	COEFF_STEP  = NUP;
+	localparam	[PHW-1:0]	PHASE_STEP  = DR;
+	localparam	[PHW-1:0]	PHASE_WRAP  = NUP;
+	localparam	[NW-1:0]	NEED_STEP   = DQ;
+
+	reg	[IW-1:0]		dmem	[0:(1<<LGMEM)-1];
+	reg	[TW-1:0]		cmem	[0:(1<<LGNCOEFFS)-1];
+
+	reg	[LGMEM-1:0]		wraddr;
+	//
+	reg	[PHW-1:0]		phase, phase_sum, next_phase;
+	reg	[NW-1:0]		need, next_need;
+	//
+	wire				stall, start;
+	reg				busy, first_branch, last_branch;
+	reg	[BW-1:0]		bidx;
+	reg	[LGNCOEFFS-1:0]		tidx;
+	wire	[LGNCOEFFS+PHW-1:0]	wide_phase;
+	reg	[LGMEM-1:0]		didx;
+	//
+	reg				r_valid, r_first, r_last;
+	reg	signed	[IW-1:0]	dval;
+	reg	signed	[TW-1:0]	cval;
+	//
+	reg				p_valid, p_first, p_last;
+	reg	signed	[IW+TW-1:0]	product;
+	//
+	reg				a_valid;
+	wire	signed	[AW-1:0]	wide_product;
+	reg	signed	[AW-1:0]	accumulator;
+	wire	signed	[AW-1:0]	next_acc;
+	//
+	wire				sgn, overflow;
+	wire	[LGGAIN:0]		sgn_bits;
+	wire	[AW-1:0]		prerounded, rounded_result;
+
+`ifdef	VERILATORTB
+	wire	S_AXI_ACLK, S_AXI_ARESETN;
+
+	assign	S_AXI_ACLK = i_clk;
+	assign	S_AXI_ARESETN = !i_reset;
+
+	assign	o_IW      = IW;
+	assign	o_TW      = TW;
+	assign	o_OW      = OW;
+	assign	o_NCOEFFS = NCOEFFS;
+	assign	o_NUP     = NUP;
+	assign	o_NDOWN   = NDOWN;
+	assign	o_LGGAIN  = LGGAIN;
+`endif
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Filter coefficient loading and/or adjustment
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	generate if (OPT_FIXED_TAPS || (INITIAL_COEFFS != 0 && INITIAL_COEFFS != ""))
+	begin : LOAD_INITIAL_COEFFS
+
+		initial $readmemh(INITIAL_COEFFS, cmem);
+
+	end else begin : ZERO_INITIAL_COEFFS
+		// Any coefficients beyond NCOEFFS are never written, so they
+		// must start out as zero
+		integer	ik;
+
+		initial	for(ik=0; ik<(1<<LGNCOEFFS); ik=ik+1)
+			cmem[ik] = 0;
+	end endgenerate
+
+	generate if (OPT_FIXED_TAPS)
+	begin : UNUSED_LOADING_PORTS
+		// {{{
+		// Verilator lint_off UNUSED
+		wire	ignored_inputs;
+		assign	ignored_inputs = &{ 1'b0, i_tap_wr, i_tap };
+		// Verilator lint_on  UNUSED
+		// }}}
+	end else begin : LOAD_COEFFICIENTS
+		// {{{
+		reg	[LGNCOEFFS-1:0]	wr_coeff_index;
+
+		initial	wr_coeff_index = 0;
+		always @(posedge S_AXI_ACLK)
+		if (!S_AXI_ARESETN)
+			wr_coeff_index <= 0;
+		else if (i_tap_wr)
+			wr_coeff_index <= wr_coeff_index + 1'b1;
+
+		always @(posedge S_AXI_ACLK)
+		if (i_tap_wr)
+			cmem[wr_coeff_index] <= i_tap;
+		// }}}
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Phase tracking: how many samples does the next output need?
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Advancing the phase by NDOWN = DQ*NUP+DR requires either DQ or
+	// DQ+1 new samples, depending upon whether or not it wraps
+	always @(*)
+	begin
+		phase_sum = phase + PHASE_STEP;
+		if (phase_sum >= PHASE_WRAP)
+		begin
+			next_phase = phase_sum - PHASE_WRAP;
+			next_need  = NEED_STEP + 1'b1;
+		end else begin
+			next_phase = phase_sum;
+			next_need  = NEED_STEP;
+		end
+	end
+
+	// The first output, y[0], uses phase zero and requires only x[0]
+	initial	phase = 0;
+	initial	need  = 1;
+	always @(posedge S_AXI_ACLK)
+	if (!S_AXI_ARESETN)
+	begin
+		phase <= 0;
+		need  <= 1;
+	end else if (start && !stall)
+	begin
+		phase <= next_phase;
+		need  <= next_need;
+	end else if (S_AXI_TVALID && S_AXI_TREADY)
+		need <= need - 1'b1;
+
+	assign	S_AXI_TREADY = (need != 0);
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Write data logic
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	initial	wraddr = 0;
+	always @(posedge S_AXI_ACLK)
+	if (!S_AXI_ARESETN)
+		wraddr <= 0;
+	else if (S_AXI_TVALID && S_AXI_TREADY)
+		wraddr <= wraddr + 1'b1;
+
+	always @(posedge S_AXI_ACLK)
+	if (S_AXI_TVALID && S_AXI_TREADY)
+		dmem[wraddr] <= S_AXI_TDATA;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Memory read index logic
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Once all of its samples are present, walk through the branches, j,
+	// of the next output from the newest sample to the oldest.  The next
+	// output may start on the same clock the last branch of the current
+	// one is read.
+	//
+
+	assign	start = (need == 0) && (!busy || last_branch);
+
+	initial	busy = 0;
+	initial	bidx = 0;
+	always @(posedge S_AXI_ACLK)
+	if (!S_AXI_ARESETN)
+	begin
+		busy <= 1'b0;
+		bidx <= 0;
+	end else if (!stall)
+	begin
+		if (start)
+		begin
+			busy <= 1'b1;
+			bidx <= 0;
+		end else if (busy)
+		begin
+			if (last_branch)
+				busy <= 1'b0;
+			bidx <= bidx + 1'b1;
+		end
+	end
+
+	always @(*)
+	begin
+		first_branch = (bidx == 0);
+		last_branch  = (bidx == LAST_BRANCH);
+	end
+
+	assign	wide_phase = { {(LGNCOEFFS){1'b0}}, phase };
+
+	initial	tidx = 0;
+	initial	didx = 0;
+	always @(posedge S_AXI_ACLK)
+	if (!stall)
+	begin
+		if (start)
+		begin
+			// Coefficient h[jL+p] is at address jL+p
+			tidx <= wide_phase[LGNCOEFFS-1:0];
+			// No samples are written while start is true, so
+			// the newest sample is the one just before wraddr
+			didx <= wraddr - 1'b1;
+		end else begin
+			tidx <= tidx + COEFF_STEP;
+			didx <= didx - 1'b1;
+		end
+	end
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Memory read(s)
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	always @(posedge S_AXI_ACLK)
+	if (!stall)
+	begin
+		dval <= dmem[didx];
+		cval <= cmem[tidx];
+	end
+
+	initial	r_valid = 0;
+	initial	r_first = 0;
+	initial	r_last  = 0;
+	initial	p_valid = 0;
+	initial	p_first = 0;
+	initial	p_last  = 0;
+	always @(posedge S_AXI_ACLK)
+	if (!S_AXI_ARESETN)
+	begin
+		r_valid <= 0;
+		r_first <= 0;
+		r_last  <= 0;
+		p_valid <= 0;
+		p_first <= 0;
+		p_last  <= 0;
+	end else if (!stall)
+	begin
+		// r_valid is true when a memory read is valid
+		r_valid <= busy;
+		r_first <= busy && first_branch;
+		r_last  <= busy && last_branch;
+
+		// p_valid is true when a product is valid
+		p_valid <= r_valid;
+		p_first <= r_first;
+		p_last  <= r_last;
+	end
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Product
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	(* mul2dsp *)
+	always @(posedge S_AXI_ACLK)
+	if (!stall)
+		product <= dval * cval;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Accumulator
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	assign	wide_product = { {(AW-IW-TW){product[IW+TW-1]}}, product };
+	assign	next_acc = (p_first) ? wide_product
+					: (accumulator + wide_product);
+
+	initial	accumulator = 0;
+	always @(posedge S_AXI_ACLK)
+	if (!S_AXI_ARESETN)
+		accumulator <= 0;
+	else if (!stall && p_valid)
+		accumulator <= next_acc;
+
+	// a_valid is true when the accumulator holds a completed output
+	initial	a_valid = 1'b0;
+	always @(posedge S_AXI_ACLK)
+	if (!S_AXI_ARESETN)
+		a_valid <= 1'b0;
+	else if (!stall)
+		a_valid <= p_valid && p_last;
+
+	// Everything stops if a completed output can't be handed off
+	assign	stall = a_valid && M_AXI_TVALID && !M_AXI_TREADY;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Round the result to the right number of bits
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	sgn        = accumulator[AW-1];
+	assign	sgn_bits   = accumulator[AW-1:AW-1-LGGAIN];
+	assign	prerounded = accumulator << LGGAIN;
+	assign	rounded_result = prerounded
+				+ { {(OW){1'b0}}, prerounded[AW-OW-1],
+					{(AW-OW-1){!prerounded[AW-OW-1]}} };
+
+	// We overflow if either the shift drops a bit that isn't a copy of
+	// the sign bit, or if rounding a positive number makes it negative
+	assign	overflow = ((|sgn_bits) && !(&sgn_bits))
+				|| (!sgn && rounded_result[AW-1]);
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Return the results
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	initial	M_AXI_TVALID = 1'b0;
+	always @(posedge S_AXI_ACLK)
+	if (!S_AXI_ARESETN)
+		M_AXI_TVALID <= 1'b0;
+	else if (!M_AXI_TVALID || M_AXI_TREADY)
+		M_AXI_TVALID <= a_valid;
+
+	initial	M_AXI_TDATA = 0;
+	always @(posedge S_AXI_ACLK)
+	if (a_valid && !stall)
+	begin
+		if (overflow)
+			M_AXI_TDATA <= (sgn) ? { 1'b1, {(OW-1){1'b0}} }
+					: { 1'b0, {(OW-1){1'b1}} };
+		else
+			M_AXI_TDATA <= rounded_result[AW-1:AW-OW];
+	end
+	// }}}
+
+	// Make Verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	unused;
+	assign	unused = &{ 1'b0, rounded_result[AW-OW-1:0],
+				wide_phase[LGNCOEFFS+PHW-1:LGNCOEFFS] };
+	// verilator lint_on  UNUSED
+	// }}}
+endmodule
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	scrambler.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A self-synchronizing (multiplicative) scrambler, processing
+//		W data bits per clock.  Each scrambled bit is the data bit
+//	XOR'd with the feedback from the LN scrambled bits before it,
+//
+//		s[n+LN] = d[n+LN] ^ (^(TAPS & s[n +: LN]))
+//
+//	using the same TAPS convention as lfsr_fib and lfsr.  The defaults,
+//	LN=58 and TAPS=58'h80001, give the 1 + x^39 + x^58 scrambler of
+//	IEEE 802.3's 64b/66b line code.  Bit zero of i_data is the first in
+//	time.  descrambler.v undoes this.
+//
+//	As with lfsr.v, the feedback is unrolled so that no scrambled bit
+//	depends upon another from the same clock.  Each is instead an XOR of
+//	the register, through a precomputed tap vector, and of the data bits
+//	at or before it, through the (precomputed) impulse response of the
+//	feedback.  Both are constants the synthesis tool works out for us.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	scrambler #(
+		// {{{
+		parameter	W  = 64,	// Data bits per clock
+				LN = 58,	// Scrambler register length
+		parameter [(LN-1):0]	TAPS = 58'h80001,
+				INITIAL_FILL = { { (LN-1){1'b0}}, 1'b1 }
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset, i_ce,
+		input	wire	[(W-1):0]	i_data,
+		output	reg			o_ce,
+		output	reg	[(W-1):0]	o_data
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	genvar	k;
+
+	// The last LN scrambled bits, with the oldest in bit zero
+	reg	[(LN-1):0]	sreg;
+	wire	[(W-1):0]	scrambled, rev_impulse;
+	wire	[(LN+W-1):0]	ext;
+	// }}}
+
+	// Precompute the unrolled feedback
+	// {{{
+	// tapv[k] describes how scrambled bit k depends upon sreg, were the
+	// data all zero.  This is the same stepping matrix lfsr.v uses.
+	//
+	// impulse[LN+k] is scrambled bit k given a single one in data bit zero
+	// and an all zero register.  By linearity, the data contribution to
+	// scrambled bit k is then the XOR of data bit j with impulse[LN+k-j],
+	// for all j <= k.
+	//
+	// As with lfsr.v, Verilator sees these as depending upon themselves.
+	// verilator lint_off UNOPTFLAT
+	wire	[(LN-1):0]	tapv	[0:(W-1)];
+	wire	[(LN+W-1):0]	impulse;
+
+	assign	tapv[0] = TAPS;
+	assign	impulse[(LN-1):0] = {(LN){1'b0}};
+	assign	impulse[LN] = 1'b1;
+
+	generate for(k=1; k<W; k=k+1)
+	begin : PRECALCULATING_TAP_VALUE
+		assign	tapv[k] = (tapv[k-1]<<1)^((tapv[k-1][(LN-1)])?TAPS:0);
+		assign	impulse[LN+k] = ^(impulse[k +: LN] & TAPS);
+	end endgenerate
+	// verilator lint_on  UNOPTFLAT
+
+	// Reverse the impulse response, so that shifting it right by W-1-k
+	// places impulse[LN+k-j] at bit j
+	generate for(k=0; k<W; k=k+1)
+	begin : REVERSE_IMPULSE
+		assign	rev_impulse[W-1-k] = impulse[LN+k];
+	end endgenerate
+	// }}}
+
+	// scrambled
+	// {{{
+	generate for(k=0; k<W; k=k+1)
+	begin : UNROLLED_FEEDBACK
+		wire	[(W-1):0]	dmask;
+
+		assign	dmask = rev_impulse >> (W-1-k);
+		assign	scrambled[k] = (^(sreg & tapv[k])) ^ (^(i_data & dmask));
+	end endgenerate
+	// }}}
+
+	// sreg
+	// {{{
+	assign	ext = { scrambled, sreg };
+
+	initial	sreg = INITIAL_FILL;
+	always @(posedge i_clk)
+	if (i_reset)
+		sreg <= INITIAL_FILL;
+	else if (i_ce)
+		sreg <= ext[(LN+W-1):W];
+	// }}}
+
+	// o_ce, o_data
+	// {{{
+	initial	o_ce = 1'b0;
+	always @(posedge i_clk)
+	if (i_reset)
+		o_ce <= 1'b0;
+	else
+		o_ce <= i_ce;
+
+	initial	o_data = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		o_data <= scrambled;
+	// }}}
+endmodule
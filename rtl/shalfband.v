@@ -4,7 +4,17 @@
 // {{{
 // Project:	DSP Filtering Example Project
 //
-// Purpose:	
+// Purpose:	A slow half-band filter.  Like slowsymf.v, it uses a single
+//		multiply, and exploits the filter's symmetry.  Only every other
+//	tap is loaded, since the rest of a half-band filter's taps are zero,
+//	save the center tap which is fixed at 2^(TW-1)-1 (or zero, if
+//	OPT_HILBERT is set).
+//
+//	With OPT_SHADOW set, coefficients can be changed while the filter
+//	runs: i_tap_wr loads a second bank, and i_tap_commit swaps the two
+//	starting with the sample given on the same clock as the commit, or
+//	else the next i_ce--just like slowfil and slowsymf.  Any i_tap_wr
+//	between the commit and the swap is ignored.
 //
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
@@ -47,13 +57,17 @@ module	shalfband #(
 		parameter	[0:0]		FIXED_TAPS = 1'b0,
 		parameter			INITIAL_COEFFS  = "",
 		parameter	[0:0]		OPT_HILBERT = 1'b0,
+		// OPT_SHADOW: double buffer the coefficients.  Ignored if
+		// FIXED_TAPS is set.
+		parameter	[0:0]		OPT_SHADOW = 1'b0,
 		//
 		localparam			LGNMEM   = LGNTAPS-1,
 						LGNCOEF  = LGNMEM-1,
 		localparam	[LGNTAPS-1:0]	HALFTAPS = NTAPS[LGNTAPS:1],
 		localparam	[LGNTAPS-2:0]	QTRTAPS=HALFTAPS[LGNTAPS-1:1]+1,
 		localparam			DMEMSZ = (1<<LGNMEM),
-		localparam			CMEMSZ = (1<<LGNCOEF)
+		localparam			CMEMSZ = (1<<LGNCOEF),
+		localparam			LGTAPMEM = LGNCOEF + (OPT_SHADOW ? 1:0)
 /*
 initial assert(NTAPS[2:0] == 3'h7);
 always @(*)
@@ -72,6 +86,8 @@ always @(posedge i_clk)
 		// the filter
 		input	wire			i_tap_wr,
 		input	wire	[(TW-1):0]	i_tap,
+		// Swap coefficient banks.  Ignored unless OPT_SHADOW
+		input	wire			i_tap_commit,
 		// }}}
 		//
 		// New sample input(s)--a new sample comes in any time i_ce is
@@ -93,8 +109,9 @@ always @(posedge i_clk)
 
 	// Local declarations
 	// {{{
-	reg	[(TW-1):0]	tapmem	[0:(CMEMSZ-1)];	// Coef memory
+	reg	[(TW-1):0]	tapmem	[0:((1<<LGTAPMEM)-1)];	// Coef memory
 	reg signed [(TW-1):0]	tap;		// Value read from coef memory
+	wire	[(LGTAPMEM-1):0] tapaddr;	// Coefficient read address
 
 	reg	[(LGNMEM-1):0]	dwidx, lidx, ridx;// Data write and read indices
 	reg	[(LGNCOEF-1):0]	tidx;		// Coefficient read index
@@ -134,14 +151,17 @@ always @(posedge i_clk)
 
 	if (FIXED_TAPS)
 	begin : NO_UPDATE_LOGIC
+		assign	tapaddr = tidx;
+
 		// Make Verilators -Wall happy
 		// {{{
 		// Verilator lint_off UNUSED
-		wire	[TW:0]	ignored_inputs;
-		assign	ignored_inputs = { i_tap_wr, i_tap };
+		wire	[TW+1:0]	ignored_inputs;
+		assign	ignored_inputs = { i_tap_wr, i_tap_commit, i_tap };
 		// Verilator lint_on  UNUSED
 		// }}}
-	end else begin : DYNAMIC_TAP_ADJUSTMENT
+	end else if (!OPT_SHADOW)
+	begin : DYNAMIC_TAP_ADJUSTMENT
 		// Coef memory write index
 		reg	[(LGNCOEF-1):0]	tapwidx;
 
@@ -155,6 +175,54 @@ always @(posedge i_clk)
 		always @(posedge i_clk)
 		if (i_tap_wr)
 			tapmem[tapwidx] <= i_tap;
+
+		assign	tapaddr = tidx;
+
+		// Verilator lint_off UNUSED
+		wire	ignored_commit;
+		assign	ignored_commit = i_tap_commit;
+		// Verilator lint_on  UNUSED
+	end else begin : SHADOW_COEFFICIENTS
+		// Coef memory write index, and the two bank selects.  Writes
+		// go to wr_bank, while the filter reads from rd_bank.  This
+		// works just like slowsymf: the banks only swap on i_ce, so a
+		// commit given with an i_ce applies to that very sample, and
+		// tap writes are ignored while a commit is pending.
+		reg	[(LGNCOEF-1):0]	tapwidx;
+		reg			wr_bank, rd_bank, commit_pending;
+		wire			tap_wr, swap;
+
+		initial	commit_pending = 1'b0;
+		always @(posedge i_clk)
+		if (i_reset || i_ce)
+			commit_pending <= 1'b0;
+		else if (i_tap_commit)
+			commit_pending <= 1'b1;
+
+		assign	swap = i_ce && (i_tap_commit || commit_pending);
+		assign	tap_wr = i_tap_wr && !i_tap_commit && !commit_pending;
+
+		initial	tapwidx = 0;
+		always @(posedge i_clk)
+		if (i_reset || i_tap_commit)
+			tapwidx <= 0;
+		else if (tap_wr)
+			tapwidx <= tapwidx + 1'b1;
+
+		always @(posedge i_clk)
+		if (tap_wr)
+			tapmem[{ wr_bank, tapwidx }] <= i_tap;
+
+		initial	wr_bank = 1'b1;
+		initial	rd_bank = 1'b0;
+		always @(posedge i_clk)
+		if (swap)
+		begin
+			wr_bank <= rd_bank;
+			rd_bank <= wr_bank;
+		end
+
+		assign	tapaddr = { rd_bank, tidx };
 	end endgenerate
 	// }}}
 	////////////////////////////////////////////////////////////////////////
@@ -305,7 +373,7 @@ always @(posedge i_clk)
 
 	initial	tap = 0;
 	always @(posedge i_clk)
-		tap <= tapmem[tidx[(LGNCOEF-1):0]];
+		tap <= tapmem[tapaddr];
 
 	// dsum
 	// {{{
@@ -11,6 +11,17 @@
 //	incoming samples.  In all other respects, however, it remains quite
 //	generic.
 //
+//	If OPT_SHADOW is set, the coefficient memory holds two banks.  The
+//	filter reads from one, while i_tap_wr writes into the other.  Once
+//	the new coefficients are loaded, an i_tap_commit strobe swaps the two
+//	banks, starting with the sample given on the same clock as the commit,
+//	or else the next i_ce--so every output is calculated entirely from
+//	one set of coefficients or the other, and the filter can be retuned
+//	without stopping the data stream.  The commit also resets the write
+//	index.  Until the swap takes place, on the first i_ce with or
+//	following the commit, any i_tap_wr is ignored, so neither the
+//	committed bank nor the one still in use can be overwritten.
+//
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
 //
@@ -50,7 +61,11 @@ module	slowfil #(
 		parameter	[LGNTAPS:0]	NTAPS = 110, // (1<<LGNTAPS);
 		parameter	[0:0]		FIXED_TAPS = 1'b0,
 		parameter			INITIAL_COEFFS  = "",
-		localparam	MEMSZ = (1<<LGNTAPS)
+		// OPT_SHADOW: double buffer the coefficients.  Ignored if
+		// FIXED_TAPS is set.
+		parameter	[0:0]		OPT_SHADOW = 1'b0,
+		localparam	MEMSZ = (1<<LGNTAPS),
+		localparam	LGTAPMEM = LGNTAPS + (OPT_SHADOW ? 1:0)
 		// }}}
 	) (
 		// {{{
@@ -62,6 +77,8 @@ module	slowfil #(
 		// in the filter
 		input	wire			i_tap_wr,
 		input	wire	[(TW-1):0]	i_tap,
+		// Swap coefficient banks.  Ignored unless OPT_SHADOW
+		input	wire			i_tap_commit,
 		// }}}
 		// New sample input(s)--a new sample comes in any time i_ce is
 		// {{{
@@ -82,8 +99,9 @@ module	slowfil #(
 
 	// Local declarations
 	// {{{
-	reg	[(TW-1):0]	tapmem	[0:(MEMSZ-1)];	// Coef memory
+	reg	[(TW-1):0]	tapmem	[0:((1<<LGTAPMEM)-1)];	// Coef memory
 	reg signed [(TW-1):0]	tap;		// Value read from coef memory
+	wire	[(LGTAPMEM-1):0] tapaddr;	// Coefficient read address
 
 	reg	[(LGNTAPS-1):0]	dwidx, didx;	// Data write and read indices
 	reg	[(LGNTAPS-1):0]	tidx;		// Coefficient read index
@@ -118,14 +136,17 @@ module	slowfil #(
 	if (FIXED_TAPS)
 	begin : NO_UPDATED_LOGIC
 
+		assign	tapaddr = tidx;
+
 		// Make Verilators -Wall happy
 		// {{{
 		// Verilator lint_off UNUSED
-		wire	[TW:0]	ignored_inputs;
-		assign	ignored_inputs = { i_tap_wr, i_tap };
+		wire	[TW+1:0]	ignored_inputs;
+		assign	ignored_inputs = { i_tap_wr, i_tap_commit, i_tap };
 		// Verilator lint_on  UNUSED
 		// }}}
-	end else begin : UPDATE_COEFFICIENTS
+	end else if (!OPT_SHADOW)
+	begin : UPDATE_COEFFICIENTS
 		// Coef memory write index
 		reg	[(LGNTAPS-1):0]	tapwidx;
 
@@ -140,6 +161,55 @@ module	slowfil #(
 		if (i_tap_wr)
 			tapmem[tapwidx] <= i_tap;
 
+		assign	tapaddr = tidx;
+
+		// Verilator lint_off UNUSED
+		wire	ignored_commit;
+		assign	ignored_commit = i_tap_commit;
+		// Verilator lint_on  UNUSED
+	end else begin : SHADOW_COEFFICIENTS
+		// Coef memory write index, and the two bank selects.  Writes
+		// go to wr_bank.  The filter reads from rd_bank.  A commit
+		// stays pending until the next i_ce, where both bank selects
+		// swap together--so, as with fastfir, a commit arriving with
+		// an i_ce applies to that very sample.  Until then, wr_bank
+		// is the bank that was just committed, so tap writes are
+		// ignored from the commit through the swap.
+		reg	[(LGNTAPS-1):0]	tapwidx;
+		reg			wr_bank, rd_bank, commit_pending;
+		wire			tap_wr, swap;
+
+		initial	commit_pending = 1'b0;
+		always @(posedge i_clk)
+		if (i_reset || i_ce)
+			commit_pending <= 1'b0;
+		else if (i_tap_commit)
+			commit_pending <= 1'b1;
+
+		assign	swap = i_ce && (i_tap_commit || commit_pending);
+		assign	tap_wr = i_tap_wr && !i_tap_commit && !commit_pending;
+
+		initial	tapwidx = 0;
+		always @(posedge i_clk)
+		if (i_reset || i_tap_commit)
+			tapwidx <= 0;
+		else if (tap_wr)
+			tapwidx <= tapwidx + 1'b1;
+
+		always @(posedge i_clk)
+		if (tap_wr)
+			tapmem[{ wr_bank, tapwidx }] <= i_tap;
+
+		initial	wr_bank = 1'b1;
+		initial	rd_bank = 1'b0;
+		always @(posedge i_clk)
+		if (swap)
+		begin
+			wr_bank <= rd_bank;
+			rd_bank <= wr_bank;
+		end
+
+		assign	tapaddr = { rd_bank, tidx };
 	end endgenerate
 	// }}}
 	////////////////////////////////////////////////////////////////////////
@@ -237,7 +307,7 @@ module	slowfil #(
 	// {{{
 	initial	tap = 0;
 	always @(posedge i_clk)
-		tap <= tapmem[tidx[(LGNTAPS-1):0]];
+		tap <= tapmem[tapaddr];
 	// }}}
 
 	// data
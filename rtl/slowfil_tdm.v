@@ -0,0 +1,374 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	slowfil_tdm.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A channelized version of slowfil.v.  Where slowfil.v shares
+//		one multiply across all of the taps of a single stream, this
+//	design shares one multiply across all of the taps of NCHAN streams.
+//	Samples from all channels arrive, interleaved in time, on the same
+//	i_ce/i_sample interface, tagged with the channel they belong to.  All
+//	channels share the same coefficients, but each has its own sample
+//	history.  The result is tagged with the same channel on the way out.
+//
+//	As with slowfil.v, there must be at least NTAPS clocks between any
+//	two i_ce's--across all channels.  Channels may arrive in any order.
+//
+//	Unlike slowfil.v, which produces its output when the next sample
+//	arrives, this filter produces the output for each sample as soon as it
+//	has been calculated, so that one channel never has to wait on another.
+//
+// Resource usage: One multiply, NTAPS coefficients, and NCHAN*2^LGNTAPS
+//		samples of memory.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	slowfil_tdm #(
+		// {{{
+		parameter	LGNTAPS = 7, IW=16, TW=16, OW = IW+TW+LGNTAPS,
+		parameter	[LGNTAPS:0]	NTAPS = 110, // (1<<LGNTAPS);
+		parameter	[0:0]		FIXED_TAPS = 1'b0,
+		parameter			INITIAL_COEFFS  = "",
+		// Log (base two) of the number of channels
+		parameter			LGNCHAN = 5,
+		localparam	MEMSZ = (1<<LGNTAPS),
+		localparam	NCHAN = (1<<LGNCHAN)
+		// }}}
+	) (
+		// {{{
+		// Control inputs (wires)
+		input	wire		i_clk, i_reset,
+		//
+		// Coefficient control -- allows you to update coefficients
+		// {{{
+		// in the filter
+		input	wire			i_tap_wr,
+		input	wire	[(TW-1):0]	i_tap,
+		// }}}
+		// New sample input(s)--a new sample comes in any time i_ce is
+		// {{{
+		// true.  There must be at least NTAPS clocks between every
+		// pair of valid i_ce's, regardless of channel.
+		input	wire			i_ce,
+		input	wire	[(LGNCHAN-1):0]	i_chan,
+		input	wire	[(IW-1):0]	i_sample,
+		// }}}
+		// The output--valid any time o_ce is true.  o_chan is the
+		// {{{
+		// channel of the sample this result was calculated from.
+		output	reg			o_ce,
+		output	reg	[(LGNCHAN-1):0]	o_chan,
+		output	reg	[(OW-1):0]	o_result
+		// }}}
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	reg	[(TW-1):0]	tapmem	[0:(MEMSZ-1)];	// Coef memory
+	reg signed [(TW-1):0]	tap;		// Value read from coef memory
+
+	// Each channel gets its own write pointer, and region of the data
+	// memory
+	reg	[(LGNTAPS-1):0]	dwidx	[0:(NCHAN-1)];
+	reg	[(LGNTAPS-1):0]	didx;		// Data read index
+	reg	[(LGNTAPS-1):0]	tidx;		// Coefficient read index
+	reg	[(IW-1):0]	dmem	[0:(NCHAN*MEMSZ-1)];	// Data memory
+	reg signed [(IW-1):0]	data;		// Data value read from memory
+
+	// Traveling CE values, and the channels that go with them
+	reg	d_ce, p_ce, m_ce;
+	reg	[(LGNCHAN-1):0]	m_chan, d_chan, acc_chan;
+	//
+	// The product and accumulator values for the filter
+	reg	signed [(IW+TW-1):0]	product;
+	reg	signed [(OW-1):0]	r_acc;
+	wire	signed [(OW-1):0]	next_acc;
+
+	wire	last_tap_index;
+	reg	[2:0]	pre_acc_ce;
+	reg	[1:0]	last_acc;
+	integer	ik;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Allow the user to set the taps
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Starting at zero on reset, increment the tap write index on any
+	// write of a new tap.  This also means that changing coefficients
+	// will require a reset.
+	generate if (FIXED_TAPS || INITIAL_COEFFS != 0)
+	begin : LOAD_TAPS
+
+		initial $readmemh(INITIAL_COEFFS, tapmem);
+	end
+
+	if (FIXED_TAPS)
+	begin : NO_UPDATED_LOGIC
+		// Make Verilators -Wall happy
+		// {{{
+		// Verilator lint_off UNUSED
+		wire	[TW:0]	ignored_inputs;
+		assign	ignored_inputs = { i_tap_wr, i_tap };
+		// Verilator lint_on  UNUSED
+		// }}}
+	end else begin : UPDATE_COEFFICIENTS
+		// Coef memory write index
+		reg	[(LGNTAPS-1):0]	tapwidx;
+
+		initial	tapwidx = 0;
+		always @(posedge i_clk)
+		if(i_reset)
+			tapwidx <= 0;
+		else if (i_tap_wr)
+			tapwidx <= tapwidx + 1'b1;
+
+		always @(posedge i_clk)
+		if (i_tap_wr)
+			tapmem[tapwidx] <= i_tap;
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Record the incoming data into a local memory
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// As with slowfil, this data writing section is *independent* of the
+	// reset, depending only upon new sample data.
+	initial	for(ik=0; ik<NCHAN; ik=ik+1)
+		dwidx[ik] = 0;
+
+	always @(posedge i_clk)
+	if (i_ce)
+		dwidx[i_chan] <= dwidx[i_chan] + 1'b1;
+
+	always @(posedge i_clk)
+	if (i_ce)
+		dmem[{ i_chan, dwidx[i_chan] }] <= i_sample;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Calculate the indexes of the filter table
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// Determine if the next clock (not this one) will contain the last
+	// valid index, and so whether or not we need to stop.
+	assign	last_tap_index = (NTAPS[LGNTAPS-1:0]-tidx <= 1);
+
+	// pre_acc_ce[0]
+	// {{{
+	// The pre_acc_ce traveling CE values keep track of when the
+	// results of reading memory are valid at the accumulation section
+	// of this code later on.
+	initial	pre_acc_ce = 3'h0;
+	always @(posedge i_clk)
+	if (i_reset)
+		pre_acc_ce[0] <= 1'b0;
+	else if (i_ce)
+		pre_acc_ce[0] <= 1'b1;
+	else if ((pre_acc_ce[0])&&(!last_tap_index))
+		pre_acc_ce[0] <= 1'b1;
+	else
+		pre_acc_ce[0] <= 1'b0;
+	// pre_acc_ce[0] means that the tap index is valid
+	// pre_acc_ce[1] means that the tap value is valid
+	// pre_acc_ce[2] means that the product is valid
+	// }}}
+
+	// pre_acc_ce[2:1]
+	// {{{
+	always @(posedge i_clk)
+	if (i_reset)
+		pre_acc_ce[2:1] <= 2'b0;
+	else
+		pre_acc_ce[2:1] <= pre_acc_ce[1:0];
+	// }}}
+
+	// last_acc
+	// {{{
+	// last_acc[1] marks the product of the last tap, in the same way
+	// pre_acc_ce[2] marks every product.  Since the next sample may arrive
+	// as soon as the last tap index is valid, pre_acc_ce can't be used to
+	// find the end of a sample.
+	initial	last_acc = 2'b0;
+	always @(posedge i_clk)
+	if (i_reset)
+		last_acc <= 2'b0;
+	else
+		last_acc <= { last_acc[0],
+				(pre_acc_ce[0])&&(last_tap_index) };
+	// }}}
+
+	// didx, tidx
+	// {{{
+	initial	didx = 0;
+	initial	tidx = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+	begin
+		didx <= dwidx[i_chan];
+		tidx <= 0;
+	end else begin
+		didx <= didx - 1'b1;
+		tidx <= tidx + 1'b1;
+	end
+	// }}}
+
+	// m_ce is valid when the first index is valid
+	// {{{
+	initial	m_ce = 1'b0;
+	always @(posedge i_clk)
+		m_ce <= (i_ce)&&(!i_reset);
+	// }}}
+
+	// m_chan
+	// {{{
+	// The channel being read from must hold until the next i_ce
+	initial	m_chan = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		m_chan <= i_chan;
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Read from memory cycle
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// tap
+	// {{{
+	initial	tap = 0;
+	always @(posedge i_clk)
+		tap <= tapmem[tidx[(LGNTAPS-1):0]];
+	// }}}
+
+	// data
+	// {{{
+	initial	data = 0;
+	always @(posedge i_clk)
+		data <= dmem[{ m_chan, didx }];
+	// }}}
+
+	// d_ce is valid when the first data from memory is read/valid
+	// {{{
+	initial	d_ce = 0;
+	always @(posedge i_clk)
+		d_ce <= (m_ce)&&(!i_reset);
+
+	initial	d_chan = 0;
+	always @(posedge i_clk)
+	if (m_ce)
+		d_chan <= m_chan;
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Apply the product to the tap and data just read
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// p_ce is valid on the first valid product
+	// {{{
+	initial	p_ce = 1'b0;
+	always @(posedge i_clk)
+		p_ce <= (d_ce)&&(!i_reset);
+
+	initial	acc_chan = 0;
+	always @(posedge i_clk)
+	if (d_ce)
+		acc_chan <= d_chan;
+	// }}}
+
+	// product
+	// {{{
+	initial	product = 0;
+	always @(posedge i_clk)
+		product <= tap * data;
+	// }}}
+
+	// r_acc
+	// {{{
+	assign	next_acc = ((p_ce) ? 0 : r_acc)
+			+ { {(OW-(IW+TW)){product[(IW+TW-1)]}}, product };
+
+	initial	r_acc = 0;
+	always @(posedge i_clk)
+	if (pre_acc_ce[2])
+		r_acc <= next_acc;
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Copy the result to the output
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// o_result, o_chan
+	// {{{
+	initial	o_result = 0;
+	initial	o_chan   = 0;
+	always @(posedge i_clk)
+	if (last_acc[1])
+	begin
+		o_result <= next_acc;
+		o_chan   <= acc_chan;
+	end
+	// }}}
+
+	// o_ce
+	// {{{
+	initial	o_ce = 1'b0;
+	always @(posedge i_clk)
+		o_ce <= (last_acc[1])&&(!i_reset);
+	// }}}
+	// }}}
+endmodule
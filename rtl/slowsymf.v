@@ -10,6 +10,13 @@
 //	half as many multiplies as the slowfil.v module in this same
 //	repository.  It has the same calling convention as that one.
 //
+//	That includes OPT_SHADOW.  When set, i_tap_wr loads a second bank of
+//	coefficients while the filter runs from the first, and i_tap_commit
+//	swaps the two starting with the sample given on the same clock as the
+//	commit, or else the next i_ce.  As with slowfil, the commit resets
+//	the write index, and i_tap_wr is ignored until the swap has taken
+//	place.
+//
 // Creator:	Dan Gisselquist, Ph.D.
 //		Gisselquist Technology, LLC
 //
@@ -50,10 +57,14 @@ module	slowsymf #(
 		parameter	[LGNTAPS:0]	NTAPS = 107,
 		parameter	[0:0]		FIXED_TAPS = 1'b0,
 		parameter			INITIAL_COEFFS  = "",
+		// OPT_SHADOW: double buffer the coefficients.  Ignored if
+		// FIXED_TAPS is set.
+		parameter	[0:0]		OPT_SHADOW = 1'b0,
 		// // //
 		localparam			LGNMEM   = LGNTAPS-1,
 		localparam	[LGNTAPS-1:0]	HALFTAPS = NTAPS[LGNTAPS:1],
-		localparam			MEMSZ = (1<<LGNMEM)
+		localparam			MEMSZ = (1<<LGNMEM),
+		localparam			LGTAPMEM = LGNMEM + (OPT_SHADOW ? 1:0)
 		// }}}
 	) (
 		// {{{
@@ -64,6 +75,8 @@ module	slowsymf #(
 		// the filter
 		input	wire			i_tap_wr,
 		input	wire	[(TW-1):0]	i_tap,
+		// Swap coefficient banks.  Ignored unless OPT_SHADOW
+		input	wire			i_tap_commit,
 		// }}}
 		// New sample input(s)--a new sample comes in any time i_ce is
 		// {{{
@@ -84,8 +97,9 @@ module	slowsymf #(
 
 	// Local declarations
 	// {{{
-	reg	[(TW-1):0]	tapmem	[0:(MEMSZ-1)];	// Coef memory
+	reg	[(TW-1):0]	tapmem	[0:((1<<LGTAPMEM)-1)];	// Coef memory
 	reg signed [(TW-1):0]	tap;		// Value read from coef memory
+	wire	[(LGTAPMEM-1):0] tapaddr;	// Coefficient read address
 
 	reg	[(LGNMEM-1):0]	dwidx, lidx, ridx;// Data write and read indices
 	reg	[(LGNMEM-1):0]	tidx;		// Coefficient read index
@@ -126,14 +140,17 @@ module	slowsymf #(
 	if (FIXED_TAPS)
 	begin : NO_COEFFICIENT_UPDATE_LOGIC
 
+		assign	tapaddr = tidx;
+
 		// Make Verilators -Wall happy
 		// {{{
 		// Verilator lint_off UNUSED
-		wire	[TW:0]	ignored_inputs;
-		assign	ignored_inputs = { i_tap_wr, i_tap };
+		wire	[TW+1:0]	ignored_inputs;
+		assign	ignored_inputs = { i_tap_wr, i_tap_commit, i_tap };
 		// Verilator lint_on  UNUSED
 		// }}}
-	end else begin : DYNAMIC_TAP_ADJUSTMENT
+	end else if (!OPT_SHADOW)
+	begin : DYNAMIC_TAP_ADJUSTMENT
 		// Coef memory write index
 		reg	[(LGNMEM-1):0]	tapwidx;
 
@@ -147,6 +164,56 @@ module	slowsymf #(
 		always @(posedge i_clk)
 			if (i_tap_wr)
 				tapmem[tapwidx] <= i_tap;
+
+		assign	tapaddr = tidx;
+
+		// Verilator lint_off UNUSED
+		wire	ignored_commit;
+		assign	ignored_commit = i_tap_commit;
+		// Verilator lint_on  UNUSED
+	end else begin : SHADOW_COEFFICIENTS
+		// Coef memory write index, and the two bank selects.  Writes
+		// go to wr_bank, while the filter reads from rd_bank.  Since
+		// the taps for each sample are only read after the i_ce
+		// starting it, swapping the banks on i_ce applies a commit
+		// given with that i_ce to that very sample.  Otherwise the
+		// commit is held pending until the next i_ce, and tap writes
+		// are ignored until then.
+		reg	[(LGNMEM-1):0]	tapwidx;
+		reg			wr_bank, rd_bank, commit_pending;
+		wire			tap_wr, swap;
+
+		initial	commit_pending = 1'b0;
+		always @(posedge i_clk)
+		if (i_reset || i_ce)
+			commit_pending <= 1'b0;
+		else if (i_tap_commit)
+			commit_pending <= 1'b1;
+
+		assign	swap = i_ce && (i_tap_commit || commit_pending);
+		assign	tap_wr = i_tap_wr && !i_tap_commit && !commit_pending;
+
+		initial	tapwidx = 0;
+		always @(posedge i_clk)
+		if (i_reset || i_tap_commit)
+			tapwidx <= 0;
+		else if (tap_wr)
+			tapwidx <= tapwidx + 1'b1;
+
+		always @(posedge i_clk)
+		if (tap_wr)
+			tapmem[{ wr_bank, tapwidx }] <= i_tap;
+
+		initial	wr_bank = 1'b1;
+		initial	rd_bank = 1'b0;
+		always @(posedge i_clk)
+		if (swap)
+		begin
+			wr_bank <= rd_bank;
+			rd_bank <= wr_bank;
+		end
+
+		assign	tapaddr = { rd_bank, tidx };
 	end endgenerate
 	// }}}
 	////////////////////////////////////////////////////////////////////////
@@ -300,7 +367,7 @@ module	slowsymf #(
 	// {{{
 	initial	tap = 0;
 	always @(posedge i_clk)
-		tap <= tapmem[tidx[(LGNTAPS-2):0]];
+		tap <= tapmem[tapaddr];
 	// }}}
 
 	// dsum
@@ -47,6 +47,16 @@
 //		You can either hold i_ce low while writing coefficients into
 //		the core, or ignore the data output during this time.
 //
+//	Shadowed coefficients:
+//		If OPT_SHADOW is set, i_tap_wr instead writes into a second
+//		bank of coefficients, and the output remains reliable.  Once
+//		they are all written, raise i_tap_commit for one cycle.  This
+//		resets the coefficient pointer, and switches the filter to the
+//		new bank starting with the first output whose block begins
+//		on the same clock as the commit or later.  The old bank then
+//		becomes the one written.  Until that swap has taken place,
+//		i_tap_wr is ignored.
+//
 //	Data processing:
 //		Every time i_ce is raised, the input value, i_sample, will be
 //		accepted in to this core as the next x[n] or data sample.  It's
@@ -118,6 +128,10 @@ module	subfildown #(
 		// know the coefficients you need, you can set this for that
 		// purpose.
 		parameter [0:0]	FIXED_COEFFS = 1'b0,
+		// If OPT_SHADOW is set, the coefficients are double buffered,
+		// so they may be changed without disturbing the output.  See
+		// "Shadowed coefficients" above.  Ignored if FIXED_COEFFS.
+		parameter [0:0]	OPT_SHADOW = 1'b0,
 		//
 		// LGNCOEFFS is the log (based two) of the number of
 		// coefficients.  So, for LGNCOEFFS=10, a 2^10 = 1024 tap
@@ -131,7 +145,8 @@ module	subfildown #(
 		parameter	INITIAL_COEFFS = "",
 		//
 		parameter	SHIFT=2,
-		localparam	AW = IW+CW+LGNCOEFFS
+		localparam	AW = IW+CW+LGNCOEFFS,
+		localparam	LGCMEM = LGNCOEFFS + (OPT_SHADOW ? 1:0)
 		// }}}
 	) (
 		// {{{
@@ -139,6 +154,7 @@ module	subfildown #(
 		//
 		input	wire		i_tap_wr,
 		input	wire [(CW-1):0]	i_tap,
+		input	wire		i_tap_commit,
 		//
 		input	wire		i_ce,
 		input	wire [(IW-1):0]	i_sample,
@@ -150,7 +166,8 @@ module	subfildown #(
 
 	// Declare registers, nets, and memories
 	// {{{
-	reg	[(CW-1):0]	cmem	[0:((1<<LGNCOEFFS)-1)];
+	reg	[(CW-1):0]	cmem	[0:((1<<LGCMEM)-1)];
+	wire	[LGCMEM-1:0]	caddr;
 	reg	[(IW-1):0]	dmem	[0:((1<<LGNCOEFFS)-1)];
 	//
 	reg	[LGNDOWN-1:0]	countdown;
@@ -196,10 +213,13 @@ module	subfildown #(
 		// Make Verilator's -Wall happy
 		// verilator lint_off UNUSED
 		wire	ignored_inputs;
-		assign	ignored_inputs = &{ 1'b0, i_tap_wr, i_tap };
+		assign	ignored_inputs = &{ 1'b0, i_tap_wr, i_tap_commit, i_tap };
 		// verilator lint_on  UNUSED
+
+		assign	caddr = tidx;
 		// }}}
-	end else begin : LOAD_COEFFICIENTS
+	end else if (!OPT_SHADOW)
+	begin : LOAD_COEFFICIENTS
 		// {{{
 		// Coeff memory write index
 		reg	[LGNCOEFFS-1:0]	wr_coeff_index;
@@ -214,6 +234,59 @@ module	subfildown #(
 		always @(posedge i_clk)
 		if (i_tap_wr)
 			cmem[wr_coeff_index] <= i_tap;
+
+		assign	caddr = tidx;
+
+		// verilator lint_off UNUSED
+		wire	ignored_commit;
+		assign	ignored_commit = i_tap_commit;
+		// verilator lint_on  UNUSED
+		// }}}
+	end else begin : SHADOW_COEFFICIENTS
+		// {{{
+		// Coeff memory write index, and the two bank selects.  New
+		// coefficients are written to wr_bank.  Each block reads its
+		// coefficients from one bank, starting with the first on the
+		// same clock as the first i_ce of the block.  A commit is held
+		// pending until then, and the two banks swap on that clock--so
+		// that first read needs the swapped bank before rd_bank has it.
+		// Coefficient writes are ignored while a commit is pending.
+		reg	[LGNCOEFFS-1:0]	wr_coeff_index;
+		reg			wr_bank, rd_bank, commit_pending;
+		wire			tap_wr, swap;
+
+		initial	commit_pending = 1'b0;
+		always @(posedge i_clk)
+		if (i_reset || (i_ce && first_sample))
+			commit_pending <= 1'b0;
+		else if (i_tap_commit)
+			commit_pending <= 1'b1;
+
+		assign	swap = i_ce && first_sample
+					&& (i_tap_commit || commit_pending);
+		assign	tap_wr = i_tap_wr && !i_tap_commit && !commit_pending;
+
+		initial	wr_coeff_index = 0;
+		always @(posedge i_clk)
+		if (i_reset || i_tap_commit)
+			wr_coeff_index <= 0;
+		else if (tap_wr)
+			wr_coeff_index <= wr_coeff_index+1'b1;
+
+		always @(posedge i_clk)
+		if (tap_wr)
+			cmem[{ wr_bank, wr_coeff_index }] <= i_tap;
+
+		initial	wr_bank = 1'b1;
+		initial	rd_bank = 1'b0;
+		always @(posedge i_clk)
+		if (swap)
+		begin
+			wr_bank <= rd_bank;
+			rd_bank <= wr_bank;
+		end
+
+		assign	caddr = { (swap) ? wr_bank : rd_bank, tidx };
 		// }}}
 	end endgenerate
 	// }}}
@@ -302,7 +375,7 @@ module	subfildown #(
 	always @(posedge i_clk)
 	begin
 		dval <= dmem[didx];
-		cval <= cmem[tidx];
+		cval <= cmem[caddr];
 	end
 
 
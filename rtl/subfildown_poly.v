@@ -0,0 +1,429 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	subfildown_poly.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A 1/NDOWN downsampler, just like subfildown.v, save that this
+//		one uses NMPY multiplies in parallel.  subfildown.v uses one
+//	multiply, and so needs about NCOEFFS/NDOWN clocks per input sample.
+//	With NMPY at least ceil(NCOEFFS/NDOWN), this core can accept a new
+//	sample on every clock.
+//
+//	Filtering equation (as with subfildown.v):
+//		y[n] = SUM_{k=0}^{N-1} h[k]x[nD-k]
+//
+//	Splitting the filter into its polyphase branches,
+//		h[k] = h[jD+r],	for 0 <= r < D,
+//
+//	each incoming sample, x[m] with r = (-m) mod D, is multiplied by
+//	h[jD+r] for every branch j, and the product is accumulated into the
+//	partial sum for output m/D+j.  There's one accumulator per branch.
+//	Once the last sample of an output, the one with r == 0, has been
+//	accumulated, accumulator zero holds the result.  Every accumulator then
+//	moves down by one, and the last one starts over from zero.  There's no
+//	sample memory at all, since every sample is used as soon as it arrives.
+//
+//	Each of the NMPY multiplies handles NSTEP = ceil(NBRANCH/NMPY) of the
+//	NBRANCH = ceil(NCOEFFS/NDOWN) branches, one per clock.  There must,
+//	therefore, be at least NSTEP clocks between samples.
+//
+// Usage:
+//	Reset
+//		Reset resets the coefficient address, the downsample phase,
+//		and clears any partial sums.  The first sample following a
+//		reset will be the last sample of the first output, exactly as
+//		with subfildown.v.
+//	Coefficients
+//		Coefficients are loaded exactly as with subfildown.v: set the
+//		i_reset flag for one cycle, then set i_tap_wr with each new
+//		coefficient, h[0] first.  Unlike subfildown, there's no option
+//		for fixed coefficients, since the coefficients are spread
+//		across NMPY separate memories.
+//	Data processing
+//		Every time i_ce is raised, i_sample will be accepted as the
+//		next x[n].  There must be at least NSTEP clocks between
+//		samples.  One output will be produced, with o_ce high, for
+//		every NDOWN incoming samples.  The output is rounded and
+//		saturated just as subfildown.v's is.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+//
+// }}}
+module	subfildown_poly #(
+		// {{{
+		//
+		// Bit widths: input width (IW),
+		parameter	IW = 16,
+		// output bit-width (OW),
+				OW = 24,
+		// and coefficient bit-width (CW)
+				CW = 12,
+		//
+		// Downsample rate, NDOWN.  For every NDOWN incoming samples,
+		// this core will produce one outgoing sample.
+		parameter	NDOWN=5,
+		localparam	LGNDOWN=$clog2(NDOWN),
+		//
+		parameter	NCOEFFS=103,
+		localparam	LGNCOEFFS=$clog2(NCOEFFS),
+		//
+		// NBRANCH is the number of polyphase branches, one per
+		// NDOWN coefficients.
+		localparam	NBRANCH = (NCOEFFS+NDOWN-1)/NDOWN,
+		//
+		// NMPY is the number of multiplies.  The default is enough
+		// to accept one sample per clock.
+		parameter	NMPY = NBRANCH,
+		localparam	LGNMPY = $clog2(NMPY+1),
+		//
+		// Each multiply handles NSTEP branches, taking one clock each
+		localparam	NSTEP = (NBRANCH+NMPY-1)/NMPY,
+		localparam	LGNSTEP = (NSTEP > 1) ? $clog2(NSTEP) : 1,
+		localparam	NACC = NMPY * NSTEP,
+		//
+		// The coefficients for each multiply
+		localparam	LANESZ = NSTEP * NDOWN,
+		localparam	LGLANE = $clog2(LANESZ),
+		//
+		parameter	SHIFT=2,
+		localparam	AW = IW+CW+LGNCOEFFS
+		// }}}
+	) (
+		// {{{
+		input	wire		i_clk, i_reset,
+		//
+		input	wire		i_tap_wr,
+		input	wire [(CW-1):0]	i_tap,
+		//
+		input	wire		i_ce,
+		input	wire [(IW-1):0]	i_sample,
+		//
+		output	reg		o_ce,
+		output	reg [(OW-1):0]	o_result
+		// }}}
+	);
+
+	// Declare registers, nets, and memories
+	// {{{
+	localparam	[LGNDOWN-1:0]	LAST_PHASE = NDOWN-1;
+	localparam	[LGNSTEP-1:0]	LAST_STEP  = NSTEP-1;
+	localparam	[LGLANE-1:0]	LAST_WADDR = LANESZ-1;
+	localparam	[LGLANE-1:0]	STEP_SIZE  = NDOWN;
+
+	reg	[LGNMPY-1:0]	wr_lane;
+	reg	[LGLANE-1:0]	wr_addr;
+	//
+	reg	[LGNDOWN-1:0]	phase;
+	//
+	reg			s_valid, s_last;
+	reg	[LGNSTEP-1:0]	s_step;
+	reg	[LGLANE-1:0]	s_addr;
+	reg	[IW-1:0]	s_sample;
+	//
+	reg			d_valid, d_shift;
+	reg	[LGNSTEP-1:0]	d_step;
+	reg	signed	[IW-1:0]	dval;
+	//
+	reg			p_valid, p_shift;
+	reg	[LGNSTEP-1:0]	p_step;
+	//
+	wire	[AW-1:0]	lane_product	[0:NMPY-1];
+	wire	[AW-1:0]	addend		[0:NACC-1];
+	reg	[AW-1:0]	accumulator	[0:NACC-1];
+	//
+	reg			r_ce;
+	reg	[AW-1:0]	r_sum;
+	//
+	wire			sgn, overflow;
+	wire	[SHIFT:0]	sgn_bits;
+	wire	[AW-1:0]	prerounded, rounded_result;
+	//
+	integer			ik;
+	genvar			gk;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Coefficient loading
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Coefficient k belongs to branch j = k/NDOWN, and so to multiply
+	// j/NSTEP.  Within that multiply's memory, it is at address
+	// (j % NSTEP)*NDOWN + (k % NDOWN)--which is just the next address.
+	//
+	initial	wr_lane = 0;
+	initial	wr_addr = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		wr_lane <= 0;
+		wr_addr <= 0;
+	end else if (i_tap_wr)
+	begin
+		if (wr_addr == LAST_WADDR)
+		begin
+			wr_lane <= wr_lane + 1'b1;
+			wr_addr <= 0;
+		end else
+			wr_addr <= wr_addr + 1'b1;
+	end
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Decimation phase, and step sequencing
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// phase
+	// {{{
+	// The phase counts down to zero, marking the last sample of each
+	// output.
+	initial	phase = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		phase <= 0;
+	else if (i_ce)
+	begin
+		if (phase == 0)
+			phase <= LAST_PHASE;
+		else
+			phase <= phase - 1'b1;
+	end
+	// }}}
+
+	// s_valid, s_step, s_last
+	// {{{
+	initial	s_valid = 1'b0;
+	initial	s_step  = 0;
+	initial	s_last  = 1'b0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		s_valid <= 1'b0;
+		s_step  <= 0;
+		s_last  <= 1'b0;
+	end else if (i_ce)
+	begin
+		s_valid <= 1'b1;
+		s_step  <= 0;
+		s_last  <= (phase == 0);
+	end else if (s_valid)
+	begin
+		s_valid <= (s_step != LAST_STEP);
+		s_step  <= s_step + 1'b1;
+	end
+	// }}}
+
+	// s_addr, s_sample
+	// {{{
+	// Coefficient h[jD+r] is at address (j%NSTEP)*NDOWN + r, so start at
+	// r, and step through by NDOWN.
+	initial	s_addr = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		s_addr <= { {(LGLANE-LGNDOWN){1'b0}}, phase };
+	else
+		s_addr <= s_addr + STEP_SIZE;
+
+	initial	s_sample = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		s_sample <= i_sample;
+	// }}}
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Memory read, and multiply
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	initial	d_valid = 1'b0;
+	initial	d_shift = 1'b0;
+	initial	p_valid = 1'b0;
+	initial	p_shift = 1'b0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		d_valid <= 1'b0;
+		d_shift <= 1'b0;
+		p_valid <= 1'b0;
+		p_shift <= 1'b0;
+	end else begin
+		d_valid <= s_valid;
+		// Shift the accumulators on the last step of the last sample
+		d_shift <= s_valid && s_last && (s_step == LAST_STEP);
+
+		p_valid <= d_valid;
+		p_shift <= d_shift;
+	end
+
+	always @(posedge i_clk)
+	begin
+		d_step <= s_step;
+		p_step <= d_step;
+		dval   <= s_sample;
+	end
+
+	generate for(gk=0; gk<NMPY; gk=gk+1)
+	begin : LANE
+		// {{{
+		localparam	[LGNMPY-1:0]	LANE_ID = gk;
+
+		reg	[(CW-1):0]	cmem	[0:((1<<LGLANE)-1)];
+		reg	signed	[CW-1:0]	cval;
+		reg	signed	[IW+CW-1:0]	product;
+		integer			iw;
+
+		// Any coefficients beyond NCOEFFS are never written, and so
+		// must start at zero
+		initial	for(iw=0; iw<(1<<LGLANE); iw=iw+1)
+			cmem[iw] = 0;
+
+		always @(posedge i_clk)
+		if ((i_tap_wr)&&(wr_lane == LANE_ID))
+			cmem[wr_addr] <= i_tap;
+
+		always @(posedge i_clk)
+			cval <= cmem[s_addr];
+
+		always @(posedge i_clk)
+			product <= dval * cval;
+
+		assign	lane_product[gk] = { {(LGNCOEFFS){product[IW+CW-1]}},
+						product };
+		// }}}
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Accumulators
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	// On step s, multiply m has the product for branch m*NSTEP+s
+	generate for(gk=0; gk<NACC; gk=gk+1)
+	begin : ADDEND
+		localparam	[LGNSTEP-1:0]	STEP_ID = gk % NSTEP;
+
+		assign	addend[gk] = (p_step == STEP_ID)
+					? lane_product[gk / NSTEP] : 0;
+	end endgenerate
+
+	initial	for(ik=0; ik<NACC; ik=ik+1)
+		accumulator[ik] = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		for(ik=0; ik<NACC; ik=ik+1)
+			accumulator[ik] <= 0;
+	end else if (p_valid && p_shift)
+	begin
+		// Accumulator zero is complete.  Move every other partial sum
+		// down by one, so that accumulator j always holds the output
+		// j outputs from now.
+		for(ik=0; ik<NACC-1; ik=ik+1)
+			accumulator[ik] <= accumulator[ik+1] + addend[ik+1];
+		accumulator[NACC-1] <= 0;
+	end else if (p_valid)
+	begin
+		for(ik=0; ik<NACC; ik=ik+1)
+			accumulator[ik] <= accumulator[ik] + addend[ik];
+	end
+
+	initial	r_ce = 1'b0;
+	always @(posedge i_clk)
+		r_ce <= !i_reset && p_valid && p_shift;
+
+	initial	r_sum = 0;
+	always @(posedge i_clk)
+	if (p_valid && p_shift)
+		r_sum <= accumulator[0] + addend[0];
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Round the result to the right number of bits
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	sgn        = r_sum[AW-1];
+	assign	sgn_bits   = r_sum[AW-1:AW-1-SHIFT];
+	assign	prerounded = r_sum << SHIFT;
+	assign	rounded_result = prerounded
+				+ { {(OW){1'b0}}, prerounded[AW-OW-1],
+					{(AW-OW-1){!prerounded[AW-OW-1]}} };
+
+	// We overflow if either the shift drops a bit that isn't a copy of
+	// the sign bit, or if rounding a positive number makes it negative
+	assign	overflow = ((|sgn_bits) && !(&sgn_bits))
+				|| (!sgn && rounded_result[AW-1]);
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Return the results
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	initial	o_ce = 1'b0;
+	always @(posedge i_clk)
+		o_ce <= !i_reset && r_ce;
+
+	initial	o_result = 0;
+	always @(posedge i_clk)
+	if (r_ce)
+	begin
+		if (overflow)
+			o_result <= (sgn) ? { 1'b1, {(OW-1){1'b0}} }
+					: { 1'b0, {(OW-1){1'b1}} };
+		else
+			o_result <= rounded_result[AW-1:AW-OW];
+	end
+	// }}}
+
+	// Make Verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	unused;
+	assign	unused = &{ 1'b0, rounded_result[AW-OW-1:0] };
+	// verilator lint_on  UNUSED
+	// }}}
+endmodule
@@ -0,0 +1,430 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	subfilup.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	This module implements a fairly generic 1:NUP upsampler, the
+//		counterpart to subfildown.v.  Conceptually, NUP-1 zeros are
+//	inserted between every pair of incoming samples, and the result is then
+//	filtered.  Since most of the products in that filter would be products
+//	of zeros, only the nonzero ones are calculated.
+//
+//	Filtering equation:
+//		y[n] = SUM_{k=0}^{N-1} h[k]u[n-k]
+//
+//		where u[nL] = x[n], and u[] is otherwise zero.  L is the
+//		upsample ratio.
+//
+//	Polyphase (non-zero only) filtering equation:
+//		y[nL+p] = SUM_{j=0}^{B-1} h[jL+p]x[n-j]
+//
+//		for each output phase, 0 <= p < L, and B = ceil(N/L).
+//
+//	As with subfildown.v, this particular algorithm is designed to
+//	accomplish one multiply every system clock.  As a result, there must
+//	be at least NUP * ceil(NCOEFFS/NUP) system clocks between incoming
+//	samples.  Each output takes ceil(NCOEFFS/NUP) clocks.
+//
+// Usage:
+//	Reset
+//		Reset can be used to hold the various ce flags low, and to
+//		reset the coefficient address.  Reset is not used in the data
+//		path.
+//	Fixed coefficients:
+//		Set INITIAL_COEFFS to point to a file of hexadecimal
+//		coefficients, one coefficient per line.
+//	Variable coefficients:
+//		To load coefficients if FIXED_COEFFS is set to zero, set the
+//		i_reset flag for one cycle.  Ever after wards, if/when
+//		i_tap_wr is set a new value of coefficient memory will be set
+//		to the input i_tap value.  The coefficient pointer will move
+//		forward with every coefficient write.
+//
+//	Data processing:
+//		Every time i_ce is raised, the input value, i_sample, will be
+//		accepted in to this core as the next x[n] or data sample.
+//		There must be at least NUP*ceil(NCOEFFS/NUP) clocks between
+//		any two samples.
+//
+//		NUP outputs will be produced for every incoming sample, each
+//		with o_ce high.  As with subfildown.v, the output is shifted
+//		left by SHIFT bits, then rounded and saturated to OW bits.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+//
+// }}}
+module	subfilup #(
+		// {{{
+		//
+		// Bit widths: input width (IW),
+		parameter	IW = 16,
+		// output bit-width (OW),
+				OW = 24,
+		// and coefficient bit-width (CW)
+				CW = 12,
+		//
+		// Upsample rate, NUP.  For every incoming sample, this core
+		// will produce NUP outgoing samples.
+		parameter	NUP=5,
+		localparam	LGNUP=$clog2(NUP),
+		//
+		// If "FIXED_COEFFS" is set to one, the logic necessary to
+		// update coefficients will be removed to save space.
+		parameter [0:0]	FIXED_COEFFS = 1'b0,
+		//
+		// NCOEFFS is the number of coefficients, at the output rate
+		parameter	NCOEFFS=103,
+		//
+		// Each output requires NBRANCH products, one from each of the
+		// NBRANCH most recent samples.  The coefficients are stored
+		// in a memory of NBRANCH*NUP words, so that those beyond
+		// NCOEFFS will read as zero.
+		localparam	NBRANCH = (NCOEFFS+NUP-1)/NUP,
+		localparam	LGNBRANCH = $clog2(NBRANCH),
+		localparam	LGNCOEFFS = $clog2(NBRANCH*NUP),
+		//
+		// For fixed coefficients, if INITIAL_COEFFS != 0 (i.e. ""),
+		// then the filter's coefficients will be initialized from the
+		// filename given.
+		parameter	INITIAL_COEFFS = "",
+		//
+		parameter	SHIFT=2,
+		localparam	AW = IW+CW+LGNBRANCH
+		// }}}
+	) (
+		// {{{
+		input	wire		i_clk, i_reset,
+		//
+		input	wire		i_tap_wr,
+		input	wire [(CW-1):0]	i_tap,
+		//
+		input	wire		i_ce,
+		input	wire [(IW-1):0]	i_sample,
+		//
+		output	reg		o_ce,
+		output	reg [(OW-1):0]	o_result
+		// }}}
+	);
+
+	// Declare registers, nets, and memories
+	// {{{
+	localparam	[LGNUP-1:0]	LAST_PHASE  = NUP-1;
+	localparam	[LGNBRANCH-1:0]	LAST_BRANCH = NBRANCH-1;
+	localparam	[LGNCOEFFS-1:0]	COEFF_STEP  = NUP;
+
+	reg	[(CW-1):0]	cmem	[0:((1<<LGNCOEFFS)-1)];
+	reg	[(IW-1):0]	dmem	[0:((1<<LGNBRANCH)-1)];
+	//
+	reg	[LGNBRANCH-1:0]	wraddr, newest;
+	//
+	reg			running, first_branch, last_branch;
+	reg	[LGNUP-1:0]	phase;
+	reg	[LGNBRANCH-1:0]	bidx, didx;
+	reg	[LGNCOEFFS-1:0]	tidx;
+	//
+	reg			d_run, d_first, d_last;
+	reg	signed	[IW-1:0]	dval;
+	reg	signed	[CW-1:0]	cval;
+	//
+	reg			p_run, p_first, p_last;
+	reg	signed [IW+CW-1:0]	product;
+	//
+	reg	[AW-1:0]	accumulator;
+	wire	[AW-1:0]	next_acc;
+	reg			r_ce;
+	reg	[AW-1:0]	r_sum;
+	//
+	wire			sgn, overflow;
+	wire	[SHIFT:0]	sgn_bits;
+	wire	[AW-1:0]	prerounded, rounded_result;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Adjust the coefficients for our filter
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	generate if (FIXED_COEFFS || INITIAL_COEFFS != 0)
+	begin : LOAD_INITIAL_COEFFS
+
+		initial $readmemh(INITIAL_COEFFS, cmem);
+
+	end else begin : ZERO_INITIAL_COEFFS
+		// Any coefficients beyond NCOEFFS are never written, so they
+		// must start out as zero
+		integer	ik;
+
+		initial	for(ik=0; ik<(1<<LGNCOEFFS); ik=ik+1)
+			cmem[ik] = 0;
+	end endgenerate
+
+	generate if (FIXED_COEFFS)
+	begin : UNUSED_LOADING_PORTS
+		// {{{
+		// Make Verilator's -Wall happy
+		// verilator lint_off UNUSED
+		wire	ignored_inputs;
+		assign	ignored_inputs = &{ 1'b0, i_tap_wr, i_tap };
+		// verilator lint_on  UNUSED
+		// }}}
+	end else begin : LOAD_COEFFICIENTS
+		// {{{
+		// Coeff memory write index
+		reg	[LGNCOEFFS-1:0]	wr_coeff_index;
+
+		initial	wr_coeff_index = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			wr_coeff_index <= 0;
+		else if (i_tap_wr)
+			wr_coeff_index <= wr_coeff_index+1'b1;
+
+		always @(posedge i_clk)
+		if (i_tap_wr)
+			cmem[wr_coeff_index] <= i_tap;
+		// }}}
+	end endgenerate
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Write data logic
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	initial	wraddr    = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		wraddr <= wraddr + 1'b1;
+
+	always @(posedge i_clk)
+	if (i_ce)
+		dmem[wraddr] <= i_sample;
+
+	// Keep track of where the newest sample is, so each phase can start
+	// from it
+	initial	newest = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		newest <= wraddr;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Memory read index logic
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	// For each phase, p, walk through the branches, j, from the newest
+	// sample to the oldest.  Coefficient h[jL+p] is at address jL+p.
+	//
+
+	initial	running = 0;
+	initial	phase   = 0;
+	initial	bidx    = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		running <= 1'b0;
+		phase   <= 0;
+		bidx    <= 0;
+	end else if (i_ce)
+	begin
+		running <= 1'b1;
+		phase   <= 0;
+		bidx    <= 0;
+	end else if (running)
+	begin
+		if (bidx == LAST_BRANCH)
+		begin
+			bidx  <= 0;
+			phase <= phase + 1'b1;
+			if (phase == LAST_PHASE)
+				running <= 1'b0;
+		end else
+			bidx <= bidx + 1'b1;
+	end
+
+	always @(*)
+	begin
+		first_branch = (bidx == 0);
+		last_branch  = (bidx == LAST_BRANCH);
+	end
+
+	initial	tidx = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		tidx <= 0;
+	else if (last_branch)
+		tidx <= { {(LGNCOEFFS-LGNUP){1'b0}}, phase } + 1'b1;
+	else
+		tidx <= tidx + COEFF_STEP;
+
+	initial	didx = 0;
+	always @(posedge i_clk)
+	if (i_ce)
+		// Start with the sample being written on this clock
+		didx <= wraddr;
+	else if (last_branch)
+		didx <= newest;
+	else
+		didx <= didx - 1'b1;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Memory read(s)
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+
+	always @(posedge i_clk)
+	begin
+		dval <= dmem[didx];
+		cval <= cmem[tidx];
+	end
+
+	initial	d_run  = 0;
+	initial	d_first= 0;
+	initial	d_last = 0;
+	initial	p_run  = 0;
+	initial	p_first= 0;
+	initial	p_last = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		d_run  <= 0;
+		d_first<= 0;
+		d_last <= 0;
+		p_run  <= 0;
+		p_first<= 0;
+		p_last <= 0;
+	end else begin
+		// d_run is true when a memory read of data is valid
+		d_run  <= running;
+		d_first<= running && first_branch;
+		d_last <= running && last_branch;
+
+		// p_run is true when a product is valid
+		p_run  <= d_run;
+		p_first<= d_first;
+		p_last <= d_last;
+	end
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Product
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	(* mul2dsp *)
+	always @(posedge i_clk)
+		product <= dval * cval;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Accumulator
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+
+	assign	next_acc = ((p_first) ? 0 : accumulator)
+			+ { {(LGNBRANCH){product[IW+CW-1]}}, product };
+
+	initial	accumulator = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		accumulator <= 0;
+	else if (p_run)
+		accumulator <= next_acc;
+
+	initial	r_ce = 1'b0;
+	always @(posedge i_clk)
+		r_ce <= !i_reset && p_run && p_last;
+
+	initial	r_sum = 0;
+	always @(posedge i_clk)
+	if (p_run && p_last)
+		r_sum <= next_acc;
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Round the result to the right number of bits
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	assign	sgn        = r_sum[AW-1];
+	assign	sgn_bits   = r_sum[AW-1:AW-1-SHIFT];
+	assign	prerounded = r_sum << SHIFT;
+	assign	rounded_result = prerounded
+				+ { {(OW){1'b0}}, prerounded[AW-OW-1],
+					{(AW-OW-1){!prerounded[AW-OW-1]}} };
+
+	// We overflow if either the shift drops a bit that isn't a copy of
+	// the sign bit, or if rounding a positive number makes it negative
+	assign	overflow = ((|sgn_bits) && !(&sgn_bits))
+				|| (!sgn && rounded_result[AW-1]);
+	// }}}
+	////////////////////////////////////////////////////////////////////////
+	//
+	// Return the results
+	// {{{
+	////////////////////////////////////////////////////////////////////////
+	//
+	//
+	initial	o_ce = 1'b0;
+	always @(posedge i_clk)
+		o_ce <= !i_reset && r_ce;
+
+	initial	o_result = 0;
+	always @(posedge i_clk)
+	if (r_ce)
+	begin
+		if (overflow)
+			o_result <= (sgn) ? { 1'b1, {(OW-1){1'b0}} }
+					: { 1'b0, {(OW-1){1'b1}} };
+		else
+			o_result <= rounded_result[AW-1:AW-OW];
+	end
+	// }}}
+
+	// Make Verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	unused;
+	assign	unused = &{ 1'b0, rounded_result[AW-OW-1:0] };
+	// verilator lint_on  UNUSED
+	// }}}
+endmodule
@@ -0,0 +1,187 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	symtap.v
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A symmetric version of firtap.v.  Where firtap multiplies its
+//		tap by a single sample, symtap first adds two samples
+//	together--the sample from its place in the delay line, and a mirror
+//	sample from the far end of the filter--and only then multiplies.  Since
+//	the two samples share a coefficient in any symmetric (linear phase)
+//	filter, this halves the number of multiplies required.
+//
+//	The center tap of an odd length filter has no mirror.  Set OPT_CENTER
+//	for that tap, and i_mirror will be ignored.
+//
+//	This tap is a component of fastsymf.v.  As with firtap, the sample
+//	delay line has two delays per tap, and the product passes through
+//	three registers (pre-add, multiply, accumulate) on its way out.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+`default_nettype	none
+// }}}
+module	symtap #(
+		// {{{
+		parameter		IW=16, TW=IW, OW=IW+TW+9,
+		parameter [0:0]		FIXED_TAPS=0,
+		parameter [(TW-1):0]	INITIAL_VALUE=0,
+		parameter [0:0]		OPT_CENTER=0
+		// }}}
+	) (
+		// {{{
+		input	wire			i_clk, i_reset,
+		// Coefficient setting/handling
+		// {{{
+		input	wire			i_tap_wr,
+		input	wire	[(TW-1):0]	i_tap,
+		output	wire signed [(TW-1):0]	o_tap,
+		// }}}
+		// Data pipeline
+		// {{{
+		input	wire			i_ce,
+		input	wire signed [(IW-1):0]	i_sample,
+		input	wire signed [(IW-1):0]	i_mirror,
+		output	reg	[(IW-1):0]	o_sample,
+		// }}}
+		// Output "results"
+		// {{{
+		input	wire	[(OW-1):0]	i_partial_acc,
+		output	reg	[(OW-1):0]	o_acc
+		// }}}
+		// }}}
+	);
+
+	// Local declarations
+	// {{{
+	reg		[(IW-1):0]	delayed_sample;
+	reg	signed	[IW:0]		presum;
+	reg	signed	[(TW+IW):0]	product;
+	// }}}
+
+	// Determine the tap we are using
+	// {{{
+	generate if (FIXED_TAPS != 0)
+	begin : NO_TAP_UPDATES
+		// If our taps are fixed, the tap is given by the i_tap
+		// external input.
+		assign	o_tap = i_tap;
+
+	end else begin : GEN_TAP_UPDATE_LOGIC
+		// Otherwise, taps are strung together through the filter,
+		// and shift forward by one on every i_tap_wr.
+		reg	[(TW-1):0]	tap;
+
+		initial	tap = INITIAL_VALUE;
+		always @(posedge i_clk)
+		if (i_tap_wr)
+			tap <= i_tap;
+		assign o_tap = tap;
+
+	end endgenerate
+	// }}}
+
+	// o_sample, delayed_sample
+	// {{{
+	// Forward the sample on down the line, with two delays per tap, just
+	// like firtap
+	initial	o_sample = 0;
+	initial	delayed_sample = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+	begin
+		delayed_sample <= 0;
+		o_sample <= 0;
+	end else if (i_ce)
+	begin
+		delayed_sample <= i_sample;
+		o_sample <= delayed_sample;
+	end
+	// }}}
+
+	// presum
+	// {{{
+	// The pre-adder: fold our sample together with its mirror image
+	generate if (OPT_CENTER)
+	begin : NO_MIRROR
+		initial	presum = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			presum <= 0;
+		else if (i_ce)
+			presum <= { i_sample[IW-1], i_sample };
+
+		// Verilator lint_off UNUSED
+		wire	[IW-1:0]	unused_mirror;
+		assign	unused_mirror = i_mirror;
+		// Verilator lint_on  UNUSED
+	end else begin : PREADD
+		initial	presum = 0;
+		always @(posedge i_clk)
+		if (i_reset)
+			presum <= 0;
+		else if (i_ce)
+			presum <= { i_sample[IW-1], i_sample }
+				+ { i_mirror[IW-1], i_mirror };
+	end endgenerate
+	// }}}
+
+	// Multiply the filter tap by the folded sample
+	// {{{
+	initial	product = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		product <= 0;
+	else if (i_ce)
+		product <= o_tap * presum;
+	// }}}
+
+	// Continue summing together the output components of the FIR filter
+	// {{{
+	initial	o_acc = 0;
+	always @(posedge i_clk)
+	if (i_reset)
+		o_acc <= 0;
+	else if (i_ce)
+		o_acc <= i_partial_acc
+			+ { {(OW-(TW+IW+1)){product[(TW+IW)]}}, product };
+	// }}}
+
+	// Make verilator happy
+	// {{{
+	// verilator lint_off UNUSED
+	wire	unused;
+	assign	unused = i_tap_wr;
+	// verilator lint_on  UNUSED
+	// }}}
+endmodule
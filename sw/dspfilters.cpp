@@ -0,0 +1,717 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dspfilters.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	The engines of libdspfilters: software filters reproducing,
+//		bit for bit, the outputs of the RTL cores they are named after.
+//	See dspfilters.h for a description of each.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include "dspfilters.h"
+
+// sbits
+// {{{
+static int64_t	sbits(int64_t val, int b) {
+	val <<= (64-b);
+	val >>= (64-b);
+	return val;
+}
+// }}}
+
+// ubits
+// {{{
+static uint64_t	ubits(uint64_t val, int b) {
+	return val & ((1ul << b)-1);
+}
+// }}}
+
+// clog2
+// {{{
+// The number of bits required to hold values from 0 to v-1, as in
+// Verilog's $clog2()
+static int	clog2(int v) {
+	int	r;
+
+	for(r=0; (1<<r) < v; r++)
+		;
+	return r;
+}
+// }}}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// DIRECTFIR
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+
+DIRECTFIR::DIRECTFIR(int ntaps, int iw, int tw, int ow)
+		: m_ntaps(ntaps), m_iw(iw), m_tw(tw), m_ow(ow) {
+	assert(ntaps > 0);
+	assert(iw > 0 && iw <= 32);
+	assert(tw > 0 && tw <= 32);
+	assert(ow > 0 && ow <= 32);
+
+	m_h    = new int64_t[ntaps];
+	m_hist = new int64_t[2*ntaps];
+	for(int k=0; k<ntaps; k++)
+		m_h[k] = 0;
+	reset();
+}
+
+DIRECTFIR::~DIRECTFIR(void) {
+	delete[] m_h;
+	delete[] m_hist;
+}
+
+void	DIRECTFIR::reset(void) {
+	for(int k=0; k<2*m_ntaps; k++)
+		m_hist[k] = 0;
+	m_pos = 0;
+}
+
+// process
+// {{{
+// The history is kept twice, so that m_hist[m_pos+k] is always x[n-k]
+// without any wrapping.
+int	DIRECTFIR::process(span<const int32_t> in, span<int32_t> out) {
+	assert(out.size() >= in.size());
+
+	for(size_t n=0; n<in.size(); n++) {
+		int64_t		acc = 0;
+		const int64_t	*x;
+
+		m_pos = ((m_pos == 0) ? m_ntaps : m_pos) - 1;
+		m_hist[m_pos] = m_hist[m_pos + m_ntaps] = sbits(in[n], m_iw);
+
+		x = &m_hist[m_pos];
+		for(int k=0; k<m_ntaps; k++)
+			acc += m_h[k] * x[k];
+
+		out[n] = (int32_t)sbits(acc, m_ow);
+	}
+
+	return (int)in.size();
+}
+// }}}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// FASTFIR, SLOWSYMF, SHALFBAND
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+
+FASTFIR::FASTFIR(int ntaps, int iw, int tw, int ow)
+		: DIRECTFIR(ntaps, iw, tw, ow) {}
+
+void	FASTFIR::load(span<const int32_t> taps) {
+	assert((int)taps.size() == m_ntaps);
+
+	for(int k=0; k<m_ntaps; k++)
+		m_h[k] = sbits(taps[k], m_tw);
+}
+
+SLOWSYMF::SLOWSYMF(int ntaps, int iw, int tw, int ow)
+		: DIRECTFIR(ntaps, iw, tw, ow) {
+	assert(ntaps & 1);
+}
+
+void	SLOWSYMF::load(span<const int32_t> taps) {
+	const	int	mid = (m_ntaps-1)/2;
+
+	assert((int)taps.size() == nload());
+
+	for(int k=0; k<mid; k++)
+		m_h[k] = m_h[m_ntaps-1-k] = sbits(taps[k], m_tw);
+	m_h[mid] = (1l << (m_tw-1))-1;
+}
+
+SHALFBAND::SHALFBAND(int ntaps, int iw, int tw, int ow)
+		: DIRECTFIR(ntaps, iw, tw, ow) {
+	assert((ntaps & 3) == 3);
+}
+
+void	SHALFBAND::load(span<const int32_t> taps) {
+	const	int	mid = (m_ntaps-1)/2;
+
+	assert((int)taps.size() == nload());
+
+	for(int k=0; k<m_ntaps; k++)
+		m_h[k] = 0;
+	for(int k=0; k<nload(); k++)
+		m_h[2*k] = m_h[m_ntaps-1-2*k] = sbits(taps[k], m_tw);
+	m_h[mid] = (1l << (m_tw-1))-1;
+}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// SUBFILDOWN
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+
+SUBFILDOWN::SUBFILDOWN(int iw, int ow, int cw, int ndown, int ncoeffs,
+		int shift) : m_iw(iw), m_ow(ow), m_cw(cw), m_ndown(ndown),
+			m_ncoeffs(ncoeffs), m_shift(shift) {
+	m_lgmem = clog2(ncoeffs);
+	m_aw = iw + cw + m_lgmem;
+
+	assert(iw > 0 && iw <= 32);
+	assert(cw > 0 && cw <= 32);
+	assert(ow > 0 && ow <= 32);
+	assert(ndown >= 2);
+	assert(m_aw < 63);
+	// Only the SHIFT_OUTPUT rounding is supported
+	assert(m_aw - shift > ow);
+
+	m_coeffs = new int64_t[1<<m_lgmem];
+	m_mem    = new int64_t[1<<m_lgmem];
+	for(int k=0; k<(1<<m_lgmem); k++)
+		m_coeffs[k] = 0;
+	reset();
+}
+
+SUBFILDOWN::~SUBFILDOWN(void) {
+	delete[] m_coeffs;
+	delete[] m_mem;
+}
+
+void	SUBFILDOWN::load(span<const int32_t> coeffs) {
+	assert((int)coeffs.size() == m_ncoeffs);
+
+	for(int k=0; k<m_ncoeffs; k++)
+		m_coeffs[k] = sbits(coeffs[k], m_cw);
+}
+
+void	SUBFILDOWN::reset(void) {
+	for(int k=0; k<(1<<m_lgmem); k++)
+		m_mem[k] = 0;
+	m_wraddr = 0;
+	m_countdown = 0;
+}
+
+// round
+// {{{
+// Shift left by m_shift, round to m_ow bits, and saturate on overflow,
+// exactly as the SHIFT_OUTPUT logic of subfildown.v does
+int32_t	SUBFILDOWN::round(int64_t acc) const {
+	const	uint64_t	mask = (1ul << m_aw)-1;
+	const	int		lsb  = m_aw - m_ow - 1;
+	uint64_t	prerounded, rounded;
+	bool		sgn, overflow;
+
+	sgn = (acc >> (m_aw-1)) & 1;
+	prerounded = ((uint64_t)acc << m_shift) & mask;
+	if ((prerounded >> lsb) & 1)
+		rounded = prerounded + (1ul << lsb);
+	else
+		rounded = prerounded + (1ul << lsb) - 1;
+	rounded &= mask;
+
+	overflow = (sgn && !((prerounded >> (m_aw-1)) & 1))
+			|| (!sgn && ((rounded >> (m_aw-1)) & 1));
+
+	if (overflow)
+		return (int32_t)((sgn) ? -(1l << (m_ow-1)) : (1l << (m_ow-1))-1);
+	return (int32_t)sbits(rounded >> (m_aw-m_ow), m_ow);
+}
+// }}}
+
+// process
+// {{{
+int	SUBFILDOWN::process(span<const int32_t> in, span<int32_t> out) {
+	const	unsigned	mask = (1u << m_lgmem)-1;
+	int	nout = 0;
+
+	assert((int)out.size() >= maxout((int)in.size()));
+
+	for(size_t n=0; n<in.size(); n++) {
+		if (m_countdown == 0) {
+			// The first sample of a block.  The core starts
+			// reading from the address this sample is about to
+			// be written to--so its first coefficient multiplies
+			// the sample 2^LGMEM before this one.
+			int64_t	acc = 0;
+
+			for(int t=0; t<m_ncoeffs; t++)
+				acc += m_coeffs[t] * m_mem[(m_wraddr + t) & mask];
+			out[nout++] = round(sbits(acc, m_aw));
+
+			m_countdown = m_ndown;
+		}
+
+		m_countdown--;
+		m_mem[m_wraddr] = sbits(in[n], m_iw);
+		m_wraddr = (m_wraddr + 1) & mask;
+	}
+
+	return nout;
+}
+// }}}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// RATFIL
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+
+RATFIL::RATFIL(int iw, int tw, int ow, int ns, int nup, int ndown,
+		int lggain, int ncoeffs) : m_iw(iw), m_tw(tw), m_ow(ow),
+			m_ns(ns), m_nup(nup), m_ndown(ndown), m_lggain(lggain),
+			m_ncoeffs(ncoeffs) {
+	const	int	ntaps = (ncoeffs + nup - 1) / nup;
+
+	assert(iw > 0 && iw <= 32);
+	assert(tw > 0 && tw <= 32);
+	assert(ns >= 1);
+	assert(nup >= 1 && ndown > nup);
+	// Every phase needs at least two coefficients, or the core never
+	// produces its output
+	assert(ncoeffs >= 2*nup);
+
+	m_lgmem = clog2(ns * (ncoeffs + nup - 1) / nup);
+	m_aw = iw + tw + clog2(ncoeffs);
+
+	assert(m_aw < 63);
+	assert(ow <= m_aw - lggain);
+
+	// The core accepts the beats it skips while it's still reading from
+	// its memory.  Those mustn't overwrite anything it has yet to read,
+	// or the core's output would depend upon its clock timing.
+	assert(ns * (ntaps + ndown / nup) <= (1 << m_lgmem));
+
+	m_coeffs = new int64_t[ncoeffs];
+	m_mem    = new int64_t[1<<m_lgmem];
+	for(int k=0; k<ncoeffs; k++)
+		m_coeffs[k] = 0;
+	for(int k=0; k<(1<<m_lgmem); k++)
+		m_mem[k] = 0;
+	reset();
+}
+
+RATFIL::~RATFIL(void) {
+	delete[] m_coeffs;
+	delete[] m_mem;
+}
+
+void	RATFIL::load(span<const int32_t> coeffs) {
+	assert((int)coeffs.size() == m_ncoeffs);
+
+	for(int k=0; k<m_ncoeffs; k++)
+		m_coeffs[k] = sbits(coeffs[k], m_tw);
+}
+
+void	RATFIL::reset(void) {
+	m_wraddr   = 0;
+	m_beat     = 0;
+	m_phase    = 0;
+	m_skip     = 0;
+	m_skip_run = false;
+}
+
+// round
+// {{{
+int32_t	RATFIL::round(int64_t acc) const {
+	const	uint64_t	mask = (1ul << m_aw)-1;
+	uint64_t	rounded;
+
+	if (m_ow == m_aw - m_lggain) {
+		// GEN_TRUNCATE: the bottom OW bits, placed at the bottom of
+		// an AW bit word, of which the top OW bits are then kept
+		rounded = ubits(acc, m_ow);
+	} else {
+		// SHIFT_OUTPUT
+		const	int	lsb = m_aw - m_ow - 1;
+		uint64_t	shifted;
+
+		shifted = ((uint64_t)acc << m_lggain) & mask;
+		if ((shifted >> lsb) & 1)
+			rounded = shifted + (1ul << lsb);
+		else
+			rounded = shifted + (1ul << lsb) - 1;
+		rounded &= mask;
+	}
+
+	// Only IW bits of the OW bit result make it to M_AXI_TDATA
+	return (int32_t)sbits(ubits(rounded >> (m_aw - m_ow), m_iw), m_iw);
+}
+// }}}
+
+// process
+// {{{
+int	RATFIL::process(span<const int32_t> in, span<int32_t> out) {
+	const	unsigned	mask = (1u << m_lgmem)-1;
+	int	nout = 0;
+
+	assert((int)out.size() >= maxout((int)in.size()));
+
+	for(size_t n=0; n<in.size(); n++) {
+		const	unsigned	wr = m_wraddr;
+		const	bool		last = (m_beat == m_ns-1);
+		int	next_phase, next_skip;
+		bool	next_skip_run;
+		int64_t	acc = 0;
+
+		m_mem[wr] = sbits(in[n], m_iw);
+		m_wraddr  = (wr + 1) & mask;
+		m_beat    = (last) ? 0 : m_beat+1;
+
+		if (m_skip_run) {
+			// The skip count only advances on the last beat
+			if (last) {
+				m_skip_run = (m_skip > 1);
+				m_skip--;
+			}
+			continue;
+		}
+
+		// Coefficients m_phase, m_phase+NUP, ..., against this
+		// beat and those before it from the same stream
+		for(int c=m_phase, k=0; c<m_ncoeffs; c+=m_nup, k++)
+			acc += m_coeffs[c] * m_mem[(wr - k*m_ns) & mask];
+		out[nout++] = round(sbits(acc, m_aw));
+
+		if (!last)
+			continue;
+
+		// Where does the next output start?
+		next_skip_run = (m_ndown >= 2*m_nup);
+		next_phase = m_phase + (m_ndown % m_nup);
+		next_skip  = (m_ndown / m_nup) - 1;
+		if (next_phase >= m_nup) {
+			next_skip_run = true;
+			next_phase -= m_nup;
+			next_skip++;
+		}
+
+		m_phase    = next_phase;
+		m_skip     = next_skip;
+		m_skip_run = next_skip_run;
+	}
+
+	return nout;
+}
+// }}}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// BOXCAR
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+
+BOXCAR::BOXCAR(int iw, int lgmem, int ow, int navg)
+		: m_iw(iw), m_lgmem(lgmem), m_ow(ow), m_navg(navg) {
+	assert(iw > 0 && lgmem > 0);
+	assert(iw + lgmem < 63);
+	assert(ow <= iw + lgmem && ow <= 32);
+
+	m_mem = new uint64_t[1<<lgmem];
+	for(int k=0; k<(1<<lgmem); k++)
+		m_mem[k] = 0;
+	reset();
+}
+
+BOXCAR::~BOXCAR(void) {
+	delete[] m_mem;
+}
+
+void	BOXCAR::reset(void) {
+	m_wraddr = 0;
+	m_rdaddr = (unsigned)ubits(-m_navg, m_lgmem);
+	m_full   = false;
+	m_acc    = 0;
+}
+
+// round
+// {{{
+uint32_t	BOXCAR::round(uint64_t acc) const {
+	const	int	aw = m_iw + m_lgmem;
+	uint64_t	rounded;
+
+	if (aw == m_ow)
+		rounded = acc;
+	else if (aw == m_ow + 1)
+		rounded = acc + ((acc >> 1) & 1);
+	else if ((acc >> (aw - m_ow)) & 1)
+		rounded = acc + (1ul << (aw - m_ow - 1));
+	else
+		rounded = acc + (1ul << (aw - m_ow - 1)) - 1;
+
+	return (uint32_t)(ubits(rounded, aw) >> (aw - m_ow));
+}
+// }}}
+
+// process
+// {{{
+int	BOXCAR::process(span<const int32_t> in, span<int32_t> out) {
+	const	unsigned	mask = (1u << m_lgmem)-1;
+
+	assert(out.size() >= in.size());
+
+	for(size_t n=0; n<in.size(); n++) {
+		uint64_t	x = ubits(in[n], m_iw), memval, sub;
+
+		// Read before write, in case m_rdaddr == m_wraddr
+		memval = m_mem[m_rdaddr];
+		m_mem[m_wraddr] = x;
+
+		m_full = m_full || (m_rdaddr == 0);
+		if (m_full)
+			sub = ubits(x - memval, m_iw+1);
+		else
+			sub = x;
+		m_acc = ubits(m_acc + sub, m_iw + m_lgmem);
+
+		m_wraddr = (m_wraddr + 1) & mask;
+		m_rdaddr = (m_rdaddr + 1) & mask;
+
+		out[n] = (int32_t)round(m_acc);
+	}
+
+	return (int)in.size();
+}
+// }}}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// IIRAVG
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+
+IIRAVG::IIRAVG(int iw, int ow, int lgalpha, uint64_t reset_value)
+		: m_iw(iw), m_ow(ow), m_lgalpha(lgalpha) {
+	assert(iw <= ow);
+	assert(ow <= 32);
+	assert(lgalpha < ow);
+
+	m_reset_value = ubits(reset_value, ow);
+	reset();
+}
+
+int	IIRAVG::process(span<const int32_t> in, span<int32_t> out) {
+	assert(out.size() >= in.size());
+
+	for(size_t n=0; n<in.size(); n++) {
+		uint64_t	data = ubits(in[n], m_iw);
+		int64_t		difference;
+
+		// The difference is taken at OW bits, and may overflow
+		difference = sbits((data << (m_ow-m_iw)) - m_average, m_ow);
+
+		// An arithmetic shift right, rounding towards minus infinity
+		m_average = ubits(m_average + (difference >> m_lgalpha), m_ow);
+
+		out[n] = (int32_t)m_average;
+	}
+
+	return (int)in.size();
+}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// CHEAPSPECTRAL
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+
+CHEAPSPECTRAL::CHEAPSPECTRAL(int iw, int lglags, int lgnavg)
+		: m_iw(iw), m_lglags(lglags), m_lgnavg(lgnavg) {
+	m_ab = 2*iw + lgnavg;
+
+	assert(iw > 0 && lglags > 0 && lgnavg > 0);
+	assert(m_ab < 63);
+
+	m_data = new int64_t[1<<lglags];
+	m_av   = new int64_t[1<<lglags];
+	reset();
+}
+
+CHEAPSPECTRAL::~CHEAPSPECTRAL(void) {
+	delete[] m_data;
+	delete[] m_av;
+}
+
+// reset
+// {{{
+// Return to the core's power up state, followed by one clock of i_reset
+void	CHEAPSPECTRAL::reset(void) {
+	for(int k=0; k<LAGS(); k++)
+		m_data[k] = m_av[k] = 0;
+
+	m_wraddr   = 0;
+	m_dlyaddr  = 1;
+	m_avaddr   = 0;
+	m_avcounts = 0;
+	m_start_request = true;
+	m_check    = true;
+	m_running  = false;
+	m_clear    = true;
+}
+// }}}
+
+// clock
+// {{{
+// One clock of the core, returning true if the estimate was completed on
+// this clock.  The core spends 2^LGLAGS clocks following each sample it
+// uses, multiplying it against the memory.  Those reads are always of
+// values older than the ones being written, so the whole correlation can
+// be taken here at once--on the clock it starts.
+bool	CHEAPSPECTRAL::clock(bool ce, int64_t sample, bool wb_write) {
+	const	unsigned	mask = LAGS()-1,
+				allones = (1u << m_lgnavg)-1;
+	const	bool	last_read = m_running && (m_avaddr == mask);
+	const	bool	first = !m_running && ce && m_check;
+	bool	done = false, clear;
+	unsigned	avcounts;
+
+	// avcounts, clear_memory
+	// {{{
+	avcounts = m_avcounts;
+	clear    = m_clear;
+	if (m_running) {
+		if (last_read)
+			clear = false;
+	} else {
+		if (m_start_request) {
+			avcounts = 0;
+			clear = true;
+		} else if (ce && m_check)
+			avcounts = (avcounts + 1) & allones;
+	}
+	// }}}
+
+	sample = sbits(sample, m_iw);
+	if (first) {
+		// The first product is read from wherever delayed_addr
+		// pointed on the last clock, before this sample is written.
+		// The rest follow this sample's address, oldest first, and
+		// end with this sample itself.
+		int64_t	delayed = m_data[m_dlyaddr & mask];
+
+		m_data[m_wraddr] = sample;
+		for(int k=0; k<LAGS(); k++) {
+			int64_t	product;
+
+			if (k > 0)
+				delayed = m_data[(m_wraddr + 1 + k) & mask];
+			product = delayed * sample;
+			m_av[k] = sbits(((clear) ? 0 : m_av[k]) + product, m_ab);
+		}
+
+		done = (avcounts == allones);
+	} else if (ce)
+		m_data[m_wraddr] = sample;
+
+	// delayed_addr
+	if (m_running && !last_read)
+		m_dlyaddr = (m_dlyaddr + 1) & mask;
+	else
+		m_dlyaddr = (m_wraddr + 1 + ((ce && m_check) ? 1:0)) & mask;
+
+	// check_this
+	if (m_running)
+		m_check = (m_avcounts != allones);
+	else
+		m_check = m_check || m_start_request || (m_avcounts != allones);
+
+	// start_request
+	if (wb_write)
+		m_start_request = true;
+	else if (first)
+		m_start_request = false;
+
+	// running, av_read_addr
+	m_avaddr  = (m_running) ? ((m_avaddr + 1) & mask) : 0;
+	m_running = (m_running) ? !last_read : first;
+
+	m_wraddr   = (m_wraddr + ((ce) ? 1:0)) & mask;
+	m_avcounts = avcounts;
+	m_clear    = clear;
+
+	return done;
+}
+// }}}
+
+void	CHEAPSPECTRAL::idle(int nclocks) {
+	for(int k=0; k<nclocks; k++)
+		clock(false, 0, false);
+}
+
+// result
+// {{{
+// The top 32 bits of the average, or the sign extended average if it's
+// narrower than that
+int32_t	CHEAPSPECTRAL::result(int addr) const {
+	int64_t	av = m_av[addr & (LAGS()-1)];
+
+	if (m_ab > 32)
+		av >>= (m_ab - 32);
+	return (int32_t)av;
+}
+// }}}
+
+// process
+// {{{
+int	CHEAPSPECTRAL::process(span<const int32_t> in, span<int32_t> out) {
+	int	nout = 0;
+
+	for(size_t n=0; n<in.size(); n++) {
+		if (clock(true, in[n], false)) {
+			assert((int)out.size() >= nout + LAGS());
+			for(int k=0; k<LAGS(); k++)
+				out[nout++] = result(k);
+		}
+	}
+
+	return nout;
+}
+// }}}
+// }}}
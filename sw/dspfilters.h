@@ -0,0 +1,358 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	dspfilters.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A host-side library of filters, each a bit exact copy of one
+//		of the RTL cores in this repository.  Given the same parameters,
+//	coefficients and input, each engine produces the same output values
+//	the core does--so a block of data can be run through the library in
+//	software, and the results then trusted to match the hardware.
+//
+//	Every engine processes samples a block at a time:
+//
+//		int	nout = engine.process(in, out);
+//
+//	consumes every sample in in[], writes the outputs those samples
+//	produce to out[], and returns how many it wrote.  out[] must have room
+//	for maxout(in.size()) values.  Samples are int32_t's, holding the
+//	input bits of the core (sign extended for signed inputs).  Outputs
+//	are sign extended for signed cores, and zero extended otherwise.
+//
+//	The core's pipeline latency is removed: out[n] is the core's answer
+//	to in[n], whenever that answer may show up.  delay() gives the number
+//	of samples that were removed.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	DSPFILTERS_H
+#define	DSPFILTERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// span
+// {{{
+// C++20 provides std::span.  Before then, we'll use a minimal stand-in for
+// it: a pointer to some number of contiguous samples, which can be built
+// from a pointer and a length, an array, or a std::vector.
+#if	__cplusplus >= 202002L
+#include <span>
+using	std::span;
+#else
+#include <utility>
+
+template<class T> class	span {
+	T	*m_data;
+	size_t	m_size;
+public:
+	span(void) : m_data(NULL), m_size(0) {}
+	span(T *data, size_t size) : m_data(data), m_size(size) {}
+	template<size_t N> span(T (&data)[N]) : m_data(data), m_size(N) {}
+	template<class C, class = decltype(std::declval<C &>().data())>
+		span(C &c) : m_data(c.data()), m_size(c.size()) {}
+	template<class U> span(const span<U> &s)
+		: m_data(s.data()), m_size(s.size()) {}
+
+	T	*data(void) const { return m_data; }
+	size_t	size(void) const { return m_size; }
+	bool	empty(void) const { return m_size == 0; }
+	T	&operator[](size_t k) const { return m_data[k]; }
+	T	*begin(void) const { return m_data; }
+	T	*end(void) const { return m_data + m_size; }
+	span<T>	subspan(size_t offset) const {
+		return span<T>(m_data + offset, m_size - offset); }
+	span<T>	subspan(size_t offset, size_t count) const {
+		return span<T>(m_data + offset, count); }
+};
+#endif
+// }}}
+
+// DSPFILTER
+// {{{
+// The interface every engine shares
+class	DSPFILTER {
+public:
+	virtual	~DSPFILTER(void) {}
+
+	// Return the filter to the state it starts in, with a history of
+	// all zeros
+	virtual	void	reset(void) = 0;
+
+	// Filter every sample of in[], returning the number of outputs
+	// written to out[]
+	virtual	int	process(span<const int32_t> in, span<int32_t> out) = 0;
+
+	// The most outputs that nin samples can produce
+	virtual	int	maxout(int nin) const { return nin; }
+
+	// The core's latency, in samples, which process() removes
+	virtual	int	delay(void) const { return 0; }
+};
+// }}}
+
+// DIRECTFIR
+// {{{
+// A direct form FIR filter, y[n] = SUM h[k] x[n-k], with the output wrapped
+// to ow bits just as the RTL's accumulator wraps.  This is the arithmetic
+// behind fastfir, slowsymf, and shalfband.  They differ only in how their
+// coefficients are loaded, and in their latencies.
+class	DIRECTFIR : public DSPFILTER {
+protected:
+	int		m_ntaps, m_iw, m_tw, m_ow;
+	int64_t		*m_h, *m_hist;
+	int		m_pos;
+
+	DIRECTFIR(int ntaps, int iw, int tw, int ow);
+public:
+	~DIRECTFIR(void);
+
+	int	NTAPS(void) const { return m_ntaps; }
+
+	// The impulse response the loaded coefficients produce
+	int64_t	tap(int k) const { return m_h[k]; }
+
+	void	reset(void);
+	int	process(span<const int32_t> in, span<int32_t> out);
+};
+// }}}
+
+// FASTFIR
+// {{{
+// fastfir.v: all ntaps coefficients are loaded, h[0] first
+class	FASTFIR : public DIRECTFIR {
+public:
+	FASTFIR(int ntaps, int iw, int tw, int ow);
+
+	void	load(span<const int32_t> taps);
+	int	delay(void) const { return 1; }
+};
+// }}}
+
+// SLOWSYMF
+// {{{
+// slowsymf.v: an odd length symmetric filter.  Only the first (ntaps-1)/2
+// coefficients are loaded.  The middle coefficient is fixed at
+// 2^(tw-1)-1, and the rest mirror the first half.
+class	SLOWSYMF : public DIRECTFIR {
+public:
+	SLOWSYMF(int ntaps, int iw, int tw, int ow);
+
+	int	nload(void) const { return (m_ntaps-1)/2; }
+	void	load(span<const int32_t> taps);
+	int	delay(void) const { return 2; }
+};
+// }}}
+
+// SHALFBAND
+// {{{
+// shalfband.v: a half-band filter, ntaps = 3 (mod 4) long.  Only the
+// (ntaps-1)/4+1 non-zero coefficients prior to the middle are loaded.
+// Every other coefficient is zero, the middle one is 2^(tw-1)-1, and the
+// rest mirror the first half.  (The OPT_HILBERT option isn't supported.)
+class	SHALFBAND : public DIRECTFIR {
+public:
+	SHALFBAND(int ntaps, int iw, int tw, int ow);
+
+	int	nload(void) const { return (m_ntaps-1)/4+1; }
+	void	load(span<const int32_t> taps);
+	int	delay(void) const { return 2; }
+};
+// }}}
+
+// SUBFILDOWN
+// {{{
+// subfildown.v: a decimating filter, producing one output for every ndown
+// inputs.  The core keeps its last 2^clog2(ncoeffs) samples in a memory,
+// and on the first sample of every block of ndown it multiplies the ncoeffs
+// coefficients against that memory--oldest sample (the one about to be
+// overwritten) first.  The sum is then shifted left by shift, rounded to
+// ow bits, and saturated.
+//
+// The core produces each output at the start of the next block.  Here,
+// it's produced at the start of its own block, so delay() is ndown.
+//
+// Only i_ce and the coefficients affect the core's block timing--i_reset
+// doesn't.  So, to match a core, this engine needs to see every sample the
+// core has seen since power up.  reset() returns it to that power up state.
+class	SUBFILDOWN : public DSPFILTER {
+protected:
+	int		m_iw, m_ow, m_cw, m_ndown, m_ncoeffs, m_shift,
+			m_lgmem, m_aw;
+	int64_t		*m_coeffs, *m_mem;
+	unsigned	m_wraddr;
+	int		m_countdown;
+
+	int32_t	round(int64_t acc) const;
+public:
+	SUBFILDOWN(int iw, int ow, int cw, int ndown, int ncoeffs, int shift);
+	~SUBFILDOWN(void);
+
+	int	NDOWN(void) const { return m_ndown; }
+	int	NCOEFFS(void) const { return m_ncoeffs; }
+	int	LGMEM(void) const { return m_lgmem; }
+	const int64_t *coeffs(void) const { return m_coeffs; }
+
+	// The bit exact rounding and saturation of one accumulator value
+	int32_t	output(int64_t acc) const { return round(acc); }
+
+	// Load all ncoeffs coefficients, in the order i_tap would
+	void	load(span<const int32_t> coeffs);
+
+	void	reset(void);
+	int	process(span<const int32_t> in, span<int32_t> out);
+	int	maxout(int nin) const { return nin / m_ndown + 1; }
+	int	delay(void) const { return m_ndown; }
+};
+// }}}
+
+// RATFIL
+// {{{
+// ratfil.v: a rational resampler, nup/ndown < 1, for ns interleaved
+// streams.  in[] holds one beat per sample, stream 0 first, and the core is
+// told (via TLAST) that every ns'th beat is the last of its group.  Each
+// output is taken from the coefficients starting at a phase between 0 and
+// nup-1, stepping by nup, against the most recent inputs of its stream.
+// The sum is shifted left by lggain and rounded to ow bits.  The output is
+// then the bottom iw bits of that, since M_AXI_TDATA is iw bits wide.
+// Outputs are produced in the same interleaved order.
+//
+// As with the core, reset() doesn't clear the data memory--it only resets
+// the write address.  Data written before the reset may therefore show up
+// in the outputs following it.
+class	RATFIL : public DSPFILTER {
+	int		m_iw, m_tw, m_ow, m_ns, m_nup, m_ndown, m_lggain,
+			m_ncoeffs, m_lgmem, m_aw;
+	int64_t		*m_coeffs, *m_mem;
+	unsigned	m_wraddr;
+	int		m_beat, m_phase, m_skip;
+	bool		m_skip_run;
+
+	int32_t	round(int64_t acc) const;
+public:
+	RATFIL(int iw, int tw, int ow, int ns, int nup, int ndown, int lggain,
+			int ncoeffs);
+	~RATFIL(void);
+
+	// Load all ncoeffs coefficients, in the order i_tap would
+	void	load(span<const int32_t> coeffs);
+
+	void	reset(void);
+	int	process(span<const int32_t> in, span<int32_t> out);
+	int	maxout(int nin) const {
+		return (int)(((int64_t)nin * m_nup) / m_ndown) + m_ns; }
+};
+// }}}
+
+// BOXCAR
+// {{{
+// boxcar.v: the (unsigned) sum of the last navg samples, rounded to ow
+// bits.  The core's running sum adds the zero extended iw+1 bit difference
+// between the newest and oldest samples, and this engine does the same.
+// i_navg is only read on reset, so changing navg requires reset(navg).
+// The memory isn't cleared on reset, so (as with the core) navg=0 sums
+// the last 2^lgmem samples, some from before the reset.
+class	BOXCAR : public DSPFILTER {
+	int		m_iw, m_lgmem, m_ow, m_navg;
+	uint64_t	*m_mem, m_acc;
+	unsigned	m_wraddr, m_rdaddr;
+	bool		m_full;
+
+	uint32_t	round(uint64_t acc) const;
+public:
+	BOXCAR(int iw, int lgmem, int ow, int navg);
+	~BOXCAR(void);
+
+	void	reset(int navg) { m_navg = navg; reset(); }
+	void	reset(void);
+	int	process(span<const int32_t> in, span<int32_t> out);
+	int	delay(void) const { return 3; }
+};
+// }}}
+
+// IIRAVG
+// {{{
+// iiravg.v: a recursive average, avg += (x - avg) >> lgalpha.  Both the
+// input and the average are unsigned, and the difference is taken at ow
+// bits--so it may overflow, just like the core's does.
+class	IIRAVG : public DSPFILTER {
+	int		m_iw, m_ow, m_lgalpha;
+	uint64_t	m_reset_value, m_average;
+public:
+	IIRAVG(int iw, int ow, int lgalpha, uint64_t reset_value = 0);
+
+	uint64_t	average(void) const { return m_average; }
+
+	void	reset(void) { m_average = m_reset_value; }
+	int	process(span<const int32_t> in, span<int32_t> out);
+};
+// }}}
+
+// CHEAPSPECTRAL
+// {{{
+// cheapspectral.v: an autocorrelation estimate, the sum of 2^lgnavg
+// products x[n]*x[n-lag] for each of 2^lglags lags.  (The single buffered,
+// restart on request, configuration only.)
+//
+// Which samples the core uses depends upon which clocks they arrive on, so
+// this engine is clocked just like the core.  process() feeds it one sample
+// per clock, idle() clocks it with no sample, and start() is a bus write
+// requesting a new estimate.  Once the estimate is complete, process()
+// writes all 2^lglags values to out[], in the order they'd be read from the
+// bus: the largest lag first, ending with lag zero.
+class	CHEAPSPECTRAL : public DSPFILTER {
+	int		m_iw, m_lglags, m_lgnavg, m_ab;
+	int64_t		*m_data, *m_av;
+	unsigned	m_wraddr, m_dlyaddr, m_avaddr, m_avcounts;
+	bool		m_start_request, m_check, m_running, m_clear;
+
+	bool	clock(bool ce, int64_t sample, bool wb_write);
+public:
+	CHEAPSPECTRAL(int iw, int lglags, int lgnavg);
+	~CHEAPSPECTRAL(void);
+
+	int	LAGS(void) const { return 1 << m_lglags; }
+
+	// The value read from address addr, at any time
+	int32_t	result(int addr) const;
+
+	void	start(void) { clock(false, 0, true); }
+	void	idle(int nclocks = 1);
+
+	void	reset(void);
+	int	process(span<const int32_t> in, span<int32_t> out);
+	int	maxout(int) const { return 1 << m_lglags; }
+};
+// }}}
+
+#endif
@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	subfildown_bench.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	Measures the throughput of SUBFILDOWN_SIMD, at each of the
+//		instruction sets this CPU supports, against both its own scalar
+//	path and the (circular buffer) SUBFILDOWN engine.  The default
+//	subfildown.v parameters are used: 16-bit samples, 12-bit coefficients,
+//	103 coefficients, and a decimation rate of five.
+//
+//	Every path is also checked against SUBFILDOWN, so this doubles as a
+//	check that the vector kernels are bit exact.  Usage:
+//
+//		subfildown_bench [nsamples]
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dspfilters.h"
+#include "subfildown_simd.h"
+
+const	int	IW = 16, OW = 24, CW = 12, NDOWN = 5, NCOEFFS = 103, SHIFT = 2;
+
+// Samples given to process() per call.  Not a multiple of NDOWN, so blocks
+// will span calls.
+const	int	BLOCKLEN = 10000;
+
+// now
+// {{{
+static	double	now(void) {
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+// }}}
+
+// run
+// {{{
+// Runs nlen samples through the engine, BLOCKLEN at a time, and returns
+// the time it took in seconds
+static	double	run(DSPFILTER &eng, const int32_t *in, int nlen, int32_t *out,
+		int &nout) {
+	double	start;
+
+	eng.reset();
+	nout = 0;
+	start = now();
+	for(int k=0; k<nlen; k+=BLOCKLEN) {
+		int	ln = (nlen - k < BLOCKLEN) ? nlen - k : BLOCKLEN;
+
+		nout += eng.process(span<const int32_t>(in+k, ln),
+				span<int32_t>(out+nout, eng.maxout(ln)));
+	}
+
+	return now() - start;
+}
+// }}}
+
+int	main(int argc, char **argv) {
+	int	nlen = (argc > 1) ? atoi(argv[1]) : 10000000;
+	int32_t	taps[NCOEFFS], *in, *ref, *out;
+	int	nref, nout;
+	double	tref, tscalar = 0;
+	bool	pass = true;
+
+	if (nlen < 1) {
+		fprintf(stderr, "Usage: %s [nsamples]\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	in  = new int32_t[nlen];
+	ref = new int32_t[nlen / NDOWN + BLOCKLEN];
+	out = new int32_t[nlen / NDOWN + BLOCKLEN];
+
+	// Random coefficients.  Full scale data, save for a stretch of small
+	// values in the middle to check the rounding of small results.
+	srand(1);
+	for(int k=0; k<NCOEFFS; k++)
+		taps[k] = (rand() & ((1<<CW)-1)) - (1<<(CW-1));
+	for(int k=0; k<nlen; k++) {
+		in[k] = (rand() & ((1<<IW)-1)) - (1<<(IW-1));
+		if (k > nlen/3 && k < nlen/2)
+			in[k] >>= 10;
+	}
+
+	SUBFILDOWN	sref(IW, OW, CW, NDOWN, NCOEFFS, SHIFT);
+	sref.load(span<const int32_t>(taps, NCOEFFS));
+	tref = run(sref, in, nlen, ref, nref);
+	printf("%-12s %8.1f MS/s\n", "SUBFILDOWN", nlen / tref / 1e6);
+
+	for(int isa=DSPISA_SCALAR; isa<=dspisa_best(); isa++) {
+		SUBFILDOWN_SIMD	eng(IW, OW, CW, NDOWN, NCOEFFS, SHIFT,
+					(DSPISA)isa);
+		double	t;
+
+		eng.load(span<const int32_t>(taps, NCOEFFS));
+		t = run(eng, in, nlen, out, nout);
+		if (isa == DSPISA_SCALAR)
+			tscalar = t;
+
+		printf("%-12s %8.1f MS/s, %5.2fx scalar\n",
+			dspisa_name(eng.isa()), nlen / t / 1e6, tscalar / t);
+
+		if (nout != nref
+			|| memcmp(out, ref, nref * sizeof(int32_t)) != 0) {
+			printf("%s: Outputs don't match SUBFILDOWN\n",
+				dspisa_name(eng.isa()));
+			pass = false;
+		}
+	}
+
+	delete[] in;
+	delete[] ref;
+	delete[] out;
+
+	if (pass)
+		printf("SUCCESS!!\n");
+	else
+		printf("TEST FAILURE!\n");
+
+	return (pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,383 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	subfildown_simd.cpp
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	The scalar, AVX2, and AVX-512 kernels of SUBFILDOWN_SIMD, and
+//		the run time choice between them.  The vector kernels are
+//	compiled for their instruction sets using function target attributes,
+//	so the rest of the library (and this file) can be built for any x86
+//	CPU.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "subfildown_simd.h"
+
+#if	defined(__x86_64__) && defined(__GNUC__)
+#define	DSP_X86
+// Some versions of GCC's AVX-512 intrinsics trip -W(maybe-)uninitialized
+// when they're inlined into a function with a target attribute
+#pragma	GCC diagnostic push
+#pragma	GCC diagnostic ignored "-Wuninitialized"
+#pragma	GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma	GCC diagnostic pop
+#endif
+
+// Samples are processed CHUNK at a time, following the last 2^LGMEM
+static	const	int	CHUNK = 4096;
+
+// Coefficients are zero padded to a multiple of the widest vector
+static	const	int	HPAD = 32;
+
+// fastround
+// {{{
+// The same shift, rounding and saturation as SUBFILDOWN::round(), but
+// without any branches--so it can be inlined into the output loop below.
+// acc must be the exact sum, which (for any coefficients and data) fits
+// within aw bits.
+static inline	int32_t	fastround(int64_t acc, int aw, int ow, int shift) {
+	const	uint64_t	mask = (1ul << aw)-1;
+	const	int		lsb  = aw - ow - 1;
+	const	uint64_t	pre  = ((uint64_t)acc << shift) & mask;
+	const	uint64_t	rounded = (pre + (1ul << lsb) - 1
+					+ ((pre >> lsb) & 1)) & mask;
+	const	bool	sgn = (acc < 0),
+			overflow = (sgn) ? !(pre >> (aw-1))
+					: (rounded >> (aw-1));
+	const	int32_t	sat = (int32_t)((sgn) ? -(1l << (ow-1))
+					: (1l << (ow-1)) - 1);
+
+	return (overflow) ? sat
+		: (int32_t)((int64_t)(rounded << (64-aw)) >> (64-ow));
+}
+// }}}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Kernels
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+// Each kernel computes nout dot products, acc[k], of the ntaps coefficients
+// in h[] against x[k*ndown ...].  The vector kernels may read past ntaps, up
+// to the next multiple of HPAD, where the coefficients are all zero.  ngroup
+// is the number of vectors whose products may be added together in 32 bits
+// before they need to be widened.
+//
+
+// decim_scalar
+// {{{
+static	void	decim_scalar(const int16_t *h, int ntaps, int,
+		const int16_t *x, int ndown, int nout, int64_t *acc) {
+	for(int k=0; k<nout; k++) {
+		const	int16_t	*w = x + k*ndown;
+		int64_t	sum = 0;
+
+		for(int t=0; t<ntaps; t++)
+			sum += (int32_t)h[t] * w[t];
+		acc[k] = sum;
+	}
+}
+// }}}
+
+#ifdef	DSP_X86
+// NOUT outputs are computed at a time, so each coefficient vector is loaded
+// once for all of them
+static	const	int	NOUT = 4;
+
+// dot_avx2
+// {{{
+template<int N> __attribute__((target("avx2")))
+static inline	void	dot_avx2(const int16_t *h, int nv, int ngroup,
+		const int16_t *x, int ndown, int64_t *acc) {
+	__m256i	sum64[N];
+
+	for(int j=0; j<N; j++)
+		sum64[j] = _mm256_setzero_si256();
+
+	for(int v=0; v<nv; ) {
+		__m256i	sum32[N];
+
+		for(int j=0; j<N; j++)
+			sum32[j] = _mm256_setzero_si256();
+
+		for(int g=0; g<ngroup && v<nv; g++, v++) {
+			const	__m256i	hv = _mm256_loadu_si256(
+					(const __m256i *)(h + 16*v));
+
+			for(int j=0; j<N; j++) {
+				const	__m256i	xv = _mm256_loadu_si256(
+					(const __m256i *)(x + j*ndown + 16*v));
+
+				sum32[j] = _mm256_add_epi32(sum32[j],
+						_mm256_madd_epi16(hv, xv));
+			}
+		}
+
+		for(int j=0; j<N; j++) {
+			sum64[j] = _mm256_add_epi64(sum64[j],
+				_mm256_cvtepi32_epi64(
+					_mm256_castsi256_si128(sum32[j])));
+			sum64[j] = _mm256_add_epi64(sum64[j],
+				_mm256_cvtepi32_epi64(
+					_mm256_extracti128_si256(sum32[j], 1)));
+		}
+	}
+
+	for(int j=0; j<N; j++) {
+		const	__m128i	s = _mm_add_epi64(
+					_mm256_castsi256_si128(sum64[j]),
+					_mm256_extracti128_si256(sum64[j], 1));
+
+		acc[j] = _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+	}
+}
+// }}}
+
+// decim_avx2
+// {{{
+__attribute__((target("avx2")))
+static	void	decim_avx2(const int16_t *h, int ntaps, int ngroup,
+		const int16_t *x, int ndown, int nout, int64_t *acc) {
+	const	int	nv = (ntaps + 15) / 16;
+	int	k;
+
+	for(k=0; k+NOUT<=nout; k+=NOUT)
+		dot_avx2<NOUT>(h, nv, ngroup, x + k*ndown, ndown, acc + k);
+	for(; k<nout; k++)
+		dot_avx2<1>(h, nv, ngroup, x + k*ndown, ndown, acc + k);
+}
+// }}}
+
+// dot_avx512
+// {{{
+template<int N> __attribute__((target("avx512f,avx512bw")))
+static inline	void	dot_avx512(const int16_t *h, int nv, int ngroup,
+		const int16_t *x, int ndown, int64_t *acc) {
+	__m512i	sum64[N];
+
+	for(int j=0; j<N; j++)
+		sum64[j] = _mm512_setzero_si512();
+
+	for(int v=0; v<nv; ) {
+		__m512i	sum32[N];
+
+		for(int j=0; j<N; j++)
+			sum32[j] = _mm512_setzero_si512();
+
+		for(int g=0; g<ngroup && v<nv; g++, v++) {
+			const	__m512i	hv = _mm512_loadu_si512(
+					(const void *)(h + 32*v));
+
+			for(int j=0; j<N; j++) {
+				const	__m512i	xv = _mm512_loadu_si512(
+					(const void *)(x + j*ndown + 32*v));
+
+				sum32[j] = _mm512_add_epi32(sum32[j],
+						_mm512_madd_epi16(hv, xv));
+			}
+		}
+
+		// Sign extend the odd and even 32-bit lanes to 64 bits
+		for(int j=0; j<N; j++) {
+			sum64[j] = _mm512_add_epi64(sum64[j],
+				_mm512_srai_epi64(
+					_mm512_slli_epi64(sum32[j], 32), 32));
+			sum64[j] = _mm512_add_epi64(sum64[j],
+				_mm512_srai_epi64(sum32[j], 32));
+		}
+	}
+
+	for(int j=0; j<N; j++)
+		acc[j] = _mm512_reduce_add_epi64(sum64[j]);
+}
+// }}}
+
+// decim_avx512
+// {{{
+__attribute__((target("avx512f,avx512bw")))
+static	void	decim_avx512(const int16_t *h, int ntaps, int ngroup,
+		const int16_t *x, int ndown, int nout, int64_t *acc) {
+	const	int	nv = (ntaps + 31) / 32;
+	int	k;
+
+	for(k=0; k+NOUT<=nout; k+=NOUT)
+		dot_avx512<NOUT>(h, nv, ngroup, x + k*ndown, ndown, acc + k);
+	for(; k<nout; k++)
+		dot_avx512<1>(h, nv, ngroup, x + k*ndown, ndown, acc + k);
+}
+// }}}
+#endif
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// Instruction set selection
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+
+DSPISA	dspisa_best(void) {
+#ifdef	DSP_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")
+			&& __builtin_cpu_supports("avx512bw"))
+		return DSPISA_AVX512;
+	if (__builtin_cpu_supports("avx2"))
+		return DSPISA_AVX2;
+#endif
+	return DSPISA_SCALAR;
+}
+
+const char *dspisa_name(DSPISA isa) {
+	switch(isa) {
+	case DSPISA_AVX2:	return "AVX2";
+	case DSPISA_AVX512:	return "AVX-512";
+	default:		return "Scalar";
+	}
+}
+// }}}
+////////////////////////////////////////////////////////////////////////////////
+//
+// SUBFILDOWN_SIMD
+// {{{
+////////////////////////////////////////////////////////////////////////////////
+//
+//
+
+SUBFILDOWN_SIMD::SUBFILDOWN_SIMD(int iw, int ow, int cw, int ndown,
+		int ncoeffs, int shift, DSPISA isa)
+		: SUBFILDOWN(iw, ow, cw, ndown, ncoeffs, shift) {
+	const	int	nh = (ncoeffs + HPAD-1) & -HPAD;
+
+	assert(iw <= 16);
+	assert(cw <= 16);
+
+	// A pair of products, summed, takes iw+cw-1 bits.  Each 32-bit lane
+	// can then hold ngroup of those sums, before it needs to be widened.
+	m_ngroup = (iw + cw <= 31) ? (1 << (32 - iw - cw)) - 1 : 0;
+
+	if (isa > dspisa_best())
+		isa = dspisa_best();
+	if (m_ngroup == 0)
+		isa = DSPISA_SCALAR;
+
+	m_isa = isa;
+	switch(isa) {
+#ifdef	DSP_X86
+	case DSPISA_AVX2:	m_kernel = decim_avx2;   break;
+	case DSPISA_AVX512:	m_kernel = decim_avx512; break;
+#endif
+	default:		m_kernel = decim_scalar; break;
+	}
+
+	m_h   = new int16_t[nh];
+	m_buf = new int16_t[(1<<m_lgmem) + CHUNK + nh];
+	m_acc = new int64_t[CHUNK / ndown + 1];
+
+	memset(m_h,   0, nh * sizeof(int16_t));
+	memset(m_buf, 0, ((1<<m_lgmem) + CHUNK + nh) * sizeof(int16_t));
+}
+
+SUBFILDOWN_SIMD::~SUBFILDOWN_SIMD(void) {
+	delete[] m_h;
+	delete[] m_buf;
+	delete[] m_acc;
+}
+
+void	SUBFILDOWN_SIMD::load(span<const int32_t> coeffs) {
+	SUBFILDOWN::load(coeffs);
+
+	for(int k=0; k<m_ncoeffs; k++)
+		m_h[k] = (int16_t)m_coeffs[k];
+}
+
+void	SUBFILDOWN_SIMD::reset(void) {
+	SUBFILDOWN::reset();
+
+	memset(m_buf, 0, (1<<m_lgmem) * sizeof(int16_t));
+}
+
+// process
+// {{{
+// m_buf[] holds the last 2^LGMEM samples, followed by the samples of this
+// chunk.  A block starting with sample x[j] of the chunk then uses
+// m_buf[j ...], beginning with the sample 2^LGMEM before x[j], just as
+// SUBFILDOWN does.  m_countdown is the number of samples remaining until the
+// next block starts.
+int	SUBFILDOWN_SIMD::process(span<const int32_t> in, span<int32_t> out) {
+	const	int	mlen = 1 << m_lgmem,
+			iw = m_iw, aw = m_aw, ow = m_ow, shift = m_shift;
+	const	int32_t	*src = in.data();
+	int16_t	*const	buf = m_buf;
+	const	int64_t	*const	acc = m_acc;
+	int32_t	*dst = out.data();
+
+	assert((int)out.size() >= maxout((int)in.size()));
+
+	for(size_t base=0; base<in.size(); ) {
+		const	int	len = (in.size() - base < (size_t)CHUNK)
+					? (int)(in.size() - base) : CHUNK;
+		int	nblocks = 0;
+
+		for(int k=0; k<len; k++)
+			buf[mlen + k] = (int16_t)((int32_t)((uint32_t)src[base+k]
+					<< (32-iw)) >> (32-iw));
+
+		if (m_countdown < len) {
+			nblocks = (len - 1 - m_countdown) / m_ndown + 1;
+
+			m_kernel(m_h, m_ncoeffs, m_ngroup, buf + m_countdown,
+				m_ndown, nblocks, m_acc);
+
+			for(int k=0; k<nblocks; k++)
+				dst[k] = fastround(acc[k], aw, ow, shift);
+			dst += nblocks;
+		}
+
+		m_countdown += nblocks * m_ndown - len;
+
+		// Keep the last 2^LGMEM samples for the next chunk
+		memmove(buf, buf + len, mlen * sizeof(int16_t));
+		base += len;
+	}
+
+	return (int)(dst - out.data());
+}
+// }}}
+// }}}
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Filename: 	subfildown_simd.h
+// {{{
+// Project:	DSP Filtering Example Project
+//
+// Purpose:	A vectorized copy of the SUBFILDOWN engine, for when a lot of
+//		data needs to be run through subfildown.v's filter in software.
+//	Its outputs are bit for bit identical to SUBFILDOWN's, and hence to
+//	the core's.
+//
+//	Only the retained outputs are computed.  Each is the dot product of
+//	the ncoeffs coefficients with a window of 16-bit samples, taken 16
+//	(AVX2) or 32 (AVX-512) products at a time with 32-bit partial sums.
+//	Those partial sums are widened to 64-bits often enough that they can
+//	never overflow.  The full accumulator is kept, and then rounded and
+//	saturated exactly as SUBFILDOWN does.
+//
+//	The instruction set is chosen at run time, from what the CPU supports,
+//	unless a particular one is requested.
+//
+// Creator:	Dan Gisselquist, Ph.D.
+//		Gisselquist Technology, LLC
+//
+////////////////////////////////////////////////////////////////////////////////
+// }}}
+// Copyright (C) 2024, Gisselquist Technology, LLC
+// {{{
+// This file is part of the DSP filtering set of designs.
+//
+// The DSP filtering designs are free RTL designs: you can redistribute them
+// and/or modify any of them under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The DSP filtering designs are distributed in the hope that they will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTIBILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with these designs.  (It's in the $(ROOT)/doc directory.  Run make
+// with no target there if the PDF file isn't present.)  If not, see
+// <http://www.gnu.org/licenses/> for a copy.
+// }}}
+// License:	LGPL, v3, as defined and found on www.gnu.org,
+// {{{
+//		http://www.gnu.org/licenses/lgpl.html
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// }}}
+#ifndef	SUBFILDOWN_SIMD_H
+#define	SUBFILDOWN_SIMD_H
+
+#include "dspfilters.h"
+
+// DSPISA
+// {{{
+// The instruction sets the vectorized engines know how to use, in order of
+// preference
+typedef	enum	{ DSPISA_SCALAR = 0, DSPISA_AVX2, DSPISA_AVX512 } DSPISA;
+
+// The best instruction set this CPU supports
+extern	DSPISA		dspisa_best(void);
+extern	const char	*dspisa_name(DSPISA isa);
+// }}}
+
+// SUBFILDOWN_SIMD
+// {{{
+// Same parameters, coefficients, and results as SUBFILDOWN, save that the
+// samples and coefficients must fit in 16 bits.  If iw+cw > 31, a pair of
+// products may no longer fit in 32 bits, and the scalar path is used.
+// Asking for an instruction set the CPU doesn't have gets the best one it
+// does.
+class	SUBFILDOWN_SIMD : public SUBFILDOWN {
+	typedef	void	(*KERNEL)(const int16_t *h, int ntaps, int ngroup,
+				const int16_t *x, int ndown, int nout,
+				int64_t *acc);
+
+	DSPISA		m_isa;
+	KERNEL		m_kernel;
+	int		m_ngroup;
+	int16_t		*m_h, *m_buf;
+	int64_t		*m_acc;
+public:
+	SUBFILDOWN_SIMD(int iw, int ow, int cw, int ndown, int ncoeffs,
+			int shift, DSPISA isa = dspisa_best());
+	~SUBFILDOWN_SIMD(void);
+
+	DSPISA	isa(void) const { return m_isa; }
+
+	void	load(span<const int32_t> coeffs);
+
+	void	reset(void);
+	int	process(span<const int32_t> in, span<int32_t> out);
+};
+// }}}
+
+#endif